@@ -0,0 +1,302 @@
+// Asset Cache for Clawd Pager
+// Content-addressed image/asset store so the bridge only sends what we lack
+
+#pragma once
+#include "esphome.h"
+#include <vector>
+#if defined(USE_ASSET_CACHE_FLASH)
+#include <LittleFS.h>
+#endif
+
+// Assets are keyed by the 64-bit FNV-1a hash of their bytes (the bridge
+// computes the same hash, devtools/asset_cache.py). The bridge offers a
+// hash first; we answer "have" or "need" on the ASSET log tag, and only a
+// "need" makes it push the bytes. Pushed bytes are re-hashed, so a
+// corrupted transfer never gets cached under the offered key.
+//
+// RAM tier: up to MAX_ENTRIES assets within a byte budget, least recently
+// used evicted first. Optional flash tier (-DUSE_ASSET_CACHE_FLASH, needs a
+// LittleFS/SPIFFS partition): every insert is also written to /assets and
+// survives reboots; RAM misses are refilled from flash. Flash has its own
+// byte budget and LRU order (reset to file order at boot).
+
+inline uint64_t asset_hash(const uint8_t* data, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// 16 lowercase hex digits, the form used in services and log lines
+inline void asset_hash_hex(uint64_t hash, char out[17]) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    for (int i = 15; i >= 0; i--) {
+        out[i] = HEX_DIGITS[hash & 0xF];
+        hash >>= 4;
+    }
+    out[16] = '\0';
+}
+
+inline bool asset_hash_parse(const char* hex, uint64_t* hash) {
+    uint64_t h = 0;
+    for (int i = 0; i < 16; i++) {
+        char c = hex[i];
+        uint8_t v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return false;
+        h = (h << 4) | v;
+    }
+    if (hex[16] != '\0') return false;
+    *hash = h;
+    return true;
+}
+
+class AssetCache {
+public:
+    static const uint8_t MAX_ENTRIES = 32;
+    // Largest single asset: a 240x135 screenshot PNG with the pager's 4 KB
+    // zlib window is ~28 KB, JPEG photos 5-20 KB, 1-bit frames 4050 bytes
+    static const size_t MAX_ASSET_BYTES = 32 * 1024;
+    // One largest asset plus the small ones it shares the screen with
+    // (icons, avatars, QR codes); must be >= MAX_ASSET_BYTES
+    static const size_t DEFAULT_RAM_BUDGET = 48 * 1024;
+    static const size_t DEFAULT_FLASH_BUDGET = 256 * 1024;
+
+    struct Stats {
+        uint32_t hits;
+        uint32_t flash_hits;
+        uint32_t misses;
+        uint32_t inserts;
+        uint32_t evictions;
+        uint32_t rejected;      // Hash mismatch or larger than the budget
+    };
+
+    static AssetCache& instance() {
+        static AssetCache inst;
+        return inst;
+    }
+
+    void set_budget(size_t ram_bytes, size_t flash_bytes = DEFAULT_FLASH_BUDGET) {
+        _ram_budget = ram_bytes;
+        _flash_budget = flash_bytes;
+        while (_ram_used > _ram_budget && evict_ram()) {}
+    }
+
+    void begin() {
+#if defined(USE_ASSET_CACHE_FLASH)
+        if (!LittleFS.begin(true)) {
+            ESP_LOGW("ASSET", "LittleFS mount failed, flash tier off");
+            return;
+        }
+        _flash_ok = true;
+        LittleFS.mkdir("/assets");
+        File dir = LittleFS.open("/assets");
+        for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+            uint64_t hash;
+            const char* name = strrchr(f.name(), '/');
+            if (asset_hash_parse(name ? name + 1 : f.name(), &hash) && _flash_count < MAX_FLASH_ENTRIES) {
+                _flash[_flash_count++] = FlashEntry{hash, (uint32_t) f.size(), ++_tick};
+                _flash_used += f.size();
+            }
+        }
+#endif
+    }
+
+    // Offer from the bridge: true if we can serve it (RAM, or flash -> RAM)
+    bool has(uint64_t hash) {
+        if (find_ram(hash) >= 0) return true;
+#if defined(USE_ASSET_CACHE_FLASH)
+        return find_flash(hash) >= 0;
+#else
+        return false;
+#endif
+    }
+
+    // Bytes of an asset, or nullptr; marks it most recently used
+    const std::vector<uint8_t>* get(uint64_t hash) {
+        int i = find_ram(hash);
+        if (i >= 0) {
+            _ram[i].last_used = ++_tick;
+            _stats.hits++;
+            return &_ram[i].data;
+        }
+#if defined(USE_ASSET_CACHE_FLASH)
+        int f = find_flash(hash);
+        if (f >= 0) {
+            std::vector<uint8_t> data;
+            if (load_flash(hash, data) && asset_hash(data.data(), data.size()) == hash) {
+                _flash[f].last_used = ++_tick;
+                _stats.flash_hits++;
+                i = insert_ram(hash, std::move(data));
+                if (i >= 0) return &_ram[i].data;
+            } else {
+                drop_flash(f);  // Corrupt or vanished: forget it
+            }
+        }
+#endif
+        _stats.misses++;
+        return nullptr;
+    }
+
+    // Store pushed bytes; expected = offered hash (0 = don't check).
+    // Returns the content hash, or 0 if rejected.
+    uint64_t put(std::vector<uint8_t> data, uint64_t expected = 0) {
+        uint64_t hash = asset_hash(data.data(), data.size());
+        if ((expected != 0 && hash != expected) || data.size() > _ram_budget) {
+            _stats.rejected++;
+            return 0;
+        }
+        if (find_ram(hash) >= 0) return hash;
+#if defined(USE_ASSET_CACHE_FLASH)
+        store_flash(hash, data);
+#endif
+        if (insert_ram(hash, std::move(data)) < 0) return 0;
+        _stats.inserts++;
+        return hash;
+    }
+
+    const Stats& stats() const { return _stats; }
+    size_t ram_used() const { return _ram_used; }
+    size_t flash_used() const { return _flash_used; }
+    uint8_t count() const { return _ram_count; }
+
+    void log_summary() const {
+        ESP_LOGI("ASSET", "entries=%u ram=%u/%u flash=%u/%u hits=%u flash_hits=%u misses=%u evicted=%u rejected=%u",
+                 _ram_count, (unsigned) _ram_used, (unsigned) _ram_budget, (unsigned) _flash_used,
+                 (unsigned) _flash_budget, (unsigned) _stats.hits, (unsigned) _stats.flash_hits,
+                 (unsigned) _stats.misses, (unsigned) _stats.evictions, (unsigned) _stats.rejected);
+    }
+
+private:
+    struct RamEntry {
+        uint64_t hash;
+        uint32_t last_used;
+        std::vector<uint8_t> data;
+    };
+
+    AssetCache() : _ram_count(0), _ram_used(0), _ram_budget(DEFAULT_RAM_BUDGET),
+                   _flash_used(0), _flash_budget(DEFAULT_FLASH_BUDGET), _tick(0), _stats() {}
+
+    int find_ram(uint64_t hash) const {
+        for (uint8_t i = 0; i < _ram_count; i++) {
+            if (_ram[i].hash == hash) return i;
+        }
+        return -1;
+    }
+
+    int insert_ram(uint64_t hash, std::vector<uint8_t>&& data) {
+        if (data.size() > _ram_budget) return -1;
+        while ((_ram_used + data.size() > _ram_budget || _ram_count >= MAX_ENTRIES) && evict_ram()) {}
+        RamEntry& e = _ram[_ram_count];
+        e.hash = hash;
+        e.last_used = ++_tick;
+        e.data = std::move(data);
+        e.data.shrink_to_fit();
+        _ram_used += e.data.size();
+        return _ram_count++;
+    }
+
+    bool evict_ram() {
+        if (_ram_count == 0) return false;
+        uint8_t lru = 0;
+        for (uint8_t i = 1; i < _ram_count; i++) {
+            if (_ram[i].last_used < _ram[lru].last_used) lru = i;
+        }
+        _ram_used -= _ram[lru].data.size();
+        std::vector<uint8_t>().swap(_ram[lru].data);  // Release the memory now
+        _ram_count--;
+        if (lru != _ram_count) {
+            _ram[lru] = std::move(_ram[_ram_count]);
+        }
+        _stats.evictions++;
+        return true;
+    }
+
+#if defined(USE_ASSET_CACHE_FLASH)
+    static const uint8_t MAX_FLASH_ENTRIES = 128;
+
+    struct FlashEntry {
+        uint64_t hash;
+        uint32_t size;
+        uint32_t last_used;
+    };
+
+    static void flash_path(uint64_t hash, char out[32]) {
+        char hex[17];
+        asset_hash_hex(hash, hex);
+        snprintf(out, 32, "/assets/%s", hex);
+    }
+
+    int find_flash(uint64_t hash) const {
+        for (uint8_t i = 0; i < _flash_count; i++) {
+            if (_flash[i].hash == hash) return i;
+        }
+        return -1;
+    }
+
+    bool load_flash(uint64_t hash, std::vector<uint8_t>& out) {
+        char path[32];
+        flash_path(hash, path);
+        File f = LittleFS.open(path, "r");
+        if (!f) return false;
+        out.resize(f.size());
+        bool ok = f.read(out.data(), out.size()) == out.size();
+        f.close();
+        return ok;
+    }
+
+    void store_flash(uint64_t hash, const std::vector<uint8_t>& data) {
+        if (!_flash_ok || data.size() > _flash_budget || find_flash(hash) >= 0) return;
+        while ((_flash_used + data.size() > _flash_budget || _flash_count >= MAX_FLASH_ENTRIES) &&
+               _flash_count > 0) {
+            uint8_t lru = 0;
+            for (uint8_t i = 1; i < _flash_count; i++) {
+                if (_flash[i].last_used < _flash[lru].last_used) lru = i;
+            }
+            drop_flash(lru);
+        }
+        char path[32];
+        flash_path(hash, path);
+        File f = LittleFS.open(path, "w");
+        if (!f) return;
+        bool ok = f.write(data.data(), data.size()) == data.size();
+        f.close();
+        if (!ok) {
+            LittleFS.remove(path);
+            return;
+        }
+        _flash[_flash_count++] = FlashEntry{hash, (uint32_t) data.size(), ++_tick};
+        _flash_used += data.size();
+    }
+
+    void drop_flash(int i) {
+        char path[32];
+        flash_path(_flash[i].hash, path);
+        LittleFS.remove(path);
+        _flash_used -= _flash[i].size;
+        _flash[i] = _flash[--_flash_count];
+    }
+
+    FlashEntry _flash[MAX_FLASH_ENTRIES];
+    uint8_t _flash_count = 0;
+    bool _flash_ok = false;
+#endif
+
+    RamEntry _ram[MAX_ENTRIES];
+    uint8_t _ram_count;
+    size_t _ram_used;
+    size_t _ram_budget;
+    size_t _flash_used;
+    size_t _flash_budget;
+    uint32_t _tick;
+    Stats _stats;
+};
+
+// Global accessor
+inline AssetCache& asset_cache() {
+    return AssetCache::instance();
+}
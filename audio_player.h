@@ -0,0 +1,345 @@
+// Audio UDP Player for Clawd Pager
+// Plays TTS audio streamed from the bridge (downlink mirror of AudioStreamer)
+
+#pragma once
+#include "esphome.h"
+#include <WiFiUdp.h>
+#include <functional>
+
+// Packet layout (little-endian), one 20 ms frame per datagram:
+//   0  seq          u16, increments per frame, wraps
+//   2  codec        u8, AUDIO_CODEC_*
+//   3  flags        u8, AUDIO_FLAG_START on the first frame, AUDIO_FLAG_END on the last
+//   4  predictor    i16, IMA ADPCM state at frame start (ignored for PCM)
+//   6  step_index   u8, IMA ADPCM state at frame start
+//   7  reserved
+//   8  payload      320 samples: 640 bytes PCM16 or 160 bytes IMA ADPCM (low nibble first)
+//
+// ADPCM state travels with every frame, so a lost packet never desyncs the
+// decoder. Frames are decoded on arrival into a ring indexed by seq, and the
+// playout side pulls from the ring as fast as the sink (speaker) accepts.
+//
+// Jitter buffer: playback starts once target_depth frames are queued. The
+// target adapts to measured inter-arrival jitter (RFC 3550 estimator) and
+// grows by one frame after every underrun, then slowly shrinks when stable.
+// A missing frame with later frames queued is concealed by repeating the
+// previous frame at half volume per repeat; an empty buffer rebuffers.
+//
+// Wiring, on a board with an I2S speaker (ESPHome speaker component):
+//   on_boot:   audio_player().begin(12347, [](const uint8_t* data, size_t len) {
+//                  return id(tts_speaker).play(data, len);
+//              });
+//   interval:  10ms -> audio_player().loop();
+// Neither pager has one wired yet: the M5StickC Plus only has a buzzer and
+// the ePaper board's ES8311 pins aren't confirmed.
+//
+// Host check: devtools/audio_player_bench.cpp (two streams back to back
+// through a lossy, reordering network).
+
+static const uint8_t AUDIO_CODEC_PCM16 = 0;
+static const uint8_t AUDIO_CODEC_IMA_ADPCM = 1;
+static const uint8_t AUDIO_FLAG_START = 0x01;
+static const uint8_t AUDIO_FLAG_END = 0x02;
+
+class AudioPlayer {
+public:
+    static const uint16_t SAMPLE_RATE = 16000;
+    static const uint16_t FRAME_SAMPLES = 320;          // 20 ms
+    static const uint8_t FRAME_MS = 20;
+    static const uint8_t SLOTS = 16;                    // 320 ms of buffering
+    static const uint8_t MIN_DEPTH = 2;
+    static const uint8_t MAX_DEPTH = SLOTS - 2;
+    static const uint8_t MAX_CONCEAL = 3;               // Then silence
+    static const uint16_t STABLE_FRAMES = 250;          // 5 s before shrinking depth
+    static const size_t HEADER_SIZE = 8;
+    static const size_t MAX_PACKET = HEADER_SIZE + FRAME_SAMPLES * 2;
+
+    // Sink accepts PCM16 bytes, returns how many it took (e.g. speaker play())
+    typedef std::function<size_t(const uint8_t*, size_t)> Sink;
+
+    struct Stats {
+        uint32_t received;
+        uint32_t late;          // Arrived after its playout time
+        uint32_t concealed;     // Frames synthesized for a gap
+        uint32_t underruns;     // Buffer ran dry mid-stream
+        uint8_t depth;          // Frames queued now
+        uint8_t target_depth;
+        float jitter_ms;
+    };
+
+    static AudioPlayer& instance() {
+        static AudioPlayer inst;
+        return inst;
+    }
+
+    void begin(uint16_t port, Sink sink) {
+        _sink = sink;
+        _udp.begin(port);
+        reset_stream();
+    }
+
+    // Call frequently (interval or loop); drains the socket and feeds the sink
+    void loop() {
+        int size;
+        while ((size = _udp.parsePacket()) > 0) {
+            int len = _udp.read(_packet, sizeof(_packet));
+            if (len >= (int) HEADER_SIZE) on_packet(_packet, len, millis());
+        }
+        pump();
+    }
+
+    bool is_playing() const { return _streaming; }
+    Stats stats() const {
+        Stats s = _stats;
+        s.depth = depth();
+        s.target_depth = _target_depth;
+        s.jitter_ms = _jitter_ms;
+        return s;
+    }
+
+    // Playout delay currently added by the jitter buffer
+    uint16_t playout_delay_ms() const { return depth() * FRAME_MS; }
+
+    void on_packet(const uint8_t* data, size_t len, uint32_t now_ms) {
+        uint16_t seq = data[0] | (data[1] << 8);
+        uint8_t codec = data[2];
+        uint8_t flags = data[3];
+
+        if (flags & AUDIO_FLAG_START) {
+            // Every stream numbers from its own START (tts_stream.py: 0), so
+            // nothing seq-based carries over from the previous one
+            reset_stream();
+            memset(&_stats, 0, sizeof(_stats));
+            _streaming = true;
+            _next_seq = seq;
+            _highest_seq = seq - 1;  // Nothing queued yet
+            _last_seq = seq;
+            _jitter_ms = 0;
+        }
+        if (!_streaming) return;  // Mid-stream packets before a START
+
+        update_jitter(seq, now_ms);
+        _stats.received++;
+
+        int16_t ahead = (int16_t) (seq - _next_seq);
+        if (ahead < 0) {
+            _stats.late++;
+            return;
+        }
+        if (ahead >= SLOTS) {
+            // Too far ahead to hold - skip forward, dropping what we had
+            _next_seq = seq - (SLOTS - 1);
+            for (uint8_t i = 0; i < SLOTS; i++) _valid[i] = false;
+        }
+
+        uint8_t slot = seq % SLOTS;
+        bool ok = decode(codec, data, len, _frames[slot]);
+        _valid[slot] = ok;
+        _slot_seq[slot] = seq;
+        if (ok && (int16_t) (seq - _highest_seq) > 0) _highest_seq = seq;
+        if (flags & AUDIO_FLAG_END) {
+            _end_seen = true;
+            _end_seq = seq;
+        }
+    }
+
+private:
+    AudioPlayer()
+        : _target_depth(3), _streaming(false), _buffering(true), _end_seen(false),
+          _next_seq(0), _highest_seq(0), _end_seq(0), _conceal_run(0), _stable_frames(0),
+          _out_offset(0), _out_len(0), _last_arrival_ms(0), _last_seq(0), _have_arrival(false),
+          _jitter_ms(0) {
+        memset(&_stats, 0, sizeof(_stats));
+        for (uint8_t i = 0; i < SLOTS; i++) _valid[i] = false;
+    }
+
+    void reset_stream() {
+        for (uint8_t i = 0; i < SLOTS; i++) _valid[i] = false;
+        _streaming = false;
+        _buffering = true;
+        _end_seen = false;
+        _conceal_run = 0;
+        _stable_frames = 0;
+        _out_offset = _out_len = 0;
+        _have_arrival = false;
+        memset(_last_frame, 0, sizeof(_last_frame));
+    }
+
+    uint8_t depth() const {
+        if (!_streaming) return 0;
+        int16_t d = (int16_t) (_highest_seq - _next_seq) + 1;
+        if (d < 0) return 0;
+        return d > SLOTS ? SLOTS : d;
+    }
+
+    bool has_frame(uint16_t seq) const {
+        uint8_t slot = seq % SLOTS;
+        return _valid[slot] && _slot_seq[slot] == seq;
+    }
+
+    // RFC 3550 interarrival jitter, in ms, against the 20 ms frame clock
+    void update_jitter(uint16_t seq, uint32_t now_ms) {
+        if (_have_arrival) {
+            int32_t expected = (int16_t) (seq - _last_seq) * (int32_t) FRAME_MS;
+            int32_t d = (int32_t) (now_ms - _last_arrival_ms) - expected;
+            if (d < 0) d = -d;
+            _jitter_ms += (d - _jitter_ms) / 16.0f;
+        }
+        _have_arrival = true;
+        _last_arrival_ms = now_ms;
+        _last_seq = seq;
+
+        // Enough frames to ride out ~2x jitter, plus one
+        uint8_t wanted = (uint8_t) (2.0f * _jitter_ms / FRAME_MS + 0.999f) + 1;
+        if (wanted < MIN_DEPTH) wanted = MIN_DEPTH;
+        if (wanted > MAX_DEPTH) wanted = MAX_DEPTH;
+        if (wanted > _target_depth) _target_depth = wanted;
+    }
+
+    // Move frames from the ring into the sink while it has room
+    void pump() {
+        if (!_sink || !_streaming) return;
+
+        while (true) {
+            // Flush the partially written frame first
+            if (_out_offset < _out_len) {
+                size_t n = _sink(reinterpret_cast<const uint8_t*>(_out) + _out_offset,
+                                 _out_len - _out_offset);
+                _out_offset += n;
+                if (_out_offset < _out_len) return;  // Sink full
+            }
+
+            if (_end_seen && (int16_t) (_next_seq - _end_seq) > 0) {
+                ESP_LOGI("AUDIO_RX", "Stream done: %u frames, %u late, %u concealed, %u underruns, target %d",
+                         _stats.received, _stats.late, _stats.concealed, _stats.underruns, _target_depth);
+                _streaming = false;
+                return;
+            }
+
+            if (_buffering) {
+                if (depth() < _target_depth && !_end_seen) return;
+                _buffering = false;
+            }
+
+            if (has_frame(_next_seq)) {
+                uint8_t slot = _next_seq % SLOTS;
+                memcpy(_out, _frames[slot], sizeof(_out));
+                memcpy(_last_frame, _out, sizeof(_last_frame));
+                _valid[slot] = false;
+                _conceal_run = 0;
+                if (++_stable_frames >= STABLE_FRAMES) {
+                    // Stable for a while - try one frame less latency
+                    _stable_frames = 0;
+                    if (_target_depth > MIN_DEPTH) _target_depth--;
+                }
+            } else if (depth() > 1) {
+                // Gap with later frames queued - conceal the lost frame
+                conceal();
+            } else {
+                // Nothing queued - underrun, rebuffer to a deeper target
+                _stats.underruns++;
+                _stable_frames = 0;
+                if (_target_depth < MAX_DEPTH) _target_depth++;
+                _buffering = true;
+                return;
+            }
+
+            _next_seq++;
+            _out_offset = 0;
+            _out_len = sizeof(_out);
+        }
+    }
+
+    void conceal() {
+        _stats.concealed++;
+        _stable_frames = 0;
+        if (_conceal_run < MAX_CONCEAL) {
+            _conceal_run++;
+            for (uint16_t i = 0; i < FRAME_SAMPLES; i++) {
+                _last_frame[i] /= 2;  // Fade the repeat to avoid a buzz
+                _out[i] = _last_frame[i];
+            }
+        } else {
+            memset(_out, 0, sizeof(_out));
+        }
+    }
+
+    bool decode(uint8_t codec, const uint8_t* data, size_t len, int16_t* out) {
+        const uint8_t* payload = data + HEADER_SIZE;
+        size_t payload_len = len - HEADER_SIZE;
+
+        if (codec == AUDIO_CODEC_PCM16) {
+            if (payload_len < FRAME_SAMPLES * 2) return false;
+            memcpy(out, payload, FRAME_SAMPLES * 2);
+            return true;
+        }
+        if (codec == AUDIO_CODEC_IMA_ADPCM) {
+            if (payload_len < FRAME_SAMPLES / 2) return false;
+            int32_t predictor = (int16_t) (data[4] | (data[5] << 8));
+            int step_index = data[6] > 88 ? 88 : data[6];
+            for (uint16_t i = 0; i < FRAME_SAMPLES; i++) {
+                uint8_t byte = payload[i / 2];
+                uint8_t nibble = (i & 1) ? (byte >> 4) : (byte & 0x0F);
+                out[i] = ima_step(nibble, predictor, step_index);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    static int16_t ima_step(uint8_t nibble, int32_t& predictor, int& step_index) {
+        static const int16_t STEPS[89] = {
+            7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+            50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+            253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+            1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+            3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+            12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+        static const int8_t INDEX[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+        int step = STEPS[step_index];
+        int diff = step >> 3;
+        if (nibble & 4) diff += step;
+        if (nibble & 2) diff += step >> 1;
+        if (nibble & 1) diff += step >> 2;
+        predictor += (nibble & 8) ? -diff : diff;
+        if (predictor > 32767) predictor = 32767;
+        if (predictor < -32768) predictor = -32768;
+
+        step_index += INDEX[nibble];
+        if (step_index < 0) step_index = 0;
+        if (step_index > 88) step_index = 88;
+        return (int16_t) predictor;
+    }
+
+    WiFiUDP _udp;
+    Sink _sink;
+    Stats _stats;
+    uint8_t _target_depth;
+    bool _streaming;
+    bool _buffering;
+    bool _end_seen;
+    uint16_t _next_seq;
+    uint16_t _highest_seq;
+    uint16_t _end_seq;
+    uint8_t _conceal_run;
+    uint16_t _stable_frames;
+    size_t _out_offset;
+    size_t _out_len;
+    uint32_t _last_arrival_ms;
+    uint16_t _last_seq;
+    bool _have_arrival;
+    float _jitter_ms;
+
+    bool _valid[SLOTS];
+    uint16_t _slot_seq[SLOTS];
+    int16_t _frames[SLOTS][FRAME_SAMPLES];
+    int16_t _last_frame[FRAME_SAMPLES];
+    int16_t _out[FRAME_SAMPLES];
+    uint8_t _packet[MAX_PACKET];
+};
+
+// Global accessor
+inline AudioPlayer& audio_player() {
+    return AudioPlayer::instance();
+}
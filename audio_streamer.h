@@ -3,6 +3,24 @@
 
 #pragma once
 #include <WiFiUdp.h>
+#include <functional>
+
+// Audio packet layout (little-endian) once the bridge has answered a clock
+// sync request (clock_sync.h):
+//   0  FF FE          magic (FF FF stays reserved for markers/side channels)
+//   2  flags          u8, AUDIO_FLAG_*
+//   3  reserved
+//   4  seq            u32, packet counter since START
+//   8  t_us           u64, capture time of the first sample: bridge clock
+//                     (unix us) if AUDIO_FLAG_SYNCED, else pager uptime us
+//   16 PCM            16-bit LE mono, 16 kHz
+// The START marker's last byte is the format version: 0 = raw PCM packets,
+// 1 = the header above. A bridge that never answered a sync request may not
+// know the header (it would take every packet for corrupt PCM), so until
+// then recordings go out as version 0. The format is fixed at START: a
+// reply that lands mid-recording applies from the next one.
+
+static const uint8_t AUDIO_FLAG_SYNCED = 0x01;
 
 class AudioStreamer {
 public:
@@ -20,8 +38,12 @@ public:
     void start_recording() {
         _is_recording = true;
         _bytes_sent = 0;
+        _seq = 0;
+        bool synced = false;
+        if (_time_source) _time_source(&synced);
+        _timestamped = synced;
         // Send start marker
-        uint8_t marker[] = {0xFF, 0xFF, 'S', 'T', 'A', 'R', 'T', 0x00};
+        uint8_t marker[] = {0xFF, 0xFF, 'S', 'T', 'A', 'R', 'T', (uint8_t) (_timestamped ? 1 : 0)};
         _udp.beginPacket(_bridge_ip, _port);
         _udp.write(marker, sizeof(marker));
         _udp.endPacket();
@@ -43,21 +65,77 @@ public:
     }
 
     // Send 16-bit audio samples (from ESPHome microphone)
+    // Samples are taken as captured just now, ending at this call.
     void send_audio(const int16_t* samples, size_t num_samples) {
         if (!_is_recording || num_samples == 0) return;
         // Convert samples to bytes
         send_raw(reinterpret_cast<const uint8_t*>(samples), num_samples * 2);
     }
 
+    // Send one datagram on the shared socket (for non-audio side channels)
+    // @param port: destination port on the bridge host (0 = audio port)
+    void send_datagram(const uint8_t* data, size_t len, uint16_t port = 0) {
+        _udp.beginPacket(_bridge_ip, port ? port : _port);
+        _udp.write(data, len);
+        _udp.endPacket();
+    }
+
+    // Replies from the bridge arrive on the same socket; each handler gets
+    // every datagram until one returns true (consumed)
+    typedef std::function<bool(const uint8_t* data, size_t len)> ReceiveHandler;
+    void add_receive_handler(ReceiveHandler handler) {
+        if (_handler_count < MAX_HANDLERS) _handlers[_handler_count++] = handler;
+    }
+
+    // Drain received datagrams (call from an interval)
+    void loop() {
+        int size;
+        while ((size = _udp.parsePacket()) > 0) {
+            size_t len = _udp.read(_rx_buf, sizeof(_rx_buf));
+            if ((size_t) size > sizeof(_rx_buf)) continue;  // Not ours: too big
+            for (uint8_t i = 0; i < _handler_count; i++) {
+                if (_handlers[i](_rx_buf, len)) break;
+            }
+        }
+    }
+
+    // Clock for audio timestamps (see clock_sync.h): returns now in us and
+    // sets *synced when that is bridge time rather than pager uptime. Only
+    // a synced clock turns the header on (see the layout above).
+    typedef uint64_t (*TimeSource)(bool* synced);
+    void set_time_source(TimeSource source) { _time_source = source; }
+
 private:
+    static const uint8_t MAX_HANDLERS = 4;
+    static const size_t RECEIVE_MAX = 1472;  // One unfragmented datagram (control_channel.h)
+    static const size_t HEADER_SIZE = 16;
+    static const uint32_t SAMPLE_RATE = 16000;
+
     void send_raw(const uint8_t* data, size_t len) {
         // Send in chunks (UDP max ~1472 bytes for safe transmission)
         const size_t chunk_size = 1024;
         size_t offset = 0;
 
+        uint64_t start_us = 0;
+        uint8_t flags = 0;
+        if (_timestamped) {
+            bool synced = false;
+            uint64_t now = _time_source(&synced);
+            start_us = now - (uint64_t) (len / 2) * 1000000 / SAMPLE_RATE;
+            flags = synced ? AUDIO_FLAG_SYNCED : 0;
+        }
+
         while (offset < len) {
             size_t to_send = (len - offset > chunk_size) ? chunk_size : (len - offset);
             _udp.beginPacket(_bridge_ip, _port);
+            if (_timestamped) {
+                uint8_t header[HEADER_SIZE] = {0xFF, 0xFE, flags, 0};
+                uint64_t t = start_us + (uint64_t) (offset / 2) * 1000000 / SAMPLE_RATE;
+                for (int i = 0; i < 4; i++) header[4 + i] = (uint8_t) (_seq >> (8 * i));
+                for (int i = 0; i < 8; i++) header[8 + i] = (uint8_t) (t >> (8 * i));
+                _udp.write(header, sizeof(header));
+                _seq++;
+            }
             _udp.write(data + offset, to_send);
             _udp.endPacket();
             offset += to_send;
@@ -68,16 +146,24 @@ private:
 public:
 
     bool is_recording() const { return _is_recording; }
+    bool timestamped() const { return _timestamped; }
     uint32_t bytes_sent() const { return _bytes_sent; }
 
 private:
-    AudioStreamer() : _is_recording(false), _bytes_sent(0), _port(12345) {}
+    AudioStreamer() : _port(12345), _is_recording(false), _timestamped(false), _bytes_sent(0), _seq(0),
+                      _time_source(nullptr), _handler_count(0) {}
 
     WiFiUDP _udp;
     IPAddress _bridge_ip;
     uint16_t _port;
     bool _is_recording;
+    bool _timestamped;  // This recording has the FF FE header (fixed at START)
     uint32_t _bytes_sent;
+    uint32_t _seq;
+    TimeSource _time_source;
+    ReceiveHandler _handlers[MAX_HANDLERS];
+    uint8_t _handler_count;
+    uint8_t _rx_buf[RECEIVE_MAX];  // Off the stack: loop() runs on the main task
 };
 
 // Global accessor
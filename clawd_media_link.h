@@ -1,15 +1,201 @@
+// Media Link for Clawd Pager
+// Images from the bridge: offered by hash, pushed only when not cached
+
+#pragma once
 #include "esphome.h"
+#include "qr_encoder.h"
+#include "image_decoder.h"
+#include "asset_cache.h"
+
+// The offer_image / push_image services in clawd-pager.yaml call in here
+// and queue an "IMAGE" screen, which draws image_buffer. The bridge side
+// is devtools/asset_cache.py (AssetSender): it offers the hash, and pushes
+// the bytes only after a "need" on the ASSET log tag.
+//
+// push_image arrives as base64 chunks in order (CHUNK_BYTES each from
+// AssetSender). The first chunk reserves the whole image once; later ones
+// decode straight into it, and the finished buffer moves into the cache,
+// so the heap holds the image once plus one chunk. Bytes whose hash is not
+// the offered one are neither shown nor cached.
+//
+// Usage:
+//   if (media_link().offer_image(hash)) message_queue().push("IMAGE", ...);
+//   if (media_link().push_image(hash, offset, total, b64)) message_queue().push("IMAGE", ...);
 
-class ClawdMediaLink : public Component, public CustomAPIDevice {
+class ClawdMediaLink {
  public:
-  uint8_t image_buffer[240 * 135 / 8]; // 1-bit buffer for now to keep it lean
+  static const int IMAGE_WIDTH = 240;
+  static const int IMAGE_HEIGHT = 135;
+  static const size_t MAX_IMAGE_BYTES = AssetCache::MAX_ASSET_BYTES;
+  alignas(4) uint8_t image_buffer[240 * 135 / 8]; // 1-bit buffer for now to keep it lean (aligned for MonoCanvas)
+
+  static ClawdMediaLink& instance() {
+    static ClawdMediaLink inst;
+    return inst;
+  }
+
+  void begin() { asset_cache().begin(); }
+
+  // Bridge offers an image by content hash; true when it was cached and is
+  // now in image_buffer ("have"), false when the bridge has to push it
+  // ("need", or a bad hash)
+  bool offer_image(const std::string& hash_hex) {
+    uint64_t hash;
+    if (!asset_hash_parse(hash_hex.c_str(), &hash)) {
+      ESP_LOGW("ClawdMedia", "Bad asset hash: %s", hash_hex.c_str());
+      return false;
+    }
+    const std::vector<uint8_t>* data = asset_cache().get(hash);
+    if (data == nullptr || !show(*data)) {
+      ESP_LOGI("ASSET", "need %s", hash_hex.c_str());
+      return false;
+    }
+    ESP_LOGI("ASSET", "have %s", hash_hex.c_str());
+    return true;
+  }
+
+  // One chunk of a pushed image: bytes [offset, offset + n) of total, in
+  // base64. True once the last chunk is in and the image showed.
+  // The image is a raw 1-bit frame (4050 bytes), or a baseline JPEG / PNG
+  // up to MAX_IMAGE_BYTES: decoded strip by strip at the 1/2^n scale that
+  // fits, dithered to 1 bit. Compressed images are cached as sent, so the
+  // cache holds more of them. Only data that showed is cached: a bad
+  // payload never evicts good ones.
+  bool push_image(const std::string& hash_hex, int32_t offset, int32_t total, const std::string& b64) {
+    uint64_t hash;
+    if (!asset_hash_parse(hash_hex.c_str(), &hash)) {
+      ESP_LOGW("ClawdMedia", "Bad asset hash: %s", hash_hex.c_str());
+      return false;
+    }
+    if (offset == 0) {
+      abort_push();
+      if (total <= 0 || (size_t) total > MAX_IMAGE_BYTES) {
+        ESP_LOGW("ClawdMedia", "Image of %d bytes, limit %u", (int) total, (unsigned) MAX_IMAGE_BYTES);
+        return false;
+      }
+      _rx.reserve(total);
+      _rx_hash = hash;
+      _rx_total = total;
+    } else if (_rx_total == 0 || hash != _rx_hash || total != (int32_t) _rx_total || offset < 0 ||
+               (size_t) offset != _rx.size()) {
+      ESP_LOGW("ClawdMedia", "Image chunk at %d out of order, dropping the push", (int) offset);
+      abort_push();
+      return false;
+    }
+    if (!base64_append(b64, _rx, _rx_total)) {
+      ESP_LOGW("ClawdMedia", "Bad image chunk at %d", (int) offset);
+      abort_push();
+      return false;
+    }
+    if (_rx.size() < _rx_total) return false;
+
+    std::vector<uint8_t> data;
+    data.swap(_rx);
+    _rx_total = 0;
+    ESP_LOGD("ClawdMedia", "Received image data: %u bytes", (unsigned) data.size());
+    if (asset_hash(data.data(), data.size()) != hash) {
+      ESP_LOGW("ClawdMedia", "Image hash mismatch for %s, not shown", hash_hex.c_str());
+      return false;
+    }
+    if (!show(data)) return false;
+    if (asset_cache().put(std::move(data), hash) != 0) ESP_LOGI("ASSET", "stored %s", hash_hex.c_str());
+    return true;
+  }
 
-  void setup() override {
-    register_service(&ClawdMediaLink::on_push_image, "push_image", {"data"});
+  // Encode a QR code on-device into image_buffer instead of receiving a 4 KB
+  // bitmap (the show_qr service draws qr_code() directly instead)
+  bool push_qr(const std::string& text) {
+    if (!qr_code().encode(text.c_str(), text.size(), QrEcc::MEDIUM)) {
+      ESP_LOGW("ClawdMedia", "QR payload too long: %u bytes", (unsigned) text.size());
+      return false;
+    }
+    memset(image_buffer, 0, sizeof(image_buffer));
+    int scale = qr_code().fit_scale(IMAGE_WIDTH, IMAGE_HEIGHT);
+    int px = (qr_code().size() + 2 * QrCode::QUIET_ZONE) * scale;
+    qr_code().render_1bit(image_buffer, IMAGE_WIDTH, IMAGE_HEIGHT,
+                          (IMAGE_WIDTH - px) / 2, (IMAGE_HEIGHT - px) / 2, scale);
+    ESP_LOGD("ClawdMedia", "QR v%d (%dx%d) at scale %d from %u bytes", qr_code().version(),
+             qr_code().size(), qr_code().size(), scale, (unsigned) text.size());
+    return true;
   }
 
-  void on_push_image(std::vector<uint8_t> data) {
-    ESP_LOGD("ClawdMedia", "Received image data: %d bytes", data.size());
-    // Logic to copy data to buffer will go here
+  // Set bit = dark pixel, rows MSB first
+  bool pixel(int x, int y) const {
+    return (image_buffer[y * (IMAGE_WIDTH / 8) + (x >> 3)] & (0x80 >> (x & 7))) != 0;
   }
+
+ private:
+  ClawdMediaLink() : _rx_hash(0), _rx_total(0) { memset(image_buffer, 0, sizeof(image_buffer)); }
+
+  void abort_push() {
+    std::vector<uint8_t>().swap(_rx);  // Release the reservation now
+    _rx_total = 0;
+  }
+
+  // Decode base64 onto out without growing it past limit (no reallocation
+  // once reserved). False on bad characters, padding or length.
+  static bool base64_append(const std::string& in, std::vector<uint8_t>& out, size_t limit) {
+    if (in.size() % 4 != 0) return false;
+    size_t pad = 0;
+    if (!in.empty() && in[in.size() - 1] == '=') pad++;
+    if (in.size() >= 2 && in[in.size() - 2] == '=') pad++;
+    if (out.size() + in.size() / 4 * 3 - pad > limit) return false;
+    for (size_t i = 0; i < in.size(); i += 4) {
+      uint32_t v = 0;
+      for (size_t k = 0; k < 4; k++) {
+        char c = in[i + k];
+        int d;
+        if (c >= 'A' && c <= 'Z') d = c - 'A';
+        else if (c >= 'a' && c <= 'z') d = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') d = c - '0' + 52;
+        else if (c == '+') d = 62;
+        else if (c == '/') d = 63;
+        else if (c == '=' && i + 4 == in.size() && k >= 4 - pad) d = 0;
+        else return false;
+        v = (v << 6) | (uint32_t) d;
+      }
+      out.push_back((uint8_t) (v >> 16));
+      if (i + 4 < in.size() || pad < 2) out.push_back((uint8_t) (v >> 8));
+      if (i + 4 < in.size() || pad < 1) out.push_back((uint8_t) v);
+    }
+    return true;
+  }
+
+  bool show(const std::vector<uint8_t>& data) {
+    if (data.size() == sizeof(image_buffer)) {
+      memcpy(image_buffer, data.data(), sizeof(image_buffer));
+      return true;
+    }
+    ImageInfo info;
+    if (!image_probe(data.data(), data.size(), &info)) {
+      ESP_LOGW("ClawdMedia", "Image is %u bytes, expected %u or a JPEG/PNG", (unsigned) data.size(),
+               (unsigned) sizeof(image_buffer));
+      return false;
+    }
+    uint8_t shift = image_pick_scale(info.width, info.height, IMAGE_WIDTH, IMAGE_HEIGHT);
+    int w = (info.width + (1 << shift) - 1) >> shift;
+    int h = (info.height + (1 << shift) - 1) >> shift;
+    Dither1Bit dither(image_buffer, IMAGE_WIDTH, IMAGE_HEIGHT);
+    dither.clear();
+    dither.place(w, h);
+    uint32_t start = millis();
+    if (!image_decoder().decode(data.data(), data.size(), info.format, shift, dither.sink())) {
+      ESP_LOGW("ClawdMedia", "Image decode failed: %s", image_decoder().error());
+      dither.clear();  // Don't leave half an image for the next IMAGE screen
+      return false;
+    }
+    ESP_LOGD("ClawdMedia", "%s %dx%d shown at 1/%d (%dx%d) in %u ms",
+             info.format == ImageFormat::JPEG ? "JPEG" : "PNG", info.width, info.height, 1 << shift, w, h,
+             (unsigned) (millis() - start));
+    return true;
+  }
+
+  std::vector<uint8_t> _rx;  // Push in progress
+  uint64_t _rx_hash;
+  size_t _rx_total;
 };
+
+// Global accessor
+inline ClawdMediaLink& media_link() {
+  return ClawdMediaLink::instance();
+}
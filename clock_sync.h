@@ -0,0 +1,310 @@
+// Clock Sync for Clawd Pager
+// NTP-style offset and drift estimate against the bridge clock
+
+#pragma once
+#include "esphome.h"
+#include "audio_streamer.h"
+#include <cmath>
+#if defined(ESP_PLATFORM)
+#include <esp_timer.h>
+#endif
+
+// Exchange (little-endian), on AudioStreamer's socket:
+//   request  pager -> bridge   FF FF 'T' 'Q'  seq u32  t1 u64
+//   reply    bridge -> pager   FF FF 'T' 'R'  seq u32  t1 u64  t2 u64  t3 u64
+// t1 = pager send time (uptime us), t2/t3 = bridge receive/send time (unix
+// us), t4 = pager receive time. Per exchange:
+//   offset = ((t2 - t1) + (t3 - t4)) / 2     delay = (t4 - t1) - (t3 - t2)
+// and the true offset lies within offset +/- delay / 2.
+//
+// Replies aren't authenticated, so t1 is not taken from them on trust: the
+// pager remembers (seq, t1) of its last PENDING requests, and a reply whose
+// echoed t1 doesn't match, or that was already answered, is ignored.
+//
+// WiFi delay is bursty, so one exchange is noisy. ClockEstimator keeps the
+// last WINDOW exchanges and fits offset(t) = a + b * t by least squares,
+// weighting each by 1 / delay^2 so the fastest exchanges dominate; the
+// slope b is the drift between the two crystals. Extrapolating the fit
+// keeps timestamps good between polls and through a lost reply.
+//
+// error_bound_us() is a hard bound, valid while drift is constant over the
+// window. Each exchange pins the true offset line inside its +/- delay / 2
+// interval, and every pair of exchanges limits that line's slope. So from
+// any exchange, the error is at most its half-delay, plus how far the fit
+// misses it, plus the slope range times the time since. The bound is the
+// smallest of these over the window.
+
+class ClockEstimator {
+public:
+    static const uint8_t WINDOW = 16;
+    static constexpr double MAX_DRIFT = 500e-6;      // Reject fits beyond 500 ppm
+    static constexpr double MIN_FIT_SPAN_US = 2e6;   // Need 2 s of samples for a slope
+    static constexpr double MIN_PAIR_SPAN_US = 1e5;  // Closer pairs say little about slope
+
+    ClockEstimator() { reset(); }
+
+    void reset() {
+        _count = 0;
+        _head = 0;
+        _a = 0;
+        _b = 0;
+        _x0 = 0;
+        _slope_lo = -MAX_DRIFT;
+        _slope_hi = MAX_DRIFT;
+    }
+
+    // One completed exchange; returns false for replies that make no sense
+    bool add_sample(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+        int64_t delay = (t4 - t1) - (t3 - t2);
+        if (t4 < t1 || t3 < t2 || delay < 0) return false;
+        Sample& s = _samples[_head];
+        s.x = (double) (t1 + (t4 - t1) / 2);
+        s.offset = ((double) (t2 - t1) + (double) (t3 - t4)) / 2;
+        s.delay = (double) delay;
+        _head = (_head + 1) % WINDOW;
+        if (_count < WINDOW) _count++;
+        fit();
+        return true;
+    }
+
+    bool synced() const { return _count > 0; }
+    uint8_t samples() const { return _count; }
+
+    double offset_us(int64_t local_us) const { return _a + _b * ((double) local_us - _x0); }
+    double drift_ppm() const { return _b * 1e6; }
+
+    int64_t to_bridge_us(int64_t local_us) const {
+        return local_us + (int64_t) llround(offset_us(local_us));
+    }
+
+    double error_bound_us(int64_t local_us) const {
+        double slope_range = fmax(fabs(_b - _slope_lo), fabs(_slope_hi - _b));
+        double bound = INFINITY;
+        for (uint8_t i = 0; i < _count; i++) {
+            const Sample& s = _samples[i];
+            double b = s.delay / 2 + fabs(offset_us((int64_t) s.x) - s.offset) +
+                       slope_range * fabs((double) local_us - s.x) + 1.0;  // +1 us rounding
+            if (b < bound) bound = b;
+        }
+        return bound;
+    }
+
+    // Slopes of the offset line still consistent with every exchange
+    double drift_min_ppm() const { return _slope_lo * 1e6; }
+    double drift_max_ppm() const { return _slope_hi * 1e6; }
+
+private:
+    struct Sample {
+        double x;       // Local midpoint of the exchange
+        double offset;
+        double delay;
+    };
+
+    void fit() {
+        // Weighted least squares, x centred on the newest sample for precision
+        const Sample& newest = _samples[(_head + WINDOW - 1) % WINDOW];
+        double x0 = newest.x;
+        double sw = 0, swx = 0, swy = 0, swxx = 0, swxy = 0;
+        double min_x = 0, max_x = 0;
+        for (uint8_t i = 0; i < _count; i++) {
+            const Sample& s = _samples[i];
+            double w = 1.0 / ((s.delay + 100.0) * (s.delay + 100.0));  // +100 us: no div by 0
+            double x = s.x - x0;
+            sw += w;
+            swx += w * x;
+            swy += w * s.offset;
+            swxx += w * x * x;
+            swxy += w * x * s.offset;
+            if (i == 0 || x < min_x) min_x = x;
+            if (i == 0 || x > max_x) max_x = x;
+        }
+        double mx = swx / sw, my = swy / sw;
+        double sxx = swxx / sw - mx * mx;
+        double b = 0;
+        if (max_x - min_x >= MIN_FIT_SPAN_US && sxx > 0) {
+            b = (swxy / sw - mx * my) / sxx;
+            if (b > MAX_DRIFT) b = MAX_DRIFT;
+            if (b < -MAX_DRIFT) b = -MAX_DRIFT;
+        }
+        // Feasible slopes: a line through two intervals can tilt only so far
+        double lo = -MAX_DRIFT, hi = MAX_DRIFT;
+        for (uint8_t i = 0; i < _count; i++) {
+            for (uint8_t j = 0; j < _count; j++) {
+                const Sample& a = _samples[i];
+                const Sample& c = _samples[j];
+                double dx = c.x - a.x;
+                if (dx < MIN_PAIR_SPAN_US) continue;
+                double reach = (a.delay + c.delay) / 2 + 2.0;  // Integer us rounding
+                lo = fmax(lo, (c.offset - a.offset - reach) / dx);
+                hi = fmin(hi, (c.offset - a.offset + reach) / dx);
+            }
+        }
+        if (lo > hi) {
+            // No straight line fits: the drift changed (temperature) or a
+            // clock stepped. Keep only the newest exchange and start over.
+            Sample keep = newest;
+            _samples[0] = keep;
+            _count = 1;
+            _head = 1 % WINDOW;
+            fit();
+            return;
+        }
+        if (b < lo) b = lo;
+        if (b > hi) b = hi;
+
+        _x0 = x0;
+        _b = b;
+        _a = my - b * mx;
+        _slope_lo = lo;
+        _slope_hi = hi;
+    }
+
+    Sample _samples[WINDOW];
+    uint8_t _count;
+    uint8_t _head;
+    double _a, _b, _x0;
+    double _slope_lo, _slope_hi;
+};
+
+class ClockSync {
+public:
+    static const uint8_t BURST = 6;                // Fast polls after boot
+    static const uint32_t BURST_INTERVAL_MS = 250;
+    static const uint32_t POLL_INTERVAL_MS = 5000;
+    static const size_t REQUEST_SIZE = 16;
+    static const size_t REPLY_SIZE = 32;
+    static const uint8_t PENDING = 8;              // Requests a reply may answer
+
+    static ClockSync& instance() {
+        static ClockSync inst;
+        return inst;
+    }
+
+    // Hook into AudioStreamer: replies, and timestamps on audio packets
+    void begin() {
+        audio_streamer().add_receive_handler([this](const uint8_t* data, size_t len) {
+            return on_datagram(data, len);
+        });
+        audio_streamer().set_time_source([](bool* synced) -> uint64_t {
+            ClockSync& cs = ClockSync::instance();
+            *synced = cs.synced();
+            return (uint64_t) cs.now_us();
+        });
+        _started = true;
+    }
+
+    void loop() {
+        if (!_started) return;
+        uint32_t now = millis();
+        uint32_t interval = _sent < BURST ? BURST_INTERVAL_MS : POLL_INTERVAL_MS;
+        if (_sent > 0 && now - _last_request_ms < interval) return;
+        _last_request_ms = now;
+        send_request();
+    }
+
+    // Parse a reply; t4 is taken on arrival
+    bool on_datagram(const uint8_t* data, size_t len) {
+        if (len < REPLY_SIZE || data[0] != 0xFF || data[1] != 0xFF || data[2] != 'T' || data[3] != 'R') {
+            return false;
+        }
+        int64_t t4 = local_us();
+        uint32_t seq = (uint32_t) read_le(data + 4, 4);
+        int64_t t1 = (int64_t) read_le(data + 8, 8);
+        Pending& p = _pending[seq % PENDING];
+        if (seq == 0 || seq > _seq || _seq - seq >= PENDING || p.seq != seq || p.t1 != t1) {
+            _rejected++;  // Stale, answered already, or not our t1
+            return true;
+        }
+        p.seq = 0;
+        int64_t t2 = (int64_t) read_le(data + 16, 8);
+        int64_t t3 = (int64_t) read_le(data + 24, 8);
+        if (_estimator.add_sample(t1, t2, t3, t4)) _replies++;
+        return true;
+    }
+
+    bool synced() const { return _estimator.synced(); }
+
+    // Bridge clock (unix us) once synced, pager uptime us before that
+    int64_t now_us() const {
+        int64_t local = local_us();
+        return synced() ? _estimator.to_bridge_us(local) : local;
+    }
+
+    // "<seconds>.<micros>" of now_us() for EVENT lines; static buffer, use
+    // before the next call
+    const char* stamp() const {
+        static char buf[24];
+        int64_t t = now_us();
+        snprintf(buf, sizeof(buf), "%u.%06u", (unsigned) (t / 1000000), (unsigned) (t % 1000000));
+        return buf;
+    }
+
+    const ClockEstimator& estimator() const { return _estimator; }
+    uint32_t replies() const { return _replies; }
+    uint32_t rejected() const { return _rejected; }
+
+    void log_summary() const {
+        int64_t local = local_us();
+        ESP_LOGI("CLOCK", "synced=%s offset=%.3fms drift=%.2fppm bound=%.0fus replies=%u/%u rejected=%u",
+                 synced() ? "true" : "false", _estimator.offset_us(local) / 1000.0,
+                 _estimator.drift_ppm(), synced() ? _estimator.error_bound_us(local) : 0.0,
+                 (unsigned) _replies, (unsigned) _sent, (unsigned) _rejected);
+    }
+
+    static int64_t local_us() {
+#if defined(ESP_PLATFORM)
+        return esp_timer_get_time();
+#else
+        return host_clock() ? host_clock()() : (int64_t) millis() * 1000;
+#endif
+    }
+
+    // Host builds: simulated pager clock for tests
+    typedef int64_t (*HostClock)();
+    static HostClock& host_clock() {
+        static HostClock clock = nullptr;
+        return clock;
+    }
+
+private:
+    struct Pending {
+        uint32_t seq;   // 0 = free or answered
+        int64_t t1;
+    };
+
+    ClockSync() : _pending(), _started(false), _seq(0), _sent(0), _replies(0), _rejected(0), _last_request_ms(0) {}
+
+    void send_request() {
+        uint8_t packet[REQUEST_SIZE] = {0xFF, 0xFF, 'T', 'Q'};
+        _seq++;
+        int64_t t1 = local_us();
+        _pending[_seq % PENDING] = Pending{_seq, t1};
+        write_le(packet + 4, _seq, 4);
+        write_le(packet + 8, (uint64_t) t1, 8);
+        audio_streamer().send_datagram(packet, sizeof(packet));
+        _sent++;
+    }
+
+    static uint64_t read_le(const uint8_t* p, int n) {
+        uint64_t v = 0;
+        for (int i = n - 1; i >= 0; i--) v = (v << 8) | p[i];
+        return v;
+    }
+    static void write_le(uint8_t* p, uint64_t v, int n) {
+        for (int i = 0; i < n; i++) p[i] = (uint8_t) (v >> (8 * i));
+    }
+
+    ClockEstimator _estimator;
+    Pending _pending[PENDING];
+    bool _started;
+    uint32_t _seq;
+    uint32_t _sent;
+    uint32_t _replies;
+    uint32_t _rejected;
+    uint32_t _last_request_ms;
+};
+
+// Global accessor
+inline ClockSync& clock_sync() {
+    return ClockSync::instance();
+}
@@ -0,0 +1,395 @@
+// Control Channel for Clawd Pager
+// Authenticated, sequenced UDP fast path for display updates
+
+#pragma once
+#include "esphome.h"
+#include "audio_streamer.h"
+
+// The ESPHome API (TCP + protobuf, reconnect handshake) stays the slow
+// path. This carries the small, urgent messages over AudioStreamer's UDP
+// socket, so they need no connection: after a WiFi hiccup the first
+// retransmit that gets through is delivered.
+//
+// Datagrams (little-endian), bridge -> pager:
+//   0  FF FF 'C' 'M'
+//   4  session u32     bridge start time (unix s); a restart moves it forward
+//   8  seq u32         per session, from 1
+//   12 type u8         CTRL_SET_DISPLAY / CTRL_ALERT / CTRL_WEATHER / CTRL_PING
+//   13 reserved u8
+//   14 len u16         payload bytes
+//   16 payload         SET_DISPLAY: mode '\0' text; ALERT, WEATHER: text
+//   16+len  tag[16]    HMAC-SHA256(key, nonce || bytes 0 .. 16+len), first 16 bytes
+// pager -> bridge:
+//   ack    FF FF 'C' 'A'  session u32  seq u32  status u8  0 0 0  tag[16]
+//   hello  FF FF 'C' 'H'  session u32 (last seen)  nonce u32  0 0 0 0  tag[16]
+// The tag on an ack/hello covers the nonce and its first 16 bytes.
+//
+// nonce (u32 LE) is drawn fresh on every boot and announced in the hello;
+// the bridge signs with the one from the last hello. The session window
+// starts over on boot, so without it a datagram captured before a reboot
+// would be accepted again. A bad tag is answered with a hello (at most
+// once per HELLO_MIN_MS), which is how a restarted bridge learns it.
+//
+// Every authenticated message is acked, including ones already applied,
+// so the bridge stops retransmitting (devtools/control_channel.py). A
+// 32-deep window per session drops duplicates. A display or weather
+// update older than one already applied is acked as CTRL_STALE and not
+// shown; alerts and prompts are applied even if they arrive late. Older
+// sessions get no answer at all.
+//
+// The key is the control_key secret (same string on the bridge), any
+// length: one over 64 bytes is replaced by its SHA-256 (RFC 2104).
+
+static const uint8_t CTRL_SET_DISPLAY = 1;
+static const uint8_t CTRL_ALERT = 2;
+static const uint8_t CTRL_WEATHER = 3;
+static const uint8_t CTRL_PING = 4;
+
+static const uint8_t CTRL_APPLIED = 0;
+static const uint8_t CTRL_DUPLICATE = 1;
+static const uint8_t CTRL_STALE = 2;
+
+// SHA-256 and HMAC-SHA256 (FIPS 180-4 / RFC 2104), small and portable
+class Sha256 {
+public:
+    static const size_t DIGEST = 32;
+    static const size_t BLOCK = 64;
+
+    Sha256() { reset(); }
+
+    void reset() {
+        static const uint32_t H0[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                       0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        memcpy(_h, H0, sizeof(_h));
+        _len = 0;
+        _fill = 0;
+    }
+
+    void update(const uint8_t* data, size_t len) {
+        _len += len;
+        while (len > 0) {
+            size_t n = BLOCK - _fill < len ? BLOCK - _fill : len;
+            memcpy(_buf + _fill, data, n);
+            _fill += n;
+            data += n;
+            len -= n;
+            if (_fill == BLOCK) {
+                compress(_buf);
+                _fill = 0;
+            }
+        }
+    }
+
+    void finish(uint8_t out[DIGEST]) {
+        uint64_t bits = _len * 8;
+        uint8_t pad = 0x80;
+        update(&pad, 1);
+        pad = 0;
+        while (_fill != 56) update(&pad, 1);
+        uint8_t len_be[8];
+        for (int i = 0; i < 8; i++) len_be[i] = (uint8_t) (bits >> (56 - 8 * i));
+        update(len_be, 8);
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 4; j++) out[i * 4 + j] = (uint8_t) (_h[i] >> (24 - 8 * j));
+        }
+    }
+
+    static void hmac(const uint8_t* key, size_t key_len, const uint8_t* data, size_t len, uint8_t out[DIGEST]) {
+        hmac(key, key_len, nullptr, 0, data, len, out);
+    }
+
+    // HMAC over prefix || data, without copying them together
+    static void hmac(const uint8_t* key, size_t key_len, const uint8_t* prefix, size_t prefix_len,
+                     const uint8_t* data, size_t len, uint8_t out[DIGEST]) {
+        uint8_t k[BLOCK] = {0};
+        if (key_len > BLOCK) {
+            Sha256 kh;
+            kh.update(key, key_len);
+            kh.finish(k);
+        } else {
+            memcpy(k, key, key_len);
+        }
+        uint8_t pad[BLOCK];
+        Sha256 inner;
+        for (size_t i = 0; i < BLOCK; i++) pad[i] = k[i] ^ 0x36;
+        inner.update(pad, BLOCK);
+        inner.update(prefix, prefix_len);
+        inner.update(data, len);
+        uint8_t inner_digest[DIGEST];
+        inner.finish(inner_digest);
+        Sha256 outer;
+        for (size_t i = 0; i < BLOCK; i++) pad[i] = k[i] ^ 0x5c;
+        outer.update(pad, BLOCK);
+        outer.update(inner_digest, DIGEST);
+        outer.finish(out);
+    }
+
+private:
+    static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    void compress(const uint8_t* block) {
+        static const uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t) block[i * 4] << 24 | (uint32_t) block[i * 4 + 1] << 16 |
+                   (uint32_t) block[i * 4 + 2] << 8 | block[i * 4 + 3];
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = _h[0], b = _h[1], c = _h[2], d = _h[3], e = _h[4], f = _h[5], g = _h[6], h = _h[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        _h[0] += a;
+        _h[1] += b;
+        _h[2] += c;
+        _h[3] += d;
+        _h[4] += e;
+        _h[5] += f;
+        _h[6] += g;
+        _h[7] += h;
+    }
+
+    uint32_t _h[8];
+    uint64_t _len;
+    uint8_t _buf[BLOCK];
+    size_t _fill;
+};
+
+class ControlChannel {
+public:
+    static const size_t HEADER_SIZE = 16;
+    static const size_t TAG_SIZE = 16;
+    static const size_t MAX_KEY = Sha256::BLOCK;
+    static const uint8_t WINDOW = 32;
+    static const uint32_t HELLO_MIN_MS = 1000;
+
+    struct Stats {
+        uint32_t received;
+        uint32_t applied;
+        uint32_t duplicates;
+        uint32_t stale;
+        uint32_t bad_tag;
+        uint32_t old_session;
+        uint32_t hellos;
+    };
+
+    // type, mode (SET_DISPLAY only, else ""), text and its length. Text
+    // points into the receive buffer: copy it before returning.
+    typedef std::function<void(uint8_t type, const char* mode, const char* text, size_t len)> MessageHandler;
+
+    static ControlChannel& instance() {
+        static ControlChannel inst;
+        return inst;
+    }
+
+    void begin(const char* key, MessageHandler handler) {
+        _nonce = esphome::random_uint32();
+        if (_nonce == 0) _nonce = 1;  // 0 is the bridge's "no hello yet"
+        // Hashed once here rather than per tag; the bridge's hmac does the same
+        size_t key_len = strlen(key);
+        if (key_len > MAX_KEY) {
+            Sha256 h;
+            h.update((const uint8_t*) key, key_len);
+            h.finish(_key);
+            _key_len = Sha256::DIGEST;
+        } else {
+            memcpy(_key, key, key_len);
+            _key_len = key_len;
+        }
+        _handler = handler;
+        audio_streamer().add_receive_handler([this](const uint8_t* data, size_t len) {
+            return on_datagram(data, len);
+        });
+        hello();
+    }
+
+    // Tell the bridge we're (back) online so it retransmits right away;
+    // call on boot and on every WiFi (re)connect
+    void hello() {
+        uint8_t packet[HEADER_SIZE + TAG_SIZE] = {0xFF, 0xFF, 'C', 'H'};
+        write_le(packet + 4, _session, 4);
+        write_le(packet + 8, _nonce, 4);
+        sign_and_send(packet);
+        _stats.hellos++;
+        _hello_ms = millis();
+    }
+
+    bool on_datagram(const uint8_t* data, size_t len) {
+        if (len < 4 || data[0] != 0xFF || data[1] != 0xFF || data[2] != 'C' || data[3] != 'M') return false;
+        _stats.received++;
+        if (len < HEADER_SIZE + TAG_SIZE) return true;
+        size_t payload = (size_t) read_le(data + 14, 2);
+        if (HEADER_SIZE + payload + TAG_SIZE != len) return true;
+        uint8_t tag[Sha256::DIGEST];
+        sign(data, HEADER_SIZE + payload, tag);
+        if (!tags_equal(tag, data + HEADER_SIZE + payload)) {
+            // From an earlier boot, or a bridge that missed our hello
+            _stats.bad_tag++;
+            if (millis() - _hello_ms >= HELLO_MIN_MS) hello();
+            return true;
+        }
+
+        uint32_t session = (uint32_t) read_le(data + 4, 4);
+        uint32_t seq = (uint32_t) read_le(data + 8, 4);
+        uint8_t type = data[12];
+        if (session < _session) {
+            _stats.old_session++;
+            return true;
+        }
+        if (session > _session) {
+            _session = session;  // Bridge restarted: fresh window
+            _top = 0;
+            _window = 0;
+            _state_top = 0;
+        }
+
+        uint8_t status = accept(seq);
+        if (status == CTRL_APPLIED && is_state(type, data + HEADER_SIZE, payload)) {
+            if (seq < _state_top) status = CTRL_STALE;
+            else _state_top = seq;
+        }
+        send_ack(seq, status);
+        if (status == CTRL_DUPLICATE) _stats.duplicates++;
+        if (status == CTRL_STALE) _stats.stale++;
+        if (status != CTRL_APPLIED || type == CTRL_PING) return true;
+
+        _stats.applied++;
+        const char* body = reinterpret_cast<const char*>(data + HEADER_SIZE);
+        if (type == CTRL_SET_DISPLAY) {
+            size_t mode_len = strnlen(body, payload);
+            if (mode_len >= payload || mode_len >= sizeof(_mode)) return true;
+            memcpy(_mode, body, mode_len + 1);
+            if (_handler) _handler(type, _mode, body + mode_len + 1, payload - mode_len - 1);
+        } else if (_handler) {
+            _handler(type, "", body, payload);
+        }
+        return true;
+    }
+
+    const Stats& stats() const { return _stats; }
+    uint32_t session() const { return _session; }
+    uint32_t nonce() const { return _nonce; }
+
+    void log_summary() const {
+        ESP_LOGI("CTRL", "session=%u received=%u applied=%u dup=%u stale=%u bad_tag=%u old_session=%u hellos=%u",
+                 (unsigned) _session, (unsigned) _stats.received, (unsigned) _stats.applied,
+                 (unsigned) _stats.duplicates, (unsigned) _stats.stale, (unsigned) _stats.bad_tag,
+                 (unsigned) _stats.old_session, (unsigned) _stats.hellos);
+    }
+
+    // Public for devtools/control_channel_bench.cpp (a fresh pager per
+    // boot); the pager uses instance()
+    ControlChannel()
+        : _key_len(0), _nonce(0), _session(0), _top(0), _window(0), _state_top(0), _hello_ms(0), _stats() {
+        _mode[0] = '\0';
+    }
+
+private:
+    // Sliding window: bit i of _window = seq (_top - i) was seen
+    uint8_t accept(uint32_t seq) {
+        if (seq > _top) {
+            uint32_t shift = seq - _top;
+            _window = shift >= WINDOW ? 0 : _window << shift;
+            _window |= 1;
+            _top = seq;
+            return CTRL_APPLIED;
+        }
+        uint32_t back = _top - seq;
+        if (back >= WINDOW) return CTRL_STALE;  // Too old to tell; never apply
+        if (_window & (1u << back)) return CTRL_DUPLICATE;
+        _window |= 1u << back;
+        return CTRL_APPLIED;
+    }
+
+    // Updates that only describe "now": a late one must not win. Prompts
+    // (PERMISSION/QUESTION/CONFIRM) are events, like alerts.
+    static bool is_state(uint8_t type, const uint8_t* payload, size_t len) {
+        if (type == CTRL_WEATHER) return true;
+        if (type != CTRL_SET_DISPLAY) return false;
+        const char* mode = reinterpret_cast<const char*>(payload);
+        size_t n = strnlen(mode, len);
+        if (n > 7 && strncmp(mode, "SILENT_", 7) == 0) {
+            mode += 7;
+            n -= 7;
+        }
+        return !((n == 10 && strncmp(mode, "PERMISSION", 10) == 0) || (n == 8 && strncmp(mode, "QUESTION", 8) == 0) ||
+                 (n == 7 && strncmp(mode, "CONFIRM", 7) == 0));
+    }
+
+    void send_ack(uint32_t seq, uint8_t status) {
+        uint8_t packet[HEADER_SIZE + TAG_SIZE] = {0xFF, 0xFF, 'C', 'A'};
+        write_le(packet + 4, _session, 4);
+        write_le(packet + 8, seq, 4);
+        packet[12] = status;
+        sign_and_send(packet);
+    }
+
+    // Every tag covers this boot's nonce first
+    void sign(const uint8_t* data, size_t len, uint8_t out[Sha256::DIGEST]) const {
+        uint8_t nonce[4];
+        write_le(nonce, _nonce, 4);
+        Sha256::hmac(_key, _key_len, nonce, sizeof(nonce), data, len, out);
+    }
+
+    void sign_and_send(uint8_t packet[HEADER_SIZE + TAG_SIZE]) {
+        uint8_t tag[Sha256::DIGEST];
+        sign(packet, HEADER_SIZE, tag);
+        memcpy(packet + HEADER_SIZE, tag, TAG_SIZE);
+        audio_streamer().send_datagram(packet, HEADER_SIZE + TAG_SIZE);
+    }
+
+    // Constant time, so a forger learns nothing from reply timing
+    static bool tags_equal(const uint8_t* a, const uint8_t* b) {
+        uint8_t diff = 0;
+        for (size_t i = 0; i < TAG_SIZE; i++) diff |= a[i] ^ b[i];
+        return diff == 0;
+    }
+
+    static uint64_t read_le(const uint8_t* p, int n) {
+        uint64_t v = 0;
+        for (int i = n - 1; i >= 0; i--) v = (v << 8) | p[i];
+        return v;
+    }
+    static void write_le(uint8_t* p, uint64_t v, int n) {
+        for (int i = 0; i < n; i++) p[i] = (uint8_t) (v >> (8 * i));
+    }
+
+    uint8_t _key[MAX_KEY];
+    size_t _key_len;
+    MessageHandler _handler;
+    uint32_t _nonce;
+    uint32_t _session;
+    uint32_t _top;
+    uint32_t _window;
+    uint32_t _state_top;
+    uint32_t _hello_ms;
+    char _mode[32];
+    Stats _stats;
+};
+
+// Global accessor
+inline ControlChannel& control_channel() {
+    return ControlChannel::instance();
+}
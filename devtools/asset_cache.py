@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+"""
+Asset Cache - Bridge side of the pager's content-addressed image cache.
+
+Instead of calling push_image with the full bitmap every time, the bridge
+calls offer_image with the content hash. The pager answers on its ASSET log
+tag: "have <hash>" (shown from cache, nothing more to send) or
+"need <hash>" (follow up with push_image). asset_cache.h uses the same
+64-bit FNV-1a hash.
+
+AssetSender does that exchange for the bridge: offer() calls offer_image
+and keeps the bytes; on_log() pushes them when the pager says "need", as
+in-order base64 chunks of CHUNK_BYTES tagged with the offered hash. The
+pager reserves the whole image on the first chunk and decodes the rest into
+it, and refuses assets over MAX_ASSET_BYTES.
+
+Usage:
+    from devtools.asset_cache import AssetSender
+    sender = AssetSender(lambda name, args: api.execute_service(name, args))
+    sender.offer(bitmap)                   # raw 1-bit frame, JPEG or PNG
+    # in the log callback:
+    sender.on_log(line)                    # pushes on "need <hash>"
+
+    # Bytes saved on a replayed day of bridge image traffic
+    python -m devtools.asset_cache --bench
+"""
+
+import argparse
+import base64
+import random
+import re
+from collections import OrderedDict
+from typing import Callable, Dict, List, Optional, Tuple
+
+FNV_OFFSET = 0xcbf29ce484222325
+FNV_PRIME = 0x100000001b3
+MASK64 = (1 << 64) - 1
+
+FRAME_BYTES = 240 * 135 // 8      # One 1-bit full-screen bitmap
+RAM_BUDGET = 48 * 1024            # asset_cache.h DEFAULT_RAM_BUDGET
+MAX_ASSET_BYTES = 32 * 1024       # asset_cache.h MAX_ASSET_BYTES
+FLASH_BUDGET = 256 * 1024         # asset_cache.h DEFAULT_FLASH_BUDGET
+MAX_ENTRIES = 32
+MAX_FLASH_ENTRIES = 128
+OFFER_BYTES = 40                  # offer_image call: 16-char hash plus API framing
+PUSH_OVERHEAD = 48                # push_image framing per call (hash, offset, total)
+CHUNK_BYTES = 2048                # Image bytes per push_image call, before base64
+
+REPLY_RE = re.compile(r"ASSET[^\]]*\]?:\s*(have|need|stored) ([0-9a-f]{16})")
+
+
+def asset_hash(data: bytes) -> int:
+    h = FNV_OFFSET
+    for b in data:
+        h = ((h ^ b) * FNV_PRIME) & MASK64
+    return h
+
+
+def asset_hash_hex(data: bytes) -> str:
+    return f"{asset_hash(data):016x}"
+
+
+def push_bytes(size: int) -> int:
+    """Bytes on the wire to push an asset of size bytes in base64 chunks."""
+    total = 0
+    for off in range(0, size, CHUNK_BYTES):
+        n = min(CHUNK_BYTES, size - off)
+        total += (n + 2) // 3 * 4 + PUSH_OVERHEAD
+    return total
+
+
+def parse_asset_reply(line: str) -> Optional[Tuple[str, str]]:
+    """("have"|"need"|"stored", hash) from a pager log line."""
+    m = REPLY_RE.search(line)
+    return (m.group(1), m.group(2)) if m else None
+
+
+class AssetSender:
+    """Bridge side of offer_image / push_image for one pager."""
+
+    def __init__(self, execute: Callable[[str, dict], None]):
+        self.execute = execute
+        self.pending: Dict[str, bytes] = {}    # Offered, no answer yet
+        self.pushed = 0
+
+    def offer(self, data: bytes) -> str:
+        if not data or len(data) > MAX_ASSET_BYTES:
+            raise ValueError(f"asset of {len(data)} bytes, the pager takes 1..{MAX_ASSET_BYTES}")
+        key = asset_hash_hex(data)
+        self.pending[key] = data
+        self.execute("offer_image", {"hash": key})
+        return key
+
+    def on_log(self, line: str) -> Optional[Tuple[str, str]]:
+        """Handle a pager log line; the (reply, hash) it carried, if any."""
+        reply = parse_asset_reply(line)
+        if reply is None:
+            return None
+        kind, key = reply
+        if kind == "need" and key in self.pending:
+            data = self.pending.pop(key)
+            for off in range(0, len(data), CHUNK_BYTES):
+                chunk = base64.b64encode(data[off:off + CHUNK_BYTES]).decode("ascii")
+                self.execute("push_image", {"hash": key, "offset": off, "total": len(data), "data": chunk})
+            self.pushed += 1
+        else:
+            # "have": shown from cache; "stored": the push arrived
+            self.pending.pop(key, None)
+        return reply
+
+
+class PagerCacheModel:
+    """LRU under a byte budget and entry cap, as asset_cache.h's RAM tier."""
+
+    def __init__(self, budget: int = RAM_BUDGET, max_entries: int = MAX_ENTRIES):
+        self.budget = budget
+        self.max_entries = max_entries
+        self.entries: "OrderedDict[int, int]" = OrderedDict()  # hash -> size, LRU first
+        self.used = 0
+
+    def get(self, key: int) -> bool:
+        if key in self.entries:
+            self.entries.move_to_end(key)
+            return True
+        return False
+
+    def put(self, key: int, size: int):
+        if size > self.budget or key in self.entries:
+            return
+        while self.entries and (self.used + size > self.budget or len(self.entries) >= self.max_entries):
+            _, old = self.entries.popitem(last=False)
+            self.used -= old
+        self.entries[key] = size
+        self.used += size
+
+
+def _bitmap(kind: str, n: int, size: int = FRAME_BYTES) -> bytes:
+    """Deterministic stand-in asset n of a kind (a 1-bit frame by default)."""
+    seed = random.Random(f"{kind}:{n}")
+    return bytes(seed.getrandbits(8) for _ in range(size))
+
+
+def day_of_traffic(seed: int = 1) -> List[Tuple[float, str, bytes]]:
+    """A workday of push_image calls: (seconds, kind, bitmap).
+
+    - status icons: one of 10 per agent state change, every 20-90 s
+    - avatars: one per session (6 sessions), shown on session switches
+    - QR codes: pairing/links, most unique, a few re-shown
+    - screenshots/diagrams: unique, occasional; PNG/JPEG of 5-28 KB
+    """
+    rng = random.Random(seed)
+    events: List[Tuple[float, str, bytes]] = []
+    icons = [_bitmap("icon", i) for i in range(10)]
+    avatars = [_bitmap("avatar", i) for i in range(6)]
+    qr_pool: List[bytes] = []
+    t = 9 * 3600.0
+    unique = 0
+    while t < 19 * 3600:
+        t += rng.uniform(20, 90)
+        r = rng.random()
+        if r < 0.70:
+            # Agent states are bursty: working/waiting/done dominate
+            events.append((t, "icon", icons[min(int(rng.expovariate(0.5)), 9)]))
+        elif r < 0.88:
+            events.append((t, "avatar", avatars[rng.randrange(len(avatars))]))
+        elif r < 0.96:
+            if qr_pool and rng.random() < 0.3:
+                events.append((t, "qr", rng.choice(qr_pool)))
+            else:
+                unique += 1
+                qr_pool.append(_bitmap("qr", unique))
+                events.append((t, "qr", qr_pool[-1]))
+        else:
+            unique += 1
+            events.append((t, "image", _bitmap("image", unique, rng.randint(5 * 1024, 28 * 1024))))
+    return events
+
+
+def replay(events: List[Tuple[float, str, bytes]], budget: int, flash_budget: int = 0) -> Dict[str, int]:
+    """Bytes on the wire with and without offer/have/need."""
+    cache = PagerCacheModel(budget)
+    flash = PagerCacheModel(flash_budget, MAX_FLASH_ENTRIES) if flash_budget else None
+    hashes: Dict[bytes, int] = {}
+    baseline = with_cache = hits = 0
+    by_kind: Dict[str, List[int]] = {}
+    for _, kind, data in events:
+        key = hashes.setdefault(data, asset_hash(data))
+        baseline += push_bytes(len(data))
+        with_cache += OFFER_BYTES
+        kind_stats = by_kind.setdefault(kind, [0, 0])
+        kind_stats[1] += 1
+        if cache.get(key) or (flash is not None and flash.get(key)):
+            hits += 1
+            kind_stats[0] += 1
+            cache.put(key, len(data))  # Flash hits are refilled into RAM
+        else:
+            with_cache += push_bytes(len(data))
+            cache.put(key, len(data))
+            if flash is not None:
+                flash.put(key, len(data))
+    return {"events": len(events), "baseline": baseline, "with_cache": with_cache,
+            "hits": hits, "by_kind": by_kind}
+
+
+def main():
+    """CLI: replay a day of traffic against cache budgets."""
+    parser = argparse.ArgumentParser(description='Pager asset cache')
+    parser.add_argument('--bench', action='store_true', help='Replay a synthetic day of traffic')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    if not args.bench:
+        parser.print_help()
+        return
+
+    events = day_of_traffic(args.seed)
+    sizes = [len(d) for _, _, d in events]
+    print(f"Day of bridge image traffic: {len(events)} images, "
+          f"{len({d for _, _, d in events})} distinct, {min(sizes)}-{max(sizes)} bytes")
+    print(f"  {'budget':>16} {'hit rate':>9} {'sent':>10} {'baseline':>10} {'saved':>7}")
+    for budget, flash_budget in ((16 * 1024, 0), (24 * 1024, 0), (32 * 1024, 0), (RAM_BUDGET, 0),
+                                 (96 * 1024, 0), (RAM_BUDGET, FLASH_BUDGET)):
+        r = replay(events, budget, flash_budget)
+        saved = 1 - r["with_cache"] / r["baseline"]
+        label = f"{budget // 1024}KB" + (f" +{flash_budget // 1024}KB fl" if flash_budget else "")
+        print(f"  {label:>16} {r['hits'] / r['events']:>8.0%} "
+              f"{r['with_cache'] / 1024:>8.0f}KB {r['baseline'] / 1024:>8.0f}KB {saved:>7.0%}")
+    r = replay(events, RAM_BUDGET)
+    print("  hit rate by kind at the default budget: " + ", ".join(
+        f"{k} {h}/{n}" for k, (h, n) in sorted(r["by_kind"].items())))
+
+
+if __name__ == '__main__':
+    main()
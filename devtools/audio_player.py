@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""
+Audio Player - Bench driver for audio_player.h.
+
+AudioPlayer is the pager end of devtools/tts_stream.py: a jitter buffer
+keyed by the frame seq, which restarts at 0 on every stream. The native
+bench (devtools/audio_player_bench.cpp) plays three streams back to back
+(two from seq 0, one across the u16 wrap) over a modeled network with
+jitter, reordering and loss into a speaker model, and checks from the
+played samples that every frame that arrived in time was played once, in
+order, and that only real gaps were concealed. This prints the per-stream
+counts.
+
+Usage:
+    g++ -O2 -I. -Idevtools/host -o /tmp/audio-player-bench devtools/audio_player_bench.cpp
+    python -m devtools.audio_player --bench --bin /tmp/audio-player-bench
+"""
+
+import argparse
+import re
+import subprocess
+from typing import Dict, List
+
+LINE_RE = re.compile(r"^(stream|total) (.*)$")
+
+
+def fields(text: str) -> Dict[str, str]:
+    return dict(kv.split("=", 1) for kv in text.split())
+
+
+def bench(binary: str, seeds: int) -> bool:
+    out = subprocess.run([binary, "-n", str(seeds)], capture_output=True, text=True)
+    streams: List[Dict[str, str]] = []
+    total = None
+    for line in out.stdout.splitlines():
+        m = LINE_RE.match(line.strip())
+        if not m:
+            continue
+        if m.group(1) == "stream":
+            streams.append(fields(m.group(2)))
+        else:
+            total = fields(m.group(2))
+    if total is None:
+        print(out.stdout + out.stderr)
+        return False
+
+    print(f"{'seed':>4}{'stream':>7}{'start':>7}{'sent':>6}{'lost':>6}{'reord':>6}{'late':>6}"
+          f"{'conceal':>8}{'underrun':>9}{'played':>7}{'depth':>6}{'jitter':>8}   check")
+    for s in streams:
+        print(f"{s['seed']:>4}{s['n']:>7}{s['start_seq']:>7}{s['sent']:>6}{s['lost']:>6}{s['reordered']:>6}"
+              f"{s['late']:>6}{s['concealed']:>8}{s['underruns']:>9}{s['played']:>7}{s['target_depth']:>6}"
+              f"{float(s['jitter_ms']):>7.1f}ms   {'ok' if s['ok'] == '1' else 'WRONG'}")
+    ok = out.returncode == 0 and total.get("failures") == "0"
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: play back-to-back streams through the jitter buffer and check the output."""
+    parser = argparse.ArgumentParser(description='AudioPlayer jitter buffer bench')
+    parser.add_argument('--bench', action='store_true', help='Run the back-to-back stream checks')
+    parser.add_argument('--bin', default='/tmp/audio-player-bench', help='Built audio_player_bench.cpp')
+    parser.add_argument('--seeds', type=int, default=5, help='Network seeds (three streams each)')
+    args = parser.parse_args()
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin, args.seeds) else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,194 @@
+// Audio Player Bench - host build of audio_player.h
+//
+// Plays TTS streams back to back through AudioPlayer as the bridge sends
+// them (devtools/tts_stream.py: every stream numbers its frames from 0,
+// START on the first, END on the last), over a modeled network:
+//   delay     25 ms + 0..35 ms uniform (more than a frame: reorders)
+//   reorder   every 23rd frame also swapped with the next one
+//   loss      4% of frames (never the START or END frame)
+// A third stream starts near the u16 wrap. The sink is the speaker: a
+// two-frame buffer drained at 16 kHz, one simulated millisecond per step.
+//
+// Every frame carries a tag (constant samples: stream and index), so the
+// output shows what was played, in what order, and what was concealed
+// (a faded repeat is below any tag). Per stream it checks:
+//   received   = sent - lost
+//   late       <= 5% of sent (arrived after playout, at the start mostly)
+//   played     = sent - lost - late, in order, no frame of another stream
+//   concealed  <= lost + late (only real gaps are filled)
+//
+// Build:
+//   g++ -O2 -I. -Idevtools/host -o /tmp/audio-player-bench devtools/audio_player_bench.cpp
+//
+// Usage:
+//   audio-player-bench [-n seeds]
+//   -> stream seed=<s> n=<k> start_seq=<q> sent=<n> lost=<n> reordered=<n> received=<n> late=<n>
+//          concealed=<n> underruns=<n> played=<n> out_of_order=<n> target_depth=<n> jitter_ms=<t> ok=<0|1>
+//      total failures=<n>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "esphome.h"
+#include "audio_player.h"
+
+static const int STREAMS = 3;
+static const int FRAMES[STREAMS] = {150, 150, 120};
+static const uint16_t START_SEQ[STREAMS] = {0, 0, 65500};
+static const uint32_t GAP_MS = 300;           // Between one stream's last frame and the next START
+static const int16_t TAG_BASE = 20000;        // Halved (concealed) tags stay below it
+static const int16_t TAG_STRIDE = 3000;
+static const size_t SPEAKER_BYTES = 2 * AudioPlayer::FRAME_SAMPLES * 2;
+static const size_t SPEAKER_BYTES_PER_MS = AudioPlayer::SAMPLE_RATE / 1000 * 2;
+
+struct Packet {
+    uint32_t arrival_ms;
+    int stream;
+    int index;
+    std::vector<uint8_t> data;
+};
+
+struct StreamPlan {
+    int sent = 0, lost = 0, reordered = 0;
+};
+
+struct StreamResult {
+    AudioPlayer::Stats stats = {};
+    bool done = false;
+    int played = 0, out_of_order = 0, last_index = -1;
+};
+
+static std::vector<uint8_t> make_packet(uint16_t seq, uint8_t flags, int16_t tag) {
+    std::vector<uint8_t> p(AudioPlayer::HEADER_SIZE + AudioPlayer::FRAME_SAMPLES * 2, 0);
+    p[0] = (uint8_t) seq;
+    p[1] = (uint8_t) (seq >> 8);
+    p[2] = AUDIO_CODEC_PCM16;
+    p[3] = flags;
+    for (uint16_t i = 0; i < AudioPlayer::FRAME_SAMPLES; i++) {
+        p[AudioPlayer::HEADER_SIZE + 2 * i] = (uint8_t) tag;
+        p[AudioPlayer::HEADER_SIZE + 2 * i + 1] = (uint8_t) ((uint16_t) tag >> 8);
+    }
+    return p;
+}
+
+static int run(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> jitter(0, 35);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    std::vector<Packet> packets;
+    StreamPlan plan[STREAMS];
+    uint32_t send_ms = 0;
+    for (int k = 0; k < STREAMS; k++) {
+        std::vector<uint32_t> delay(FRAMES[k]);
+        for (int i = 0; i < FRAMES[k]; i++) delay[i] = 25 + jitter(rng);
+        for (int i = 0; i + 1 < FRAMES[k]; i += 23) std::swap(delay[i], delay[i + 1]);
+        delay[0] = std::min(delay[0], delay[1]);  // START arrives first
+
+        uint32_t prev_arrival = 0;
+        for (int i = 0; i < FRAMES[k]; i++) {
+            uint32_t arrival = send_ms + delay[i];
+            uint8_t flags = (i == 0 ? AUDIO_FLAG_START : 0) | (i == FRAMES[k] - 1 ? AUDIO_FLAG_END : 0);
+            bool lose = i > 0 && i < FRAMES[k] - 1 && percent(rng) < 4;
+            plan[k].sent++;
+            if (lose) {
+                plan[k].lost++;
+            } else {
+                if (i > 0 && arrival < prev_arrival) plan[k].reordered++;
+                prev_arrival = arrival;
+                packets.push_back({arrival, k, i, make_packet((uint16_t) (START_SEQ[k] + i), flags,
+                                                             (int16_t) (TAG_BASE + k * TAG_STRIDE + i))});
+            }
+            send_ms += AudioPlayer::FRAME_MS;
+        }
+        send_ms += GAP_MS;
+    }
+    std::stable_sort(packets.begin(), packets.end(),
+                     [](const Packet& a, const Packet& b) { return a.arrival_ms < b.arrival_ms; });
+
+    // Speaker: a small FIFO drained at the sample rate
+    size_t speaker_fill = 0;
+    std::vector<int16_t> played;
+    AudioPlayer& player = audio_player();
+    player.begin(12347, [&](const uint8_t* data, size_t len) -> size_t {
+        size_t n = std::min(len, SPEAKER_BYTES - speaker_fill) & ~(size_t) 1;
+        size_t at = played.size();
+        played.resize(at + n / 2);
+        memcpy(&played[at], data, n);
+        speaker_fill += n;
+        return n;
+    });
+
+    StreamResult result[STREAMS];
+    int current = -1;
+    size_t next = 0;
+    uint32_t end_ms = send_ms + 2000;
+    for (uint32_t now = 0; now < end_ms; now++) {
+        speaker_fill -= std::min(speaker_fill, SPEAKER_BYTES_PER_MS);
+        for (; next < packets.size() && packets[next].arrival_ms <= now; next++) {
+            const Packet& p = packets[next];
+            if (p.data[3] & AUDIO_FLAG_START) current = p.stream;
+            player.on_packet(p.data.data(), p.data.size(), now);
+        }
+        bool was_playing = player.is_playing();
+        player.loop();
+        if (was_playing && !player.is_playing() && current >= 0) {
+            result[current].stats = player.stats();
+            result[current].done = true;
+        }
+    }
+
+    // Output, frame by frame: tagged (played), faded repeat (concealed) or silence
+    int stream = -1;
+    int failures = 0;
+    for (size_t f = 0; f + AudioPlayer::FRAME_SAMPLES <= played.size(); f += AudioPlayer::FRAME_SAMPLES) {
+        int16_t v = played[f];
+        bool uniform = true;
+        for (size_t i = 1; i < AudioPlayer::FRAME_SAMPLES; i++) uniform &= played[f + i] == v;
+        if (!uniform) {
+            if (stream >= 0) result[stream].out_of_order++;
+            continue;
+        }
+        if (v < TAG_BASE) continue;
+        int k = (v - TAG_BASE) / TAG_STRIDE;
+        int index = (v - TAG_BASE) % TAG_STRIDE;
+        if (k < stream) {
+            result[stream].out_of_order++;  // An earlier stream's frame after the next one started
+            continue;
+        }
+        stream = k;
+        if (index <= result[k].last_index) result[k].out_of_order++;
+        result[k].last_index = index;
+        result[k].played++;
+    }
+
+    for (int k = 0; k < STREAMS; k++) {
+        const StreamPlan& p = plan[k];
+        StreamResult& r = result[k];
+        const AudioPlayer::Stats& s = r.stats;
+        bool ok = r.done && (int) s.received == p.sent - p.lost && (int) s.late * 20 <= p.sent &&
+                  r.played == p.sent - p.lost - (int) s.late && (int) s.concealed <= p.lost + (int) s.late &&
+                  r.out_of_order == 0;
+        if (!ok) failures++;
+        printf("stream seed=%u n=%d start_seq=%u sent=%d lost=%d reordered=%d received=%u late=%u "
+               "concealed=%u underruns=%u played=%d out_of_order=%d target_depth=%u jitter_ms=%.1f ok=%d\n",
+               seed, k, START_SEQ[k], p.sent, p.lost, p.reordered, s.received, s.late, s.concealed, s.underruns,
+               r.played, r.out_of_order, s.target_depth, s.jitter_ms, ok ? 1 : 0);
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    int seeds = 5;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) seeds = atoi(argv[++i]);
+    }
+    int failures = 0;
+    for (int s = 1; s <= seeds; s++) failures += run((unsigned) s);
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""
+Broadcast Hub - WebSocket fan-out for the dashboard server.
+
+Each message is serialized once and appended to a bounded per-client queue;
+a writer task per client drains its own queue. A slow or stalled client (for
+example the screensaver's PagerFeedClient on a sleeping laptop) only backs
+up its own queue instead of delaying every other dashboard.
+
+Queue policy per client:
+- "state" frames coalesce: a queued state snapshot is replaced by the newer
+  one, since only the latest device state matters.
+- Everything else is drop-oldest once the queue is full; the drop count is
+  kept per client.
+- A client whose send has been stuck for SEND_TIMEOUT is disconnected.
+
+Usage:
+    hub = BroadcastHub()
+    channel = hub.add(ws)          # in the WebSocket handler
+    channel.put({"type": "state", "data": {...}})
+    hub.publish({"type": "event", "data": {...}})
+    await hub.remove(ws)
+
+    # Load test: 100 clients, one stalled
+    python -m devtools.broadcast_hub --bench
+"""
+
+import argparse
+import asyncio
+import json
+import logging
+import time
+from collections import deque
+from typing import Any, Deque, Dict, List, Optional, Tuple
+
+logger = logging.getLogger("Dashboard")
+
+QUEUE_LIMIT = 256
+SEND_TIMEOUT = 10.0
+COALESCE_TYPES = ("state",)
+
+
+class ClientChannel:
+    """Bounded outgoing queue and writer task for one WebSocket."""
+
+    def __init__(self, ws, limit: int = QUEUE_LIMIT, send_timeout: float = SEND_TIMEOUT):
+        self.ws = ws
+        self.limit = limit
+        self.send_timeout = send_timeout
+        self.dropped = 0
+        self.sent = 0
+        self._send_started: Optional[float] = None
+        # (coalesce key or None, serialized frame)
+        self._queue: Deque[Tuple[Optional[str], str]] = deque()
+        self._ready = asyncio.Event()
+        self._closed = False
+        self._task = asyncio.create_task(self._writer())
+
+    def put(self, message: Dict[str, Any]):
+        """Queue a message for this client only."""
+        self.put_frame(json.dumps(message), message.get("type"))
+
+    def put_frame(self, frame: str, msg_type: Optional[str] = None):
+        """Queue an already-serialized frame. Never blocks."""
+        if self._closed:
+            return
+        key = msg_type if msg_type in COALESCE_TYPES else None
+        if key is not None:
+            for i, (queued_key, _) in enumerate(self._queue):
+                if queued_key == key:
+                    self._queue[i] = (key, frame)
+                    return
+        if len(self._queue) >= self.limit:
+            self._queue.popleft()
+            self.dropped += 1
+        self._queue.append((key, frame))
+        self._ready.set()
+
+    @property
+    def depth(self) -> int:
+        return len(self._queue)
+
+    @property
+    def queued_bytes(self) -> int:
+        return sum(len(frame) for _, frame in self._queue)
+
+    @property
+    def closed(self) -> bool:
+        return self._closed
+
+    def stalled(self, now: float) -> bool:
+        """True if the current send has been blocked for longer than send_timeout."""
+        return self._send_started is not None and now - self._send_started > self.send_timeout
+
+    async def _writer(self):
+        loop = asyncio.get_running_loop()
+        try:
+            while not self._closed:
+                await self._ready.wait()
+                self._ready.clear()
+                while self._queue and not self._closed:
+                    _, frame = self._queue.popleft()
+                    # Checked by the hub instead of wait_for(), which costs a task per frame
+                    self._send_started = loop.time()
+                    await self.ws.send_str(frame)
+                    self._send_started = None
+                    self.sent += 1
+        except asyncio.CancelledError:
+            pass
+        except Exception:
+            await self._close_ws()
+        finally:
+            self._closed = True
+            self._queue.clear()
+
+    async def _close_ws(self):
+        try:
+            await asyncio.wait_for(self.ws.close(), 1.0)
+        except Exception:
+            pass
+
+    def abort(self):
+        """Stop a stalled writer and close its socket in the background."""
+        logger.warning(f"Dashboard client stalled for {self.send_timeout:.0f}s, disconnecting")
+        self._closed = True
+        self._task.cancel()
+        asyncio.ensure_future(self._close_ws())
+
+    async def close(self):
+        self._closed = True
+        self._ready.set()
+        self._task.cancel()
+        try:
+            await self._task
+        except asyncio.CancelledError:
+            pass
+
+
+class BroadcastHub:
+    """Serialize-once fan-out to all connected clients."""
+
+    def __init__(self, limit: int = QUEUE_LIMIT, send_timeout: float = SEND_TIMEOUT):
+        self.limit = limit
+        self.send_timeout = send_timeout
+        self.channels: Dict[Any, ClientChannel] = {}
+
+    def __len__(self) -> int:
+        return len(self.channels)
+
+    def add(self, ws) -> ClientChannel:
+        channel = ClientChannel(ws, self.limit, self.send_timeout)
+        self.channels[ws] = channel
+        return channel
+
+    async def remove(self, ws):
+        channel = self.channels.pop(ws, None)
+        if channel:
+            await channel.close()
+
+    def publish(self, message: Dict[str, Any]):
+        """Queue a message for every client; returns without waiting on any of them."""
+        if not self.channels:
+            return
+        frame = json.dumps(message)
+        msg_type = message.get("type")
+        now = asyncio.get_running_loop().time()
+        dead = []
+        for ws, channel in self.channels.items():
+            if not channel.closed and channel.stalled(now):
+                channel.abort()
+            if channel.closed:
+                dead.append(ws)
+            else:
+                channel.put_frame(frame, msg_type)
+        for ws in dead:
+            del self.channels[ws]
+
+    def stats(self) -> Dict[str, Any]:
+        return {
+            "clients": len(self.channels),
+            "queued": sum(c.depth for c in self.channels.values()),
+            "queued_bytes": sum(c.queued_bytes for c in self.channels.values()),
+            "dropped": sum(c.dropped for c in self.channels.values()),
+        }
+
+
+class _BenchSocket:
+    """Stand-in WebSocket recording per-message latency."""
+
+    def __init__(self, published: Dict[str, float], delay: float = 0.0, stalled: bool = False):
+        self.published = published
+        self.delay = delay
+        self.stalled = stalled
+        self.latencies: List[float] = []
+
+    async def send_str(self, frame: str):
+        if self.stalled:
+            await asyncio.Event().wait()  # Never completes, like a dead TCP peer
+        if self.delay:
+            await asyncio.sleep(self.delay)
+        self.latencies.append(time.perf_counter() - self.published[frame])
+
+    async def close(self):
+        pass
+
+
+async def _bench_hub(clients: int, events: int, rate: float) -> Dict[str, float]:
+    published: Dict[str, float] = {}
+    sockets = [_BenchSocket(published, stalled=(i == 0)) for i in range(clients)]
+    hub = BroadcastHub(send_timeout=3600)
+    for ws in sockets:
+        hub.add(ws)
+
+    peak_queued = 0
+    start = time.perf_counter()
+    for i in range(events):
+        message = {"type": "event", "data": {"seq": i, "text": "x" * 120}}
+        hub.publish(message)
+        published[json.dumps(message)] = time.perf_counter()
+        if i % 100 == 0:
+            peak_queued = max(peak_queued, hub.stats()["queued_bytes"])
+        await asyncio.sleep(max(0.0, start + (i + 1) / rate - time.perf_counter()))
+    while any(c.depth for ws, c in hub.channels.items() if not ws.stalled):
+        await asyncio.sleep(0.001)
+    elapsed = time.perf_counter() - start
+
+    latencies = sorted(l for ws in sockets for l in ws.latencies)
+    stalled_dropped = hub.channels[sockets[0]].dropped
+    healthy_dropped = hub.stats()["dropped"] - stalled_dropped
+    for ws in sockets:
+        await hub.remove(ws)
+    return {
+        "events_per_s": events / elapsed,
+        "p50_ms": latencies[len(latencies) // 2] * 1000,
+        "p99_ms": latencies[int(len(latencies) * 0.99)] * 1000,
+        "max_ms": latencies[-1] * 1000,
+        "peak_queued_kb": peak_queued / 1024,
+        "stalled_dropped": stalled_dropped,
+        "healthy_dropped": healthy_dropped,
+        "delivered": len(latencies),
+    }
+
+
+async def _bench_serial(clients: int, events: int, slow_delay: float) -> Dict[str, float]:
+    """The old broadcast(): json.dumps then await each send in turn."""
+    published: Dict[str, float] = {}
+    sockets = [_BenchSocket(published, delay=slow_delay if i == 0 else 0.0) for i in range(clients)]
+    start = time.perf_counter()
+    for i in range(events):
+        msg = json.dumps({"type": "event", "data": {"seq": i, "text": "x" * 120}})
+        published[msg] = time.perf_counter()
+        for ws in sockets:
+            await ws.send_str(msg)
+    elapsed = time.perf_counter() - start
+    latencies = sorted(l for ws in sockets[1:] for l in ws.latencies)
+    return {"events_per_s": events / elapsed, "p99_ms": latencies[int(len(latencies) * 0.99)] * 1000}
+
+
+def main():
+    """CLI: load test the hub."""
+    parser = argparse.ArgumentParser(description='Dashboard broadcast hub')
+    parser.add_argument('--bench', action='store_true', help='Run the 100-client load test')
+    parser.add_argument('--clients', type=int, default=100)
+    parser.add_argument('--events', type=int, default=5000)
+    parser.add_argument('--rate', type=float, default=500, help='Publish rate (events/s)')
+    args = parser.parse_args()
+
+    if not args.bench:
+        parser.print_help()
+        return
+
+    r = asyncio.run(_bench_hub(args.clients, args.events, args.rate))
+    print(f"Hub: {args.clients} clients (1 stalled), {args.events} events at {args.rate:.0f}/s")
+    print(f"  event rate      {r['events_per_s']:8.0f} events/s")
+    print(f"  latency         p50 {r['p50_ms']:.2f} ms  p99 {r['p99_ms']:.2f} ms  max {r['max_ms']:.2f} ms")
+    print(f"  queued memory   {r['peak_queued_kb']:8.0f} KB peak, summed per client")
+    print(f"  delivered       {r['delivered']} frames; dropped: stalled client "
+          f"{r['stalled_dropped']}, healthy clients {r['healthy_dropped']}")
+
+    serial_events = min(args.events, 200)
+    s = asyncio.run(_bench_serial(args.clients, serial_events, 0.02))
+    print(f"Serial broadcast: {args.clients} clients, 1 slow (20 ms/send; a stalled one blocks forever)")
+    print(f"  event rate      {s['events_per_s']:8.0f} events/s   p99 {s['p99_ms']:.2f} ms")
+
+
+if __name__ == '__main__':
+    main()
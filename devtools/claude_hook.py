@@ -14,6 +14,9 @@ Usage:
     echo '{"tool_name":"Edit",...}' | claude_hook.py TOOL_START
     claude_hook.py TOOL_END Edit
     claude_hook.py WAITING
+
+For low-latency hooks, use the native clawd_hook.cpp client with the
+hook_forwarder.py daemon instead; both share build_event() below.
 """
 
 import sys
@@ -237,6 +240,37 @@ def extract_tool_details(tool_name: str, tool_input: dict) -> dict:
     return details
 
 
+def build_event(event_type: str, tool_name: str, tool_input: dict, session_id: str = None):
+    """Turn a hook invocation into the bridge event (None if not forwarded).
+
+    session_id is Claude Code's, from the hook's stdin; it picks the row on
+    the pager's multi-session board (see session_manager.track_agent_event).
+    """
+    if event_type == "TOOL_START":
+        # Extract rich details and send to pager
+        event = extract_tool_details(tool_name or "Tool", tool_input)
+
+    elif event_type == "TOOL_END":
+        event = {
+            "event_type": "TOOL_END",
+            "tool": tool_name or "Tool"
+        }
+
+    elif event_type == "WAITING":
+        event = {
+            "event_type": "WAITING",
+            "display_text": "READY",
+            "display_mode": "IDLE"
+        }
+
+    else:
+        return None
+
+    if session_id:
+        event["session_id"] = session_id
+    return event
+
+
 def main():
     # CRITICAL: Always exit 0 for hook events to avoid blocking tools
 
@@ -249,6 +283,7 @@ def main():
     # Try to read JSON from stdin (Claude Code provides tool details)
     tool_input = {}
     tool_name = tool_name_arg
+    session_id = None
 
     try:
         # Non-blocking stdin read
@@ -259,26 +294,13 @@ def main():
                 data = json.loads(stdin_data)
                 tool_name = data.get("tool_name", tool_name_arg)
                 tool_input = data.get("tool_input", {})
+                session_id = data.get("session_id")
     except Exception:
         pass  # Use fallback if stdin parsing fails
 
-    if event_type == "TOOL_START":
-        # Extract rich details and send to pager
-        details = extract_tool_details(tool_name or "Tool", tool_input)
-        send_to_bridge(details)
-
-    elif event_type == "TOOL_END":
-        send_to_bridge({
-            "event_type": "TOOL_END",
-            "tool": tool_name or "Tool"
-        })
-
-    elif event_type == "WAITING":
-        send_to_bridge({
-            "event_type": "WAITING",
-            "display_text": "READY",
-            "display_mode": "IDLE"
-        })
+    event = build_event(event_type, tool_name, tool_input, session_id)
+    if event:
+        send_to_bridge(event)
 
     sys.exit(0)
 
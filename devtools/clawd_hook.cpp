@@ -0,0 +1,139 @@
+// Clawd Hook Client - native drop-in for claude_hook.py
+//
+// Claude Code runs the hook once per tool call. The Python hook paid
+// interpreter start-up plus an HTTP round trip (up to 500 ms) every time.
+// This client only hands the raw event to the local forwarder daemon
+// (hook_forwarder.py) over a Unix datagram socket and exits; the daemon
+// extracts details and posts to the bridge in the background.
+//
+// Build:
+//   g++ -O2 -s -o ~/.local/bin/clawd-hook devtools/clawd_hook.cpp
+//
+// Usage (same arguments as claude_hook.py):
+//   echo '{"tool_name":"Edit",...}' | clawd-hook TOOL_START
+//   clawd-hook TOOL_END Edit
+//   clawd-hook WAITING
+//
+// Datagram: event_type '\0' tool_name '\0' stdin_json
+// Socket:   $CLAWD_HOOK_SOCKET, else clawd-hook.sock in $XDG_RUNTIME_DIR,
+//           then in /tmp/clawd-hook-<uid>/. A directory is only used if it
+//           is ours, not a symlink and mode 0700, so no other user can have
+//           put a socket there to collect tool input.
+//
+// Always exits 0: a missing daemon or an oversized payload must never
+// block or fail the tool call. Input over MAX_STDIN (or too big for one
+// datagram) is not sent cut short: the event goes out without it, with
+// the tool name pulled from its start so the pager still shows the tool.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+static const size_t MAX_STDIN = 4 * 1024 * 1024;
+
+// Ours, a real directory and closed to group and others
+static bool private_dir(const std::string& dir) {
+    struct stat st;
+    return lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid() &&
+           (st.st_mode & 077) == 0;
+}
+
+// Where the forwarder may be listening, in the order it picks them
+static std::vector<std::string> socket_paths() {
+    std::vector<std::string> paths;
+    if (const char* p = getenv("CLAWD_HOOK_SOCKET")) {
+        paths.push_back(p);
+        return paths;
+    }
+    const char* xdg = getenv("XDG_RUNTIME_DIR");
+    if (xdg && *xdg && private_dir(xdg)) paths.push_back(std::string(xdg) + "/clawd-hook.sock");
+    std::string tmp = "/tmp/clawd-hook-" + std::to_string(getuid());
+    if (private_dir(tmp)) paths.push_back(tmp + "/clawd-hook.sock");
+    return paths;
+}
+
+// False only if nothing listens at path, so the next one is worth a try
+static bool send_packet(int fd, const std::string& path, const std::string& packet, const std::string& header) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    ssize_t sent = sendto(fd, packet.data(), packet.size(), MSG_DONTWAIT,
+                          reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    if (sent >= 0) return true;
+    int err = errno;
+    if (err == EMSGSIZE || err == ENOBUFS) {
+        // Too big for one datagram (e.g. Write with a huge file)
+        sendto(fd, header.data(), header.size(), MSG_DONTWAIT,
+               reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+    return err != ENOENT && err != ECONNREFUSED;
+}
+
+// All of stdin, or only its first bytes (and *oversized set) past
+// MAX_STDIN: cut-off JSON would just fail to parse in the forwarder.
+// Reads to EOF either way, so Claude Code's write never fails.
+static std::string read_stdin(bool* oversized) {
+    std::string data;
+    *oversized = false;
+    if (isatty(STDIN_FILENO)) return data;
+    char buf[16384];
+    ssize_t n;
+    while ((n = read(STDIN_FILENO, buf, sizeof(buf))) > 0) {
+        if (*oversized) continue;
+        if (data.size() + n > MAX_STDIN) {
+            *oversized = true;
+            continue;
+        }
+        data.append(buf, n);
+    }
+    return data;
+}
+
+// "tool_name": "<name>" from the start of the hook JSON, "" if not found
+static std::string tool_name_from(const std::string& json) {
+    size_t at = json.find("\"tool_name\"");
+    if (at == std::string::npos) return "";
+    at += 11;
+    while (at < json.size() && (json[at] == ' ' || json[at] == ':')) at++;
+    if (at >= json.size() || json[at] != '"') return "";
+    size_t end = json.find_first_of("\"\\", ++at);
+    if (end == std::string::npos || json[end] != '"') return "";
+    return json.substr(at, end - at);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return 0;
+
+    bool oversized;
+    std::string input = read_stdin(&oversized);
+
+    // Header-only fallback: event type and tool name, no tool input
+    std::string header = argv[1];
+    header.push_back('\0');
+    header += argc > 2 ? std::string(argv[2]) : tool_name_from(input.substr(0, 4096));
+    header.push_back('\0');
+    std::string packet = header;
+    if (!oversized) packet += input;
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return 0;
+
+    int sndbuf = (int) packet.size() + 1024;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    for (const std::string& path : socket_paths()) {
+        if (send_packet(fd, path, packet, header)) break;
+    }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""
+Clock Sync - Bridge side of the pager timebase (see clock_sync.h).
+
+The pager polls the bridge with FF FF 'T' 'Q' datagrams on its audio socket.
+The bridge answers each with its receive and send times (unix microseconds),
+and from those the pager keeps an offset/drift fit. Once synced, every audio
+packet header and every EVENT log line (" | t=<sec>.<usec>") carries
+bridge-clock time, so latency can be measured end to end and button events
+lined up with audio.
+
+The bridge's audio receive loop should pass each datagram through
+handle_datagram() first, then give the rest to parse_audio():
+
+    from devtools.clock_sync import handle_datagram, parse_audio
+    data, addr = sock.recvfrom(2048)
+    if handle_datagram(sock, data, addr):
+        continue                       # Sync request, already answered
+    packet = parse_audio(data)         # AudioPacket, or None for markers
+
+Until the bridge has answered a sync request the pager sends raw PCM
+(START format v0): a bridge that never replies never sees the header.
+
+Usage:
+    # Stand-alone receiver: answers sync and prints per-packet audio latency
+    python -m devtools.clock_sync --port 12345
+
+    # Error bound under skew/jitter/loss, and the audio header gating
+    g++ -O2 -I. -Idevtools/host -o /tmp/clock-sync-bench devtools/clock_sync_bench.cpp
+    python -m devtools.clock_sync --bench --bin /tmp/clock-sync-bench
+"""
+
+import argparse
+import re
+import socket
+import struct
+import subprocess
+import time
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Tuple
+
+REQUEST = struct.Struct("<4sIQ")            # magic, seq, t1
+REPLY = struct.Struct("<4sIQQQ")            # magic, seq, t1, t2, t3
+AUDIO_HEADER = struct.Struct("<2sBxIQ")     # magic, flags, seq, t_us
+
+REQUEST_MAGIC = b"\xff\xffTQ"
+REPLY_MAGIC = b"\xff\xffTR"
+AUDIO_MAGIC = b"\xff\xfe"
+AUDIO_FLAG_SYNCED = 0x01
+
+
+def now_us() -> int:
+    return time.time_ns() // 1000
+
+
+def handle_datagram(sock: socket.socket, data: bytes, addr: Tuple[str, int],
+                    received_us: Optional[int] = None) -> bool:
+    """Answer a clock sync request. Returns False for anything else.
+
+    received_us should be taken as soon as recvfrom() returns; time spent
+    before the reply is sent is excluded from the pager's delay estimate.
+    """
+    if len(data) < REQUEST.size or not data.startswith(REQUEST_MAGIC):
+        return False
+    t2 = received_us if received_us is not None else now_us()
+    _, seq, t1 = REQUEST.unpack_from(data)
+    sock.sendto(REPLY.pack(REPLY_MAGIC, seq, t1, t2, now_us()), addr)
+    return True
+
+
+@dataclass
+class AudioPacket:
+    seq: int
+    t_us: int          # Capture time of the first sample
+    synced: bool       # t_us is bridge clock (else pager uptime)
+    pcm: bytes
+
+
+def parse_audio(data: bytes) -> Optional[AudioPacket]:
+    """Timestamped audio packet -> AudioPacket; None for markers/side channels.
+
+    Version 0 streams (START marker ends in 0x00: the pager had no sync
+    reply yet) send raw PCM with no header; those come back with seq -1 and
+    t_us 0.
+    """
+    if data.startswith(b"\xff\xff"):
+        return None
+    if data.startswith(AUDIO_MAGIC) and len(data) >= AUDIO_HEADER.size:
+        _, flags, seq, t_us = AUDIO_HEADER.unpack_from(data)
+        return AudioPacket(seq, t_us, bool(flags & AUDIO_FLAG_SYNCED), data[AUDIO_HEADER.size:])
+    return AudioPacket(-1, 0, False, data)
+
+
+def parse_event_time(line: str) -> Optional[float]:
+    """Bridge-clock time (unix seconds) from an EVENT log line, if stamped."""
+    marker = line.rfind("| t=")
+    if marker < 0:
+        return None
+    try:
+        return float(line[marker + 4:].split()[0])
+    except (ValueError, IndexError):
+        return None
+
+
+BENCH_LINE_RE = re.compile(r"^(sim|check|vector|total) (.*)$")
+
+
+def fields(text: str) -> Dict[str, str]:
+    return dict(kv.split("=", 1) for kv in text.split())
+
+
+def bench(binary: str, minutes: int) -> bool:
+    out = subprocess.run([binary, "-n", str(minutes)], capture_output=True, text=True)
+    sims: List[Dict[str, str]] = []
+    checks: List[Dict[str, str]] = []
+    vector = total = None
+    for line in out.stdout.splitlines():
+        m = BENCH_LINE_RE.match(line.strip())
+        if not m:
+            continue
+        f = fields(m.group(2))
+        if m.group(1) == "sim":
+            sims.append(f)
+        elif m.group(1) == "check":
+            checks.append(f)
+        elif m.group(1) == "vector":
+            vector = f
+        else:
+            total = f
+    if total is None:
+        print(out.stdout + out.stderr)
+        return False
+
+    print(f"{minutes} simulated minutes per row, 10% replies lost, 2% delay spikes")
+    print(f"  {'skew':>6} {'jitter':>7} {'exchanges':>10} {'checks':>7} {'over bound':>11}"
+          f" {'p50 err':>9} {'max err':>9} {'p50 bound':>10}")
+    for s in sims:
+        print(f"  {s['skew_ppm']:>4}pp {float(s['jitter_ms']):>5.1f}ms {s['exchanges']:>10} {s['checks']:>7}"
+              f" {s['violations']:>11} {int(s['p50_us']) / 1000:>7.2f}ms {int(s['max_us']) / 1000:>7.2f}ms"
+              f" {int(s['bound_p50_us']) / 1000:>8.2f}ms")
+
+    bad = [c for c in checks if c["ok"] != "1"]
+    print(f"\nAudio header and replies: {len(checks) - len(bad)}/{len(checks)} checks pass")
+    for c in bad:
+        print(f"  FAIL {c['name']}")
+
+    # The pager's header, read back with the bridge's parser
+    parsed = False
+    if vector is not None:
+        packet = parse_audio(bytes.fromhex(vector["data"]))
+        parsed = (packet is not None and packet.synced and packet.seq == int(vector["seq"])
+                  and packet.t_us == int(vector["t_us"])
+                  and packet.pcm == struct.pack("<4h", 0, 97, 194, 291))
+    print(f"parse_audio on the pager's header packet: {'ok' if parsed else 'WRONG'}")
+
+    ok = out.returncode == 0 and total.get("failures") == "0" and parsed
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: answer sync requests and report audio latency, or run the bench."""
+    parser = argparse.ArgumentParser(description='Pager clock sync responder')
+    parser.add_argument('--port', type=int, default=12345, help='Audio UDP port')
+    parser.add_argument('--bench', action='store_true', help='Run devtools/clock_sync_bench.cpp and check it')
+    parser.add_argument('--bin', default='/tmp/clock-sync-bench', help='Built clock_sync_bench.cpp')
+    parser.add_argument('--minutes', type=int, default=60, help='Simulated minutes per skew/jitter pair')
+    args = parser.parse_args()
+    if args.bench:
+        raise SystemExit(0 if bench(args.bin, args.minutes) else 1)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("0.0.0.0", args.port))
+    print(f"Listening on UDP {args.port} (sync replies + audio latency)")
+
+    syncs = 0
+    latencies = []
+    while True:
+        data, addr = sock.recvfrom(2048)
+        received = now_us()
+        if handle_datagram(sock, data, addr, received):
+            syncs += 1
+            continue
+        if data.startswith(b"\xff\xffSTART"):
+            latencies = []
+            print(f"START from {addr[0]} (format v{data[7] if len(data) > 7 else 0}), syncs so far: {syncs}")
+            continue
+        if data.startswith(b"\xff\xffSTOP"):
+            if latencies:
+                latencies.sort()
+                print(f"STOP: {len(latencies)} packets, capture->bridge latency "
+                      f"p50 {latencies[len(latencies) // 2] / 1000:.1f} ms, "
+                      f"max {latencies[-1] / 1000:.1f} ms")
+            continue
+        packet = parse_audio(data)
+        if packet and packet.synced:
+            # Latency of the packet's last sample: capture to arrival here
+            last_sample = packet.t_us + len(packet.pcm) // 2 * 1_000_000 // 16000
+            latencies.append(received - last_sample)
+
+
+if __name__ == '__main__':
+    main()
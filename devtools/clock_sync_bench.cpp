@@ -0,0 +1,300 @@
+// Clock Sync Bench - host build of clock_sync.h and the audio header
+//
+// Estimator: simulates an exchange schedule like ClockSync's (a burst of
+// BURST polls 250 ms apart, then one every 5 s) between a pager whose
+// crystal runs off by a skew and the bridge clock, over a modeled network:
+//   delay     1 ms + exponential jitter per direction (asymmetric)
+//   spikes    2% of legs delayed another 20..200 ms
+//   loss      10% of replies
+// Every 100 ms of simulated time it compares ClockEstimator's bridge time
+// with the true one: the error must stay within error_bound_us() (that is
+// a hard bound, so violations must be 0). Skews 0 / +25 / -40 / +150 ppm,
+// jitter 0.5 / 3 / 15 ms.
+//
+// Audio header: drives the real ClockSync and AudioStreamer singletons on
+// a simulated pager clock. Checks:
+//   unsynced   before any sync reply: START says version 0, audio is raw PCM
+//   midstream  a reply during a recording doesn't change its format
+//   header     the next recording is version 1: FF FE, synced flag, seq
+//              counting from 0, t_us of the first sample in bridge time
+//   reply_t1   a reply echoing a t1 the pager didn't send, or answering a
+//              request twice, is ignored; the genuine reply still counts
+//              (waits one burst interval for the next request)
+// The vector line is one header packet for devtools/clock_sync.py to parse
+// with the bridge's own parse_audio().
+//
+// Build:
+//   g++ -O2 -I. -Idevtools/host -o /tmp/clock-sync-bench devtools/clock_sync_bench.cpp
+//
+// Usage:
+//   clock-sync-bench [-n minutes]
+//   -> sim skew_ppm=<p> jitter_ms=<j> exchanges=<n> checks=<n> violations=<n> p50_us=<t> max_us=<t>
+//          bound_p50_us=<t> ok=<0|1>
+//      check name=<check> ok=<0|1>
+//      vector data=<hex> seq=<n> t_us=<t>
+//      total failures=<n>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esphome.h"
+#include "clock_sync.h"
+
+static const int64_t BRIDGE_EPOCH_US = 1760000000LL * 1000000;  // Bridge clock at t = 0
+static const int64_t PAGER_BOOT_US = 3000000;                    // Pager uptime at t = 0
+static const uint16_t BRIDGE_PORT = 12345;
+
+static int failures = 0;
+
+static void check(const char* name, bool ok) {
+    if (!ok) failures++;
+    printf("check name=%s ok=%d\n", name, ok ? 1 : 0);
+}
+
+// True time t (us since start) on each clock
+struct Clocks {
+    double skew;  // Pager rate error
+
+    int64_t pager(double t) const { return PAGER_BOOT_US + (int64_t) llround(t * (1 + skew)); }
+    int64_t bridge(double t) const { return BRIDGE_EPOCH_US + (int64_t) llround(t); }
+    // Bridge time at the instant the pager clock reads local
+    double bridge_at_local(int64_t local) const {
+        return (double) BRIDGE_EPOCH_US + (double) (local - PAGER_BOOT_US) / (1 + skew);
+    }
+};
+
+static void sim(double skew_ppm, double jitter_ms, int minutes, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> jitter(1.0 / (jitter_ms * 1000));
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::uniform_real_distribution<double> spike(20000, 200000);
+    Clocks c{skew_ppm * 1e-6};
+    auto leg = [&]() {
+        double d = 1000 + jitter(rng);
+        if (unit(rng) < 0.02) d += spike(rng);
+        return d;
+    };
+
+    ClockEstimator est;
+    double end = minutes * 60e6;
+    double next_poll = 0, next_check = 0;
+    int polls = 0, exchanges = 0, checks = 0, violations = 0;
+    std::vector<double> errors, bounds;
+    // Replies in flight: (arrival t, t1, t2, t3)
+    struct Reply {
+        double at;
+        int64_t t1, t2, t3;
+    };
+    std::vector<Reply> flight;
+
+    for (double t = 0; t < end; t += 1000) {  // 1 ms steps
+        if (t >= next_poll) {
+            double d1 = leg(), d2 = leg();
+            double proc = 50 + 200 * unit(rng);
+            if (unit(rng) >= 0.10) {
+                flight.push_back({t + d1 + proc + d2, c.pager(t), c.bridge(t + d1), c.bridge(t + d1 + proc)});
+            }
+            polls++;
+            next_poll += polls < ClockSync::BURST ? ClockSync::BURST_INTERVAL_MS * 1000.0
+                                                   : ClockSync::POLL_INTERVAL_MS * 1000.0;
+        }
+        for (size_t i = 0; i < flight.size();) {
+            if (flight[i].at <= t) {
+                if (est.add_sample(flight[i].t1, flight[i].t2, flight[i].t3, c.pager(flight[i].at))) exchanges++;
+                flight.erase(flight.begin() + i);
+            } else {
+                i++;
+            }
+        }
+        if (t >= next_check && est.synced()) {
+            int64_t local = c.pager(t);
+            double err = fabs((double) est.to_bridge_us(local) - c.bridge_at_local(local));
+            double bound = est.error_bound_us(local);
+            if (err > bound) violations++;
+            errors.push_back(err);
+            bounds.push_back(bound);
+            checks++;
+        }
+        if (t >= next_check) next_check += 100000;
+    }
+
+    std::sort(errors.begin(), errors.end());
+    std::sort(bounds.begin(), bounds.end());
+    double p50 = errors.empty() ? 0 : errors[errors.size() / 2];
+    double max = errors.empty() ? 0 : errors.back();
+    double bound_p50 = bounds.empty() ? 0 : bounds[bounds.size() / 2];
+    bool ok = checks > 0 && violations == 0;
+    if (!ok) failures++;
+    printf("sim skew_ppm=%+.0f jitter_ms=%.1f exchanges=%d checks=%d violations=%d p50_us=%.0f max_us=%.0f "
+           "bound_p50_us=%.0f ok=%d\n",
+           skew_ppm, jitter_ms, exchanges, checks, violations, p50, max, bound_p50, ok ? 1 : 0);
+}
+
+// Simulated pager uptime for ClockSync::local_us()
+static int64_t g_pager_us = PAGER_BOOT_US;
+static int64_t pager_clock() { return g_pager_us; }
+
+static std::vector<HostDatagram> take_sent() {
+    std::vector<HostDatagram> sent = host_udp_sent();
+    host_udp_sent().clear();
+    return sent;
+}
+
+static uint64_t get_le(const uint8_t* p, int n) {
+    uint64_t v = 0;
+    for (int i = n - 1; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static void put_le(uint8_t* p, uint64_t v, int n) {
+    for (int i = 0; i < n; i++) p[i] = (uint8_t) (v >> (8 * i));
+}
+
+static std::string hex(const std::vector<uint8_t>& d, size_t n) {
+    std::string s;
+    char b[3];
+    for (size_t i = 0; i < n && i < d.size(); i++) {
+        snprintf(b, sizeof(b), "%02x", d[i]);
+        s += b;
+    }
+    return s;
+}
+
+// One recording of `chunks` microphone reads; returns its audio packets
+static std::vector<HostDatagram> record(int chunks, void (*between)() = nullptr) {
+    std::vector<int16_t> samples(256);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = (int16_t) (i * 97);
+    audio_streamer().start_recording();
+    take_sent();
+    std::vector<HostDatagram> sent;
+    for (int k = 0; k < chunks; k++) {
+        g_pager_us += 16000;  // 256 samples at 16 kHz
+        audio_streamer().send_audio(samples.data(), samples.size());
+        for (const HostDatagram& d : take_sent()) sent.push_back(d);
+        if (k == 0 && between) between();
+    }
+    audio_streamer().stop_recording();
+    take_sent();
+    return sent;
+}
+
+static bool is_raw(const HostDatagram& d) {
+    return d.data.size() == 512 && get_le(&d.data[2], 2) == (uint16_t) (1 * 97);  // Samples 1.. of the ramp
+}
+
+static void answer_sync() {
+    ClockSync::instance().loop();  // First request goes out at once
+    for (const HostDatagram& d : take_sent()) {
+        if (d.data.size() != ClockSync::REQUEST_SIZE || d.data[2] != 'T' || d.data[3] != 'Q') continue;
+        uint8_t reply[ClockSync::REPLY_SIZE] = {0xFF, 0xFF, 'T', 'R'};
+        memcpy(reply + 4, &d.data[4], 12);  // seq, t1
+        int64_t bridge = BRIDGE_EPOCH_US + (g_pager_us - PAGER_BOOT_US);
+        put_le(reply + 16, (uint64_t) bridge + 500, 8);
+        put_le(reply + 24, (uint64_t) bridge + 600, 8);
+        g_pager_us += 1100;
+        clock_sync().on_datagram(reply, sizeof(reply));
+    }
+}
+
+// Answers the next request with a forged t1, then genuinely, twice
+static void reply_checks() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ClockSync::BURST_INTERVAL_MS + 10));
+    take_sent();
+    clock_sync().loop();
+    std::vector<HostDatagram> sent = take_sent();
+    bool ok = sent.size() == 1 && sent[0].data.size() == ClockSync::REQUEST_SIZE;
+    if (ok) {
+        uint8_t reply[ClockSync::REPLY_SIZE] = {0xFF, 0xFF, 'T', 'R'};
+        memcpy(reply + 4, &sent[0].data[4], 12);
+        int64_t bridge = BRIDGE_EPOCH_US + (g_pager_us - PAGER_BOOT_US);
+        put_le(reply + 16, (uint64_t) bridge + 500, 8);
+        put_le(reply + 24, (uint64_t) bridge + 600, 8);
+        g_pager_us += 1100;
+        uint8_t forged[ClockSync::REPLY_SIZE];
+        memcpy(forged, reply, sizeof(reply));
+        put_le(forged + 8, get_le(reply + 8, 8) - 400000, 8);  // Would pull the offset by 200 ms
+
+        uint32_t replies = clock_sync().replies(), rejected = clock_sync().rejected();
+        clock_sync().on_datagram(forged, sizeof(forged));
+        ok = clock_sync().replies() == replies && clock_sync().rejected() == rejected + 1;
+        clock_sync().on_datagram(reply, sizeof(reply));
+        ok &= clock_sync().replies() == replies + 1;
+        clock_sync().on_datagram(reply, sizeof(reply));
+        ok &= clock_sync().replies() == replies + 1 && clock_sync().rejected() == rejected + 2;
+    }
+    check("reply_t1", ok);
+}
+
+static void header_checks() {
+    ClockSync::host_clock() = pager_clock;
+    audio_streamer().begin("127.0.0.1", BRIDGE_PORT);
+    clock_sync().begin();
+
+    // No reply yet: the bridge may not know the header
+    take_sent();
+    audio_streamer().start_recording();
+    std::vector<HostDatagram> start = take_sent();
+    audio_streamer().stop_recording();
+    std::vector<HostDatagram> rec = record(3);
+    bool raw = true;
+    for (const HostDatagram& d : rec) raw &= is_raw(d);
+    check("unsynced", start.size() == 1 && start[0].data.size() == 8 && start[0].data[7] == 0 && rec.size() == 3 &&
+                          raw && !audio_streamer().timestamped());
+
+    // The reply lands after the first chunk: this recording stays raw
+    rec = record(3, answer_sync);
+    raw = true;
+    for (const HostDatagram& d : rec) raw &= is_raw(d);
+    check("midstream", clock_sync().synced() && rec.size() == 3 && raw);
+
+    // Next recording: version 1, every packet headed and synced
+    take_sent();
+    audio_streamer().start_recording();
+    start = take_sent();
+    audio_streamer().stop_recording();
+    int64_t first_sample_local = g_pager_us;  // record() advances 16 ms per chunk before sending it
+    rec = record(3);
+    bool headed = start.size() == 1 && start[0].data[7] == 1 && rec.size() == 3;
+    int64_t t0 = 0;
+    for (size_t k = 0; headed && k < rec.size(); k++) {
+        const std::vector<uint8_t>& p = rec[k].data;
+        headed = p.size() == 16 + 512 && p[0] == 0xFF && p[1] == 0xFE && (p[2] & AUDIO_FLAG_SYNCED) &&
+                 get_le(&p[4], 4) == k && get_le(&p[18], 2) == (uint16_t) 97;
+        int64_t t = (int64_t) get_le(&p[8], 8);
+        if (k == 0) t0 = t;
+        // Consecutive chunks 16 ms apart on the bridge clock
+        headed &= k == 0 || llabs(t - t0 - (int64_t) k * 16000) <= 2;
+    }
+    int64_t expect = clock_sync().estimator().to_bridge_us(first_sample_local);
+    headed &= llabs(t0 - expect) <= 2;
+    check("header", headed);
+    if (!rec.empty()) {
+        printf("vector data=%s seq=%u t_us=%lld\n", hex(rec[0].data, 16 + 8).c_str(),
+               (unsigned) get_le(&rec[0].data[4], 4), (long long) get_le(&rec[0].data[8], 8));
+    }
+}
+
+int main(int argc, char** argv) {
+    int minutes = 60;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) minutes = atoi(argv[++i]);
+    }
+    static const double SKEWS[] = {0, 25, -40, 150};
+    static const double JITTERS[] = {0.5, 3, 15};
+    unsigned seed = 1;
+    for (double skew : SKEWS) {
+        for (double jitter : JITTERS) sim(skew, jitter, minutes, seed++);
+    }
+    header_checks();
+    reply_checks();
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
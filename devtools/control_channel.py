@@ -0,0 +1,788 @@
+#!/usr/bin/env python3
+"""
+Control Channel - Bridge side of the pager's UDP fast path (see control_channel.h).
+
+set_display, alert and update_weather go to the pager as HMAC-tagged,
+sequenced datagrams on its audio socket instead of ESPHome API service
+calls. The pager acks every authenticated message; ControlSender
+retransmits until the ack arrives (RTO from measured RTT, doubling up to
+1 s) and resends everything at once when the pager says hello after a
+WiFi reconnect. A message that is still unacked at its TTL is reported
+"expired": send it through the API instead, which stays the slow path.
+
+Every tag also covers the pager's boot nonce, taken from its hello, so
+nothing captured before a pager reboot verifies afterwards. Until a hello
+arrives the sender signs with nonce 0; the pager answers those with a
+hello, and everything pending goes out again signed right.
+
+The bridge's audio receive loop hands datagrams to the sender first, like
+clock sync (the pager's address is learned from its hello):
+
+    from devtools.control_channel import ControlSender, load_key
+    control = ControlSender.over_socket(sock, load_key())
+    ...
+    data, addr = sock.recvfrom(2048)
+    if control.handle_datagram(data, addr):
+        continue                      # Ack or hello
+    ...
+    control.send_display("AGENT_READ", "main.cpp", on_result=fallback_to_api)
+    control.poll()                    # At least every 10 ms while anything is pending
+
+The key is the control_key secret, from $CLAWD_CONTROL_KEY, used whole (hmac
+hashes one over 64 bytes first, as the pager does).
+
+Usage:
+    # Stand-alone: wait for the pager's hello on the audio port, then send
+    python -m devtools.control_channel --port 12345 --send AGENT_BASH "npm test"
+
+    # Send -> applied latency and recovery after WiFi drops, UDP vs API,
+    # over a simulated link (the sender below, PagerStandIn, a TCP model)
+    python -m devtools.control_channel --bench
+
+    # The same two paths over real localhost sockets (no WiFi in the loop)
+    python -m devtools.control_channel --bench --live
+
+    # control_channel.h itself: duplicates, stale, bad tags, replay after
+    # reboot (devtools/control_channel_bench.cpp), and the same tag here
+    g++ -O2 -I. -Idevtools/host -o /tmp/control-channel-bench devtools/control_channel_bench.cpp
+    python -m devtools.control_channel --check --bin /tmp/control-channel-bench
+"""
+
+import argparse
+import hashlib
+import heapq
+import hmac
+import os
+import random
+import socket
+import struct
+import subprocess
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import Callable, Dict, List, Optional, Tuple
+
+from devtools.message_queue import ALERT as ALERT_CLASS, PROMPT_MODES, STATUS, classify, strip_silent, synthetic_calls
+
+HEADER = struct.Struct("<4sIIBBH")          # magic, session, seq, type, reserved, len
+ACK = struct.Struct("<4sIIB3x")             # magic, session, seq, status (hello: session, nonce)
+NONCE = struct.Struct("<I")
+TAG_SIZE = 16
+MAX_DATAGRAM = 1472                         # AudioStreamer::RECEIVE_MAX
+MAX_PAYLOAD = MAX_DATAGRAM - HEADER.size - TAG_SIZE
+
+MSG_MAGIC = b"\xff\xffCM"
+ACK_MAGIC = b"\xff\xffCA"
+HELLO_MAGIC = b"\xff\xffCH"
+
+SET_DISPLAY, ALERT, WEATHER, PING = 1, 2, 3, 4
+APPLIED, DUPLICATE, STALE = 0, 1, 2
+STATUS_NAMES = {APPLIED: "applied", DUPLICATE: "duplicate", STALE: "stale"}
+WINDOW = 32
+
+# How long a message is worth retransmitting, per message_queue class,
+# before it is reported expired (API fallback): an AGENT_* update is old
+# news after a few seconds, a prompt lasts its dwell. The pager's queue
+# keeps the newest state however long it waits; this is only the bridge
+# giving up on the fast path.
+SEND_TTL_MS = (4000, 15000, 120000, 90000)
+
+RTO_INITIAL_S = 0.1
+RTO_MIN_S = 0.05                            # Pager drains the socket every 20 ms
+RTO_MAX_S = 1.0
+
+
+def load_key(env: str = "CLAWD_CONTROL_KEY") -> bytes:
+    key = os.environ.get(env, "")
+    if not key:
+        raise SystemExit(f"{env} is not set (the control_key from secrets.yaml)")
+    return key.encode()
+
+
+def tag(key: bytes, nonce: int, data: bytes) -> bytes:
+    return hmac.new(key, NONCE.pack(nonce) + data, hashlib.sha256).digest()[:TAG_SIZE]
+
+
+def is_state(msg_type: int, payload: bytes) -> bool:
+    """Same test as ControlChannel::is_state(): a late one must not win."""
+    if msg_type == WEATHER:
+        return True
+    if msg_type != SET_DISPLAY:
+        return False
+    mode = strip_silent(payload.split(b"\0", 1)[0].decode(errors="replace"))[0]
+    return mode not in PROMPT_MODES
+
+
+@dataclass
+class Pending:
+    seq: int
+    body: bytes                             # Signed at each transmit: the nonce can change
+    state: bool
+    first_sent: float
+    deadline: float
+    next_send: float = 0.0
+    rto: float = RTO_INITIAL_S
+    sends: int = 0
+    on_result: Optional[Callable[[int, str], None]] = None
+
+
+class ControlSender:
+    """Sequenced, acked sender; clock and transmit are injectable for the bench."""
+
+    def __init__(self, key: bytes, transmit: Callable[[bytes], None],
+                 clock: Callable[[], float] = time.monotonic, session: Optional[int] = None):
+        self.key = key
+        self.transmit = transmit
+        self.clock = clock
+        self.session = session if session is not None else int(time.time())
+        self.seq = 0
+        self.nonce = 0                          # Pager's boot nonce, from its last hello
+        self.peer: Optional[Tuple[str, int]] = None
+        self.pending: Dict[int, Pending] = {}
+        self.srtt: Optional[float] = None
+        self.rttvar = 0.0
+        self.stats = {"sent": 0, "retransmits": 0, "acked": 0, "stale": 0, "duplicate_acks": 0,
+                      "superseded": 0, "expired": 0, "hellos": 0, "bad_tag": 0}
+
+    @classmethod
+    def over_socket(cls, sock: socket.socket, key: bytes, peer: Optional[Tuple[str, int]] = None,
+                    **kwargs) -> "ControlSender":
+        """Sender on the bridge's audio socket; quiet until the pager's address is known."""
+        sender = cls(key, lambda packet: sender.peer and sock.sendto(packet, sender.peer), **kwargs)
+        sender.peer = peer
+        return sender
+
+    # -- sending --
+
+    def send_display(self, mode: str, text: str, on_result=None) -> Optional[int]:
+        ttl = SEND_TTL_MS[classify(strip_silent(mode)[0])] / 1000
+        return self.send(SET_DISPLAY, mode.encode() + b"\0" + text.encode(), ttl, on_result)
+
+    def send_alert(self, text: str, on_result=None) -> Optional[int]:
+        return self.send(ALERT, text.encode(), SEND_TTL_MS[ALERT_CLASS] / 1000, on_result)
+
+    def send_weather(self, text: str, on_result=None) -> Optional[int]:
+        return self.send(WEATHER, text.encode(), SEND_TTL_MS[STATUS] / 1000, on_result)
+
+    def ping(self, on_result=None) -> Optional[int]:
+        return self.send(PING, b"", 2.0, on_result)
+
+    def send(self, msg_type: int, payload: bytes, ttl_s: float, on_result=None) -> Optional[int]:
+        """Queue and transmit one message; None if it only fits the API path."""
+        if len(payload) > MAX_PAYLOAD:
+            return None
+        now = self.clock()
+        state = is_state(msg_type, payload)
+        if state:
+            # A newer state makes any unacked older one pointless to resend
+            for old in [p for p in self.pending.values() if p.state]:
+                self._finish(old, "superseded")
+        self.seq += 1
+        body = HEADER.pack(MSG_MAGIC, self.session, self.seq, msg_type, 0, len(payload)) + payload
+        p = Pending(self.seq, body, state, now, now + ttl_s, on_result=on_result)
+        p.rto = self._rto()
+        self.pending[p.seq] = p
+        self._transmit(p, now)
+        return p.seq
+
+    def poll(self, now: Optional[float] = None):
+        """Retransmit what is due and expire what is too old."""
+        now = self.clock() if now is None else now
+        for p in sorted(self.pending.values(), key=lambda p: p.seq):
+            if now >= p.deadline:
+                self._finish(p, "expired")
+            elif now >= p.next_send:
+                self.stats["retransmits"] += 1
+                p.rto = min(p.rto * 2, RTO_MAX_S)
+                self._transmit(p, now)
+
+    def next_timer(self) -> Optional[float]:
+        return min((min(p.next_send, p.deadline) for p in self.pending.values()), default=None)
+
+    # -- receiving --
+
+    def handle_datagram(self, data: bytes, addr: Optional[Tuple[str, int]] = None) -> bool:
+        """Consume an ack or hello from the pager. Returns False for anything else."""
+        if not (data.startswith(ACK_MAGIC) or data.startswith(HELLO_MAGIC)):
+            return False
+        if len(data) != ACK.size + TAG_SIZE:
+            self.stats["bad_tag"] += 1
+            return True
+        magic, session, seq, status = ACK.unpack_from(data)
+        nonce = seq if magic == HELLO_MAGIC else self.nonce
+        if not hmac.compare_digest(tag(self.key, nonce, data[:ACK.size]), data[ACK.size:]):
+            self.stats["bad_tag"] += 1
+            return True
+        if addr is not None:
+            self.peer = addr
+        now = self.clock()
+        if magic == HELLO_MAGIC:
+            # Back online (maybe rebooted): everything pending goes out now,
+            # signed for this boot, from a fresh RTO
+            self.nonce = nonce
+            self.stats["hellos"] += 1
+            for p in sorted(self.pending.values(), key=lambda p: p.seq):
+                p.rto = self._rto()
+                self._transmit(p, now)
+            return True
+        p = self.pending.get(seq)
+        if session != self.session or p is None:
+            self.stats["duplicate_acks"] += 1
+            return True
+        if p.sends == 1:
+            self._sample_rtt(now - p.first_sent)  # Karn: only unambiguous samples
+        if status == STALE:
+            self.stats["stale"] += 1
+        self._finish(p, STATUS_NAMES.get(status, "applied"))
+        return True
+
+    # -- internals --
+
+    def _transmit(self, p: Pending, now: float):
+        p.sends += 1
+        p.next_send = now + p.rto
+        self.stats["sent"] += 1
+        self.transmit(p.body + tag(self.key, self.nonce, p.body))
+
+    def _finish(self, p: Pending, result: str):
+        del self.pending[p.seq]
+        if result in ("applied", "duplicate", "stale"):
+            self.stats["acked"] += 1
+        elif result in self.stats:
+            self.stats[result] += 1
+        if p.on_result:
+            p.on_result(p.seq, result)
+
+    def _sample_rtt(self, rtt: float):
+        if self.srtt is None:
+            self.srtt, self.rttvar = rtt, rtt / 2
+        else:
+            self.rttvar = 0.75 * self.rttvar + 0.25 * abs(self.srtt - rtt)
+            self.srtt = 0.875 * self.srtt + 0.125 * rtt
+
+    def _rto(self) -> float:
+        if self.srtt is None:
+            return RTO_INITIAL_S
+        return min(max(self.srtt + 4 * self.rttvar, RTO_MIN_S), RTO_MAX_S)
+
+
+class PagerStandIn:
+    """ControlChannel::on_datagram() in Python: same nonce, window, stale and ack rules.
+
+    One instance is one boot. The hello rate limit is left out: there is no
+    clock here, every bad tag is answered.
+    """
+
+    def __init__(self, key: bytes, apply: Callable[[int, str, bytes], None], nonce: Optional[int] = None):
+        self.key = key
+        self.apply = apply
+        self.nonce = nonce if nonce is not None else random.getrandbits(32) or 1
+        self.session = self.top = self.window = self.state_top = 0
+        self.stats = {"received": 0, "applied": 0, "duplicates": 0, "stale": 0, "bad_tag": 0, "old_session": 0}
+
+    def hello(self) -> bytes:
+        body = ACK.pack(HELLO_MAGIC, self.session, self.nonce, 0)
+        return body + tag(self.key, self.nonce, body)
+
+    def on_datagram(self, data: bytes) -> Optional[bytes]:
+        """Returns the ack or hello to send, or None (not ours / old session)."""
+        if not data.startswith(MSG_MAGIC):
+            return None
+        self.stats["received"] += 1
+        if len(data) < HEADER.size + TAG_SIZE:
+            return None
+        _, session, seq, msg_type, _, length = HEADER.unpack_from(data)
+        if HEADER.size + length + TAG_SIZE != len(data):
+            return None
+        if not hmac.compare_digest(tag(self.key, self.nonce, data[:HEADER.size + length]), data[HEADER.size + length:]):
+            self.stats["bad_tag"] += 1
+            return self.hello()
+        if session < self.session:
+            self.stats["old_session"] += 1
+            return None
+        if session > self.session:
+            self.session, self.top, self.window, self.state_top = session, 0, 0, 0
+        payload = data[HEADER.size:HEADER.size + length]
+        status = self._accept(seq)
+        if status == APPLIED and is_state(msg_type, payload):
+            if seq < self.state_top:
+                status = STALE
+            else:
+                self.state_top = seq
+        if status == DUPLICATE:
+            self.stats["duplicates"] += 1
+        elif status == STALE:
+            self.stats["stale"] += 1
+        elif msg_type != PING:
+            self.stats["applied"] += 1
+            if msg_type == SET_DISPLAY:
+                mode, _, text = payload.partition(b"\0")
+                self.apply(msg_type, mode.decode(), text)
+            else:
+                self.apply(msg_type, "", payload)
+        body = ACK.pack(ACK_MAGIC, self.session, seq, status)
+        return body + tag(self.key, self.nonce, body)
+
+    def _accept(self, seq: int) -> int:
+        if seq > self.top:
+            shift = seq - self.top
+            self.window = 0 if shift >= WINDOW else (self.window << shift) & 0xFFFFFFFF
+            self.window |= 1
+            self.top = seq
+            return APPLIED
+        back = self.top - seq
+        if back >= WINDOW:
+            return STALE
+        if self.window & (1 << back):
+            return DUPLICATE
+        self.window |= 1 << back
+        return APPLIED
+
+
+# -- bench: simulated link --
+#
+# Both paths run over the same link model: one-way delay, independent
+# loss each way, and WiFi drops (nothing gets through for a few seconds,
+# then the pager reconnects). Both are read by the pager's main loop,
+# modelled as a 20 ms poll, and both end in the same message_queue push,
+# so "applied" differs from "pixel" by the same show_queued + redraw.
+#
+# UDP: the real ControlSender and PagerStandIn above, on a simulated clock.
+# API: one TCP connection carrying service calls in order. Loss is
+# repaired by retransmission timeout with the Linux rules (min 200 ms,
+# RTT-based, doubling per timeout, no cap that matters here); a message
+# behind a lost one waits for it. Short drops do not kill the connection
+# (keepalive is 20 s), so the API recovers on its backed-off retransmit
+# timer; a drop that also reset the connection would cost a reconnect
+# and handshake on top, which this leaves out in the API's favour.
+
+POLL_S = 0.020
+TCP_RTO_MIN_S = 0.2
+TCP_RTO_MAX_S = 120.0
+
+
+@dataclass
+class Link:
+    delay_s: Tuple[float, float] = (0.002, 0.008)
+    loss: float = 0.0
+    drops: List[Tuple[float, float]] = field(default_factory=list)   # (start, end) s
+
+    def up(self, t: float) -> bool:
+        return not any(a <= t < b for a, b in self.drops)
+
+    def arrival(self, rng: random.Random, t: float) -> Optional[float]:
+        if not self.up(t) or rng.random() < self.loss:
+            return None
+        return t + rng.uniform(*self.delay_s)
+
+    def reconnect_at(self, t: float) -> Optional[float]:
+        for a, b in self.drops:
+            if a <= t < b:
+                return b
+        return None
+
+
+def poll_tick(t: float, phase: float) -> float:
+    """Next pager loop pass at or after t."""
+    k = int((t - phase) / POLL_S)
+    tick = phase + k * POLL_S
+    return tick if tick >= t else tick + POLL_S
+
+
+def messages_for(calls: List[Dict]) -> List[Tuple[float, str, str]]:
+    return [(c["t"], c["mode"], c.get("text", "")) for c in calls]
+
+
+
+
+def simulate_udp(msgs, link: Link, seed: int) -> Dict:
+    """Real ControlSender and PagerStandIn on a simulated clock and link."""
+    rng = random.Random(seed)
+    phase = rng.uniform(0, POLL_S)
+    key = b"bench-key"
+    events: List[Tuple[float, int, str, object]] = []
+    order = 0
+    now = 0.0
+
+    def at(t, kind, data=None):
+        nonlocal order
+        order += 1
+        heapq.heappush(events, (t, order, kind, data))
+
+    def to_pager(packet: bytes):
+        t = link.arrival(rng, now)
+        if t is not None:
+            at(poll_tick(t, phase), "pager", packet)
+
+    applied_at: Dict[int, float] = {}
+    applying = [0]
+    results: Dict[str, int] = {}
+    sender = ControlSender(key, to_pager, clock=lambda: now, session=1)
+    pager = PagerStandIn(key, lambda msg_type, mode, text: applied_at.setdefault(applying[0], now))
+
+    def result(seq, r):
+        results[r] = results.get(r, 0) + 1
+
+    sender.handle_datagram(pager.hello())  # The pager booted before the trace
+
+    for t, mode, text in msgs:
+        at(t, "send", (mode, text))
+    rng_hello = random.Random(seed + 2)
+    for _, b in link.drops:
+        at(b + rng_hello.uniform(0.05, 0.3), "hello")  # WiFi on_connect after association
+    timer_at = None
+    while events:
+        now, _, kind, data = heapq.heappop(events)
+        if kind == "send":
+            sender.send_display(*data, on_result=result)
+        elif kind == "pager":
+            applying[0] = HEADER.unpack_from(data)[2]
+            ack = pager.on_datagram(data)
+            t = link.arrival(rng, now) if ack else None
+            if t is not None:
+                at(t, "bridge", ack)
+        elif kind == "bridge":
+            sender.handle_datagram(data)
+        elif kind == "hello":
+            t = link.arrival(rng, now)
+            if t is not None:
+                at(t, "bridge", pager.hello())
+        elif kind == "timer" and data == timer_at:
+            timer_at = None
+            sender.poll(now)
+        nxt = sender.next_timer()
+        if nxt is not None and (timer_at is None or nxt < timer_at):
+            timer_at = max(nxt, now)
+            at(timer_at, "timer", timer_at)
+    # seq i + 1 is msgs[i]; superseded/stale/expired ones were never applied
+    applied = [applied_at.get(i + 1) for i in range(len(msgs))]
+    return {"applied": applied, "results": results, "sent": sender.stats["sent"]}
+
+
+def simulate_api(msgs, link: Link, seed: int) -> Dict:
+    """One TCP stream: in-order delivery, Linux-style RTO retransmission."""
+    rng = random.Random(seed)
+    phase = rng.uniform(0, POLL_S)
+    srtt: Optional[float] = None
+    rttvar = 0.0
+    sent = 0
+    applied: List[Optional[float]] = []
+    in_order_until = 0.0       # Nothing is handed up before an earlier message
+    for t, mode, text in msgs:
+        rto = TCP_RTO_MIN_S if srtt is None else max(srtt + 4 * rttvar, TCP_RTO_MIN_S)
+        send = t
+        first = True
+        while True:
+            sent += 1
+            arrive = link.arrival(rng, send)
+            if arrive is not None:
+                ack = link.arrival(rng, arrive)
+                if ack is not None and first:
+                    rtt = ack - send
+                    if srtt is None:
+                        srtt, rttvar = rtt, rtt / 2
+                    else:
+                        rttvar = 0.75 * rttvar + 0.25 * abs(srtt - rtt)
+                        srtt = 0.875 * srtt + 0.125 * rtt
+                break
+            send += rto
+            rto = min(rto * 2, TCP_RTO_MAX_S)
+            first = False
+        in_order_until = max(arrive, in_order_until)
+        applied.append(poll_tick(in_order_until, phase))
+    return {"applied": applied, "results": {}, "sent": sent}
+
+
+def pct(values: List[float], q: float) -> float:
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(q * len(values)))]
+
+
+def summarize(msgs, link: Link, r: Dict) -> Dict:
+    lat, rec, late = [], [], 0
+    for (t, mode, _), done in zip(msgs, r["applied"]):
+        if done is None:
+            continue
+        lat.append(done - t)
+        if done - t > SEND_TTL_MS[classify(strip_silent(mode)[0])] / 1000:
+            late += 1  # TCP still delivers it, past the point udp gives up
+        up = link.reconnect_at(t)
+        if up is not None:
+            rec.append(done - up)
+    skipped = sum(1 for a in r["applied"] if a is None)
+    return {"lat": lat, "rec": rec, "late": late + r["results"].get("expired", 0), "skipped": skipped}
+
+
+def bench(seed: int, hours: float):
+    calls = synthetic_calls(seed, hours)
+    msgs = messages_for(calls)
+    end = msgs[-1][0] if msgs else 0
+    drng = random.Random(seed + 1)
+    drops = []
+    t = 60.0
+    while t < end:
+        length = drng.uniform(2.0, 8.0)
+        drops.append((t, t + length))
+        t += drng.uniform(90, 240)
+    scenarios = [
+        ("clean LAN", Link()),
+        ("3% loss", Link(loss=0.03)),
+        ("10% loss", Link(loss=0.10, delay_s=(0.003, 0.03))),
+        ("WiFi drops", Link(loss=0.01, drops=drops)),
+    ]
+    print(f"{len(msgs)} messages over {end / 60:.0f} min (message_queue synthetic trace); "
+          f"last scenario drops WiFi {len(drops)} times for 2-8 s")
+    print(f"  {'link':11} {'path':4} {'p50':>6} {'p99':>7} {'max':>7} {'late':>5} {'skipped':>8} "
+          f"{'packets':>8} {'link up -> applied p50':>23} {'max':>7}")
+    for name, link in scenarios:
+        for path, fn in (("api", simulate_api), ("udp", simulate_udp)):
+            r = fn(msgs, link, seed)
+            s = summarize(msgs, link, r)
+            line = (f"  {name:11} {path:4} {pct(s['lat'], 0.5) * 1000:>4.0f}ms {pct(s['lat'], 0.99) * 1000:>5.0f}ms "
+                    f"{max(s['lat'], default=0) * 1000:>5.0f}ms {s['late']:>5} {s['skipped']:>8} {r['sent']:>8}")
+            if link.drops:
+                line += f" {pct(s['rec'], 0.5) * 1000:>21.0f}ms {max(s['rec'], default=0) * 1000:>5.0f}ms"
+            print(line)
+    print("  skipped: superseded by a newer state before delivery (never shown, by design)")
+    print("  late: applied after its send TTL; udp expires these at the bridge -> API fallback")
+
+
+# -- bench: real localhost sockets --
+
+def live_bench(count: int, loss: float, seed: int):
+    """UDP sender -> PagerStandIn, and a TCP stand-in for the API, on 127.0.0.1.
+
+    The TCP stand-in frames each call the way the native API does (0x00,
+    varint length, varint type, body) and the pager side parses the frame
+    before "applying". The UDP stand-in drops a fraction of datagrams each
+    way; TCP on loopback cannot be made lossy from here, so its loss column
+    is always zero.
+    """
+    key = b"live-bench-key"
+    rng = random.Random(seed)
+    lock = threading.Lock()
+    applied: Dict[int, float] = {}
+    stop = threading.Event()
+
+    # UDP pager stand-in
+    pager_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    pager_sock.bind(("127.0.0.1", 0))
+    pager_sock.settimeout(0.05)
+    bridge_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    bridge_sock.bind(("127.0.0.1", 0))
+    bridge_sock.settimeout(0.002)
+    current = [0]
+
+    def on_apply(msg_type, mode, text):
+        with lock:
+            applied.setdefault(int(text.split(b" ")[0]), time.perf_counter())
+
+    pager = PagerStandIn(key, on_apply)
+
+    def pager_loop():
+        while not stop.is_set():
+            try:
+                data, addr = pager_sock.recvfrom(MAX_DATAGRAM)
+            except socket.timeout:
+                continue
+            if rng.random() < loss:
+                continue
+            ack = pager.on_datagram(data)
+            if ack and rng.random() >= loss:
+                pager_sock.sendto(ack, addr)
+
+    sender = ControlSender.over_socket(bridge_sock, key, pager_sock.getsockname(), clock=time.perf_counter)
+    sender.handle_datagram(pager.hello())
+    threading.Thread(target=pager_loop, daemon=True).start()
+    sent_at: Dict[int, float] = {}
+    for i in range(count):
+        t0 = time.perf_counter()
+        sent_at[i] = t0
+        current[0] = i
+        sender.send_display("ALERT" if i % 2 else "PERMISSION", f"{i} message")  # Events: none superseded
+        deadline = t0 + 0.005
+        while time.perf_counter() < deadline or sender.pending:
+            try:
+                data, addr = bridge_sock.recvfrom(MAX_DATAGRAM)
+                sender.handle_datagram(data, addr)
+            except socket.timeout:
+                pass
+            sender.poll()
+            if time.perf_counter() - t0 > 5:
+                break
+    udp = sorted(applied[i] - sent_at[i] for i in applied)
+    udp_stats = dict(sender.stats)
+    stop.set()
+
+    # TCP API stand-in
+    applied_tcp: Dict[int, float] = {}
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.bind(("127.0.0.1", 0))
+    server.listen(1)
+
+    def read_varint(conn_file) -> int:
+        shift = value = 0
+        while True:
+            b = conn_file.read(1)
+            if not b:
+                raise EOFError
+            value |= (b[0] & 0x7F) << shift
+            if b[0] < 0x80:
+                return value
+            shift += 7
+
+    def api_loop():
+        conn, _ = server.accept()
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        f = conn.makefile("rb")
+        try:
+            while True:
+                if f.read(1) != b"\0":
+                    break
+                length = read_varint(f)
+                read_varint(f)  # Message type
+                body = f.read(length)
+                text = body.split(b"\0", 1)[1]
+                applied_tcp.setdefault(int(text.split(b" ")[0]), time.perf_counter())
+        except EOFError:
+            pass
+
+    def varint(v: int) -> bytes:
+        out = bytearray()
+        while v >= 0x80:
+            out.append((v & 0x7F) | 0x80)
+            v >>= 7
+        out.append(v)
+        return bytes(out)
+
+    threading.Thread(target=api_loop, daemon=True).start()
+    client = socket.create_connection(server.getsockname())
+    client.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    sent_tcp: Dict[int, float] = {}
+    for i in range(count):
+        body = b"PERMISSION\0" + f"{i} message".encode()
+        sent_tcp[i] = time.perf_counter()
+        client.sendall(b"\0" + varint(len(body)) + varint(42) + body)  # 42: ExecuteServiceRequest
+        time.sleep(0.005)
+    time.sleep(0.1)
+    client.close()
+    tcp = sorted(applied_tcp[i] - sent_tcp[i] for i in applied_tcp)
+
+    print(f"{count} messages each way over 127.0.0.1, udp loss {loss:.0%} each way")
+    print(f"  {'path':4} {'delivered':>10} {'p50':>8} {'p99':>8} {'max':>8}")
+    for name, lat in (("api", tcp), ("udp", udp)):
+        print(f"  {name:4} {len(lat):>10} {pct(lat, 0.5) * 1e6:>6.0f}us {pct(lat, 0.99) * 1e6:>6.0f}us "
+              f"{max(lat, default=0) * 1e6:>6.0f}us")
+    print(f"  udp: sent {udp_stats['sent']}, retransmits {udp_stats['retransmits']}, "
+          f"duplicates seen by pager {pager.stats['duplicates']}, srtt {(sender.srtt or 0) * 1e6:.0f}us")
+
+
+# -- check: the pager's own code --
+
+def check(binary: str, boots: int) -> bool:
+    """Run control_channel_bench.cpp and verify its datagram with tag() above.
+
+    Then the same reboot replay against PagerStandIn, so the stand-in the
+    benches use keeps the pager's rules.
+    """
+    out = subprocess.run([binary, "-n", str(boots)], capture_output=True, text=True)
+    rows = [dict(kv.split("=", 1) for kv in line.split()[1:]) for line in out.stdout.splitlines() if line]
+    kinds = [line.split()[0] for line in out.stdout.splitlines() if line]
+    total = next((r for k, r in zip(kinds, rows) if k == "total"), None)
+    if total is None:
+        print(out.stdout + out.stderr)
+        return False
+    for k, r in zip(kinds, rows):
+        if k == "check":
+            print(f"  {r['name']:<12} {'ok' if r['ok'] == '1' else 'FAIL'}")
+        elif k == "boot":
+            print(f"  boot {r['n']}: replayed {r['replayed']} from earlier boots, applied {r['applied']}, "
+                  f"answered {r['answered']}")
+    vectors = [r for k, r in zip(kinds, rows) if k == "vector"]
+    same_tag = len(vectors) == 2
+    for vector in vectors:
+        ok = tag(vector["key"].encode(), int(vector["nonce"]), bytes.fromhex(vector["data"])).hex() == vector["tag"]
+        print(f"  {'bridge tag':<12} {'ok' if ok else 'FAIL'}  ({len(vector['key'])}-byte key)")
+        same_tag = same_tag and ok
+
+    key, shown, captured = b"check-key", [], []
+    pager = PagerStandIn(key, lambda msg_type, mode, text: shown.append(text))
+    sender = ControlSender(key, captured.append, session=1)
+    sender.handle_datagram(pager.hello())
+    for i in range(5):
+        sender.send_alert(f"alert {i}")
+    for packet in captured:
+        pager.on_datagram(packet)
+    rebooted = PagerStandIn(key, lambda msg_type, mode, text: shown.append(text))
+    replies = [rebooted.on_datagram(packet) for packet in captured]
+    stand_in = (len(shown) == 5 and rebooted.stats["applied"] == 0 and
+                all(r is not None and r.startswith(HELLO_MAGIC) for r in replies))
+    print(f"  {'stand-in':<12} {'ok' if stand_in else 'FAIL'}")
+
+    ok = out.returncode == 0 and total.get("failures") == "0" and same_tag and stand_in
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: send control messages to the pager, or bench UDP against the API."""
+    parser = argparse.ArgumentParser(description='Pager control channel (bridge side)')
+    parser.add_argument('--port', type=int, default=12345, help='Bridge audio port to listen on')
+    parser.add_argument('--send', nargs=2, metavar=('MODE', 'TEXT'), help='Send one set_display')
+    parser.add_argument('--bench', action='store_true', help='Compare UDP and API delivery')
+    parser.add_argument('--live', action='store_true', help='Bench over real localhost sockets')
+    parser.add_argument('--check', action='store_true', help='Run the host build of control_channel.h')
+    parser.add_argument('--bin', default='/tmp/control-channel-bench', help='Built control_channel_bench.cpp')
+    parser.add_argument('--boots', type=int, default=3, help='Reboots to replay across for --check')
+    parser.add_argument('--count', type=int, default=500, help='Messages for --live')
+    parser.add_argument('--loss', type=float, default=0.05, help='UDP loss each way for --live')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--hours', type=float, default=2.0, help='Length of the synthetic trace')
+    args = parser.parse_args()
+
+    if args.check:
+        raise SystemExit(0 if check(args.bin, args.boots) else 1)
+    if args.bench:
+        if args.live:
+            live_bench(args.count, args.loss, args.seed)
+        else:
+            bench(args.seed, args.hours)
+        return
+    if not args.send:
+        parser.print_help()
+        return
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("0.0.0.0", args.port))
+    sock.settimeout(0.01)
+    sender = ControlSender.over_socket(sock, load_key())
+    done = threading.Event()
+
+    def report(seq, result):
+        print(f"seq {seq}: {result}")
+        done.set()
+
+    print(f"Waiting for the pager's hello on :{args.port} (reboot it or toggle WiFi)...")
+    while sender.peer is None:
+        try:
+            data, addr = sock.recvfrom(2048)
+            sender.handle_datagram(data, addr)
+        except socket.timeout:
+            pass
+    if sender.send_display(args.send[0], args.send[1], on_result=report) is None:
+        print("Too long for one datagram: use the API service")
+        return
+    while not done.is_set():
+        try:
+            data, addr = sock.recvfrom(2048)
+            sender.handle_datagram(data, addr)
+        except socket.timeout:
+            pass
+        sender.poll()
+    print(f"sent {sender.stats['sent']} datagram(s), srtt {(sender.srtt or 0) * 1000:.1f} ms")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,279 @@
+// Control Channel Bench - host build of control_channel.h
+//
+// Drives ControlChannel::on_datagram() with datagrams signed the way the
+// bridge signs them (devtools/control_channel.py) and reads the pager's
+// acks and hellos back from the host socket stand-in. Checks:
+//   hmac        HMAC-SHA256 against RFC 4231 test case 2
+//   hello       boot hello carries the boot nonce, tag verifies with it
+//   applied     a fresh message is applied once and acked APPLIED
+//   duplicate   the same datagram again is acked DUPLICATE, not applied
+//   stale       an older display update after a newer one: STALE, not shown;
+//               an older alert is still applied (events are never stale)
+//   too_old     more than WINDOW behind the newest: STALE, never applied
+//   bad_tag     one flipped bit: no ack, nothing applied
+//   old_session an earlier bridge session: no answer at all
+//   reboot      every datagram captured in the boot before (in order, then
+//               reversed) is rejected after a reboot: nothing applied, no ack
+//   rehello     a bad tag is answered with a hello, at most once per
+//               HELLO_MIN_MS (waits that long once)
+//   resync      a bridge that learns the nonce from that hello gets through
+//   old_ack     an ack from the boot before does not verify for the bridge
+//   long_key    with a 100-byte key: a message signed with all of it is
+//               applied, one signed with a key that differs only past byte
+//               64 is not (keys are hashed, never cut)
+// -n repeats the reboot check over that many boots. The vector lines are
+// signed datagrams (short and long key) for devtools/control_channel.py to
+// verify with the bridge's own tag().
+//
+// Build:
+//   g++ -O2 -I. -Idevtools/host -o /tmp/control-channel-bench devtools/control_channel_bench.cpp
+//
+// Usage:
+//   control-channel-bench [-n boots]
+//   -> check name=<check> ok=<0|1>
+//      boot n=<k> nonce=<hex> replayed=<n> applied=<n> answered=<n> bad_tag=<n> ok=<0|1>
+//      vector key=<text> nonce=<n> data=<hex> tag=<hex>
+//      total failures=<n>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esphome.h"
+#include "control_channel.h"
+
+static const char* KEY = "bench-control-key";
+static const std::string LONG_KEY = "bench-control-key/" + std::string(82, 'k');
+static std::string g_key = KEY;  // Key the bridge and the next Pager use
+static const uint16_t BRIDGE_PORT = 12345;
+
+typedef std::vector<uint8_t> Bytes;
+
+static void put_le(uint8_t* p, uint32_t v, int n) {
+    for (int i = 0; i < n; i++) p[i] = (uint8_t) (v >> (8 * i));
+}
+
+static uint32_t get_le(const uint8_t* p) {
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static void sign(uint32_t nonce, const uint8_t* data, size_t len, uint8_t out[Sha256::DIGEST]) {
+    uint8_t n[4];
+    put_le(n, nonce, 4);
+    Sha256::hmac((const uint8_t*) g_key.data(), g_key.size(), n, 4, data, len, out);
+}
+
+// Bridge side: ControlSender's framing, nonce learned from the pager's hello
+struct Bridge {
+    uint32_t session = 1700000000;
+    uint32_t seq = 0;
+    uint32_t nonce = 0;
+
+    Bytes message(uint8_t type, const std::string& payload, uint32_t at_seq = 0) {
+        Bytes d(ControlChannel::HEADER_SIZE + payload.size() + ControlChannel::TAG_SIZE, 0);
+        d[0] = 0xFF;
+        d[1] = 0xFF;
+        d[2] = 'C';
+        d[3] = 'M';
+        put_le(&d[4], session, 4);
+        put_le(&d[8], at_seq ? at_seq : ++seq, 4);
+        d[12] = type;
+        put_le(&d[14], (uint32_t) payload.size(), 2);
+        memcpy(&d[ControlChannel::HEADER_SIZE], payload.data(), payload.size());
+        uint8_t tag[Sha256::DIGEST];
+        sign(nonce, d.data(), ControlChannel::HEADER_SIZE + payload.size(), tag);
+        memcpy(&d[ControlChannel::HEADER_SIZE + payload.size()], tag, ControlChannel::TAG_SIZE);
+        return d;
+    }
+
+    Bytes display(const std::string& mode, const std::string& text, uint32_t at_seq = 0) {
+        return message(CTRL_SET_DISPLAY, mode + std::string(1, '\0') + text, at_seq);
+    }
+
+    // Ack or hello tag check, with the nonce the bridge would use
+    bool verifies(const Bytes& reply) const {
+        if (reply.size() != ControlChannel::HEADER_SIZE + ControlChannel::TAG_SIZE) return false;
+        bool hello = reply[3] == 'H';
+        uint8_t tag[Sha256::DIGEST];
+        sign(hello ? get_le(&reply[8]) : nonce, reply.data(), ControlChannel::HEADER_SIZE, tag);
+        return memcmp(tag, &reply[ControlChannel::HEADER_SIZE], ControlChannel::TAG_SIZE) == 0;
+    }
+};
+
+// One boot of the pager
+struct Pager {
+    ControlChannel channel;
+    std::vector<std::string> shown;
+
+    Pager() {
+        channel.begin(g_key.c_str(), [this](uint8_t type, const char* mode, const char* text, size_t len) {
+            shown.push_back(std::string(mode) + ":" + std::string(text, len));
+        });
+    }
+
+    // Replies sent while handling one datagram
+    std::vector<Bytes> feed(const Bytes& d) {
+        host_udp_sent().clear();
+        channel.on_datagram(d.data(), d.size());
+        std::vector<Bytes> replies;
+        for (const HostDatagram& h : host_udp_sent()) replies.push_back(h.data);
+        return replies;
+    }
+};
+
+static int failures = 0;
+
+static void check(const char* name, bool ok) {
+    if (!ok) failures++;
+    printf("check name=%s ok=%d\n", name, ok ? 1 : 0);
+}
+
+static bool is_ack(const std::vector<Bytes>& r, uint8_t status) {
+    return r.size() == 1 && r[0][3] == 'A' && r[0][12] == status;
+}
+
+static std::string hex(const uint8_t* p, size_t n) {
+    std::string s;
+    char b[3];
+    for (size_t i = 0; i < n; i++) {
+        snprintf(b, sizeof(b), "%02x", p[i]);
+        s += b;
+    }
+    return s;
+}
+
+static void print_vector(const Bridge& bridge, const Bytes& d) {
+    printf("vector key=%s nonce=%u data=%s tag=%s\n", g_key.c_str(), (unsigned) bridge.nonce,
+           hex(d.data(), d.size() - ControlChannel::TAG_SIZE).c_str(),
+           hex(d.data() + d.size() - ControlChannel::TAG_SIZE, ControlChannel::TAG_SIZE).c_str());
+}
+
+int main(int argc, char** argv) {
+    int boots = 3;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) boots = atoi(argv[++i]);
+    }
+    audio_streamer().begin("127.0.0.1", BRIDGE_PORT);
+
+    // RFC 4231, test case 2
+    uint8_t mac[Sha256::DIGEST];
+    const char* data = "what do ya want for nothing?";
+    Sha256::hmac((const uint8_t*) "Jefe", 4, (const uint8_t*) data, strlen(data), mac);
+    check("hmac", hex(mac, sizeof(mac)) == "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+    Bridge bridge;
+    host_udp_sent().clear();
+    Pager* pager = new Pager();
+    bool hello_ok = host_udp_sent().size() == 1 && host_udp_sent()[0].data[3] == 'H' &&
+                    get_le(&host_udp_sent()[0].data[8]) == pager->channel.nonce() &&
+                    bridge.verifies(host_udp_sent()[0].data);
+    check("hello", hello_ok && pager->channel.nonce() != 0);
+    bridge.nonce = pager->channel.nonce();
+
+    std::vector<Bytes> captured;
+    Bytes first = bridge.display("AGENT_READ", "main.cpp");
+    captured.push_back(first);
+    std::vector<Bytes> r = pager->feed(first);
+    check("applied", is_ack(r, CTRL_APPLIED) && bridge.verifies(r[0]) && pager->shown.size() == 1 &&
+                         pager->shown[0] == "AGENT_READ:main.cpp");
+    Bytes first_ack = r.empty() ? Bytes() : r[0];
+
+    r = pager->feed(first);
+    check("duplicate", is_ack(r, CTRL_DUPLICATE) && pager->shown.size() == 1 &&
+                           pager->channel.stats().duplicates == 1);
+
+    Bytes older_state = bridge.display("AGENT_BASH", "npm test");  // seq 2, delayed
+    Bytes older_alert = bridge.message(CTRL_ALERT, "build failed");  // seq 3, delayed
+    Bytes newer_state = bridge.display("AGENT_EDIT", "app.ts");  // seq 4
+    captured.push_back(newer_state);
+    captured.push_back(older_state);
+    captured.push_back(older_alert);
+    pager->feed(newer_state);
+    r = pager->feed(older_state);
+    std::vector<Bytes> ra = pager->feed(older_alert);
+    check("stale", is_ack(r, CTRL_STALE) && is_ack(ra, CTRL_APPLIED) && pager->shown.size() == 3 &&
+                       pager->shown[1] == "AGENT_EDIT:app.ts" && pager->shown[2] == ":build failed");
+
+    bridge.seq += ControlChannel::WINDOW;
+    captured.push_back(bridge.message(CTRL_ALERT, "far ahead"));
+    pager->feed(captured.back());
+    r = pager->feed(bridge.message(CTRL_ALERT, "too old", 5));
+    check("too_old", is_ack(r, CTRL_STALE) && pager->shown.back() == ":far ahead");
+
+    Bytes forged = bridge.message(CTRL_ALERT, "forged");
+    forged[ControlChannel::HEADER_SIZE] ^= 0x01;
+    uint32_t bad_before = pager->channel.stats().bad_tag;
+    r = pager->feed(forged);
+    check("bad_tag", r.empty() && pager->channel.stats().bad_tag == bad_before + 1 && pager->shown.back() == ":far ahead");
+
+    bridge.session--;
+    r = pager->feed(bridge.message(CTRL_ALERT, "old session"));
+    bridge.session++;
+    check("old_session", r.empty() && pager->channel.stats().old_session == 1 && pager->shown.back() == ":far ahead");
+
+    // Reboots: nothing signed for an earlier boot gets in, in any order
+    bool reboot_ok = true;
+    for (int k = 1; k <= boots; k++) {
+        delete pager;
+        pager = new Pager();
+        std::vector<Bytes> replay = captured;
+        replay.insert(replay.end(), captured.rbegin(), captured.rend());
+        int answered = 0;
+        for (const Bytes& d : replay) answered += (int) pager->feed(d).size();
+        const ControlChannel::Stats& s = pager->channel.stats();
+        bool ok = pager->shown.empty() && answered == 0 && s.applied == 0 && s.bad_tag == replay.size() &&
+                  pager->channel.session() == 0;
+        reboot_ok &= ok;
+        printf("boot n=%d nonce=%08x replayed=%zu applied=%u answered=%d bad_tag=%u ok=%d\n", k,
+               (unsigned) pager->channel.nonce(), replay.size(), (unsigned) s.applied, answered, (unsigned) s.bad_tag,
+               ok ? 1 : 0);
+
+        // Next boot replays this one's traffic too
+        bridge.nonce = pager->channel.nonce();
+        captured.push_back(bridge.display("AGENT_WRITE", "boot " + std::to_string(k)));
+        pager->feed(captured.back());
+    }
+    check("reboot", reboot_ok);
+
+    // The bridge still signs for the boot before: its first datagram is
+    // answered with a hello once HELLO_MIN_MS has passed since the last one
+    delete pager;
+    pager = new Pager();
+    std::this_thread::sleep_for(std::chrono::milliseconds(ControlChannel::HELLO_MIN_MS + 50));
+    Bytes unknown = bridge.display("AGENT_GREP", "TODO");
+    r = pager->feed(unknown);
+    std::vector<Bytes> r2 = pager->feed(unknown);
+    bool rehello = r.size() == 1 && r[0][3] == 'H' && bridge.verifies(r[0]) && r2.empty() && pager->shown.empty();
+    check("rehello", rehello);
+
+    if (rehello) bridge.nonce = get_le(&r[0][8]);
+    Bytes resent = bridge.display("AGENT_GREP", "TODO", get_le(&unknown[8]));
+    r = pager->feed(resent);
+    check("resync", is_ack(r, CTRL_APPLIED) && bridge.verifies(r[0]) && pager->shown.size() == 1 &&
+                        pager->shown[0] == "AGENT_GREP:TODO");
+
+    check("old_ack", !first_ack.empty() && !bridge.verifies(first_ack));
+
+    print_vector(bridge, resent);
+    delete pager;
+
+    g_key = LONG_KEY;
+    pager = new Pager();
+    bridge.nonce = pager->channel.nonce();
+    Bytes long_signed = bridge.display("AGENT_READ", "long key");
+    r = pager->feed(long_signed);
+    bool long_ok = is_ack(r, CTRL_APPLIED) && bridge.verifies(r[0]);
+    g_key[ControlChannel::MAX_KEY + 10] ^= 0x01;
+    r = pager->feed(bridge.display("AGENT_READ", "tail differs"));
+    g_key = LONG_KEY;
+    check("long_key", long_ok && r.empty() && pager->shown.size() == 1 && pager->shown[0] == "AGENT_READ:long key");
+    print_vector(bridge, long_signed);
+    delete pager;
+
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
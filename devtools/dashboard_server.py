@@ -14,6 +14,9 @@ Usage:
     # Or with custom port
     python -m devtools.dashboard_server --port 8080
 
+    # Also drive the pager's multi-session board from logged agent events
+    python -m devtools.dashboard_server --pager 192.168.50.85 --pager-key <api key>
+
 The dashboard will be available at http://localhost:8080
 """
 
@@ -24,7 +27,7 @@ import logging
 import os
 from datetime import datetime
 from pathlib import Path
-from typing import Optional, Set, Dict, Any, List
+from typing import Optional, Dict, Any, List
 from dataclasses import dataclass, asdict
 
 try:
@@ -41,6 +44,7 @@ except ImportError:
     HAS_ANTHROPIC = False
     print("anthropic not installed. Run: pip install anthropic")
 
+from .broadcast_hub import BroadcastHub
 from .event_logger import EventLogger, EventSource, PagerEvent, get_logger
 from .session_manager import SessionManager, get_session_manager
 
@@ -98,7 +102,7 @@ class DashboardServer:
         self.host = host
         self.port = port
 
-        self.websockets: Set[web.WebSocketResponse] = set()
+        self.hub = BroadcastHub()
         self.device_state = DeviceState()
         self.app: Optional[web.Application] = None
         self._running = False
@@ -254,7 +258,8 @@ class DashboardServer:
         """Get monthly token usage statistics from real OpenClaw session data."""
         try:
             from .openclaw_usage import get_monthly_usage
-            usage_data = get_monthly_usage()
+            # Off the event loop: a cold scan (first run, no checkpoint) can take seconds
+            usage_data = await asyncio.get_running_loop().run_in_executor(None, get_monthly_usage)
             return web.json_response(usage_data)
         except Exception as e:
             logger.error(f"Failed to get OpenClaw usage data: {e}")
@@ -410,6 +415,11 @@ class DashboardServer:
                 # Claude Code finished and waiting for user
                 logger.info("Agent: waiting for user input")
 
+            # Agent events with a session_id move that session's board row
+            delta = self.session_manager.track_agent_event(event_type, event_data)
+            if delta:
+                logger.info(f"Board: {delta!r}")
+
             # Broadcast to connected dashboards
             await self.broadcast_event(event)
             
@@ -714,11 +724,12 @@ Respond with ONLY the summary sentence, nothing else."""
         ws = web.WebSocketResponse()
         await ws.prepare(request)
 
-        self.websockets.add(ws)
-        logger.info(f"Dashboard client connected ({len(self.websockets)} total)")
+        # All writes go through the client's queue so ordering is kept
+        channel = self.hub.add(ws)
+        logger.info(f"Dashboard client connected ({len(self.hub)} total)")
 
         # Send current state on connect
-        await ws.send_json({
+        channel.put({
             "type": "state",
             "data": self.device_state.to_dict()
         })
@@ -726,7 +737,7 @@ Respond with ONLY the summary sentence, nothing else."""
         # Send recent events
         recent = self.event_logger.get_recent_events(20)
         for event in reversed(recent):
-            await ws.send_json({
+            channel.put({
                 "type": "event",
                 "data": event.to_dict()
             })
@@ -742,8 +753,8 @@ Respond with ONLY the summary sentence, nothing else."""
                 elif msg.type == web.WSMsgType.ERROR:
                     logger.error(f"WebSocket error: {ws.exception()}")
         finally:
-            self.websockets.discard(ws)
-            logger.info(f"Dashboard client disconnected ({len(self.websockets)} total)")
+            await self.hub.remove(ws)
+            logger.info(f"Dashboard client disconnected ({len(self.hub)} total)")
 
         return ws
 
@@ -752,7 +763,9 @@ Respond with ONLY the summary sentence, nothing else."""
         msg_type = data.get('type')
 
         if msg_type == 'ping':
-            await ws.send_json({"type": "pong"})
+            channel = self.hub.channels.get(ws)
+            if channel:
+                channel.put({"type": "pong"})
 
         elif msg_type == 'start_session':
             notes = data.get('notes', '')
@@ -774,21 +787,11 @@ Respond with ONLY the summary sentence, nothing else."""
             self.session_manager.add_note(note)
 
     async def broadcast(self, message: dict):
-        """Broadcast a message to all connected WebSocket clients."""
-        if not self.websockets:
-            return
-
-        msg_str = json.dumps(message)
-        dead_sockets = set()
+        """Broadcast a message to all connected WebSocket clients.
 
-        for ws in self.websockets:
-            try:
-                await ws.send_str(msg_str)
-            except Exception:
-                dead_sockets.add(ws)
-
-        # Clean up disconnected sockets
-        self.websockets -= dead_sockets
+        Serializes once and queues per client; never waits on a slow client.
+        """
+        self.hub.publish(message)
 
     async def broadcast_event(self, event: PagerEvent):
         """Broadcast an event to all dashboards."""
@@ -811,7 +814,31 @@ Respond with ONLY the summary sentence, nothing else."""
             "data": self.device_state.to_dict()
         }))
 
-    async def run(self):
+    async def connect_pager(self, host: str, key: Optional[str] = None, port: int = 6053):
+        """Connect to the pager's API and send board deltas to board_update."""
+        try:
+            from aioesphomeapi import APIClient
+        except ImportError:
+            logger.warning("aioesphomeapi not installed - session board disabled")
+            return
+        client = APIClient(host, port, "", noise_psk=key)
+        await client.connect(login=True)
+        _, services = await client.list_entities_services()
+        board = next((s for s in services if s.name == "board_update"), None)
+        if board is None:
+            logger.warning(f"Pager at {host} has no board_update service")
+            return
+
+        def send(delta: str):
+            # execute_service is sync in some aioesphomeapi versions
+            result = client.execute_service(board, {"delta": delta})
+            if asyncio.iscoroutine(result):
+                asyncio.ensure_future(result)
+
+        self.session_manager.board_sink = send
+        logger.info(f"Session board: sending to {host}")
+
+    async def run(self, pager: Optional[str] = None, pager_key: Optional[str] = None):
         """Start the dashboard server."""
         self.setup_routes()
         self._running = True
@@ -824,6 +851,8 @@ Respond with ONLY the summary sentence, nothing else."""
 
         logger.info(f"Dashboard server running at http://{self.host}:{self.port}")
         logger.info(f"WebSocket endpoint: ws://{self.host}:{self.port}/ws")
+        if pager:
+            await self.connect_pager(pager, pager_key)
 
         try:
             while self._running:
@@ -853,6 +882,8 @@ def main():
     parser = argparse.ArgumentParser(description='Clawd Pager Development Dashboard')
     parser.add_argument('--host', default='0.0.0.0', help='Host to bind to')
     parser.add_argument('--port', type=int, default=8080, help='Port to listen on')
+    parser.add_argument('--pager', help='Pager host: send agent sessions to its board')
+    parser.add_argument('--pager-key', help='Pager API encryption key')
     args = parser.parse_args()
 
     if not HAS_AIOHTTP:
@@ -862,7 +893,7 @@ def main():
     server = DashboardServer(host=args.host, port=args.port)
 
     try:
-        asyncio.run(server.run())
+        asyncio.run(server.run(args.pager, args.pager_key))
     except KeyboardInterrupt:
         logger.info("Dashboard server stopped")
 
@@ -0,0 +1,312 @@
+#!/usr/bin/env python3
+"""
+ePaper Pipeline - Timing simulation of the ePaper refresh paths.
+
+On the ePaper pager, waveshare_epaper's update() composes the frame, sends
+all of it and then waits on BUSY, so the ESPHome loop stops for the whole
+refresh (~2 s full, ~0.4 s partial). API calls and buttons queue up behind
+it, and each queued show_message runs another blocking refresh.
+epaper_pipeline.h instead composes and diffs the next frame while the
+panel is busy, sends only the changed rows once BUSY falls (interrupt),
+coalesces requests and drops frames that match the panel.
+
+This simulates both paths over the same workload (display requests from
+show_message calls and the 60 s tick, plus API/button events to service)
+and reports:
+- loop latency (event arrival -> serviced by a loop pass), overall and for
+  events that arrive while the panel refreshes
+- the longest loop stall
+- request -> glass latency (the refresh showing it has finished)
+- refresh, coalesced and unchanged counts
+
+PipelineModel follows epaper_pipeline.h state for state (INIT is left out).
+
+Usage:
+    python -m devtools.epaper_pipeline --bench
+    python -m devtools.epaper_pipeline --bench --minutes 60 --compose-ms 12 --spi-mhz 4
+"""
+
+import argparse
+import random
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Tuple
+
+ROWS = 200
+ROW_BYTES = 25
+CHUNK_ROWS = 100           # epaper_pipeline.h
+FULL_EVERY = 30
+LOOP_MS = 16.0            # ESPHome loop interval when nothing else is due
+PASS_MS = 0.6             # Everything else a loop pass does (API, sensors, WiFi)
+REGIONS = {               # EPAPER_DESIGN.md dashboard: rows per section
+    "header": (0, 31),
+    "body": (31, 160),
+    "footer": (160, 200),
+}
+
+
+@dataclass
+class Panel:
+    full_ms: float = 2000.0
+    partial_ms: float = 400.0
+    spi_mhz: float = 2.0   # waveshare_epaper default data rate
+    compose_ms: float = 6.0
+
+    def spi_ms(self, rows: int) -> float:
+        return rows * ROW_BYTES * 8 / (self.spi_mhz * 1000)
+
+
+@dataclass
+class Request:
+    t: float                         # ms
+    regions: Tuple[str, ...]         # Changed sections (empty: same content)
+    glass: Optional[float] = None    # Refresh finished showing it
+    unchanged: bool = False
+
+
+@dataclass
+class Result:
+    event_lat: List[float] = field(default_factory=list)
+    busy_lat: List[float] = field(default_factory=list)    # Arrived mid-refresh
+    max_stall: float = 0.0
+    full: int = 0
+    partial: int = 0
+    coalesced: int = 0
+    unchanged: int = 0
+    rows_sent: int = 0
+
+
+def workload(kind: str, minutes: float, seed: int) -> Tuple[List[Request], List[float]]:
+    """Display requests and API/button event times (ms) for a scenario."""
+    rng = random.Random(seed)
+    end = minutes * 60000
+    reqs = [Request(t, ("header",)) for t in range(60000, int(end), 60000)]   # Clock tick
+    t = 0.0
+    if kind == "chatty":      # Agent status every few seconds
+        while True:
+            t += rng.expovariate(1 / 3000)
+            if t >= end:
+                break
+            same = rng.random() < 0.15
+            reqs.append(Request(t, () if same else (("body", "footer") if rng.random() < 0.3 else ("body",))))
+    elif kind == "bursts":    # Tool runs: a handful of updates within a second or two
+        while True:
+            t += rng.uniform(20000, 40000)
+            if t >= end:
+                break
+            for i in range(rng.randint(3, 8)):
+                reqs.append(Request(t + i * rng.uniform(100, 400), ("body",)))
+    reqs.sort(key=lambda r: r.t)
+    events, t = [], 0.0
+    while True:
+        t += rng.expovariate(4 / 1000)   # API calls, button presses, sensor pushes
+        if t >= end:
+            break
+        events.append(t)
+    return reqs, events
+
+
+def changed_rows(regions) -> Tuple[int, int]:
+    first = min(REGIONS[r][0] for r in regions)
+    last = max(REGIONS[r][1] for r in regions)
+    return first, last
+
+
+class LoopClock:
+    """Loop passes: events are serviced at the start of each pass."""
+
+    def __init__(self, events: List[float], result: Result):
+        self.events = events
+        self.i = 0
+        self.r = result
+        self.last_start = 0.0
+
+    def service(self, t: float, refreshing: List[Tuple[float, float]]):
+        self.r.max_stall = max(self.r.max_stall, t - self.last_start)
+        self.last_start = t
+        while self.i < len(self.events) and self.events[self.i] <= t:
+            e = self.events[self.i]
+            self.r.event_lat.append(t - e)
+            if any(a <= e < b for a, b in refreshing[-3:]):
+                self.r.busy_lat.append(t - e)
+            self.i += 1
+
+
+def simulate_blocking(reqs: List[Request], events: List[float], panel: Panel, end: float) -> Result:
+    """waveshare_epaper update(): compose, send the frame, wait on BUSY, in the loop."""
+    r = Result()
+    clock = LoopClock(events, r)
+    refreshing: List[Tuple[float, float]] = []
+    t, qi, count = 0.0, 0, 0
+    while t < end:
+        clock.service(t, refreshing)
+        t += PASS_MS
+        if qi < len(reqs) and reqs[qi].t <= t:
+            # One component.update per service call / tick, in arrival order
+            req = reqs[qi]
+            qi += 1
+            full = count % FULL_EVERY == 0
+            count += 1
+            t += panel.compose_ms + panel.spi_ms(ROWS)
+            start = t
+            t += panel.full_ms if full else panel.partial_ms
+            refreshing.append((start, t))
+            r.rows_sent += ROWS
+            r.full += full
+            r.partial += not full
+            req.glass = t
+            continue   # Next pass right away: the loop is late already
+        t = (t // LOOP_MS + 1) * LOOP_MS
+    return r
+
+
+class PipelineModel:
+    """epaper_pipeline.h: loop() once per pass, BUSY via interrupt."""
+
+    def __init__(self, panel: Panel, r: Result):
+        self.panel = panel
+        self.r = r
+        self.state = "IDLE"
+        self.busy_until = 0.0
+        self.wanted: List[Request] = []       # Requests since the last compose
+        self.force_full = True
+        self.panel_valid = False
+        self.partials = 0
+        self.content: Dict[str, int] = {k: 0 for k in REGIONS}    # Section versions in RAM
+        self.shown: Dict[str, int] = dict(self.content)           # ... on the panel
+        self.staged: Optional[Tuple[Tuple[int, int], bool, List[Request]]] = None
+        self.inflight: List[Request] = []
+        self.transfer_rows = 0
+        self.prev_band = (0, ROWS)
+        self.refreshing: List[Tuple[float, float]] = []
+
+    def request(self, req: Request):
+        for region in req.regions:
+            self.content[region] += 1
+        self.wanted.append(req)
+
+    def loop(self, t: float) -> float:
+        """One pass at t; returns the time it took."""
+        cost = 0.0
+        if self.state == "BUSY" and t >= self.busy_until:
+            for req in self.inflight:
+                req.glass = self.busy_until
+            self.inflight = []
+            self.state = "IDLE"
+        if self.wanted and self.state != "TRANSFER":
+            cost += self.panel.compose_ms
+            cost += self.stage()
+        if self.state == "IDLE" and self.staged:
+            self.start_transfer()
+        if self.state == "TRANSFER":
+            rows = min(CHUNK_ROWS, self.transfer_rows)
+            cost += self.panel.spi_ms(rows)
+            self.transfer_rows -= rows
+            self.r.rows_sent += rows
+            if self.transfer_rows == 0:
+                self.refresh(t + cost)
+        return cost
+
+    def stage(self) -> float:
+        reqs, self.wanted = self.wanted, []
+        if self.staged:
+            self.r.coalesced += 1
+            reqs = self.staged[2] + reqs
+        full = self.force_full or not self.panel_valid or self.partials >= FULL_EVERY
+        diff = [k for k in REGIONS if self.content[k] != self.shown[k]]
+        if not full and not diff:
+            self.r.unchanged += 1
+            for req in reqs:
+                req.unchanged = True
+            self.staged = None
+            return 0.0
+        band = (0, ROWS) if full else changed_rows(diff)
+        self.staged = (band, full, reqs)
+        self.snapshot = dict(self.content)
+        return 0.0
+
+    def start_transfer(self):
+        (first, last), full, reqs = self.staged
+        self.staged = None
+        self.full = full
+        self.force_full = False
+        # 0x26 (panel rows over the previous and new band) then 0x24; full: 0x24 only
+        old = max(last, self.prev_band[1]) - min(first, self.prev_band[0])
+        self.transfer_rows = (last - first) + (0 if full else old)
+        self.prev_band = (first, last)
+        self.inflight = reqs
+        self.state = "TRANSFER"
+
+    def refresh(self, t: float):
+        self.shown = dict(self.snapshot)
+        self.panel_valid = True
+        if self.full:
+            self.partials = 0
+            self.r.full += 1
+        else:
+            self.partials += 1
+            self.r.partial += 1
+        self.busy_until = t + (self.panel.full_ms if self.full else self.panel.partial_ms)
+        self.refreshing.append((t, self.busy_until))
+        self.state = "BUSY"
+
+
+def simulate_pipeline(reqs: List[Request], events: List[float], panel: Panel, end: float) -> Result:
+    r = Result()
+    clock = LoopClock(events, r)
+    p = PipelineModel(panel, r)
+    t, qi = 0.0, 0
+    while t < end:
+        clock.service(t, p.refreshing)
+        while qi < len(reqs) and reqs[qi].t <= t:
+            p.request(reqs[qi])   # API service call handled in this pass
+            qi += 1
+        t += PASS_MS + p.loop(t)
+        t = (t // LOOP_MS + 1) * LOOP_MS
+    return r
+
+
+def pct(values: List[float], q: float) -> float:
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(q * len(values)))]
+
+
+def bench(minutes: float, seed: int, panel: Panel):
+    end = minutes * 60000
+    print(f"{minutes:.0f} min per scenario, events 4/s; full {panel.full_ms:.0f} ms, partial "
+          f"{panel.partial_ms:.0f} ms, compose {panel.compose_ms:.0f} ms, SPI {panel.spi_mhz:g} MHz")
+    print(f"  {'scenario':9} {'path':9} {'loop p50':>9} {'p99':>7} {'busy p99':>9} {'max':>7} {'stall':>7} "
+          f"{'glass p50':>10} {'p99':>7} {'full':>5} {'part':>5} {'coal':>5} {'same':>5} {'rows':>7}")
+    for kind in ("dashboard", "chatty", "bursts"):
+        for path, fn in (("blocking", simulate_blocking), ("pipeline", simulate_pipeline)):
+            reqs, events = workload(kind, minutes, seed)
+            r = fn(reqs, events, panel, end)
+            glass = [q.glass - q.t for q in reqs if q.glass is not None]
+            print(f"  {kind:9} {path:9} {pct(r.event_lat, 0.5):>7.1f}ms {pct(r.event_lat, 0.99):>5.0f}ms "
+                  f"{pct(r.busy_lat, 0.99):>7.0f}ms {max(r.event_lat, default=0):>5.0f}ms {r.max_stall:>5.0f}ms "
+                  f"{pct(glass, 0.5):>8.0f}ms {pct(glass, 0.99):>5.0f}ms {r.full:>5} {r.partial:>5} "
+                  f"{r.coalesced:>5} {r.unchanged:>5} {r.rows_sent:>7}")
+    print("  loop: event arrival -> serviced; busy: events arriving mid-refresh; stall: longest gap between passes")
+    print("  glass: request -> refresh showing it done; coal: frames replaced before sending; same: matched the panel")
+
+
+def main():
+    """CLI: simulate blocking vs pipelined ePaper refreshes."""
+    parser = argparse.ArgumentParser(description='ePaper refresh pipeline simulation')
+    parser.add_argument('--bench', action='store_true', help='Run the scenarios on both paths')
+    parser.add_argument('--minutes', type=float, default=30, help='Simulated time per scenario')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--full-ms', type=float, default=2000.0, help='Full refresh (BUSY high)')
+    parser.add_argument('--partial-ms', type=float, default=400.0, help='Partial refresh (BUSY high)')
+    parser.add_argument('--compose-ms', type=float, default=6.0, help='Display lambda render time')
+    parser.add_argument('--spi-mhz', type=float, default=2.0, help='SPI data rate')
+    args = parser.parse_args()
+    if not args.bench:
+        parser.print_help()
+        return
+    bench(args.minutes, args.seed, Panel(args.full_ms, args.partial_ms, args.spi_mhz, args.compose_ms))
+
+
+if __name__ == '__main__':
+    main()
@@ -5,6 +5,12 @@ This is the foundation of the observability system. Every button press,
 mode change, API call, and error gets timestamped and stored for
 later analysis and session replay.
 
+Writes are group-committed: log() assigns the sequence number and queues the
+row, and a writer thread commits queued rows in one transaction every
+FLUSH_INTERVAL seconds (or FLUSH_BATCH rows). Queries flush first, so reads
+always see every event logged before them. The database runs in WAL mode and
+keeps a trigram FTS5 index over the data column for search_events().
+
 Usage:
     from devtools import EventLogger, EventSource
 
@@ -14,11 +20,17 @@ Usage:
     # Query events
     events = logger.get_recent_events(100)
     sessions = logger.list_sessions()
+
+    # Ingest/search benchmark against the commit-per-event path
+    python -m devtools.event_logger --bench 1000000
 """
 
+import argparse
 import sqlite3
 import json
 import os
+import tempfile
+import time
 from datetime import datetime
 from pathlib import Path
 from typing import Optional, Dict, Any, List, Tuple
@@ -103,12 +115,19 @@ class EventLogger:
         "NOTE": "User added a note",
     }
 
-    def __init__(self, db_path: str = "~/.clawd/pager_events.db"):
+    # Group commit: flush queued events this often, or at this many rows
+    FLUSH_INTERVAL = 0.05
+    FLUSH_BATCH = 512
+
+    def __init__(self, db_path: str = "~/.clawd/pager_events.db",
+                 group_commit: bool = True):
         """
         Initialize the event logger.
 
         Args:
             db_path: Path to SQLite database (will be created if doesn't exist)
+            group_commit: Batch writes on a background thread (False commits
+                          every event inline, as before)
         """
         self.db_path = Path(db_path).expanduser()
         self.db_path.parent.mkdir(parents=True, exist_ok=True)
@@ -116,12 +135,24 @@ class EventLogger:
         # Generate session ID based on start time
         self.session_id = datetime.now().strftime("%Y%m%d_%H%M%S")
         self.sequence = 0
-        self._lock = threading.Lock()
+        self._lock = threading.Lock()       # sequence + pending queue
+        self._db_lock = threading.Lock()    # connection
+        self._pending: List[Tuple] = []
+        self._wake = threading.Condition(self._lock)
+        self._closed = False
 
         # Initialize database
         self.conn = sqlite3.connect(str(self.db_path), check_same_thread=False)
+        self.has_fts = False
         self._init_db()
 
+        self.group_commit = group_commit
+        self._writer: Optional[threading.Thread] = None
+        if group_commit:
+            self._writer = threading.Thread(target=self._writer_loop, daemon=True,
+                                            name="event-logger-writer")
+            self._writer.start()
+
         # Log session start
         self.log(EventSource.BRIDGE, "SESSION_START", {
             "session_id": self.session_id,
@@ -130,6 +161,9 @@ class EventLogger:
 
     def _init_db(self):
         """Create database schema if it doesn't exist."""
+        # WAL lets the dashboard read while the writer commits
+        self.conn.execute("PRAGMA journal_mode=WAL")
+        self.conn.execute("PRAGMA synchronous=NORMAL")
         self.conn.execute("""
             CREATE TABLE IF NOT EXISTS events (
                 id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -155,6 +189,24 @@ class EventLogger:
             CREATE INDEX IF NOT EXISTS idx_event_type
             ON events(event_type)
         """)
+        self.conn.execute("""
+            CREATE INDEX IF NOT EXISTS idx_session_sequence
+            ON events(session_id, sequence)
+        """)
+
+        # Trigram index keeps search_events() substring semantics without a scan
+        try:
+            exists = self.conn.execute(
+                "SELECT 1 FROM sqlite_master WHERE name = 'events_fts'").fetchone()
+            self.conn.execute("""
+                CREATE VIRTUAL TABLE IF NOT EXISTS events_fts
+                USING fts5(data, content='events', content_rowid='id', tokenize='trigram')
+            """)
+            if not exists:
+                self.conn.execute("INSERT INTO events_fts(events_fts) VALUES('rebuild')")
+            self.has_fts = True
+        except sqlite3.OperationalError:
+            pass  # SQLite without FTS5/trigram (< 3.34): search falls back to LIKE
 
         self.conn.commit()
 
@@ -183,16 +235,59 @@ class EventLogger:
                 sequence=self.sequence
             )
 
-            self.conn.execute(
-                """INSERT INTO events
-                   (timestamp, session_id, source, event_type, data, sequence)
-                   VALUES (?, ?, ?, ?, ?, ?)""",
+            self._pending.append(
                 (event.timestamp, event.session_id, event.source,
                  event.event_type, json.dumps(event.data), event.sequence)
             )
-            self.conn.commit()
+            if len(self._pending) >= self.FLUSH_BATCH:
+                self._wake.notify()
 
-            return event
+        if not self.group_commit:
+            self.flush()
+        return event
+
+    def flush(self):
+        """Commit all queued events now."""
+        with self._lock:
+            batch, self._pending = self._pending, []
+        if batch:
+            self._write(batch)
+
+    def _write(self, batch: List[Tuple]):
+        """Insert a batch (and its search index rows) in one transaction."""
+        with self._db_lock:
+            with self.conn:
+                if not self.has_fts:
+                    self.conn.executemany(
+                        """INSERT INTO events
+                           (timestamp, session_id, source, event_type, data, sequence)
+                           VALUES (?, ?, ?, ?, ?, ?)""", batch)
+                    return
+                for row in batch:
+                    cur = self.conn.execute(
+                        """INSERT INTO events
+                           (timestamp, session_id, source, event_type, data, sequence)
+                           VALUES (?, ?, ?, ?, ?, ?)""", row)
+                    self.conn.execute(
+                        "INSERT INTO events_fts(rowid, data) VALUES (?, ?)",
+                        (cur.lastrowid, row[4]))
+
+    def _writer_loop(self):
+        """Background group commit."""
+        while True:
+            with self._lock:
+                if not self._closed and len(self._pending) < self.FLUSH_BATCH:
+                    self._wake.wait(self.FLUSH_INTERVAL)
+                closed = self._closed
+            self.flush()
+            if closed:
+                return
+
+    def _query(self, sql: str, params: tuple = ()) -> List[tuple]:
+        """Run a read after flushing, so callers see their own writes."""
+        self.flush()
+        with self._db_lock:
+            return self.conn.execute(sql, params).fetchall()
 
     def log_error(self, error_type: str, message: str,
                   source: EventSource = EventSource.BRIDGE,
@@ -215,13 +310,13 @@ class EventLogger:
             List of PagerEvent objects ordered by sequence
         """
         sid = session_id or self.session_id
-        cursor = self.conn.execute(
+        rows = self._query(
             """SELECT * FROM events
                WHERE session_id = ?
                ORDER BY sequence""",
             (sid,)
         )
-        return [PagerEvent.from_row(row) for row in cursor.fetchall()]
+        return [PagerEvent.from_row(row) for row in rows]
 
     def get_recent_events(self, limit: int = 100,
                           event_type: Optional[str] = None) -> List[PagerEvent]:
@@ -236,19 +331,19 @@ class EventLogger:
             List of PagerEvent objects, newest first
         """
         if event_type:
-            cursor = self.conn.execute(
+            rows = self._query(
                 """SELECT * FROM events
                    WHERE event_type = ?
                    ORDER BY id DESC LIMIT ?""",
                 (event_type, limit)
             )
         else:
-            cursor = self.conn.execute(
+            rows = self._query(
                 """SELECT * FROM events
                    ORDER BY id DESC LIMIT ?""",
                 (limit,)
             )
-        return [PagerEvent.from_row(row) for row in cursor.fetchall()]
+        return [PagerEvent.from_row(row) for row in rows]
 
     def list_sessions(self) -> List[Dict[str, Any]]:
         """
@@ -257,7 +352,7 @@ class EventLogger:
         Returns:
             List of session summaries with start/end times and event counts
         """
-        cursor = self.conn.execute("""
+        rows = self._query("""
             SELECT
                 session_id,
                 MIN(timestamp) as start_time,
@@ -277,13 +372,13 @@ class EventLogger:
                 "event_count": row[3],
                 "error_count": row[4]
             }
-            for row in cursor.fetchall()
+            for row in rows
         ]
 
     def get_event_counts_by_type(self, session_id: Optional[str] = None) -> Dict[str, int]:
         """Get count of each event type for analysis."""
         sid = session_id or self.session_id
-        cursor = self.conn.execute(
+        rows = self._query(
             """SELECT event_type, COUNT(*) as count
                FROM events
                WHERE session_id = ?
@@ -291,7 +386,7 @@ class EventLogger:
                ORDER BY count DESC""",
             (sid,)
         )
-        return {row[0]: row[1] for row in cursor.fetchall()}
+        return {row[0]: row[1] for row in rows}
 
     def search_events(self, query: str, limit: int = 50) -> List[PagerEvent]:
         """
@@ -304,20 +399,38 @@ class EventLogger:
         Returns:
             Matching events
         """
-        cursor = self.conn.execute(
-            """SELECT * FROM events
-               WHERE data LIKE ?
-               ORDER BY id DESC LIMIT ?""",
-            (f'%{query}%', limit)
-        )
-        return [PagerEvent.from_row(row) for row in cursor.fetchall()]
+        # Trigram matching needs 3+ characters; shorter queries scan
+        if self.has_fts and len(query) >= 3:
+            phrase = '"' + query.replace('"', '""') + '"'
+            rows = self._query(
+                """SELECT events.* FROM
+                     (SELECT rowid FROM events_fts WHERE events_fts MATCH ?
+                      ORDER BY rowid DESC LIMIT ?) AS hits
+                   JOIN events ON events.id = hits.rowid
+                   ORDER BY events.id DESC""",
+                (phrase, limit)
+            )
+        else:
+            rows = self._query(
+                """SELECT * FROM events
+                   WHERE data LIKE ?
+                   ORDER BY id DESC LIMIT ?""",
+                (f'%{query}%', limit)
+            )
+        return [PagerEvent.from_row(row) for row in rows]
 
     def close(self):
-        """Close the database connection."""
+        """Flush queued events and close the database connection."""
         self.log(EventSource.BRIDGE, "SESSION_END", {
             "session_id": self.session_id,
             "total_events": self.sequence
         })
+        with self._lock:
+            self._closed = True
+            self._wake.notify()
+        if self._writer:
+            self._writer.join()
+        self.flush()
         self.conn.close()
 
     def __enter__(self):
@@ -432,3 +545,77 @@ def log_ota_end(success: bool, duration_s: float):
         "success": success,
         "duration_s": duration_s
     })
+
+
+def _bench_events(count: int):
+    """Synthetic hook-style events for benchmarking."""
+    tools = ["Edit", "Read", "Bash", "Grep", "Write", "WebFetch"]
+    files = ["clawd-pager.yaml", "audio_streamer.h", "dashboard_server.py",
+             "event_logger.py", "display_modes/page_index.h", "README.md"]
+    for i in range(count):
+        yield EventSource.BRIDGE, "TOOL_START", {
+            "tool": tools[i % len(tools)],
+            "file": files[(i * 7) % len(files)],
+            "display_text": f"step {i} of agent burst {i // 1000}",
+        }
+
+
+def bench(count: int, legacy_cap: int = 20000) -> Dict[str, float]:
+    """Ingest rate and search latency: group commit + FTS vs commit-per-event + LIKE."""
+    results: Dict[str, float] = {}
+    with tempfile.TemporaryDirectory() as tmp:
+        # Old path: default journal, one commit per event (capped, it is slow)
+        legacy_n = min(count, legacy_cap)
+        conn = sqlite3.connect(os.path.join(tmp, "legacy.db"))
+        conn.execute("""CREATE TABLE events (id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        timestamp TEXT, session_id TEXT, source TEXT, event_type TEXT,
+                        data JSON, sequence INTEGER)""")
+        start = time.perf_counter()
+        for seq, (source, event_type, data) in enumerate(_bench_events(legacy_n), 1):
+            conn.execute("INSERT INTO events (timestamp, session_id, source, event_type, data, sequence)"
+                         " VALUES (?, ?, ?, ?, ?, ?)",
+                         (datetime.now().isoformat(timespec='milliseconds'), "bench",
+                          source.value, event_type, json.dumps(data), seq))
+            conn.commit()
+        results["legacy_events_per_s"] = legacy_n / (time.perf_counter() - start)
+        conn.close()
+
+        logger = EventLogger(os.path.join(tmp, "events.db"))
+        start = time.perf_counter()
+        for source, event_type, data in _bench_events(count):
+            logger.log(source, event_type, data)
+        logger.flush()
+        results["group_events_per_s"] = count / (time.perf_counter() - start)
+
+        # Search over the full table: FTS vs the LIKE scan
+        queries = ["audio_streamer", "burst 42", "page_index", "no such text"]
+        for label, fts in (("fts", True), ("like", False)):
+            logger.has_fts = fts
+            start = time.perf_counter()
+            for q in queries:
+                logger.search_events(q, limit=50)
+            results[f"{label}_search_ms"] = (time.perf_counter() - start) * 1000 / len(queries)
+        logger.has_fts = True
+        logger.close()
+    return results
+
+
+def main():
+    """CLI: run the event store benchmark."""
+    parser = argparse.ArgumentParser(description='Clawd Pager event logger')
+    parser.add_argument('--bench', type=int, metavar='N', help='Benchmark with N events')
+    args = parser.parse_args()
+
+    if not args.bench:
+        parser.print_help()
+        return
+
+    r = bench(args.bench)
+    print(f"Ingest  commit-per-event: {r['legacy_events_per_s']:>10,.0f} events/s")
+    print(f"Ingest  group commit:     {r['group_events_per_s']:>10,.0f} events/s")
+    print(f"Search  LIKE scan:        {r['like_search_ms']:>10.2f} ms")
+    print(f"Search  FTS5 trigram:     {r['fts_search_ms']:>10.2f} ms")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+Fleet - Driver, query client and WebSocket relay for devtools/fleet_aggregator.cpp.
+
+Pagers push state deltas and timing histograms (fleet_telemetry.h) to the
+aggregator on UDP 12348; it keeps one row per pager in a column table and
+answers fleet queries ("who is low on battery", "p99 frame time by
+firmware") in microseconds. Three modes:
+
+    --bench   run the aggregator's load generator (1,000 simulated pagers by
+              default) and print ingest rate, memory per pager and query
+              times, each query checked against the generator's truth
+    --query   send one query to a running aggregator and print the JSON reply
+    --relay   accept fleet datagrams as binary WebSocket messages (pagers or
+              bridges that can't reach UDP) and forward them to the aggregator
+
+Usage:
+    g++ -O2 -I. -pthread -o /tmp/fleet-aggregator devtools/fleet_aggregator.cpp
+    /tmp/fleet-aggregator --port 12348 &
+    python -m devtools.fleet --bench --bin /tmp/fleet-aggregator
+    python -m devtools.fleet --query "p99 frame_ms"
+    python -m devtools.fleet --relay --ws-port 8766
+"""
+
+import argparse
+import json
+import re
+import socket
+import subprocess
+from typing import Dict, List
+
+DEFAULT_PORT = 12348
+QUERY_MAGIC = b"\xff\xffFQ"
+FLEET_MAGIC = b"\xff\xffFT"
+
+LINE_RE = re.compile(r"^(loadgen|ingest|udp|memory|query|p99|total|error) (.*)$")
+
+
+def fields(text: str) -> Dict[str, str]:
+    return dict(kv.split("=", 1) for kv in text.split())
+
+
+def bench(binary: str, devices: int, minutes: int, repeat: int) -> bool:
+    out = subprocess.run([binary, "--loadgen", str(devices), "--minutes", str(minutes), "-n", str(repeat)],
+                         capture_output=True, text=True)
+    lines: Dict[str, Dict[str, str]] = {}
+    queries: List[Dict[str, str]] = []
+    p99: List[Dict[str, str]] = []
+    for line in out.stdout.splitlines():
+        m = LINE_RE.match(line.strip())
+        if not m:
+            continue
+        if m.group(1) == "query":
+            queries.append(fields(m.group(2)))
+        elif m.group(1) == "p99":
+            p99.append(fields(m.group(2)))
+        else:
+            lines[m.group(1)] = fields(m.group(2))
+    if "total" not in lines:
+        print(out.stdout + out.stderr)
+        return False
+
+    gen, ingest, udp, mem = lines["loadgen"], lines["ingest"], lines["udp"], lines["memory"]
+    print(f"{gen['devices']} pagers, {gen['minutes']} min: {gen['datagrams']} datagrams, "
+          f"{float(gen['avg_datagram']):.0f} B average")
+    print(f"Ingest in process: {float(ingest['datagrams_per_s']) / 1e6:.1f} M datagrams/s "
+          f"({float(ingest['ns_per_datagram']):.0f} ns each); the fleet sends {ingest['needed_per_s']}/s")
+    print(f"Ingest over UDP:   {float(udp['datagrams_per_s']) / 1e3:.0f} k datagrams/s, "
+          f"{udp['lost']} of {udp['sent']} lost")
+    print(f"Memory:            {float(mem['bytes_per_device']):.0f} B per pager "
+          f"({int(mem['table_bytes']) / 1024:.0f} KB for {mem['capacity']})")
+    if "error" in lines:
+        print(f"  ERROR {lines['error']}")
+
+    print(f"\n{'query':<24}{'us':>8}{'results':>9}   check")
+    for q in queries:
+        print(f"{q['name']:<24}{float(q['us']):>8.2f}{q['results']:>9}   {'ok' if q['ok'] == '1' else 'WRONG'}")
+    if p99:
+        print(f"\n{'firmware':<16}{'pagers':>7}{'p50 ms':>8}{'p99 ms':>8}{'exact p99':>11}")
+        for f in p99:
+            print(f"{f['firmware']:<16}{f['devices']:>7}{float(f['p50_ms']):>8.1f}{float(f['p99_ms']):>8.1f}"
+                  f"{float(f['exact_p99_ms']):>11.1f}")
+    ok = out.returncode == 0 and lines["total"].get("failures") == "0"
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def query(text: str, host: str = "127.0.0.1", port: int = DEFAULT_PORT, timeout: float = 2.0) -> dict:
+    """Send one query to the aggregator and return its JSON reply."""
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.settimeout(timeout)
+        sock.sendto(QUERY_MAGIC + text.encode(), (host, port))
+        return json.loads(sock.recv(65535))
+
+
+async def relay(ws_port: int, host: str, port: int):
+    """Forward binary WebSocket messages holding fleet datagrams to the aggregator over UDP."""
+    import asyncio
+    from aiohttp import web, WSMsgType
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setblocking(False)
+    counts: Dict[str, int] = {"forwarded": 0, "dropped": 0}
+
+    async def handle(request):
+        ws = web.WebSocketResponse()
+        await ws.prepare(request)
+        async for msg in ws:
+            if msg.type != WSMsgType.BINARY:
+                continue
+            if msg.data[:4] != FLEET_MAGIC:
+                counts["dropped"] += 1
+                continue
+            try:
+                sock.sendto(msg.data, (host, port))
+                counts["forwarded"] += 1
+            except BlockingIOError:
+                counts["dropped"] += 1
+        return ws
+
+    app = web.Application()
+    app.router.add_get("/fleet", handle)
+    runner = web.AppRunner(app)
+    await runner.setup()
+    await web.TCPSite(runner, "0.0.0.0", ws_port).start()
+    print(f"Relaying ws://0.0.0.0:{ws_port}/fleet -> udp {host}:{port}")
+    while True:
+        await asyncio.sleep(60)
+        print(f"forwarded={counts['forwarded']} dropped={counts['dropped']}")
+
+
+def main():
+    """CLI: load-test the fleet aggregator, query it, or relay WebSocket telemetry to it."""
+    parser = argparse.ArgumentParser(description='Fleet telemetry aggregator tools')
+    parser.add_argument('--bench', action='store_true', help='Run the load generator and the query checks')
+    parser.add_argument('--bin', default='/tmp/fleet-aggregator', help='Built fleet_aggregator.cpp')
+    parser.add_argument('--devices', type=int, default=1000, help='Simulated pagers')
+    parser.add_argument('--minutes', type=int, default=10, help='Simulated minutes of reports')
+    parser.add_argument('--repeat', type=int, default=3, help='Ingest passes (best is kept)')
+    parser.add_argument('--query', help='Query a running aggregator, e.g. "low_battery 20"')
+    parser.add_argument('--relay', action='store_true', help='Relay WebSocket datagrams to the aggregator')
+    parser.add_argument('--ws-port', type=int, default=8766, help='WebSocket port for --relay')
+    parser.add_argument('--host', default='127.0.0.1', help='Aggregator host')
+    parser.add_argument('--port', type=int, default=DEFAULT_PORT, help='Aggregator UDP port')
+    args = parser.parse_args()
+    if args.bench:
+        raise SystemExit(0 if bench(args.bin, args.devices, args.minutes, args.repeat) else 1)
+    if args.query:
+        print(json.dumps(query(args.query, args.host, args.port), indent=2))
+        return
+    if args.relay:
+        import asyncio
+        asyncio.run(relay(args.ws_port, args.host, args.port))
+        return
+    parser.print_help()
+
+
+if __name__ == '__main__':
+    main()
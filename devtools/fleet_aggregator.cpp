@@ -0,0 +1,537 @@
+// Fleet Aggregator - fleet telemetry ingest and queries on the bridge host
+//
+// Pagers push state deltas and timing histograms (fleet_telemetry.h) over
+// UDP; each datagram goes into a FleetTable (fleet_table.h), one row per
+// pager. Queries are datagrams too, answered with one JSON datagram, so the
+// dashboard (or `python -m devtools.fleet --query`) asks the aggregator
+// instead of polling every pager.
+//
+// Query datagram: FF FF 'F' 'Q' then one of
+//   summary                      devices, capacity, bytes, ingest stats
+//   low_battery [pct]            not charging and under pct (default 20)
+//   silent [seconds]             not heard from for seconds (default 60)
+//   modes                        pagers per display mode
+//   p99 <loop_ms|frame_ms>       p50/p99 per firmware over the last 1-2 min
+//   device <id hex>              one pager's row
+// Every reply carries "us", the time the query took in the table.
+//
+// --loadgen simulates a fleet with the pager's own FleetReporter (three
+// firmwares with different frame-time distributions, batteries draining
+// and charging, mode changes, a few pagers going silent) and reports:
+//   ingest    datagrams/s into the table in process, and through UDP
+//             loopback (sendmmsg/recvmmsg) with the datagrams lost
+//   memory    table bytes per pager at capacity
+//   queries   time per query, each checked against the generator's truth
+//
+// Build:
+//   g++ -O2 -I. -pthread -o /tmp/fleet-aggregator devtools/fleet_aggregator.cpp
+//
+// Usage:
+//   fleet-aggregator [--port 12348] [--capacity 4096]
+//   fleet-aggregator --loadgen 1000 [--minutes 10] [-n repeat]
+//   -> loadgen devices=<n> minutes=<m> datagrams=<n> bytes=<n> avg_datagram=<b>
+//      ingest datagrams_per_s=<r> ns_per_datagram=<t> needed_per_s=<r>
+//      udp sent=<n> received=<n> lost=<n> datagrams_per_s=<r>
+//      memory capacity=<n> table_bytes=<n> bytes_per_device=<b>
+//      query name=<q> us=<t> results=<n> ok=<0|1>
+//      total failures=<n>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "fleet_table.h"
+
+static const uint8_t QUERY_MAGIC[4] = {0xFF, 0xFF, 'F', 'Q'};
+static const int BATCH = 64;
+
+static uint64_t host_ns() {
+    using namespace std::chrono;
+    return (uint64_t) duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t host_ms() { return (uint32_t) (host_ns() / 1000000); }
+
+// ---- Queries ----
+
+static std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char) c < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static std::string json_ids(const std::vector<uint32_t>& ids, size_t limit) {
+    std::string out = "[";
+    for (size_t i = 0; i < ids.size() && i < limit; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "%s\"%08x\"", i ? "," : "", ids[i]);
+        out += id;
+    }
+    return out + "]";
+}
+
+// Reply to one query; ids lists are cut at 500 to stay in one datagram
+static std::string answer(FleetTable& table, const std::string& query, uint32_t now_ms) {
+    char word[32] = "", arg[32] = "";
+    sscanf(query.c_str(), "%31s %31s", word, arg);
+    std::string q = word, body;
+    std::vector<uint32_t> ids;
+    char buf[256];
+    uint64_t t0 = host_ns();
+
+    if (q == "summary") {
+        const FleetTable::Stats& s = table.stats();
+        snprintf(buf, sizeof(buf),
+                 "\"devices\":%zu,\"capacity\":%zu,\"bytes\":%zu,\"datagrams\":%llu,\"malformed\":%llu,"
+                 "\"lost\":%llu,\"reordered\":%llu,\"stale_state\":%llu,\"full\":%llu",
+                 table.devices(), table.capacity(), table.bytes(), (unsigned long long) s.datagrams,
+                 (unsigned long long) s.malformed, (unsigned long long) s.lost, (unsigned long long) s.reordered,
+                 (unsigned long long) s.stale_state, (unsigned long long) s.full);
+        body = buf;
+    } else if (q == "low_battery" || q == "silent") {
+        int n = arg[0] ? atoi(arg) : (q == "silent" ? 60 : 20);
+        if (q == "low_battery") table.low_battery(n * 10, ids);
+        else table.silent(now_ms, (uint32_t) n * 1000, ids);
+        snprintf(buf, sizeof(buf), "\"%s\":%d,\"count\":%zu,\"devices\":", q == "silent" ? "seconds" : "pct", n,
+                 ids.size());
+        body = buf + json_ids(ids, 500);
+    } else if (q == "modes") {
+        std::vector<std::pair<std::string, uint32_t>> modes;
+        table.by_mode(modes);
+        body = "\"modes\":{";
+        for (size_t i = 0; i < modes.size(); i++) {
+            body += (i ? "," : "") + json_string(modes[i].first) + ":" + std::to_string(modes[i].second);
+        }
+        body += "}";
+    } else if (q == "p99") {
+        std::string name = arg[0] ? arg : "frame_ms";
+        Metric m = name == "loop_ms" ? Metric::LOOP_MS : Metric::FRAME_MS;
+        std::vector<FleetTable::Percentiles> groups;
+        table.percentiles_by_firmware(m, now_ms, groups);
+        body = "\"metric\":" + json_string(name) + ",\"firmware\":[";
+        for (size_t i = 0; i < groups.size(); i++) {
+            const FleetTable::Percentiles& g = groups[i];
+            snprintf(buf, sizeof(buf), "%s{\"name\":%s,\"devices\":%u,\"samples\":%llu,\"p50_ms\":%.1f,\"p99_ms\":%.1f}",
+                     i ? "," : "", json_string(g.firmware).c_str(), g.devices, (unsigned long long) g.samples,
+                     g.p50 / 10.0, g.p99 / 10.0);
+            body += buf;
+        }
+        body += "]";
+    } else if (q == "device") {
+        int32_t battery;
+        bool charging;
+        int8_t rssi;
+        uint32_t heap_free, uptime, last_seen;
+        std::string mode, firmware;
+        uint32_t id = (uint32_t) strtoul(arg, nullptr, 16);
+        if (table.device(id, &battery, &charging, &rssi, &heap_free, &uptime, &mode, &firmware, &last_seen)) {
+            snprintf(buf, sizeof(buf),
+                     "\"id\":\"%08x\",\"battery\":%.1f,\"charging\":%s,\"rssi\":%d,\"heap_free\":%u,\"uptime_s\":%u,"
+                     "\"age_s\":%u,",
+                     id, battery / 10.0, charging ? "true" : "false", rssi, heap_free, uptime,
+                     (now_ms - last_seen) / 1000);
+            body = buf + std::string("\"mode\":") + json_string(mode) + ",\"firmware\":" + json_string(firmware);
+        } else {
+            body = "\"error\":\"unknown device\"";
+        }
+    } else {
+        body = "\"error\":\"unknown query\"";
+    }
+
+    snprintf(buf, sizeof(buf), "{\"query\":%s,\"us\":%.1f,", json_string(q).c_str(), (host_ns() - t0) / 1000.0);
+    return buf + body + "}";
+}
+
+static int bind_udp(const char* addr, int port, int rcvbuf) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    sockaddr_in sa = {};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_pton(AF_INET, addr, &sa.sin_addr);
+    if (bind(fd, (sockaddr*) &sa, sizeof(sa)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Receive buffers for one recvmmsg batch
+struct Batch {
+    uint8_t data[BATCH][1500];
+    iovec iov[BATCH];
+    sockaddr_in from[BATCH];
+    mmsghdr msgs[BATCH];
+
+    Batch() {
+        for (int i = 0; i < BATCH; i++) {
+            iov[i] = {data[i], sizeof(data[i])};
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    int receive(int fd, int flags) {
+        for (int i = 0; i < BATCH; i++) {
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+        }
+        return recvmmsg(fd, msgs, BATCH, flags, nullptr);
+    }
+};
+
+static int serve(int port, size_t capacity) {
+    int fd = bind_udp("0.0.0.0", port, 4 << 20);
+    if (fd < 0) {
+        perror("bind");
+        return 1;
+    }
+    FleetTable table(capacity);
+    static Batch batch;
+    printf("listening port=%d capacity=%zu table_bytes=%zu\n", port, capacity, table.bytes());
+    fflush(stdout);
+    uint32_t last_log = host_ms();
+    for (;;) {
+        pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, 1000) > 0) {
+            int n = batch.receive(fd, MSG_DONTWAIT);
+            uint32_t now = host_ms();
+            for (int i = 0; i < n; i++) {
+                const uint8_t* d = batch.data[i];
+                size_t len = batch.msgs[i].msg_len;
+                if (len >= 4 && memcmp(d, QUERY_MAGIC, 4) == 0) {
+                    std::string reply = answer(table, std::string((const char*) d + 4, len - 4), now);
+                    sendto(fd, reply.data(), reply.size(), MSG_DONTWAIT, (sockaddr*) &batch.from[i],
+                           batch.msgs[i].msg_hdr.msg_namelen);
+                } else {
+                    table.ingest(d, len, now);
+                }
+            }
+        }
+        if (host_ms() - last_log >= 60000) {
+            last_log = host_ms();
+            const FleetTable::Stats& s = table.stats();
+            printf("stats devices=%zu datagrams=%llu malformed=%llu lost=%llu reordered=%llu full=%llu\n",
+                   table.devices(), (unsigned long long) s.datagrams, (unsigned long long) s.malformed,
+                   (unsigned long long) s.lost, (unsigned long long) s.reordered, (unsigned long long) s.full);
+            fflush(stdout);
+        }
+    }
+}
+
+// ---- Load generator ----
+
+static const char* FIRMWARES[3] = {"0.9.2", "1.0.0", "1.1.0-dev"};
+static const char* MODES[5] = {"IDLE", "AGENT", "PROCESSING", "LISTENING", "DOCKED"};
+
+// Frame time (ms x10) per firmware: a body around base and a tail
+struct FrameModel {
+    int base, spread, tail, tail_pct;
+};
+static const FrameModel FRAME_MODELS[3] = {{160, 40, 450, 1}, {200, 60, 900, 2}, {280, 80, 1600, 5}};
+
+struct SimPager {
+    FleetReporter reporter;
+    uint32_t id;
+    int firmware;
+    uint32_t phase_ms;
+    int32_t battery;  // % x10
+    bool charging;
+    int mode;
+    int32_t rssi;
+    uint32_t silent_after;  // Report index it stops at (UINT32_MAX = never)
+    std::vector<int32_t> pending_frames;
+};
+
+struct Datagram {
+    uint32_t at_ms;
+    uint32_t offset;
+    uint16_t len;
+};
+
+struct Fleet {
+    std::vector<Datagram> datagrams;
+    std::vector<uint8_t> bytes;
+    uint32_t end_ms;
+    // Truth at end_ms
+    std::vector<uint32_t> low_battery;                    // Under 20%, not charging
+    std::vector<uint32_t> silent;                         // No report for 30 s
+    std::map<std::string, uint32_t> modes;
+    std::vector<int32_t> frames[3];                       // Frame samples in the last two minutes
+};
+
+static Fleet generate(size_t devices, int minutes) {
+    std::mt19937 rng(42);
+    std::vector<SimPager> pagers(devices);
+    for (size_t i = 0; i < devices; i++) {
+        SimPager& p = pagers[i];
+        // Espressif OUIs 24:0A:C4 and 30:AE:A4, as ESP.getEfuseMac() packs them
+        uint64_t oui = i % 2 ? 0xC40A24ull : 0xA4AE30ull;
+        p.id = fleet_device_id(oui | (uint64_t) ((i * 0x9E37u + 1) & 0xFFFFFF) << 24);
+        p.firmware = (int) (i % 3);
+        p.phase_ms = rng() % FleetReporter::REPORT_MS;
+        p.battery = 50 + (int32_t) (rng() % 950);
+        p.charging = rng() % 10 == 0;
+        p.mode = (int) (rng() % 5);
+        p.rssi = -50 - (int32_t) (rng() % 40);
+        p.silent_after = rng() % 50 == 0 ? (uint32_t) (minutes * 3) : UINT32_MAX;
+        p.reporter.begin(p.id, FIRMWARES[p.firmware]);
+    }
+    std::vector<size_t> order(devices);
+    for (size_t i = 0; i < devices; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return pagers[a].phase_ms < pagers[b].phase_ms; });
+
+    Fleet fleet;
+    uint32_t reports = (uint32_t) minutes * 60000 / FleetReporter::REPORT_MS;
+    fleet.end_ms = reports * FleetReporter::REPORT_MS + FleetReporter::REPORT_MS;
+    uint32_t last_epoch = fleet.end_ms / FleetTable::EPOCH_MS;
+    uint8_t pkt[FleetReporter::MAX_DATAGRAM];
+    std::uniform_int_distribution<int> pct(0, 99);
+
+    for (uint32_t r = 0; r < reports; r++) {
+        for (size_t i : order) {
+            SimPager& p = pagers[i];
+            if (r >= p.silent_after) continue;
+            uint32_t now = (r + 1) * FleetReporter::REPORT_MS + p.phase_ms;
+            // 10 s of samples: loop every 100 ms, frames at 20 fps
+            const FrameModel& fm = FRAME_MODELS[p.firmware];
+            for (int s = 0; s < 100; s++) p.reporter.observe(Metric::LOOP_MS, 100 + (int32_t) (rng() % 150));
+            for (int s = 0; s < 200; s++) {
+                int32_t v = pct(rng) < fm.tail_pct ? fm.tail + (int32_t) (rng() % fm.tail)
+                                                   : fm.base + (int32_t) (rng() % (2 * fm.spread)) - fm.spread;
+                p.reporter.observe(Metric::FRAME_MS, v);
+                p.pending_frames.push_back(v);
+            }
+            p.battery += p.charging ? 8 : -(int32_t) (rng() % 4);
+            p.battery = std::max(0, std::min(1000, p.battery));
+            if (rng() % 200 == 0) p.charging = !p.charging;
+            if (rng() % 5 == 0) p.mode = (int) (rng() % 5);
+            if (rng() % 3 == 0) p.rssi = -50 - (int32_t) (rng() % 40);
+            p.reporter.observe(Metric::BATTERY, p.battery);
+            p.reporter.observe(Metric::CHARGING, p.charging);
+            p.reporter.observe(Metric::RSSI, p.rssi);
+            p.reporter.set(FleetField::HEAP_FREE, 120000 + (int32_t) (rng() % 4000));
+            p.reporter.set(FleetField::HEAP_LARGEST, 60000);
+            p.reporter.set(FleetField::UPTIME_S, (int32_t) (now / 1000));
+            p.reporter.set_text(FleetField::MODE, MODES[p.mode]);
+            while (size_t n = p.reporter.poll(now, pkt, sizeof(pkt))) {
+                fleet.datagrams.push_back({now, (uint32_t) fleet.bytes.size(), (uint16_t) n});
+                fleet.bytes.insert(fleet.bytes.end(), pkt, pkt + n);
+            }
+            // The aggregator files them under the minute they arrive in
+            if (now / FleetTable::EPOCH_MS + 1 >= last_epoch) {
+                fleet.frames[p.firmware].insert(fleet.frames[p.firmware].end(), p.pending_frames.begin(),
+                                                p.pending_frames.end());
+            }
+            p.pending_frames.clear();
+        }
+    }
+    for (SimPager& p : pagers) {
+        if (p.battery < 200 && !p.charging) fleet.low_battery.push_back(p.id);
+        if (p.silent_after != UINT32_MAX) fleet.silent.push_back(p.id);
+        fleet.modes[MODES[p.mode]]++;
+    }
+    return fleet;
+}
+
+static double ingest_in_process(const Fleet& fleet, FleetTable& table) {
+    uint64_t t0 = host_ns();
+    for (const Datagram& d : fleet.datagrams) table.ingest(&fleet.bytes[d.offset], d.len, d.at_ms);
+    return (double) (host_ns() - t0);
+}
+
+// Sender and receiver on loopback; the sender backs off when it gets more
+// than a socket buffer ahead, as a fleet spread over 10 s never bursts
+static void ingest_udp(const Fleet& fleet, size_t capacity, size_t* received, double* ns) {
+    int rx = bind_udp("127.0.0.1", 0, 8 << 20);
+    int tx = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in sa = {};
+    socklen_t sl = sizeof(sa);
+    getsockname(rx, (sockaddr*) &sa, &sl);
+    connect(tx, (sockaddr*) &sa, sizeof(sa));
+
+    std::atomic<size_t> got(0);
+    std::atomic<bool> done(false);
+    std::thread receiver([&] {
+        FleetTable table(capacity);
+        static Batch batch;
+        uint64_t idle_since = 0;
+        for (;;) {
+            int n = batch.receive(rx, MSG_DONTWAIT);
+            if (n > 0) {
+                uint32_t now = host_ms();
+                for (int i = 0; i < n; i++) table.ingest(batch.data[i], batch.msgs[i].msg_len, now);
+                got += n;
+                idle_since = 0;
+                continue;
+            }
+            if (!done) continue;
+            if (!idle_since) idle_since = host_ns();
+            if (host_ns() - idle_since > 200000000ull) break;
+        }
+    });
+
+    std::vector<mmsghdr> msgs(BATCH);
+    std::vector<iovec> iov(BATCH);
+    uint64_t t0 = host_ns();
+    for (size_t i = 0; i < fleet.datagrams.size();) {
+        int n = 0;
+        for (; n < BATCH && i + n < fleet.datagrams.size(); n++) {
+            const Datagram& d = fleet.datagrams[i + n];
+            iov[n] = {(void*) &fleet.bytes[d.offset], d.len};
+            memset(&msgs[n], 0, sizeof(mmsghdr));
+            msgs[n].msg_hdr.msg_iov = &iov[n];
+            msgs[n].msg_hdr.msg_iovlen = 1;
+        }
+        int sent = sendmmsg(tx, msgs.data(), n, 0);
+        if (sent <= 0) continue;
+        i += sent;
+        uint64_t wait = host_ns();
+        while (i - got > 2048 && host_ns() - wait < 20000000ull) std::this_thread::yield();
+    }
+    done = true;
+    receiver.join();
+    *ns = (double) (host_ns() - t0);
+    *received = got;
+    close(tx);
+    close(rx);
+}
+
+template <typename F>
+static double time_us(int repeat, F f) {
+    std::vector<double> t;
+    for (int i = 0; i < repeat; i++) {
+        uint64_t t0 = host_ns();
+        f();
+        t.push_back((host_ns() - t0) / 1000.0);
+    }
+    std::sort(t.begin(), t.end());
+    return t[t.size() / 2];
+}
+
+static int loadgen(size_t devices, int minutes, int repeat) {
+    Fleet fleet = generate(devices, minutes);
+    size_t capacity = devices;
+    int failures = 0;
+    printf("loadgen devices=%zu minutes=%d datagrams=%zu bytes=%zu avg_datagram=%.1f\n", devices, minutes,
+           fleet.datagrams.size(), fleet.bytes.size(), (double) fleet.bytes.size() / fleet.datagrams.size());
+
+    double best = 1e30;
+    for (int i = 0; i < repeat; i++) {
+        FleetTable scratch(capacity);
+        best = std::min(best, ingest_in_process(fleet, scratch));
+    }
+    double needed = devices * 2.0 * 1000 / FleetReporter::REPORT_MS;
+    printf("ingest datagrams_per_s=%.0f ns_per_datagram=%.1f needed_per_s=%.0f\n",
+           fleet.datagrams.size() / (best / 1e9), best / fleet.datagrams.size(), needed);
+
+    size_t received = 0;
+    double udp_ns = 0;
+    ingest_udp(fleet, capacity, &received, &udp_ns);
+    printf("udp sent=%zu received=%zu lost=%zu datagrams_per_s=%.0f\n", fleet.datagrams.size(), received,
+           fleet.datagrams.size() - received, received / (udp_ns / 1e9));
+
+    FleetTable table(capacity);
+    ingest_in_process(fleet, table);
+    if (table.stats().malformed || table.stats().lost || table.devices() != devices) {
+        printf("error malformed=%llu lost=%llu devices=%zu\n", (unsigned long long) table.stats().malformed,
+               (unsigned long long) table.stats().lost, table.devices());
+        failures++;
+    }
+    printf("memory capacity=%zu table_bytes=%zu bytes_per_device=%.1f\n", table.capacity(), table.bytes(),
+           (double) table.bytes() / table.capacity());
+
+    uint32_t now = fleet.end_ms;
+    std::vector<uint32_t> ids;
+    auto report = [&](const char* name, double us, size_t results, bool ok) {
+        printf("query name=%s us=%.2f results=%zu ok=%d\n", name, us, results, ok ? 1 : 0);
+        if (!ok) failures++;
+    };
+
+    double us = time_us(repeat * 100, [&] { table.low_battery(200, ids); });
+    std::vector<uint32_t> want = fleet.low_battery;
+    std::sort(ids.begin(), ids.end());
+    std::sort(want.begin(), want.end());
+    report("low_battery", us, ids.size(), ids == want);
+
+    us = time_us(repeat * 100, [&] { table.silent(now, 30000, ids); });
+    want = fleet.silent;
+    std::sort(ids.begin(), ids.end());
+    std::sort(want.begin(), want.end());
+    report("silent", us, ids.size(), ids == want);
+
+    std::vector<std::pair<std::string, uint32_t>> modes;
+    us = time_us(repeat * 100, [&] { table.by_mode(modes); });
+    std::map<std::string, uint32_t> got_modes(modes.begin(), modes.end());
+    report("modes", us, modes.size(), got_modes == fleet.modes);
+
+    std::vector<FleetTable::Percentiles> groups;
+    us = time_us(repeat * 100, [&] { table.percentiles_by_firmware(Metric::FRAME_MS, now, groups); });
+    bool ok = groups.size() == 3;
+    for (const FleetTable::Percentiles& g : groups) {
+        int f = (int) (std::find_if(FIRMWARES, FIRMWARES + 3, [&](const char* n) { return g.firmware == n; }) -
+                       FIRMWARES);
+        if (f == 3) {
+            ok = false;
+            continue;
+        }
+        // The bucket holding the exact p99 sample
+        std::vector<int32_t> v = fleet.frames[f];
+        std::sort(v.begin(), v.end());
+        size_t rank = (v.size() * 99 + 99) / 100;
+        uint8_t b = fleet_bucket(v[rank - 1]);
+        int32_t expect = FLEET_BUCKET_UPPER[b < FLEET_BUCKETS - 1 ? b : b - 1];
+        printf("p99 firmware=%s devices=%u samples=%llu p50_ms=%.1f p99_ms=%.1f exact_p99_ms=%.1f\n",
+               g.firmware.c_str(), g.devices, (unsigned long long) g.samples, g.p50 / 10.0, g.p99 / 10.0,
+               v[rank - 1] / 10.0);
+        ok = ok && g.p99 == expect && g.samples == v.size();
+    }
+    report("p99_frame_by_firmware", us, groups.size(), ok);
+
+    std::string reply;
+    char query[32];
+    snprintf(query, sizeof(query), "device %08x", fleet_device_id(0xA4AE30ull | 1ull << 24));  // Pager 0
+    us = time_us(repeat * 100, [&] { reply = answer(table, query, now); });
+    report("device_json", us, 1, reply.find("\"firmware\":\"0.9.2\"") != std::string::npos);
+
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    int port = 12348, minutes = 10, repeat = 3;
+    size_t capacity = 4096, devices = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--port") && i + 1 < argc) port = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--capacity") && i + 1 < argc) capacity = (size_t) atol(argv[++i]);
+        else if (!strcmp(argv[i], "--loadgen") && i + 1 < argc) devices = (size_t) atol(argv[++i]);
+        else if (!strcmp(argv[i], "--minutes") && i + 1 < argc) minutes = std::max(3, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) repeat = std::max(1, atoi(argv[++i]));
+    }
+    if (devices) return loadgen(devices, minutes, repeat);
+    return serve(port, capacity);
+}
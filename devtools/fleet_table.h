@@ -0,0 +1,368 @@
+// Fleet Table - per-pager rolling state for the fleet aggregator
+//
+// One row per pager, one column per field (structure of arrays): a fleet
+// query touches only the columns it needs, in order, so "who is low on
+// battery" over 1,000 pagers reads 3 KB instead of 300 KB of rows.
+//
+// Columns are sized for `capacity` pagers up front and never move. Pager
+// id -> row is an open-addressing table (linear probing, 2x capacity).
+//
+// Timing histograms (loop and frame time, FLEET_BUCKETS buckets each) keep
+// two one-minute halves per row: the half for the current minute and the
+// one before it. Reaching a new minute clears the older half in place, so
+// a query sees the last 1-2 minutes with no per-query bookkeeping.
+// Percentiles are the upper edge of the bucket they fall in (as coarse as
+// FLEET_BUCKET_UPPER).
+//
+// State datagrams older than the last one applied (seq, mod 2^16) are
+// dropped: state is latest-wins. Metrics are applied whatever the order.
+//
+// Wire format: fleet_telemetry.h. Used by fleet_aggregator.cpp.
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../fleet_telemetry.h"
+
+class FleetTable {
+public:
+    static const uint32_t EPOCH_MS = 60000;
+    static const int TIMINGS = 2;  // Metric::LOOP_MS, Metric::FRAME_MS
+    static const uint16_t NONE = 0xFFFF;
+
+    struct Stats {
+        uint64_t datagrams;
+        uint64_t bytes;
+        uint64_t malformed;
+        uint64_t stale_state;  // Older than the state already applied
+        uint64_t lost;         // Gaps in seq
+        uint64_t reordered;
+        uint64_t full;         // New pager, no free row
+    };
+
+    struct Percentiles {
+        std::string firmware;
+        uint32_t devices;
+        uint64_t samples;
+        int32_t p50;  // Metric fixed point (ms x10); bucket upper edge
+        int32_t p99;
+    };
+
+    explicit FleetTable(size_t capacity)
+        : _capacity(capacity), _count(0), _stats() {
+        size_t slots = 1;
+        while (slots < capacity * 2) slots <<= 1;
+        _slots.assign(slots, 0);
+        _id.resize(capacity);
+        _last_seen.resize(capacity);
+        _seq.resize(capacity);
+        _known.resize(capacity);
+        _battery.resize(capacity);
+        _charging.resize(capacity);
+        _rssi.resize(capacity);
+        _heap_free.resize(capacity);
+        _heap_largest.resize(capacity);
+        _uptime.resize(capacity);
+        _mode.resize(capacity);
+        _firmware.resize(capacity);
+        for (int t = 0; t < TIMINGS; t++) {
+            _epoch[t].resize(capacity);
+            _hist[t].resize(capacity * 2 * FLEET_BUCKETS);
+        }
+    }
+
+    // Apply one datagram; false if it isn't a well-formed fleet datagram
+    bool ingest(const uint8_t* d, size_t len, uint32_t now_ms) {
+        if (len < FLEET_HEADER_SIZE || memcmp(d, FLEET_MAGIC, 4) != 0) return malformed();
+        uint32_t id = get32(d + 4);
+        uint16_t seq = (uint16_t) (d[8] | d[9] << 8);
+        uint8_t type = d[10], count = d[11];
+        if (type != FLEET_STATE && type != FLEET_METRICS) return malformed();
+        if (!valid(type, d + FLEET_HEADER_SIZE, d + len, count)) return malformed();
+        uint32_t row = find_or_add(id);
+        if (row == NONE32) {
+            _stats.full++;
+            return true;
+        }
+        _stats.datagrams++;
+        _stats.bytes += len;
+        _last_seen[row] = now_ms;
+
+        bool newer = true;
+        if (_known[row] & KNOWN_SEQ) {
+            int16_t ahead = (int16_t) (seq - _seq[row]);
+            if (ahead <= 0) {
+                newer = false;
+                _stats.reordered++;
+            } else {
+                _stats.lost += ahead - 1;
+            }
+        }
+        if (newer) {
+            _seq[row] = seq;
+            _known[row] |= KNOWN_SEQ;
+        }
+
+        const uint8_t* p = d + FLEET_HEADER_SIZE;
+        if (type == FLEET_STATE) {
+            if (!newer) {
+                _stats.stale_state++;
+                return true;
+            }
+            for (uint8_t i = 0; i < count; i++) {
+                uint8_t field = p[0], flen = p[1];
+                apply_state(row, field, p + 2, flen);
+                p += 2 + flen;
+            }
+        } else {
+            uint32_t epoch = now_ms / EPOCH_MS;
+            for (uint8_t i = 0; i < count; i++) {
+                int t = timing_index(p[0]);
+                uint8_t buckets = p[1];
+                p += 4;
+                uint16_t* half = t >= 0 ? current_half(t, row, epoch) : nullptr;
+                for (uint8_t b = 0; b < buckets; b++, p += 3) {
+                    if (!half || p[0] >= FLEET_BUCKETS) continue;
+                    uint32_t sum = half[p[0]] + (uint32_t) (p[1] | p[2] << 8);
+                    half[p[0]] = (uint16_t) (sum > 0xFFFF ? 0xFFFF : sum);
+                }
+            }
+        }
+        return true;
+    }
+
+    // Pagers under below_x10 (% x10) and not charging
+    size_t low_battery(int32_t below_x10, std::vector<uint32_t>& out) const {
+        out.clear();
+        for (size_t r = 0; r < _count; r++) {
+            if (_battery[r] < below_x10 && !_charging[r] && (_known[r] & KNOWN_BATTERY)) out.push_back(_id[r]);
+        }
+        return out.size();
+    }
+
+    // Pagers not heard from for silent_ms
+    size_t silent(uint32_t now_ms, uint32_t silent_ms, std::vector<uint32_t>& out) const {
+        out.clear();
+        for (size_t r = 0; r < _count; r++) {
+            if (now_ms - _last_seen[r] >= silent_ms) out.push_back(_id[r]);
+        }
+        return out.size();
+    }
+
+    // Pagers per display mode
+    void by_mode(std::vector<std::pair<std::string, uint32_t>>& out) const {
+        std::vector<uint32_t> counts(_names.size() + 1, 0);
+        for (size_t r = 0; r < _count; r++) counts[_mode[r] == NONE ? _names.size() : _mode[r]]++;
+        out.clear();
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (counts[i]) out.emplace_back(i < _names.size() ? _names[i] : "?", counts[i]);
+        }
+    }
+
+    // p50/p99 of a timing metric over the last 1-2 minutes, per firmware
+    void percentiles_by_firmware(Metric m, uint32_t now_ms, std::vector<Percentiles>& out) const {
+        out.clear();
+        int t = timing_index((uint8_t) m);
+        if (t < 0) return;
+        uint32_t epoch = now_ms / EPOCH_MS;
+        // Group sums indexed by firmware name id (NONE last)
+        size_t groups = _names.size() + 1;
+        std::vector<uint32_t> sums(groups * FLEET_BUCKETS, 0);
+        std::vector<uint32_t> devices(groups, 0);
+        const uint16_t* hist = _hist[t].data();
+        for (size_t r = 0; r < _count; r++) {
+            uint32_t e = _epoch[t][r];
+            if (e + 1 < epoch) continue;  // Nothing from the last two minutes
+            size_t g = _firmware[r] == NONE ? groups - 1 : _firmware[r];
+            uint32_t* sum = &sums[g * FLEET_BUCKETS];
+            const uint16_t* cur = hist + (r * 2 + (e & 1)) * FLEET_BUCKETS;
+            for (int b = 0; b < FLEET_BUCKETS; b++) sum[b] += cur[b];
+            if (e == epoch) {
+                const uint16_t* prev = hist + (r * 2 + ((e + 1) & 1)) * FLEET_BUCKETS;
+                for (int b = 0; b < FLEET_BUCKETS; b++) sum[b] += prev[b];
+            }
+            devices[g]++;
+        }
+        for (size_t g = 0; g < groups; g++) {
+            if (!devices[g]) continue;
+            const uint32_t* sum = &sums[g * FLEET_BUCKETS];
+            uint64_t total = 0;
+            for (int b = 0; b < FLEET_BUCKETS; b++) total += sum[b];
+            out.push_back({g < _names.size() ? _names[g] : "?", devices[g], total, quantile(sum, total, 50),
+                           quantile(sum, total, 99)});
+        }
+    }
+
+    // Row fields for one pager (for the "device" query)
+    bool device(uint32_t id, int32_t* battery_x10, bool* charging, int8_t* rssi, uint32_t* heap_free,
+                uint32_t* uptime_s, std::string* mode, std::string* firmware, uint32_t* last_seen_ms) const {
+        uint32_t row = find(id);
+        if (row == NONE32) return false;
+        *battery_x10 = _battery[row];
+        *charging = _charging[row];
+        *rssi = _rssi[row];
+        *heap_free = _heap_free[row];
+        *uptime_s = _uptime[row];
+        *mode = _mode[row] == NONE ? "" : _names[_mode[row]];
+        *firmware = _firmware[row] == NONE ? "" : _names[_firmware[row]];
+        *last_seen_ms = _last_seen[row];
+        return true;
+    }
+
+    size_t devices() const { return _count; }
+    size_t capacity() const { return _capacity; }
+    const Stats& stats() const { return _stats; }
+
+    // Heap held by the table (columns at capacity, id index, names)
+    size_t bytes() const {
+        size_t n = sizeof(*this) + _slots.size() * sizeof(uint32_t);
+        n += _capacity * (sizeof(uint32_t) * 5 + sizeof(uint16_t) * 4 + sizeof(int16_t) + 2);
+        for (int t = 0; t < TIMINGS; t++) n += _epoch[t].size() * sizeof(uint32_t) + _hist[t].size() * sizeof(uint16_t);
+        for (const std::string& s : _names) n += sizeof(std::string) + s.capacity() + 32;  // + map node
+        return n;
+    }
+
+private:
+    static const uint32_t NONE32 = 0xFFFFFFFF;
+    static const uint16_t KNOWN_SEQ = 0x8000;
+    static const uint16_t KNOWN_BATTERY = 1u << (int) FleetField::BATTERY;
+
+    bool malformed() {
+        _stats.malformed++;
+        return false;
+    }
+
+    // Entries stay inside the datagram
+    static bool valid(uint8_t type, const uint8_t* p, const uint8_t* end, uint8_t count) {
+        for (uint8_t i = 0; i < count; i++) {
+            if (type == FLEET_STATE) {
+                if (end - p < 2 || end - p < 2 + p[1]) return false;
+                p += 2 + p[1];
+            } else {
+                if (end - p < 4 || end - p < 4 + 3 * p[1]) return false;
+                p += 4 + 3 * p[1];
+            }
+        }
+        return true;
+    }
+
+    static int timing_index(uint8_t metric) {
+        if (metric == (uint8_t) Metric::LOOP_MS) return 0;
+        if (metric == (uint8_t) Metric::FRAME_MS) return 1;
+        return -1;
+    }
+
+    static uint32_t get32(const uint8_t* p) {
+        return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+    }
+
+    static int32_t quantile(const uint32_t* sum, uint64_t total, int pct) {
+        if (!total) return 0;
+        uint64_t want = (total * pct + 99) / 100, seen = 0;
+        for (int b = 0; b < FLEET_BUCKETS; b++) {
+            seen += sum[b];
+            if (seen >= want) return b < FLEET_BUCKETS - 1 ? FLEET_BUCKET_UPPER[b] : FLEET_BUCKET_UPPER[b - 1];
+        }
+        return FLEET_BUCKET_UPPER[FLEET_BUCKETS - 2];
+    }
+
+    size_t slot_of(uint32_t id) const { return (size_t) ((id * 0x9E3779B1u) >> 7) & (_slots.size() - 1); }
+
+    uint32_t find(uint32_t id) const {
+        for (size_t s = slot_of(id);; s = (s + 1) & (_slots.size() - 1)) {
+            uint32_t v = _slots[s];
+            if (v == 0) return NONE32;
+            if (_id[v - 1] == id) return v - 1;
+        }
+    }
+
+    uint32_t find_or_add(uint32_t id) {
+        size_t s = slot_of(id);
+        for (;; s = (s + 1) & (_slots.size() - 1)) {
+            uint32_t v = _slots[s];
+            if (v == 0) break;
+            if (_id[v - 1] == id) return v - 1;
+        }
+        if (_count == _capacity) return NONE32;
+        uint32_t row = (uint32_t) _count++;
+        _slots[s] = row + 1;
+        _id[row] = id;
+        _known[row] = 0;
+        _mode[row] = _firmware[row] = NONE;
+        for (int t = 0; t < TIMINGS; t++) _epoch[t][row] = 0;
+        return row;
+    }
+
+    uint16_t intern(const uint8_t* text, uint8_t len) {
+        std::string s((const char*) text, len);
+        auto it = _index.find(s);
+        if (it != _index.end()) return it->second;
+        if (_names.size() >= NONE) return NONE;
+        _names.push_back(s);
+        return _index[s] = (uint16_t) (_names.size() - 1);
+    }
+
+    void apply_state(uint32_t row, uint8_t field, const uint8_t* v, uint8_t len) {
+        if (field >= (uint8_t) FleetField::COUNT) return;
+        FleetField f = (FleetField) field;
+        if (fleet_field_is_text(f)) {
+            uint16_t name = intern(v, len);
+            if (f == FleetField::MODE) _mode[row] = name;
+            else _firmware[row] = name;
+        } else {
+            if (len != 4) return;
+            int32_t x = (int32_t) get32(v);
+            switch (f) {
+                case FleetField::BATTERY: _battery[row] = (int16_t) x; break;
+                case FleetField::CHARGING: _charging[row] = x != 0; break;
+                case FleetField::RSSI: _rssi[row] = (int8_t) x; break;
+                case FleetField::HEAP_FREE: _heap_free[row] = (uint32_t) x; break;
+                case FleetField::HEAP_LARGEST: _heap_largest[row] = (uint32_t) x; break;
+                case FleetField::UPTIME_S: _uptime[row] = (uint32_t) x; break;
+                default: break;
+            }
+        }
+        _known[row] |= (uint16_t) (1u << field);
+    }
+
+    // Half for this minute; a new minute clears the half two minutes back
+    uint16_t* current_half(int t, uint32_t row, uint32_t epoch) {
+        uint32_t& e = _epoch[t][row];
+        uint16_t* base = &_hist[t][(size_t) row * 2 * FLEET_BUCKETS];
+        if (epoch != e) {
+            if (epoch < e) return base + (e & 1) * FLEET_BUCKETS;  // Clock went back: keep counting
+            if (epoch > e + 1) memset(base, 0, 2 * FLEET_BUCKETS * sizeof(uint16_t));
+            else memset(base + (epoch & 1) * FLEET_BUCKETS, 0, FLEET_BUCKETS * sizeof(uint16_t));
+            e = epoch;
+        }
+        return base + (epoch & 1) * FLEET_BUCKETS;
+    }
+
+    size_t _capacity;
+    size_t _count;
+    std::vector<uint32_t> _slots;  // Row + 1, 0 = empty
+    // Columns
+    std::vector<uint32_t> _id;
+    std::vector<uint32_t> _last_seen;
+    std::vector<uint16_t> _seq;
+    std::vector<uint16_t> _known;  // Bit per FleetField seen, KNOWN_SEQ
+    std::vector<int16_t> _battery;
+    std::vector<uint8_t> _charging;
+    std::vector<int8_t> _rssi;
+    std::vector<uint32_t> _heap_free;
+    std::vector<uint32_t> _heap_largest;
+    std::vector<uint32_t> _uptime;
+    std::vector<uint16_t> _mode;      // Name id
+    std::vector<uint16_t> _firmware;  // Name id
+    std::vector<uint32_t> _epoch[TIMINGS];  // Minute of the newer histogram half
+    std::vector<uint16_t> _hist[TIMINGS];   // Row x 2 halves x FLEET_BUCKETS
+    // Mode and firmware names
+    std::vector<std::string> _names;
+    std::unordered_map<std::string, uint16_t> _index;
+    Stats _stats;
+};
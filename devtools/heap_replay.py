@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""
+Heap Replay - Reproduces pager heap fragmentation from recorded traces.
+
+heap_telemetry.h records the last alloc/free events per subsystem. Dump them
+with the dump_heap_trace API service and save the log; this tool replays the
+events against a first-fit allocator model of the ESP32 heap and reports
+free bytes, largest free block and fragmentation after every step, so a
+pattern that fails on the device can be studied (and fixed, e.g. by giving a
+subsystem an arena) on the host.
+
+Usage:
+    esphome logs clawd-pager.yaml > pager.log     # after calling dump_heap_trace
+    python -m devtools.heap_replay pager.log --heap 120000
+
+    # Loop the trace to watch fragmentation build up
+    python -m devtools.heap_replay pager.log --repeat 50
+
+    # What if display allocations had come from an arena?
+    python -m devtools.heap_replay pager.log --arena display
+"""
+
+import argparse
+import bisect
+import re
+from dataclasses import dataclass
+from typing import Dict, Iterable, List, Optional, Set, Tuple
+
+# "[12:00:01][I][HEAPTRACE:123]: 51234 A 17 61 display arena"
+TRACE_RE = re.compile(r"HEAPTRACE[^\]]*\]?:\s*(\d+) ([AFX]) (\d+) (\d+) (\w+)( arena)?")
+BEGIN_RE = re.compile(r"HEAPTRACE[^\]]*\]?:\s*begin count=(\d+) free=(\d+) largest=(\d+)")
+
+# ESP-IDF heap: 4-byte alignment plus a block header per allocation
+ALIGN = 4
+BLOCK_OVERHEAD = 8
+# Our hook's header in front of every tracked allocation
+HOOK_HEADER = 8
+
+
+@dataclass
+class TraceEvent:
+    ms: int
+    op: str       # 'A' alloc, 'F' free, 'X' failed alloc
+    id: int
+    size: int
+    tag: str
+    arena: bool
+
+
+def parse_trace(lines: Iterable[str]) -> Tuple[List[TraceEvent], Optional[Tuple[int, int]]]:
+    """Extract the last dumped trace. Returns events and (free, largest) at dump time."""
+    events: List[TraceEvent] = []
+    heap = None
+    for line in lines:
+        m = BEGIN_RE.search(line)
+        if m:
+            events = []  # Keep only the most recent dump
+            heap = (int(m.group(2)), int(m.group(3)))
+            continue
+        m = TRACE_RE.search(line)
+        if m:
+            events.append(TraceEvent(int(m.group(1)), m.group(2), int(m.group(3)),
+                                     int(m.group(4)), m.group(5), bool(m.group(6))))
+    return events, heap
+
+
+class FirstFitHeap:
+    """Address-ordered free list with first-fit allocation and coalescing."""
+
+    def __init__(self, size: int):
+        self.size = size
+        self.free_starts: List[int] = [0]
+        self.free_sizes: Dict[int, int] = {0: size}
+        self.used: Dict[Tuple[int, int], Tuple[int, int]] = {}  # (pass, id) -> (addr, block size)
+        self.failures = 0
+
+    def alloc(self, alloc_id: Tuple[int, int], size: int) -> bool:
+        need = (size + HOOK_HEADER + BLOCK_OVERHEAD + ALIGN - 1) // ALIGN * ALIGN
+        for i, start in enumerate(self.free_starts):
+            block = self.free_sizes[start]
+            if block >= need:
+                del self.free_sizes[start]
+                del self.free_starts[i]
+                if block > need:
+                    rest = start + need
+                    self.free_starts.insert(i, rest)
+                    self.free_sizes[rest] = block - need
+                self.used[alloc_id] = (start, need)
+                return True
+        self.failures += 1
+        return False
+
+    def free(self, alloc_id: Tuple[int, int]):
+        if alloc_id not in self.used:
+            return  # Allocated before the trace window
+        start, size = self.used.pop(alloc_id)
+        i = bisect.bisect_left(self.free_starts, start)
+        # Coalesce with the following free block
+        if i < len(self.free_starts) and self.free_starts[i] == start + size:
+            nxt = self.free_starts.pop(i)
+            size += self.free_sizes.pop(nxt)
+        # Coalesce with the preceding free block
+        if i > 0:
+            prev = self.free_starts[i - 1]
+            if prev + self.free_sizes[prev] == start:
+                self.free_sizes[prev] += size
+                return
+        self.free_starts.insert(i, start)
+        self.free_sizes[start] = size
+
+    @property
+    def free_bytes(self) -> int:
+        return sum(self.free_sizes.values())
+
+    @property
+    def largest(self) -> int:
+        return max(self.free_sizes.values(), default=0)
+
+    @property
+    def fragmentation(self) -> float:
+        free = self.free_bytes
+        return 0.0 if free == 0 else 100.0 * (1 - self.largest / free)
+
+
+def replay(events: List[TraceEvent], heap_size: int, repeat: int = 1,
+           arena_tags: Optional[Set[str]] = None) -> Dict[str, float]:
+    """Replay the trace; returns worst-case numbers across the run."""
+    arena_tags = arena_tags or set()
+    heap = FirstFitHeap(heap_size)
+    worst_largest = heap_size
+    worst_frag = 0.0
+    steps = 0
+    for r in range(repeat):
+        for e in events:
+            # Arena allocations never touch the heap
+            if e.arena or e.tag in arena_tags:
+                continue
+            key = (r, e.id)
+            if e.op == 'A':
+                heap.alloc(key, e.size)
+            elif e.op == 'F':
+                heap.free(key)
+            steps += 1
+            worst_largest = min(worst_largest, heap.largest)
+            worst_frag = max(worst_frag, heap.fragmentation)
+    return {
+        "steps": steps,
+        "free": heap.free_bytes,
+        "largest": heap.largest,
+        "fragmentation_pct": heap.fragmentation,
+        "worst_largest": worst_largest,
+        "worst_fragmentation_pct": worst_frag,
+        "failures": heap.failures,
+        "live_allocs": len(heap.used),
+    }
+
+
+def main():
+    """CLI: replay a trace from a log file."""
+    parser = argparse.ArgumentParser(description='Replay pager heap traces')
+    parser.add_argument('log', help='Log file containing a dump_heap_trace dump')
+    parser.add_argument('--heap', type=int, default=0,
+                        help='Heap size in bytes (default: free heap reported at dump time)')
+    parser.add_argument('--repeat', type=int, default=1, help='Replay the trace N times')
+    parser.add_argument('--arena', action='append', default=[],
+                        help='Treat this tag as arena-backed (repeatable)')
+    args = parser.parse_args()
+
+    with open(args.log, errors='replace') as f:
+        events, heap = parse_trace(f)
+    if not events:
+        print("No HEAPTRACE dump found in log")
+        return
+
+    heap_size = args.heap or (heap[0] if heap else 100_000)
+    by_tag: Dict[str, int] = {}
+    for e in events:
+        if e.op == 'A':
+            by_tag[e.tag] = by_tag.get(e.tag, 0) + e.size
+    print(f"Trace: {len(events)} events over {events[-1].ms - events[0].ms} ms; "
+          f"allocated by tag: " + ", ".join(f"{t}={n}" for t, n in sorted(by_tag.items())))
+    if heap:
+        print(f"Device at dump: free={heap[0]} largest={heap[1]}")
+
+    r = replay(events, heap_size, args.repeat, set(args.arena))
+    print(f"Replay on {heap_size} byte heap x{args.repeat}"
+          f"{' (arena: ' + ', '.join(args.arena) + ')' if args.arena else ''}:")
+    print(f"  end:   free={r['free']} largest={r['largest']} frag={r['fragmentation_pct']:.1f}%")
+    print(f"  worst: largest={r['worst_largest']} frag={r['worst_fragmentation_pct']:.1f}%")
+    print(f"  failed allocations: {r['failures']}, still live: {r['live_allocs']}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,405 @@
+#!/usr/bin/env python3
+"""
+Hook Forwarder - Local daemon between the native hook client and the bridge.
+
+The clawd_hook.cpp client drops each hook event on a Unix datagram socket
+and exits in well under a millisecond. This daemon receives them, builds the
+same rich event claude_hook.py would (via build_event), and posts queued
+events to the bridge in order, one POST /agent each, over one keep-alive
+HTTP connection on a background thread, so a slow or offline bridge never
+delays a tool call. An event the bridge didn't take goes back to the head
+of the queue and is retried with backoff (0.5 s doubling to 30 s); past
+MAX_QUEUE waiting events the oldest are dropped.
+
+Usage:
+    # Run the daemon (or install clawd-hook-forwarder.service)
+    python -m devtools.hook_forwarder
+
+    # Point Claude Code hooks at the native client
+    g++ -O2 -s -o ~/.local/bin/clawd-hook devtools/clawd_hook.cpp
+    clawd-hook TOOL_START < tool.json
+
+    # Compare hook wall time: Python hook vs native client + forwarder,
+    # then check nothing is lost while the bridge is down for a while and
+    # that client and daemon find the same private socket by default
+    python -m devtools.hook_forwarder --bench 1000 --client ~/.local/bin/clawd-hook
+"""
+
+import argparse
+import http.client
+import json
+import os
+import re
+import socket
+import stat
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from collections import deque
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Deque, Dict, List, Optional
+from urllib.parse import urlsplit
+
+from .claude_hook import BRIDGE_URL, build_event
+
+MAX_DATAGRAM = 4 * 1024 * 1024
+MAX_QUEUE = 1000   # Oldest events are dropped past this while the bridge is down
+RETRY_MIN_S = 0.5
+RETRY_MAX_S = 30.0
+
+
+def private_dir(path: str) -> bool:
+    """Ours, a real directory (not a symlink) and closed to group and others."""
+    try:
+        st = os.lstat(path)
+    except OSError:
+        return False
+    return stat.S_ISDIR(st.st_mode) and st.st_uid == os.getuid() and st.st_mode & 0o077 == 0
+
+
+def default_socket_path() -> str:
+    """Same resolution order as clawd_hook.cpp.
+
+    $CLAWD_HOOK_SOCKET, else clawd-hook.sock in $XDG_RUNTIME_DIR, else in a
+    0700 /tmp/clawd-hook-<uid>/ created here. A /tmp directory someone else
+    made first (or left open) is refused rather than used.
+    """
+    if os.environ.get("CLAWD_HOOK_SOCKET"):
+        return os.environ["CLAWD_HOOK_SOCKET"]
+    xdg = os.environ.get("XDG_RUNTIME_DIR")
+    if xdg and private_dir(xdg):
+        return os.path.join(xdg, "clawd-hook.sock")
+    tmp = f"/tmp/clawd-hook-{os.getuid()}"
+    try:
+        os.mkdir(tmp, 0o700)
+    except FileExistsError:
+        pass
+    if not private_dir(tmp):
+        raise PermissionError(f"{tmp} is not a directory private to uid {os.getuid()}")
+    return os.path.join(tmp, "clawd-hook.sock")
+
+
+def parse_datagram(data: bytes) -> Optional[Dict]:
+    """event_type NUL tool_name NUL stdin_json -> bridge event."""
+    parts = data.split(b"\0", 2)
+    if len(parts) < 2:
+        return None
+    event_type = parts[0].decode("utf-8", "replace").upper()
+    tool_name = parts[1].decode("utf-8", "replace") or None
+    tool_input = {}
+    session_id = None
+    if len(parts) == 3 and parts[2].strip():
+        try:
+            payload = json.loads(parts[2])
+            tool_name = payload.get("tool_name", tool_name)
+            tool_input = payload.get("tool_input", {})
+            session_id = payload.get("session_id")
+        except (ValueError, AttributeError):
+            pass  # Use fallback if stdin parsing fails
+    return build_event(event_type, tool_name, tool_input, session_id)
+
+
+class HookForwarder:
+    """Receives hook datagrams and forwards them to the bridge asynchronously."""
+
+    def __init__(self, socket_path: Optional[str] = None, bridge_url: str = BRIDGE_URL):
+        self.socket_path = socket_path or default_socket_path()
+        url = urlsplit(bridge_url)
+        self._host = url.hostname
+        self._port = url.port or 80
+        self._queue: Deque[Dict] = deque(maxlen=MAX_QUEUE)
+        self._wake = threading.Condition()
+        self._conn: Optional[http.client.HTTPConnection] = None
+        self._running = False
+        self._sock: Optional[socket.socket] = None
+        self.received = 0
+        self.forwarded = 0
+        self.failed = 0    # POSTs that didn't go through (the event is retried)
+        self.dropped = 0   # Events lost to MAX_QUEUE
+
+    def start(self):
+        """Bind the socket and start the receive and send threads."""
+        if os.path.exists(self.socket_path):
+            os.unlink(self.socket_path)  # Stale socket from a previous run
+        self._sock = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+        self._sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, MAX_DATAGRAM)
+        old_umask = os.umask(0o077)  # Never open to others, not even until a chmod
+        try:
+            self._sock.bind(self.socket_path)
+        finally:
+            os.umask(old_umask)
+        self._running = True
+        threading.Thread(target=self._receive_loop, daemon=True, name="hook-recv").start()
+        threading.Thread(target=self._send_loop, daemon=True, name="hook-send").start()
+
+    def stop(self):
+        self._running = False
+        with self._wake:
+            self._wake.notify()
+        if self._sock:
+            self._sock.close()
+        if os.path.exists(self.socket_path):
+            os.unlink(self.socket_path)
+
+    def _receive_loop(self):
+        while self._running:
+            try:
+                data = self._sock.recv(MAX_DATAGRAM)
+            except OSError:
+                return
+            event = parse_datagram(data)
+            if event is None:
+                continue
+            with self._wake:
+                self.received += 1
+                if len(self._queue) == MAX_QUEUE:
+                    self.dropped += 1  # append() pushes the oldest out
+                self._queue.append(event)
+                self._wake.notify()
+
+    def pending(self) -> int:
+        with self._wake:
+            return len(self._queue)
+
+    def _send_loop(self):
+        backoff = 0.0
+        while self._running:
+            with self._wake:
+                while self._running and not self._queue:
+                    self._wake.wait()
+                # New events wake the condition too: wait out the whole backoff
+                retry_at = time.monotonic() + backoff
+                while self._running and time.monotonic() < retry_at:
+                    self._wake.wait(retry_at - time.monotonic())
+                if not self._running:
+                    return
+                event = self._queue.popleft()
+            if self._post(event):
+                self.forwarded += 1
+                backoff = 0.0
+                continue
+            self.failed += 1
+            backoff = min(max(backoff * 2, RETRY_MIN_S), RETRY_MAX_S)
+            with self._wake:
+                # Back to the head, in order; if the queue filled up meanwhile
+                # this is the oldest event, so it is the one dropped
+                if len(self._queue) < MAX_QUEUE:
+                    self._queue.appendleft(event)
+                else:
+                    self.dropped += 1
+
+    def _post(self, event: Dict) -> bool:
+        body = json.dumps(event).encode("utf-8")
+        # One retry on a fresh connection (keep-alive may have been closed)
+        for _ in range(2):
+            try:
+                if self._conn is None:
+                    self._conn = http.client.HTTPConnection(self._host, self._port, timeout=2)
+                self._conn.request("POST", "/agent", body, {"Content-Type": "application/json"})
+                self._conn.getresponse().read()
+                return True
+            except (OSError, http.client.HTTPException):
+                if self._conn:
+                    self._conn.close()
+                self._conn = None
+        return False
+
+
+def _time_hooks(cmd: List[str], count: int, env: Dict[str, str]) -> List[float]:
+    """Wall time of count hook invocations, alternating TOOL_START/TOOL_END."""
+    payload = json.dumps({"tool_name": "Edit", "tool_input": {
+        "file_path": "/home/dev/clawd-pager/audio_streamer.h",
+        "old_string": "a\nb\n", "new_string": "a\nb\nc\n"}}).encode()
+    times = []
+    for i in range(count):
+        args = cmd + (["TOOL_START"] if i % 2 == 0 else ["TOOL_END", "Edit"])
+        start = time.perf_counter()
+        subprocess.run(args, input=payload if i % 2 == 0 else b"", env=env,
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        times.append(time.perf_counter() - start)
+    return times
+
+
+def _dummy_bridge(port: int, bodies: List[bytes]) -> ThreadingHTTPServer:
+    """Local stand-in for the bridge's POST /agent; records each body."""
+
+    class Bridge(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def do_POST(self):
+            bodies.append(self.rfile.read(int(self.headers.get("Content-Length", 0))))
+            self.send_response(200)
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+
+        def log_message(self, *args):
+            pass
+
+    server = ThreadingHTTPServer(("127.0.0.1", port), Bridge)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
+
+
+def outage_check(count: int, down_s: float) -> bool:
+    """Bridge down while count events arrive, then up: all delivered, in order."""
+    probe = socket.socket()
+    probe.bind(("127.0.0.1", 0))
+    port = probe.getsockname()[1]
+    probe.close()
+    sock_path = os.path.join(tempfile.mkdtemp(prefix="clawd-hook-"), "outage.sock")
+    forwarder = HookForwarder(sock_path, f"http://127.0.0.1:{port}")
+    forwarder.start()
+    client = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+    for i in range(count):
+        payload = json.dumps({"tool_name": "Read", "tool_input": {"file_path": f"/src/file{i}.cpp"}})
+        client.sendto(b"TOOL_START\0Read\0" + payload.encode(), sock_path)
+    time.sleep(down_s)
+    bodies: List[bytes] = []
+    server = _dummy_bridge(port, bodies)
+    deadline = time.time() + RETRY_MAX_S
+    while len(bodies) < count and time.time() < deadline:
+        time.sleep(0.05)
+    forwarder.stop()
+    server.shutdown()
+    os.rmdir(os.path.dirname(sock_path))
+    order = [int(m.group(1)) for m in (re.search(rb"file(\d+)\.cpp", b) for b in bodies) if m]
+    ok = order == list(range(count)) and forwarder.dropped == 0
+    print(f"Bridge down {down_s:.1f} s with {count} events queued: delivered {len(bodies)}/{count} "
+          f"{'in order' if order == sorted(order) else 'OUT OF ORDER'}, {forwarder.failed} failed POSTs retried, "
+          f"dropped {forwarder.dropped}")
+    return ok
+
+
+def oversized_check(client: str) -> bool:
+    """Tool input over MAX_STDIN: the event still arrives, with its tool name."""
+    bodies: List[bytes] = []
+    server = _dummy_bridge(0, bodies)
+    sock_path = os.path.join(tempfile.mkdtemp(prefix="clawd-hook-"), "big.sock")
+    forwarder = HookForwarder(sock_path, f"http://127.0.0.1:{server.server_port}")
+    forwarder.start()
+    huge = json.dumps({"tool_name": "Write", "tool_input": {"file_path": "/src/big.bin",
+                                                            "content": "x" * (MAX_DATAGRAM + 1)}})
+    subprocess.run([os.path.expanduser(client), "TOOL_START"], input=huge.encode(),
+                   env=dict(os.environ, CLAWD_HOOK_SOCKET=sock_path))
+    deadline = time.time() + 5
+    while not bodies and time.time() < deadline:
+        time.sleep(0.05)
+    forwarder.stop()
+    server.shutdown()
+    os.rmdir(os.path.dirname(sock_path))
+    events = [json.loads(b) for b in bodies]
+    ok = len(events) == 1 and events[0].get("tool") == "Write"
+    print(f"Oversized tool input ({len(huge) >> 20} MB): {len(events)} event(s), "
+          f"tool {events[0].get('tool') if events else None!r}")
+    return ok
+
+
+def default_path_check(client: str) -> bool:
+    """No $CLAWD_HOOK_SOCKET: client and forwarder meet in $XDG_RUNTIME_DIR, and
+    in the private /tmp directory when the forwarder runs without it (as a
+    system service does); the socket is closed to group and others."""
+    ok = True
+    runtime = tempfile.mkdtemp(prefix="clawd-hook-xdg-")
+    for name, forwarder_env in (("XDG_RUNTIME_DIR", {"XDG_RUNTIME_DIR": runtime}), ("/tmp fallback", {})):
+        bodies: List[bytes] = []
+        server = _dummy_bridge(0, bodies)
+        saved = dict(os.environ)
+        os.environ.pop("CLAWD_HOOK_SOCKET", None)
+        os.environ.pop("XDG_RUNTIME_DIR", None)
+        os.environ.update(forwarder_env)
+        try:
+            forwarder = HookForwarder(None, f"http://127.0.0.1:{server.server_port}")
+        finally:
+            os.environ.clear()
+            os.environ.update(saved)
+        forwarder.start()
+        mode = stat.S_IMODE(os.stat(forwarder.socket_path).st_mode)
+        env = {k: v for k, v in os.environ.items() if k != "CLAWD_HOOK_SOCKET"}
+        env["XDG_RUNTIME_DIR"] = runtime
+        subprocess.run([os.path.expanduser(client), "TOOL_START", "Read"], input=b"", env=env)
+        deadline = time.time() + 5
+        while not bodies and time.time() < deadline:
+            time.sleep(0.05)
+        forwarder.stop()
+        server.shutdown()
+        print(f"Default socket, {name}: {forwarder.socket_path} mode {mode:o}, {len(bodies)} event(s)")
+        ok = ok and len(bodies) == 1 and mode & 0o077 == 0
+    os.rmdir(runtime)
+    return ok
+
+
+def bench(count: int, client: Optional[str]) -> bool:
+    """Compare Python hook vs native client + forwarder against a local dummy bridge."""
+    bodies: List[bytes] = []
+    server = _dummy_bridge(0, bodies)
+    bridge_url = f"http://127.0.0.1:{server.server_port}"
+    sock_path = os.path.join(tempfile.mkdtemp(prefix="clawd-hook-"), "bench.sock")
+    env = dict(os.environ, BRIDGE_URL=bridge_url, CLAWD_HOOK_SOCKET=sock_path)
+
+    def report(name: str, times: List[float]):
+        times = sorted(times)
+        print(f"  {name:28s} mean {sum(times) / len(times) * 1000:7.2f} ms   "
+              f"p99 {times[int(len(times) * 0.99) - 1] * 1000:7.2f} ms   "
+              f"total {sum(times):6.2f} s")
+
+    print(f"Hook wall time for {count} tool events:")
+    hook = os.path.join(os.path.dirname(os.path.abspath(__file__)), "claude_hook.py")
+    report("claude_hook.py (urllib)", _time_hooks([sys.executable, hook], count, env))
+    python_posts = len(bodies)
+
+    ok = True
+    if client:
+        forwarder = HookForwarder(sock_path, bridge_url)
+        forwarder.start()
+        bodies.clear()
+        report("clawd-hook + forwarder", _time_hooks([os.path.expanduser(client)], count, env))
+        deadline = time.time() + 10
+        while len(bodies) < count and time.time() < deadline:
+            time.sleep(0.05)
+        forwarder.stop()
+        print(f"  delivered: python {python_posts}/{count}, native {len(bodies)}/{count}")
+        ok = len(bodies) == count
+    else:
+        print("  (pass --client to time the native hook)")
+    server.shutdown()
+    os.rmdir(os.path.dirname(sock_path))
+
+    print()
+    ok = outage_check(min(count, MAX_QUEUE), 3.0) and ok
+    if client:
+        ok = oversized_check(client) and ok
+        ok = default_path_check(client) and ok
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: run the forwarder daemon or the hook benchmark."""
+    parser = argparse.ArgumentParser(description='Clawd hook forwarder daemon')
+    parser.add_argument('--socket', help='Unix socket path (default: as clawd_hook.cpp)')
+    parser.add_argument('--bridge', default=BRIDGE_URL, help='Bridge base URL')
+    parser.add_argument('--bench', type=int, metavar='N', help='Benchmark N hook events and exit')
+    parser.add_argument('--client', help='Native clawd-hook binary for --bench')
+    args = parser.parse_args()
+
+    if args.bench:
+        raise SystemExit(0 if bench(args.bench, args.client) else 1)
+
+    forwarder = HookForwarder(args.socket, args.bridge)
+    forwarder.start()
+    print(f"Forwarding hook events from {forwarder.socket_path} to {args.bridge}")
+    try:
+        while True:
+            time.sleep(60)
+            print(f"received={forwarder.received} forwarded={forwarder.forwarded} failed={forwarder.failed} "
+                  f"queued={forwarder.pending()} dropped={forwarder.dropped}", flush=True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        forwarder.stop()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,142 @@
+// Host stand-in for Arduino's WiFiUdp.h (WiFiUDP, IPAddress)
+//
+// No real sockets: a WiFiUDP bound with begin() can be handed datagrams
+// with host_udp_deliver(port, ...) and reads them back through
+// parsePacket()/read() like the ESP32's. Everything sent lands in
+// host_udp_sent(), tagged with the sending socket's port. begin(0) binds
+// an ephemeral port from 49152, as lwIP does.
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+class IPAddress {
+public:
+    IPAddress() : _addr{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _addr{a, b, c, d} {}
+
+    bool fromString(const char* s) {
+        unsigned a, b, c, d;
+        if (sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return false;
+        _addr[0] = a; _addr[1] = b; _addr[2] = c; _addr[3] = d;
+        return true;
+    }
+
+    std::string toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _addr[0], _addr[1], _addr[2], _addr[3]);
+        return buf;
+    }
+
+    uint8_t operator[](int i) const { return _addr[i]; }
+    bool operator==(const IPAddress& o) const { return memcmp(_addr, o._addr, 4) == 0; }
+
+private:
+    uint8_t _addr[4];
+};
+
+struct HostDatagram {
+    uint16_t src_port;
+    IPAddress remote_ip;  // Destination when sent, sender when received
+    uint16_t dst_port;
+    std::vector<uint8_t> data;
+};
+
+class WiFiUDP;
+
+// Never destroyed: singletons' sockets unregister during static teardown
+inline std::vector<WiFiUDP*>& host_udp_sockets() {
+    static std::vector<WiFiUDP*>* sockets = new std::vector<WiFiUDP*>();
+    return *sockets;
+}
+
+inline std::vector<HostDatagram>& host_udp_sent() {
+    static std::vector<HostDatagram> sent;
+    return sent;
+}
+
+class WiFiUDP {
+public:
+    ~WiFiUDP() { stop(); }
+
+    uint8_t begin(uint16_t port) {
+        static uint16_t ephemeral = 49152;
+        stop();
+        _port = port ? port : ephemeral++;
+        host_udp_sockets().push_back(this);
+        return 1;
+    }
+
+    void stop() {
+        auto& s = host_udp_sockets();
+        for (size_t i = 0; i < s.size(); i++) {
+            if (s[i] == this) {
+                s.erase(s.begin() + i);
+                break;
+            }
+        }
+    }
+
+    uint16_t localPort() const { return _port; }
+
+    int beginPacket(IPAddress ip, uint16_t port) {
+        _out = HostDatagram{_port, ip, port, {}};
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t len) {
+        _out.data.insert(_out.data.end(), data, data + len);
+        return len;
+    }
+
+    int endPacket() {
+        host_udp_sent().push_back(_out);
+        return 1;
+    }
+
+    // Next datagram; its size, 0 when none is waiting
+    int parsePacket() {
+        if (_inbox.empty()) return 0;
+        _rx = _inbox.front();
+        _inbox.pop_front();
+        _rx_pos = 0;
+        return (int) _rx.data.size();
+    }
+
+    int read(uint8_t* buf, size_t len) {
+        size_t n = _rx.data.size() - _rx_pos;
+        if (n > len) n = len;
+        memcpy(buf, _rx.data.data() + _rx_pos, n);
+        _rx_pos += n;
+        return (int) n;
+    }
+
+    IPAddress remoteIP() const { return _rx.remote_ip; }
+    uint16_t remotePort() const { return _rx.src_port; }
+
+    void deliver(const uint8_t* data, size_t len, uint16_t src_port) {
+        _inbox.push_back(HostDatagram{src_port, IPAddress(127, 0, 0, 1), _port, std::vector<uint8_t>(data, data + len)});
+    }
+
+private:
+    uint16_t _port = 0;
+    HostDatagram _out;
+    HostDatagram _rx;
+    size_t _rx_pos = 0;
+    std::deque<HostDatagram> _inbox;
+};
+
+// Queue a datagram for the socket bound to port; false if none is
+inline bool host_udp_deliver(uint16_t port, const uint8_t* data, size_t len, uint16_t src_port = 12345) {
+    for (WiFiUDP* s : host_udp_sockets()) {
+        if (s->localPort() == port) {
+            s->deliver(data, len, src_port);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,174 @@
+// Host stand-in for the slice of esphome.h the pager headers use
+//
+// Lets devtools benches compile display_modes/*.h and the root headers
+// natively:
+//   g++ -O2 -I. -Idevtools/host ...
+//
+// Arduino's millis()/micros() are the host's steady clock; ESP_LOGx
+// prints to stderr, so bench output on stdout stays parseable.
+// devtools/host/WiFiUdp.h is the matching socket stand-in.
+//
+// Drawing follows ESPHome's Display: every primitive comes down to
+// draw_pixel_at (filled_circle is the same midpoint loop as
+// esphome/components/display/display.cpp), which rotates and calls the
+// driver's draw_absolute_pixel_internal. HostDisplay is the pager's
+// st7789v: 135x240 panel, rotation 270 (240x135 logical), big-endian
+// RGB565. draw_pixel_at calls are counted, clipped ones included: that is
+// the per-frame cost the modes declare (RenderCost).
+
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+struct Color {
+    uint8_t r, g, b, w;
+
+    Color() : r(0), g(0), b(0), w(0) {}
+    Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) : r(r), g(g), b(b), w(w) {}
+
+    static const Color BLACK;
+    static const Color WHITE;
+};
+inline const Color Color::BLACK(0, 0, 0);
+inline const Color Color::WHITE(255, 255, 255);
+
+inline uint32_t millis() {
+    using namespace std::chrono;
+    return (uint32_t) duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline uint32_t micros() {
+    using namespace std::chrono;
+    return (uint32_t) duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// esphome/core/helpers.h: the ESP32's hardware RNG there
+inline uint32_t random_uint32() {
+    static std::random_device rd;
+    return rd();
+}
+
+namespace display {
+
+class DisplayBuffer {
+public:
+    virtual ~DisplayBuffer() {}
+
+    int get_width() const { return 240; }
+    int get_height() const { return 135; }
+
+    void fill(Color color) { filled_rectangle(0, 0, get_width(), get_height(), color); }
+
+    void filled_rectangle(int x1, int y1, int width, int height, Color color) {
+        for (int y = y1; y < y1 + height; y++)
+            for (int x = x1; x < x1 + width; x++) draw_pixel_at(x, y, color);
+    }
+
+    void horizontal_line(int x, int y, int width, Color color) {
+        for (int i = x; i < x + width; i++) draw_pixel_at(i, y, color);
+    }
+
+    void vertical_line(int x, int y, int height, Color color) {
+        for (int i = y; i < y + height; i++) draw_pixel_at(x, i, color);
+    }
+
+    void rectangle(int x1, int y1, int width, int height, Color color) {
+        horizontal_line(x1, y1, width, color);
+        horizontal_line(x1, y1 + height - 1, width, color);
+        vertical_line(x1, y1, height, color);
+        vertical_line(x1 + width - 1, y1, height, color);
+    }
+
+    void filled_circle(int center_x, int center_y, int radius, Color color) {
+        int dx = -radius, dy = 0, err = 2 - 2 * radius, e2;
+        do {
+            for (int hline = center_x + dx; hline <= center_x - dx; hline++) {
+                draw_pixel_at(hline, center_y + dy, color);
+                draw_pixel_at(hline, center_y - dy, color);
+            }
+            e2 = err;
+            if (e2 < dy) {
+                dy++;
+                err += dy * 2 + 1;
+                if (-dx == dy && e2 <= dx) e2 = 0;
+            }
+            if (e2 > dx) {
+                dx++;
+                err += dx * 2 + 1;
+            }
+        } while (dx <= 0);
+    }
+
+    void draw_pixel_at(int x, int y, Color color) {
+        pixel_calls++;
+        if (x < 0 || y < 0 || x >= get_width() || y >= get_height()) return;
+        // Rotation 270
+        draw_absolute_pixel_internal(y, 239 - x, color);
+    }
+
+    uint64_t pixel_calls = 0;
+
+protected:
+    virtual void draw_absolute_pixel_internal(int x, int y, Color color) = 0;
+    virtual int get_width_internal() = 0;
+    virtual int get_height_internal() = 0;
+
+    // The panel framebuffer and rotation in degrees, as ESPHome's
+    // DisplayBuffer/Display keep them (screen_capture.h's FrameBufferPeek)
+    uint8_t* buffer_ = nullptr;
+    int rotation_ = 0;
+};
+
+class HostDisplay : public DisplayBuffer {
+public:
+    static const int PANEL_W = 135, PANEL_H = 240;
+
+    HostDisplay() : buffer(PANEL_W * PANEL_H, 0) {
+        buffer_ = reinterpret_cast<uint8_t*>(buffer.data());
+        rotation_ = 270;
+    }
+    HostDisplay(const HostDisplay&) = delete;
+
+    std::vector<uint16_t> buffer;
+
+protected:
+    int get_width_internal() override { return PANEL_W; }
+    int get_height_internal() override { return PANEL_H; }
+
+    void draw_absolute_pixel_internal(int x, int y, Color color) override {
+        uint16_t c = (uint16_t) ((color.r >> 3) << 11 | (color.g >> 2) << 5 | (color.b >> 3));
+        buffer[(size_t) y * PANEL_W + x] = (uint16_t) (c >> 8 | c << 8);
+    }
+};
+
+}  // namespace display
+}  // namespace esphome
+
+// Arduino core
+inline uint32_t millis() { return esphome::millis(); }
+inline uint32_t micros() { return esphome::micros(); }
+
+inline void host_log(char level, const char* tag, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[%c][%s] ", level, tag);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+#define ESP_LOGE(tag, ...) host_log('E', tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) host_log('W', tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) host_log('I', tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) host_log('D', tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) host_log('V', tag, __VA_ARGS__)
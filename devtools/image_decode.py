@@ -0,0 +1,405 @@
+#!/usr/bin/env python3
+"""
+Image Decode - Fixtures and reference check for the pager's image decoder.
+
+push_image accepts baseline JPEG and PNG as well as the raw 1-bit frame.
+image_decoder.h decodes strip by strip (an MCU row of JPEG, a scanline of
+PNG) at 1/1, 1/2, 1/4 or 1/8 scale, so the bridge can push the original
+file instead of converting it first.
+
+This script builds a fixture set with Pillow and runs the native bench
+(devtools/image_decode_bench.cpp) over it at every scale. It compares each
+result with Pillow's decode of the same file: JPEG through libjpeg's own
+DCT scaling (draft mode, luma only), PNG composited over white and
+box-reduced. It reports decode time, peak working memory and PSNR.
+
+Encoding for the pager: keep JPEG baseline (progressive=False). PngDecoder
+keeps its zlib window in a fixed 4 KB buffer and refuses PNGs that declare
+more. Pillow (and most encoders) declare 32 KB, so write_png() here uses a
+1 KB window and shrink_window() re-deflates any PNG's image data to fit;
+the fixture set keeps one stock PNG to check that it is refused.
+
+Usage:
+    g++ -O2 -o /tmp/image-decode-bench devtools/image_decode_bench.cpp
+    python -m devtools.image_decode --bench --bin /tmp/image-decode-bench
+
+    # Corrupted copies of every fixture through a sanitizer build
+    g++ -O1 -g -fsanitize=address,undefined -fno-sanitize-recover=all -o /tmp/image-decode-asan devtools/image_decode_bench.cpp
+    python -m devtools.image_decode --bench --bin /tmp/image-decode-asan --fuzz 300
+
+    # Pager-friendly PNG (small zlib window) from any image
+    python -m devtools.image_decode --png-out small.png photo.jpg
+
+    # Or keep a PNG as it is (palette, 16-bit...) and only shrink its window
+    png = shrink_window(open("shot.png", "rb").read())
+"""
+
+import argparse
+import math
+import os
+import struct
+import subprocess
+import tempfile
+import zlib
+from typing import Dict, List, Optional, Tuple
+
+try:
+    from PIL import Image, ImageDraw, ImageFilter
+except ImportError:  # Only needed for fixtures and the reference decode
+    Image = None
+
+SCREEN = (240, 135)
+JPEG_MAX_DIFF = 2         # Float IDCT vs libjpeg's integer one, any scale
+PNG_MAX_DIFF = 1          # Lossless: only gray weights and box rounding differ
+PAGER_WBITS = 12          # PngDecoder::WINDOW_BYTES = 4 KB
+
+# Fixtures the decoder must refuse, by name suffix: expected error
+REFUSED = {
+    "_w32k": "zlib window",       # Stock PNG: window over the static budget
+    "_dht_oversub": "bad DHT",    # AC table with 150 one-bit codes
+    "_dht_class": "bad DHT",      # Table class 2
+}
+
+
+def write_png(path: str, img, wbits: int = 10, filters: Tuple[int, ...] = (0, 1, 2, 3, 4)):
+    """PNG with a small zlib window, cycling row filters (L, LA, RGB, RGBA)."""
+    color = {"L": 0, "LA": 4, "RGB": 2, "RGBA": 6}[img.mode]
+    channels = len(img.mode)
+    width, height = img.size
+    raw = img.tobytes()
+    stride = width * channels
+    out = bytearray()
+    prev = bytes(stride)
+    for y in range(height):
+        line = raw[y * stride:(y + 1) * stride]
+        f = filters[y % len(filters)]
+        out.append(f)
+        out += _filter(f, line, prev, channels)
+        prev = line
+    z = zlib.compressobj(9, zlib.DEFLATED, wbits)
+    data = z.compress(bytes(out)) + z.flush()
+
+    def chunk(kind: bytes, body: bytes) -> bytes:
+        return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", zlib.crc32(kind + body))
+
+    ihdr = struct.pack(">IIBBBBB", width, height, 8, color, 0, 0, 0)
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", ihdr))
+        # Several IDAT chunks so the decoder has to stream across them
+        for i in range(0, len(data), 4096):
+            f.write(chunk(b"IDAT", data[i:i + 4096]))
+        f.write(chunk(b"IEND", b""))
+
+
+def shrink_window(png: bytes, wbits: int = PAGER_WBITS) -> bytes:
+    """Same PNG with its image data re-deflated using a 2^wbits byte window."""
+    pos = 8
+    head, idat, tail = bytearray(png[:8]), bytearray(), bytearray()
+    while pos + 12 <= len(png):
+        n, = struct.unpack(">I", png[pos:pos + 4])
+        kind = png[pos + 4:pos + 8]
+        whole = png[pos:pos + 12 + n]
+        if kind == b"IDAT":
+            idat += png[pos + 8:pos + 8 + n]
+        elif idat:
+            tail += whole
+        else:
+            head += whole
+        pos += 12 + n
+    z = zlib.compressobj(9, zlib.DEFLATED, wbits)
+    data = z.compress(zlib.decompress(bytes(idat))) + z.flush()
+    body = b"".join(struct.pack(">I", len(data[i:i + 4096])) + b"IDAT" + data[i:i + 4096] +
+                    struct.pack(">I", zlib.crc32(b"IDAT" + data[i:i + 4096])) for i in range(0, len(data), 4096))
+    return bytes(head) + body + bytes(tail)
+
+
+def _patch_dht(jpeg: bytes, patch) -> bytes:
+    """JPEG with patch(table) applied to the first AC Huffman table in place.
+
+    table is a bytearray view of Tc/Th, the 16 counts and the values.
+    """
+    out = bytearray(jpeg)
+    pos = 2
+    while pos + 4 <= len(out) and out[pos] == 0xFF:
+        marker = out[pos + 1]
+        n, = struct.unpack(">H", out[pos + 2:pos + 4])
+        if marker == 0xC4:
+            p, end = pos + 4, pos + 2 + n
+            while p + 17 <= end:
+                total = sum(out[p + 1:p + 17])
+                if out[p] >> 4 == 1:
+                    table = out[p:p + 17 + total]
+                    patch(table)
+                    out[p:p + 17 + total] = table
+                    return bytes(out)
+                p += 17 + total
+        if marker == 0xDA:
+            break
+        pos += 2 + n
+    raise ValueError("no AC Huffman table")
+
+
+def _oversubscribe(table: bytearray):
+    # Same number of values, but 150 codes of length 1 (only 2 exist): the
+    # old decoder wrote its 8-bit lookup table out of bounds
+    total = sum(table[1:17])
+    table[1:17] = bytes([min(150, total)] + [0] * 14 + [total - min(150, total)])
+
+
+def _bad_class(table: bytearray):
+    table[0] = 0x20 | (table[0] & 0x0F)
+
+
+def _filter(f: int, line: bytes, prev: bytes, bpp: int) -> bytes:
+    out = bytearray(len(line))
+    for i, v in enumerate(line):
+        a = line[i - bpp] if i >= bpp else 0
+        b = prev[i]
+        c = prev[i - bpp] if i >= bpp else 0
+        if f == 0:
+            p = 0
+        elif f == 1:
+            p = a
+        elif f == 2:
+            p = b
+        elif f == 3:
+            p = (a + b) // 2
+        else:
+            pa, pb, pc = abs(b - c), abs(a - c), abs(a + b - 2 * c)
+            p = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+        out[i] = (v - p) & 0xFF
+    return bytes(out)
+
+
+def _photo(w: int, h: int, seed: int):
+    """Smooth shading, edges and grain: stands in for a camera image."""
+    img = Image.new("RGB", (w, h))
+    px = img.load()
+    for y in range(h):
+        for x in range(w):
+            r = int(128 + 100 * math.sin(x / 37.0 + seed) * math.cos(y / 23.0))
+            g = int(128 + 90 * math.sin((x + y) / 51.0))
+            b = int(255 * y / h)
+            px[x, y] = (r, g, b)
+    draw = ImageDraw.Draw(img)
+    for i in range(6):
+        cx, cy = (i * 97 + seed * 13) % w, (i * 53 + seed * 29) % h
+        rad = 10 + (i * 17) % 50
+        draw.ellipse((cx - rad, cy - rad, cx + rad, cy + rad), fill=((i * 70) % 256, 200 - i * 30, i * 40))
+    return img.filter(ImageFilter.GaussianBlur(0.8))
+
+
+def _screenshot(w: int, h: int):
+    """Text and flat UI blocks: stands in for a terminal or diagram capture."""
+    img = Image.new("RGB", (w, h), (250, 250, 250))
+    draw = ImageDraw.Draw(img)
+    draw.rectangle((0, 0, w, 18), fill=(40, 44, 52))
+    for i in range(h // 14):
+        draw.text((6, 22 + i * 14), f"{i:3d}  def handle(event): return dispatch(event, {i * 7})", fill=(20, 20, 20))
+    draw.rectangle((w - 80, 30, w - 10, 90), outline=(200, 30, 30), width=3)
+    return img
+
+
+def build_fixtures(out_dir: str) -> List[str]:
+    """Write the fixture set; returns file paths."""
+    photo = _photo(640, 360, 1)
+    odd = _photo(333, 197, 2)
+    shot = _screenshot(480, 270)
+    paths = []
+
+    def save(name: str, img, **kw):
+        path = os.path.join(out_dir, name)
+        img.save(path, **kw)
+        if name.endswith(".png"):
+            with open(path, "rb") as f:
+                png = shrink_window(f.read())
+            with open(path, "wb") as f:
+                f.write(png)
+        paths.append(path)
+
+    save("photo_420_q85.jpg", photo, quality=85, subsampling=2)
+    save("photo_444_q95.jpg", photo, quality=95, subsampling=0)
+    save("photo_422_q75.jpg", photo, quality=75, subsampling=1)
+    save("photo_gray_q90.jpg", photo.convert("L"), quality=90)
+    save("odd_420_q80.jpg", odd, quality=80, subsampling=2)
+    save("shot_420_q90.jpg", shot, quality=90, subsampling=2)
+    save("photo_restart.jpg", photo, quality=85, subsampling=2, restart_marker_blocks=5)
+    save("screen_420_q85.jpg", photo.resize(SCREEN), quality=85)
+
+    save("shot_rgb.png", shot)
+    save("shot_palette.png", shot.quantize(16))
+    save("shot_1bit.png", shot.convert("L").point(lambda v: 255 if v > 128 else 0).convert("1"))
+    save("odd_rgba.png", _with_alpha(odd))
+    save("odd_la.png", _with_alpha(odd).convert("LA"))
+    save("photo_gray16.png", photo.convert("L").point(lambda v: v * 257, "I").convert("I;16"))
+    pal = shot.quantize(8)
+    pal.info["transparency"] = 0
+    save("shot_palette_trns.png", pal, transparency=0)
+    stock = os.path.join(out_dir, "shot_rgb_w32k.png")  # As Pillow writes it: refused
+    shot.save(stock)
+    paths.append(stock)
+    with open(os.path.join(out_dir, "screen_420_q85.jpg"), "rb") as f:
+        jpeg = f.read()
+    for name, patch in (("screen_dht_oversub.jpg", _oversubscribe), ("screen_dht_class.jpg", _bad_class)):
+        path = os.path.join(out_dir, name)
+        with open(path, "wb") as f:
+            f.write(_patch_dht(jpeg, patch))
+        paths.append(path)
+    for name, img in (("photo_rgb_w1k.png", photo), ("odd_la_w1k.png", _with_alpha(odd).convert("LA")),
+                      ("screen_gray_w1k.png", photo.resize(SCREEN).convert("L"))):
+        path = os.path.join(out_dir, name)
+        write_png(path, img)
+        paths.append(path)
+    return paths
+
+
+def _with_alpha(img):
+    rgba = img.convert("RGBA")
+    w, h = rgba.size
+    alpha = Image.linear_gradient("L").resize((w, h))
+    rgba.putalpha(alpha)
+    return rgba
+
+
+def reference(path: str, shift: int):
+    """Pillow's grayscale decode at 1/2^shift, as the pager would show it."""
+    img = Image.open(path)
+    w, h = img.size
+    size = ((w + (1 << shift) - 1) >> shift, (h + (1 << shift) - 1) >> shift)
+    if img.format == "JPEG":
+        # libjpeg DCT scaling, luma only; draft() picks the scale from floor sizes
+        img.draft("L", (max(1, w >> shift), max(1, h >> shift)))
+        img = img.convert("L")
+        return img if img.size == size else img.resize(size, Image.BOX)
+    if img.mode in ("I", "I;16", "I;16B"):
+        img = img.point(lambda v: v * (1 / 256)).convert("L")
+    elif img.mode == "P" and "transparency" in img.info:
+        img = img.convert("RGBA")
+    if img.mode in ("RGBA", "LA", "PA"):
+        rgba = img.convert("RGBA")
+        white = Image.new("RGBA", rgba.size, (255, 255, 255, 255))
+        img = Image.alpha_composite(white, rgba)
+    img = img.convert("L")
+    return img.reduce(1 << shift) if shift else img
+
+
+def compare(a, b) -> Tuple[float, int]:
+    """(PSNR dB, max abs difference) of two same-size L images."""
+    pa, pb = a.tobytes(), b.tobytes()
+    se = 0
+    worst = 0
+    for x, y in zip(pa, pb):
+        d = abs(x - y)
+        se += d * d
+        worst = max(worst, d)
+    mse = se / max(1, len(pa))
+    return (99.0 if mse == 0 else 10 * math.log10(255 * 255 / mse)), worst
+
+
+def run_bench(binary: str, files: List[str], shift: int, out_dir: str, repeat: int) -> Dict[str, Dict]:
+    out = subprocess.run([binary, "-s", str(shift), "-n", str(repeat), "-o", out_dir] + files,
+                         capture_output=True, text=True, check=True).stdout
+    results = {}
+    for line in out.splitlines():
+        head, _, error = line.partition(" error=")
+        parts = head.split()
+        fields = dict(p.split("=", 1) for p in parts[3:] if "=" in p)
+        results[parts[0]] = {"format": parts[1], "size": parts[2], "ok": not error,
+                             "us": float(fields.get("us", 0)), "peak_heap": int(fields.get("peak_heap", 0)),
+                             "static": int(fields.get("static", 0)), "error": error}
+    return results
+
+
+def fuzz(binary: str, files: List[str], runs: int) -> bool:
+    """Corrupted copies of each fixture; any sanitizer report or crash fails."""
+    out = subprocess.run([binary, "-z", str(runs), "-s", "1"] + files, capture_output=True, text=True)
+    total = decoded = 0
+    for line in out.stdout.splitlines():
+        if line.startswith("fuzz "):
+            fields = dict(p.split("=", 1) for p in line.split()[2:])
+            total += int(fields["runs"])
+            decoded += int(fields["decoded"])
+    ok = out.returncode == 0 and total == runs * len(files)
+    print(f"Fuzz: {total} corrupted inputs, {decoded} still decoded, {total - decoded} refused"
+          f"{'' if ok else ' - CRASHED'}")
+    if not ok:
+        print(out.stderr[-2000:])
+    return ok
+
+
+def bench(binary: str, repeat: int, fuzz_runs: int = 0) -> bool:
+    all_ok = True
+    with tempfile.TemporaryDirectory() as tmp:
+        files = build_fixtures(tmp)
+        if fuzz_runs:
+            all_ok = fuzz(binary, files, fuzz_runs)
+            print("PASS" if all_ok else "FAIL")
+            return all_ok
+        static = 0
+        max_heap = 0
+        print(f"{'fixture':<22} {'bytes':>7} {'scale':>5} {'out':>8} {'decode':>9} {'heap':>7} "
+              f"{'PSNR':>6} {'maxd':>4}")
+        for shift in range(4):
+            results = run_bench(binary, files, shift, tmp, repeat)
+            for path in files:
+                r = results[path]
+                name = os.path.basename(path)
+                base = os.path.splitext(name)[0]
+                if not r["ok"] and "too wide" in r["error"]:
+                    continue  # Past MAX_WIDTH at this scale; the pager picks a smaller one
+                expect = next((err for suffix, err in REFUSED.items() if base.endswith(suffix)), None)
+                if expect:
+                    refused = not r["ok"] and expect in r["error"]
+                    all_ok &= refused
+                    print(f"{name:<22} {os.path.getsize(path):>7} {'1/' + str(1 << shift):>5} "
+                          f"{'refused: ' + r['error'] if refused else 'DECODED, expected a refusal'}")
+                    continue
+                if not r["ok"]:
+                    print(f"{name:<22} FAILED at 1/{1 << shift}: {r['error']}")
+                    all_ok = False
+                    continue
+                static = r["static"]
+                if r["format"] == "png":
+                    max_heap = max(max_heap, r["peak_heap"])
+                ours = Image.open(os.path.join(tmp, f"{base}.s{shift}.pgm"))
+                psnr, worst = compare(ours, reference(path, shift))
+                good = worst <= (JPEG_MAX_DIFF if r["format"] == "jpeg" else PNG_MAX_DIFF)
+                all_ok &= good
+                print(f"{name:<22} {os.path.getsize(path):>7} {'1/' + str(1 << shift):>5} {r['size']:>8} "
+                      f"{r['us'] / 1000:>7.2f}ms {r['peak_heap']:>7} {psnr:>6.1f} {worst:>4}"
+                      f"{'' if good else '  <-- MISMATCH'}")
+        print(f"Decoder static footprint: {static} bytes (heap column: peak allocations per decode)")
+        if max_heap:
+            print(f"PNG decode allocated up to {max_heap} bytes; its buffers should all be static")
+            all_ok = False
+    print("PASS" if all_ok else "FAIL")
+    return all_ok
+
+
+def main():
+    """CLI: fixture benchmark against Pillow, or write a pager-friendly PNG."""
+    parser = argparse.ArgumentParser(description='Pager image decoder bench')
+    parser.add_argument('--bench', action='store_true', help='Decode the fixture set and check it')
+    parser.add_argument('--bin', default='/tmp/image-decode-bench', help='Built image_decode_bench.cpp')
+    parser.add_argument('--repeat', type=int, default=5, help='Timed decodes per file')
+    parser.add_argument('--fuzz', type=int, default=0, help='Decode this many corrupted copies of each fixture instead')
+    parser.add_argument('--png-out', help='Write this PNG (1 KB zlib window, fit to the screen)')
+    parser.add_argument('image', nargs='?', help='Source image for --png-out')
+    args = parser.parse_args()
+
+    if Image is None:
+        raise SystemExit("Pillow is required: pip install pillow")
+    if args.png_out and args.image:
+        img = Image.open(args.image)
+        img.thumbnail(SCREEN)
+        write_png(args.png_out, img.convert("RGBA" if "A" in img.getbands() else "RGB"))
+        print(f"Wrote {args.png_out} ({img.size[0]}x{img.size[1]}, {os.path.getsize(args.png_out)} bytes)")
+        return
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin, args.repeat, args.fuzz) else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,172 @@
+// Image Decode Bench - host build of image_decoder.h
+//
+// Decodes each file at a given scale, writes the grayscale result as PGM,
+// and prints one line per file: size, decode time and memory. Memory is the
+// decoder's static footprint plus the peak of everything allocated with new
+// during the decode (0 for both formats: their buffers are in the static
+// decoder; anything here is a regression).
+// image_decode.py drives this over a fixture set and checks the output
+// against a reference decoder.
+//
+// -z runs decodes that many corrupted copies of each file instead: cut at a
+// random length, 1-8 random bits flipped, or both. Built with
+// -fsanitize=address,undefined, any out-of-bounds access stops the run.
+//
+// Build:
+//   g++ -O2 -o /tmp/image-decode-bench devtools/image_decode_bench.cpp
+//   g++ -O1 -g -fsanitize=address,undefined -fno-sanitize-recover=all -o /tmp/image-decode-asan devtools/image_decode_bench.cpp
+//
+// Usage:
+//   image-decode-bench [-s shift] [-n repeat] [-o out_dir] file...
+//   -> <file> <format> <w>x<h> <ok|error> us=<per decode> peak_heap=<bytes> static=<bytes>
+//   image-decode-bench -z runs [-s shift] file...
+//   -> fuzz <file> runs=<n> decoded=<n> refused=<n>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../image_decoder.h"
+
+static size_t g_heap_now = 0;
+static size_t g_heap_peak = 0;
+
+void* operator new(size_t n) {
+    size_t* p = static_cast<size_t*>(malloc(n + sizeof(size_t) * 2));
+    if (!p) throw std::bad_alloc();
+    p[0] = n;
+    g_heap_now += n;
+    if (g_heap_now > g_heap_peak) g_heap_peak = g_heap_now;
+    return p + 2;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    size_t* p = static_cast<size_t*>(ptr) - 2;
+    g_heap_now -= p[0];
+    free(p);
+}
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+
+static bool read_file(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buf[16384];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+static std::string base_name(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.rfind('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+// Decode corrupted copies; a crash here is the failure
+static void fuzz(const char* path, const std::vector<uint8_t>& data, int shift, int runs) {
+    uint32_t x = 2463534242u;
+    auto next = [&]() {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    };
+    RowSink sink = [](int, const uint8_t*, int) {};
+    int decoded = 0;
+    for (int r = 0; r < runs; r++) {
+        std::vector<uint8_t> bad = data;
+        uint32_t kind = next() % 3;
+        if (kind != 1) bad.resize(next() % (bad.size() + 1));
+        if (kind != 0 && !bad.empty()) {
+            for (uint32_t k = 0, flips = 1 + next() % 8; k < flips; k++) bad[next() % bad.size()] ^= 1 << (next() % 8);
+        }
+        ImageInfo info;
+        if (!image_probe(bad.data(), bad.size(), &info)) continue;
+        decoded += image_decoder().decode(bad.data(), bad.size(), info.format, (uint8_t) shift, sink);
+    }
+    printf("fuzz %s runs=%d decoded=%d refused=%d\n", path, runs, decoded, runs - decoded);
+}
+
+int main(int argc, char** argv) {
+    int shift = 0, repeat = 5, runs = 0;
+    std::string out_dir;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-s" && i + 1 < argc) shift = atoi(argv[++i]);
+        else if (a == "-n" && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (a == "-o" && i + 1 < argc) out_dir = argv[++i];
+        else if (a == "-z" && i + 1 < argc) runs = atoi(argv[++i]);
+        else files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        fprintf(stderr, "usage: %s [-s shift] [-n repeat] [-o out_dir] [-z runs] file...\n", argv[0]);
+        return 2;
+    }
+    if (repeat < 1) repeat = 1;
+
+    // Static like on the pager; constructed before any measurement
+    ImageDecoder& dec = image_decoder();
+
+    for (const char* path : files) {
+        std::vector<uint8_t> data;
+        if (!read_file(path, data)) {
+            printf("%s - 0x0 error=unreadable\n", path);
+            continue;
+        }
+        if (runs > 0) {
+            fuzz(path, data, shift, runs);
+            continue;
+        }
+        ImageInfo info;
+        if (!image_probe(data.data(), data.size(), &info)) {
+            printf("%s - 0x0 error=unknown-format\n", path);
+            continue;
+        }
+        int out_w = (info.width + (1 << shift) - 1) >> shift;
+        int out_h = (info.height + (1 << shift) - 1) >> shift;
+        std::vector<uint8_t> pixels((size_t) out_w * out_h, 0);
+        int rows = 0;
+        RowSink sink = [&](int y, const uint8_t* gray, int width) {
+            if (y < out_h) memcpy(&pixels[(size_t) y * out_w], gray, width < out_w ? width : out_w);
+            rows++;
+        };
+
+        // First run measures memory (output buffer already allocated)
+        size_t base = g_heap_now;
+        g_heap_peak = g_heap_now;
+        bool ok = dec.decode(data.data(), data.size(), info.format, (uint8_t) shift, sink);
+        size_t peak = g_heap_peak - base;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeat && ok; r++) dec.decode(data.data(), data.size(), info.format, (uint8_t) shift, sink);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / repeat;
+
+        const char* fmt = info.format == ImageFormat::JPEG ? "jpeg" : "png";
+        if (!ok) {
+            printf("%s %s %dx%d error=%s\n", path, fmt, out_w, out_h, dec.error());
+            continue;
+        }
+        printf("%s %s %dx%d ok us=%.0f peak_heap=%u static=%u\n", path, fmt, out_w, out_h, us,
+               (unsigned) peak, (unsigned) ImageDecoder::storage_bytes());
+
+        if (!out_dir.empty()) {
+            std::string out = out_dir + "/" + base_name(path) + ".s" + std::to_string(shift) + ".pgm";
+            FILE* f = fopen(out.c_str(), "wb");
+            if (f) {
+                fprintf(f, "P5\n%d %d\n255\n", out_w, out_h);
+                fwrite(pixels.data(), 1, pixels.size(), f);
+                fclose(f);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,352 @@
+#!/usr/bin/env python3
+"""
+Message Queue - Model of the pager's display message queue, and a replay bench.
+
+The pager no longer shows every set_display/alert call at once: prompts and
+alerts outrank AGENT_* tool updates, every message has a minimum dwell and
+a TTL, and queued AGENT/status updates coalesce to the latest, which is
+kept until shown and always has a queue slot (policy in display_modes/message_queue.h;
+MessageQueueModel below mirrors it). CLEAR retracts prompts resolved off
+the device.
+
+The bench replays hook traffic through both the old direct path and the
+queue: screen changes, beeps, how long a prompt took to reach the screen,
+how many prompts were covered up before the user could answer, and how
+often the screen after an answered prompt was not the latest state.
+Traffic is either a synthetic multi-session workday or a recorded trace,
+one JSON object per line:
+
+    {"t": 12.345, "mode": "SILENT_AGENT_READ", "text": "main.cpp"}
+    {"t": 12.900, "mode": "ALERT", "text": "Build failed"}
+
+Usage:
+    # Synthetic bursts (2 sessions, tools, permissions, questions)
+    python -m devtools.message_queue --bench
+
+    # Recorded bridge traffic, and/or write the synthetic trace out
+    python -m devtools.message_queue --bench --replay calls.jsonl
+    python -m devtools.message_queue --bench --dump calls.jsonl
+"""
+
+import argparse
+import json
+import random
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Tuple
+
+AGENT, STATUS, ALERT, PROMPT = range(4)
+CLASS_NAMES = ("AGENT", "STATUS", "ALERT", "PROMPT")
+DWELL_MS = (1500, 1000, 3000, 90000)
+TTL_MS = (0, 0, 120000, 90000)   # 0: kept until superseded
+MAX_PENDING = 6                   # One of them kept for the state message
+POOL_BYTES = 6144
+STATE_RESERVE = 512               # Pool bytes kept for the state message
+TICK_MS = 20                      # show_queued runs on the 20 ms interval too
+
+PROMPT_MODES = ("PERMISSION", "QUESTION", "CONFIRM")
+ANSWER_SCREENS = {"PERMISSION": "PERM_APPROVED", "QUESTION": "RESPONSE", "CONFIRM": "PROCESSING"}
+
+
+def classify(mode: str) -> int:
+    if mode.startswith("AGENT_"):
+        return AGENT
+    if mode in PROMPT_MODES:
+        return PROMPT
+    if mode in ("ALERT", "QR", "IMAGE"):
+        return ALERT
+    return STATUS
+
+
+def strip_silent(mode: str) -> Tuple[str, bool]:
+    """(mode, beeps) the way push() reads SILENT / SILENT_*."""
+    if mode.startswith("SILENT_"):
+        return mode[7:], False
+    return mode, mode != "SILENT"
+
+
+@dataclass
+class Message:
+    mode: str
+    text: str
+    cls: int
+    beep: bool
+    queued_ms: int
+    ident: int = 0
+
+
+class MessageQueueModel:
+    """Same decisions as MessageQueue::push()/poll()."""
+
+    def __init__(self):
+        self.pending: List[Message] = []
+        self.current_mode: Optional[str] = None
+        self.current_cls = STATUS
+        self.shown_ms = 0
+        self.stats = {"pushed": 0, "shown": 0, "coalesced": 0, "expired": 0, "evicted": 0,
+                      "retracted": 0, "beeps": 0, "beeps_saved": 0}
+
+    def _pool_used(self) -> int:
+        return sum(len(m.text) for m in self.pending)
+
+    def _events(self) -> List[Message]:
+        return [m for m in self.pending if m.cls >= ALERT]
+
+    def _event_bytes(self) -> int:
+        return sum(len(m.text) for m in self._events())
+
+    def push(self, mode: str, text: str, sound: bool, now_ms: int, ident: int = 0):
+        self.stats["pushed"] += 1
+        mode, beeps = strip_silent(mode)
+        if mode == "CLEAR":
+            self.retract_prompts(now_ms)
+            if any(m.cls <= STATUS for m in self.pending):
+                return
+            mode, beeps = "IDLE", False
+        cls = classify(mode)
+        if cls <= STATUS:
+            kept = [m for m in self.pending if m.cls > STATUS]
+            self.stats["coalesced"] += len(self.pending) - len(kept)
+            self.pending = kept
+        else:
+            event_pool = POOL_BYTES - STATE_RESERVE
+            while len(self._events()) >= MAX_PENDING - 1 or self._event_bytes() + len(text) > event_pool:
+                victim = next((m for m in self.pending if m.cls == ALERT), None)
+                if victim is None:
+                    break
+                self.pending.remove(victim)
+                self.stats["evicted"] += 1
+            if len(self._events()) >= MAX_PENDING - 1 or self._event_bytes() >= event_pool:
+                self.stats["evicted"] += 1
+                return
+            text = text[:event_pool - self._event_bytes()]
+            for m in self.pending:
+                if m.cls <= STATUS and self._pool_used() + len(text) > POOL_BYTES:
+                    m.text = m.text[:POOL_BYTES - len(text) - self._event_bytes()]
+        text = text[:POOL_BYTES - self._pool_used()]
+        self.pending.append(Message(mode, text, cls, sound and beeps, now_ms, ident))
+
+    def poll(self, now_ms: int, shown_mode: Optional[str], hold: bool = False) -> Optional[Message]:
+        if shown_mode is not None and shown_mode != self.current_mode:
+            self.current_mode, self.current_cls, self.shown_ms = shown_mode, STATUS, now_ms
+        for m in list(self.pending):
+            if TTL_MS[m.cls] and now_ms - m.queued_ms > TTL_MS[m.cls]:
+                self.pending.remove(m)
+                self.stats["expired"] += 1
+        if hold or not self.pending:
+            return None
+        best = self.pending[0]
+        for m in self.pending[1:]:
+            if m.cls > best.cls:
+                best = m
+        if (self.current_mode is not None and best.cls <= self.current_cls
+                and now_ms - self.shown_ms < DWELL_MS[self.current_cls]):
+            return None
+        beep = best.beep
+        if beep and best.cls == AGENT and self.current_mode is not None and self.current_cls == AGENT:
+            beep = False
+            self.stats["beeps_saved"] += 1
+        if beep:
+            self.stats["beeps"] += 1
+        self.pending.remove(best)
+        self.current_mode, self.current_cls, self.shown_ms = best.mode, best.cls, now_ms
+        self.stats["shown"] += 1
+        return Message(best.mode, best.text, best.cls, beep, best.queued_ms, best.ident)
+
+    def retract_prompts(self, now_ms: int):
+        kept = [m for m in self.pending if m.cls != PROMPT]
+        self.stats["retracted"] += len(self.pending) - len(kept)
+        self.pending = kept
+        if self.current_mode is not None and self.current_cls == PROMPT:
+            self.current_cls, self.shown_ms = AGENT, now_ms - DWELL_MS[AGENT]
+            self.stats["retracted"] += 1
+
+
+class DirectModel:
+    """The old services: every call goes straight to the screen."""
+
+    def __init__(self):
+        self.stats = {"pushed": 0, "shown": 0, "beeps": 0}
+        self.current_mode: Optional[str] = None
+
+    def push(self, mode: str, text: str, sound: bool, now_ms: int, ident: int = 0):
+        self.stats["pushed"] += 1
+        mode, beeps = strip_silent(mode)
+        if mode == "CLEAR":
+            mode = "IDLE"  # What the bridge sent before CLEAR existed
+        self._next = Message(mode, text, classify(mode), sound and beeps, now_ms, ident)
+
+    def poll(self, now_ms: int, shown_mode: Optional[str], hold: bool = False) -> Optional[Message]:
+        nxt, self._next = getattr(self, "_next", None), None
+        if nxt:
+            self.stats["shown"] += 1
+            self.stats["beeps"] += nxt.beep
+        return nxt
+
+
+def synthetic_calls(seed: int = 1, hours: float = 2.0) -> List[Dict]:
+    """Two agent sessions of bursty tool calls, with prompts and alerts.
+
+    Each session works in bursts of 3-25 tool calls 80-600 ms apart (the
+    bridge sends the agent modes SILENT_ unless a tool is new in the burst),
+    pauses 5-90 s, and sometimes stops on a PERMISSION or QUESTION prompt,
+    which is now and then answered at the terminal first (CLEAR).
+    """
+    rng = random.Random(seed)
+    tools = ["AGENT_READ", "AGENT_SEARCH", "AGENT_BASH", "AGENT_EDIT", "AGENT_WEB", "AGENT_SUB", "AGENT_PLAN"]
+    calls: List[Dict] = []
+    end = hours * 3600
+    for session in range(2):
+        t = rng.uniform(0, 20)
+        while t < end:
+            seen = set()
+            for _ in range(rng.randint(3, 25)):
+                t += rng.uniform(0.08, 0.6)
+                tool = rng.choice(tools[:4] if rng.random() < 0.8 else tools)
+                mode = tool if tool not in seen else "SILENT_" + tool
+                seen.add(tool)
+                calls.append({"t": round(t, 3), "mode": mode, "text": f"s{session} {tool[6:].lower()} file_{rng.randint(1, 40)}.py"})
+            r = rng.random()
+            if r < 0.18:
+                if r < 0.12:
+                    calls.append({"t": round(t + 0.05, 3), "mode": "PERMISSION", "text": f"s{session} Bash: npm test"})
+                else:
+                    calls.append({"t": round(t + 0.05, 3), "mode": "QUESTION", "text": f"s{session} Proceed with the refactor? " * 3})
+                if rng.random() < 0.3:
+                    # Answered at the terminal first: the bridge retracts it
+                    calls.append({"t": round(t + rng.uniform(1, 8), 3), "mode": "CLEAR", "text": "Ready"})
+            elif r < 0.21:
+                calls.append({"t": round(t + 0.05, 3), "mode": "ALERT", "text": f"s{session} Build failed"})
+            else:
+                calls.append({"t": round(t + 0.05, 3), "mode": "SILENT_IDLE", "text": "Ready"})
+            t += rng.uniform(5, 90)
+    calls.sort(key=lambda c: c["t"])
+    return calls
+
+
+def replay(calls: List[Dict], model, answer_s: Tuple[float, float] = (3.0, 40.0), seed: int = 7) -> Dict:
+    """Drive a model with calls and a user who answers prompts they can see.
+
+    A prompt counts as answered once it has been on screen for the user's
+    reaction time; if something else covers it first, it was hidden (unless
+    CLEAR retracted it). After an answer, the screen should reach the
+    latest state pushed while the prompt was up within STALE_MS; if not,
+    the answer left it stale.
+    """
+    STALE_MS = 3000
+    rng = random.Random(seed)
+    events = sorted((round(c["t"] * 1000), i, c) for i, c in enumerate(calls))
+    order = {ident: k for k, (_, ident, _) in enumerate(events)}
+    end_ms = (events[-1][0] if events else 0) + 120_000
+    screen: Optional[Message] = None
+    answer_at: Optional[int] = None
+    shown_mode: Optional[str] = None
+    prompt_pushed: Dict[int, int] = {}
+    prompt_latency: List[int] = []
+    hidden = answered = retracted = stale = 0
+    renders = 0
+    last_state = -1                         # Newest state call pushed so far
+    state_at_prompt = -1
+    resolved = False                        # CLEAR arrived for the prompt on screen
+    want: Optional[Tuple[int, int]] = None  # (state ident, deadline) after an answer
+
+    def show(m: Optional[Message], now: int):
+        nonlocal screen, answer_at, shown_mode, hidden, retracted, renders, state_at_prompt, resolved, want
+        if m is None:
+            return
+        renders += 1
+        if screen is not None and screen.cls == PROMPT and answer_at is not None:
+            if resolved:
+                retracted += 1
+            else:
+                hidden += 1  # Covered before the user got to it
+        screen, shown_mode = m, m.mode
+        answer_at = None
+        resolved = False
+        if want and (m.cls >= ALERT or order.get(m.ident, -1) >= order[want[0]]):
+            want = None  # Reached the latest state, or something that outranks it
+        if m.cls == PROMPT:
+            prompt_latency.append(now - prompt_pushed.get(m.ident, now))
+            answer_at = now + int(rng.uniform(*answer_s) * 1000)
+            state_at_prompt = last_state
+
+    idx = 0
+    now = 0
+    while now <= end_ms:
+        while idx < len(events) and events[idx][0] <= now:
+            t, ident, c = events[idx]
+            idx += 1
+            mode = c["mode"]
+            bare = strip_silent(mode)[0]
+            if bare == "CLEAR":
+                resolved = screen is not None and screen.cls == PROMPT
+            elif classify(bare) == PROMPT:
+                prompt_pushed[ident] = t
+            elif classify(bare) <= STATUS:
+                last_state = ident
+            model.push(mode, c.get("text", ""), True, t, ident)
+            show(model.poll(t, shown_mode), t)  # show_queued runs right after the service
+        if answer_at is not None and now >= answer_at:
+            answered += 1
+            answer_at = None
+            if last_state != state_at_prompt:
+                want = (last_state, now + STALE_MS)
+            shown_mode = ANSWER_SCREENS.get(screen.mode, "IDLE")
+            screen = Message(shown_mode, "", STATUS, False, now)
+            renders += 1
+        show(model.poll(now, shown_mode), now)
+        if want and now > want[1]:
+            stale += 1
+            want = None
+        now += TICK_MS
+
+    prompt_latency.sort()
+    prompts = len(prompt_pushed)
+    return {
+        "calls": len(calls), "renders": renders, "beeps": model.stats["beeps"],
+        "prompts": prompts, "answered": answered, "hidden": hidden, "retracted": retracted, "stale": stale,
+        "never_shown": prompts - len(prompt_latency),
+        "prompt_p50_ms": prompt_latency[len(prompt_latency) // 2] if prompt_latency else 0,
+        "prompt_max_ms": prompt_latency[-1] if prompt_latency else 0,
+        "stats": model.stats,
+    }
+
+
+def main():
+    """CLI: replay hook bursts through the direct path and the queue."""
+    parser = argparse.ArgumentParser(description='Pager display message queue')
+    parser.add_argument('--bench', action='store_true', help='Replay traffic and compare')
+    parser.add_argument('--replay', help='JSONL trace of set_display/alert calls')
+    parser.add_argument('--dump', help='Write the synthetic trace as JSONL')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--hours', type=float, default=2.0, help='Length of the synthetic trace')
+    args = parser.parse_args()
+
+    if not args.bench:
+        parser.print_help()
+        return
+
+    if args.replay:
+        with open(args.replay) as f:
+            calls = [json.loads(line) for line in f if line.strip()]
+    else:
+        calls = synthetic_calls(args.seed, args.hours)
+    if args.dump:
+        with open(args.dump, "w") as f:
+            for c in calls:
+                f.write(json.dumps(c) + "\n")
+
+    print(f"{len(calls)} set_display/alert calls over {calls[-1]['t'] / 60:.0f} min" if calls else "no calls")
+    print(f"  {'':10} {'renders':>8} {'beeps':>6} {'prompts':>8} {'hidden':>7} {'unseen':>7} "
+          f"{'p50 to screen':>14} {'max':>8} {'stale':>6}")
+    for name, model in (("direct", DirectModel()), ("queue", MessageQueueModel())):
+        r = replay(calls, model)
+        print(f"  {name:10} {r['renders']:>8} {r['beeps']:>6} {r['prompts']:>8} {r['hidden']:>7} "
+              f"{r['never_shown']:>7} {r['prompt_p50_ms']:>12}ms {r['prompt_max_ms']:>6}ms {r['stale']:>6}")
+        if name == "queue":
+            s = r["stats"]
+            print(f"  queue: coalesced {s['coalesced']}, expired {s['expired']}, evicted {s['evicted']}, "
+                  f"retracted {s['retracted']} ({r['retracted']} on screen), beeps saved {s['beeps_saved']}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,327 @@
+#!/usr/bin/env python3
+"""
+Metrics TSDB - Decoder and host check for the pager's on-device metrics.
+
+metrics_tsdb.h keeps battery, charging, RSSI, loop time and frame time on
+the pager at 1 s, 1 min and 15 min resolution (min/avg/max per bucket,
+delta-encoded blocks in fixed rings). One call to the dump_metrics API
+service logs everything as METRICS lines; this decodes them, so the
+dashboard can plot hours or days of history without polling get_state.
+
+The bench feeds a synthetic week of samples through the native build
+(devtools/metrics_tsdb_bench.cpp) and checks that every decoded point
+equals the min/avg/max of the raw samples in its bucket (compaction is
+exact at every tier), that gaps are real gaps, and reports bytes per
+metric-day and the horizon each ring holds.
+
+Usage:
+    esphome logs clawd-pager.yaml > pager.log     # after calling dump_metrics
+    python -m devtools.metrics_tsdb pager.log
+    python -m devtools.metrics_tsdb pager.log --metric battery --tier 2 --csv battery.csv
+
+    g++ -O2 -o /tmp/metrics-tsdb-bench devtools/metrics_tsdb_bench.cpp
+    python -m devtools.metrics_tsdb --bench --bin /tmp/metrics-tsdb-bench
+"""
+
+import argparse
+import os
+import random
+import re
+import struct
+import subprocess
+import tempfile
+from dataclasses import dataclass, field
+from typing import Dict, Iterable, List, Optional, Tuple
+
+METRICS = ("battery", "charging", "rssi", "loop_ms", "frame_ms")
+SCALE = {"battery": 10, "charging": 1000, "rssi": 1, "loop_ms": 10, "frame_ms": 10}
+TIER_SECONDS = (1, 60, 900)
+RING_BLOCKS = (6, 12, 30)
+BLOCK_BYTES = 64                    # 52 data + header, as stored on the pager
+TAG_FLAT, TAG_SPREAD, TAG_GAP = 0, 1, 2
+
+# "[12:00:01][I][METRICS:123]: battery 1 2140 18 0a4b..."
+LINE_RE = re.compile(r"METRICS(?::\d+)?\]?:?\s+(.*)$")
+BEGIN_RE = re.compile(r"begin now_s=(\d+) t=([\d.]+)")
+
+
+@dataclass
+class Point:
+    bucket: int
+    min: int
+    avg: int
+    max: int
+
+
+@dataclass
+class Dump:
+    now_s: int = 0
+    stamp: float = 0.0                   # Bridge clock at dump; pager uptime if unsynced
+    blocks: List[Tuple[str, int, int, int, bytes]] = field(default_factory=list)
+    open: List[Tuple[str, int, Point, int]] = field(default_factory=list)
+    bytes: int = 0
+
+    def series(self, metric: str, tier: int) -> List[Point]:
+        """Decoded points, oldest first, open bucket last."""
+        points: List[Point] = []
+        for m, t, start, count, data in self.blocks:
+            if m == metric and t == tier:
+                points.extend(decode_block(start, count, data))
+        for m, t, p, _ in self.open:
+            if m == metric and t == tier:
+                points.append(p)
+        return points
+
+    def wall_time(self, bucket: int, tier: int) -> Optional[float]:
+        """Bucket start as bridge clock (unix s), if the pager was synced."""
+        if self.stamp < 1e9:
+            return None
+        return self.stamp - self.now_s + bucket * TIER_SECONDS[tier]
+
+
+def parse_dump(lines: Iterable[str]) -> Dump:
+    """Last complete dump_metrics output in a log."""
+    dump, current = Dump(), None
+    for line in lines:
+        m = LINE_RE.search(line.rstrip())
+        if not m:
+            continue
+        body = m.group(1).strip()
+        if body.startswith("begin"):
+            b = BEGIN_RE.search(body)
+            current = Dump(now_s=int(b.group(1)), stamp=float(b.group(2))) if b else Dump()
+        elif current is None:
+            continue
+        elif body.startswith("end"):
+            current.bytes = int(body.split("bytes=")[1])
+            dump, current = current, None
+        else:
+            f = body.split()
+            if f[2] == "open":
+                p = Point(int(f[3]), int(f[4]), int(f[5]), int(f[6]))
+                current.open.append((f[0], int(f[1]), p, int(f[7])))
+            else:
+                current.blocks.append((f[0], int(f[1]), int(f[2]), int(f[3]),
+                                       bytes.fromhex(f[4]) if len(f) > 4 else b""))
+    return dump
+
+
+def read_varint(data: bytes, pos: int) -> Tuple[int, int]:
+    value = shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if b < 0x80:
+            return value, pos
+        shift += 7
+
+
+def decode_block(start: int, count: int, data: bytes) -> List[Point]:
+    points: List[Point] = []
+    bucket, last, pos = start, 0, 0
+    while pos < len(data):
+        v, pos = read_varint(data, pos)
+        tag, payload = v & 3, v >> 2
+        if tag == TAG_GAP:
+            bucket += payload
+            continue
+        avg = last + ((payload >> 1) ^ -(payload & 1))
+        lo = hi = avg
+        if tag == TAG_SPREAD:
+            below, pos = read_varint(data, pos)
+            above, pos = read_varint(data, pos)
+            lo, hi = avg - below, avg + above
+        points.append(Point(bucket, lo, avg, hi))
+        bucket += 1
+        last = avg
+    if bucket != start + count:
+        raise ValueError(f"block at {start} decodes to {bucket - start} buckets, header says {count}")
+    return points
+
+
+# -- bench --
+
+def synthetic_samples(days: float, seed: int) -> List[Tuple[int, int, int]]:
+    """(t_ms, metric index, fixed-point value), as the pager would record them.
+
+    Gauges are recorded every second from their last state (battery updates
+    once a minute, charging follows a desk/night routine, RSSI walks and
+    drops out while WiFi is down); loop and frame time twice a second with
+    spikes. Two WiFi outages leave RSSI gaps.
+    """
+    rng = random.Random(seed)
+    out: List[Tuple[int, int, int]] = []
+    battery, rssi = 95.0, -58
+    charging = False
+    outages = [(int(days * 86400 * f), int(days * 86400 * f) + rng.randint(300, 2400)) for f in (0.31, 0.77)]
+    for s in range(int(days * 86400)):
+        hour = (s / 3600) % 24
+        charging = hour >= 23 or hour < 7 or 12.5 <= hour < 13.5
+        if s % 60 == 0:
+            battery = min(100.0, battery + 0.35) if charging else max(3.0, battery - rng.uniform(0.15, 0.3))
+        t = s * 1000
+        out.append((t, 0, round(battery * SCALE["battery"])))
+        out.append((t + 1, 1, SCALE["charging"] if charging else 0))
+        if not any(a <= s < b for a, b in outages):
+            rssi = max(-90, min(-40, rssi + rng.choice((-1, 0, 0, 0, 1))))
+            out.append((t + 2, 2, rssi))
+        for k in range(2):
+            loop = 20.0 + rng.expovariate(4.0) + (rng.uniform(30, 180) if rng.random() < 0.01 else 0)
+            out.append((t + 10 + 500 * k, 3, round(loop * SCALE["loop_ms"])))
+            frame = 9.0 + rng.gauss(0, 0.8) + (rng.uniform(15, 40) if rng.random() < 0.02 else 0)
+            out.append((t + 20 + 500 * k, 4, round(max(0.5, frame) * SCALE["frame_ms"])))
+    return out
+
+
+def reference(samples: List[Tuple[int, int, int]]) -> Dict[Tuple[str, int], Dict[int, Tuple[int, int, int, int]]]:
+    """(metric, tier) -> bucket -> (min, sum, max, n) of the raw samples."""
+    ref: Dict[Tuple[str, int], Dict[int, List[int]]] = {}
+    for t_ms, mi, v in samples:
+        s = t_ms // 1000
+        for tier, secs in enumerate(TIER_SECONDS):
+            b = ref.setdefault((METRICS[mi], tier), {}).setdefault(s // secs, [v, 0, v, 0])
+            if v < b[0]:
+                b[0] = v
+            if v > b[2]:
+                b[2] = v
+            b[1] += v
+            b[3] += 1
+    return {k: {b: tuple(a) for b, a in d.items()} for k, d in ref.items()}
+
+
+def rounded_avg(total: int, n: int) -> int:
+    return (2 * total + n) // (2 * n)   # Half up, like MetricsTsdb::avg()
+
+
+def check(dump: Dump, ref) -> Tuple[int, List[str]]:
+    """Every stored bucket (point or gap) against the raw samples."""
+    errors: List[str] = []
+    checked = 0
+    for metric in METRICS:
+        for tier in range(len(TIER_SECONDS)):
+            buckets = ref.get((metric, tier), {})
+            for m, t, start, count, data in dump.blocks:
+                if m != metric or t != tier:
+                    continue
+                stored = {p.bucket: p for p in decode_block(start, count, data)}
+                for b in range(start, start + count):
+                    want = buckets.get(b)
+                    got = stored.get(b)
+                    checked += 1
+                    if want is None and got is None:
+                        continue
+                    if want is None or got is None:
+                        errors.append(f"{metric} tier {tier} bucket {b}: stored {got}, samples {want}")
+                        continue
+                    exp = (want[0], rounded_avg(want[1], want[3]), want[2])
+                    if (got.min, got.avg, got.max) != exp:
+                        errors.append(f"{metric} tier {tier} bucket {b}: {got} != min/avg/max {exp}")
+            for m, t, p, n in dump.open:
+                if m == metric and t == tier:
+                    want = buckets.get(p.bucket)
+                    checked += 1
+                    if want is None or (p.min, p.avg, p.max, n) != (want[0], rounded_avg(want[1], want[3]), want[2], want[3]):
+                        errors.append(f"{metric} tier {tier} open bucket {p.bucket}: {p} n={n}, samples {want}")
+    return checked, errors
+
+
+def bench(binary: str, days: float, seed: int, start_ms: int = 0) -> bool:
+    samples = [(t + start_ms, m, v) for t, m, v in synthetic_samples(days, seed)]
+    samples.sort()
+    with tempfile.NamedTemporaryFile(suffix=".bin", delete=False) as f:
+        # The pager's millis() is 32-bit; uptime (and the reference) is not
+        f.write(b"".join(struct.pack("<IBi", t & 0xFFFFFFFF, m, v) for t, m, v in samples))
+        path = f.name
+    try:
+        out = subprocess.run([binary, path], capture_output=True, text=True, check=True).stdout.splitlines()
+    finally:
+        os.unlink(path)
+    dump = parse_dump(out)
+    summary = dict(kv.split("=") for kv in out[-1].split())
+    checked, errors = check(dump, reference(samples))
+
+    print(f"{len(samples)} samples over {days:g} days, {float(summary['us_per_sample']):.3f} us/sample, "
+          f"static {summary['static']} B, {dump.bytes} B in {len(dump.blocks)} blocks")
+    print(f"compaction: {checked} buckets checked against raw samples, {len(errors)} mismatches")
+    for e in errors[:10]:
+        print("  " + e)
+
+    print(f"  {'metric':9} {'tier':>5} {'B/point':>8} {'B/metric-day':>13} {'raw 12B/pt':>11} {'horizon':>9}")
+    for metric in METRICS:
+        for tier, secs in enumerate(TIER_SECONDS):
+            blocks = [(c, d) for m, t, _, c, d in dump.blocks if m == metric and t == tier]
+            # Full blocks only: the head block is still filling
+            full = blocks[:-1] or blocks
+            buckets = sum(c for c, _ in full)
+            used = sum(len(d) for _, d in full)
+            per_day = used / (buckets * secs) * 86400 if buckets else 0
+            horizon_s = RING_BLOCKS[tier] * (buckets / len(full) if full else 0) * secs
+            print(f"  {metric:9} {secs:>4}s {used / buckets if buckets else 0:>8.2f} {per_day:>13.0f} "
+                  f"{12 * 86400 // secs:>11} {format_duration(horizon_s):>9}")
+    memory = RING_BLOCKS[0] + RING_BLOCKS[1] + RING_BLOCKS[2]
+    print(f"  each metric holds {memory} x {BLOCK_BYTES} B = {memory * BLOCK_BYTES} B")
+    return not errors
+
+
+def format_duration(s: float) -> str:
+    if s >= 86400:
+        return f"{s / 86400:.1f} d"
+    if s >= 3600:
+        return f"{s / 3600:.1f} h"
+    return f"{s / 60:.0f} min"
+
+
+def main():
+    """CLI: decode a dump_metrics log, or check the encoder on the host."""
+    parser = argparse.ArgumentParser(description='Pager metrics TSDB decoder')
+    parser.add_argument('log', nargs='?', help='Log containing a dump_metrics output')
+    parser.add_argument('--metric', choices=METRICS, help='Only this metric')
+    parser.add_argument('--tier', type=int, choices=range(len(TIER_SECONDS)), help='Only this tier')
+    parser.add_argument('--csv', help='Write metric,tier,time,min,avg,max')
+    parser.add_argument('--bench', action='store_true', help='Run the host check')
+    parser.add_argument('--bin', default='/tmp/metrics-tsdb-bench', help='Built metrics_tsdb_bench.cpp')
+    parser.add_argument('--days', type=float, default=7.0, help='Length of the synthetic trace')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--start-ms', type=int, default=0, help='Uptime at the first sample (4290000000: cross the millis() wrap)')
+    args = parser.parse_args()
+
+    if args.bench:
+        raise SystemExit(0 if bench(args.bin, args.days, args.seed, args.start_ms) else 1)
+    if not args.log:
+        parser.print_help()
+        return
+
+    with open(args.log, errors="replace") as f:
+        dump = parse_dump(f)
+    if not dump.blocks and not dump.open:
+        raise SystemExit("No METRICS dump in the log (call dump_metrics first)")
+    rows = []
+    for metric in METRICS:
+        if args.metric and metric != args.metric:
+            continue
+        for tier, secs in enumerate(TIER_SECONDS):
+            if args.tier is not None and tier != args.tier:
+                continue
+            points = dump.series(metric, tier)
+            if not points:
+                continue
+            scale = SCALE[metric]
+            span = (points[-1].bucket - points[0].bucket + 1) * secs
+            print(f"{metric:9} {secs:>4}s  {len(points):>4} points over {format_duration(span):>8}  "
+                  f"min {min(p.min for p in points) / scale:g}  avg {sum(p.avg for p in points) / len(points) / scale:.1f}  "
+                  f"max {max(p.max for p in points) / scale:g}")
+            for p in points:
+                when = dump.wall_time(p.bucket, tier)
+                rows.append((metric, tier, when if when is not None else p.bucket * secs - dump.now_s,
+                             p.min / scale, p.avg / scale, p.max / scale))
+    print(f"{dump.bytes} B of blocks; times are {'unix s' if dump.stamp >= 1e9 else 's relative to the dump'}")
+    if args.csv:
+        with open(args.csv, "w") as f:
+            f.write("metric,tier,time,min,avg,max\n")
+            for r in rows:
+                f.write(",".join(f"{x:.3f}" if isinstance(x, float) else str(x) for x in r) + "\n")
+
+
+if __name__ == '__main__':
+    main()
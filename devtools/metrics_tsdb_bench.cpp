@@ -0,0 +1,59 @@
+// Metrics TSDB Bench - host build of metrics_tsdb.h
+//
+// Feeds a sample file through MetricsTsdb and prints the dump_metrics log
+// lines ("METRICS ..."), then one summary line. metrics_tsdb.py writes the
+// samples, decodes the dump and checks it against its own compaction of
+// the same samples.
+//
+// Sample file: little-endian records of u32 t_ms, u8 metric, i32 value
+// (fixed point, as record_fixed() takes it).
+//
+// Build:
+//   g++ -O2 -o /tmp/metrics-tsdb-bench devtools/metrics_tsdb_bench.cpp
+//
+// Usage:
+//   metrics-tsdb-bench samples.bin
+//   -> METRICS ... lines, then: samples=<n> us_per_sample=<t> static=<bytes>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "../metrics_tsdb.h"
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s samples.bin\n", argv[0]);
+        return 2;
+    }
+    FILE* f = fopen(argv[1], "rb");
+    if (!f) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    MetricsTsdb& db = metrics_tsdb();
+    const size_t RECORD = 9;
+    size_t samples = data.size() / RECORD;
+    uint32_t last_ms = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; i++) {
+        const uint8_t* r = &data[i * RECORD];
+        uint32_t t_ms = (uint32_t) r[0] | (uint32_t) r[1] << 8 | (uint32_t) r[2] << 16 | (uint32_t) r[3] << 24;
+        int32_t value = (int32_t) ((uint32_t) r[5] | (uint32_t) r[6] << 8 | (uint32_t) r[7] << 16 | (uint32_t) r[8] << 24);
+        if (r[4] >= (uint8_t) Metric::COUNT) continue;
+        db.record_fixed((Metric) r[4], value, t_ms);
+        last_ms = t_ms;
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+    db.dump(last_ms, "0.000000", [](const char* line) { printf("METRICS %s\n", line); });
+    printf("samples=%u us_per_sample=%.3f static=%u\n", (unsigned) samples, samples ? us / samples : 0.0,
+           (unsigned) MetricsTsdb::storage_bytes());
+    return 0;
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Mode Transition - Bench driver for display_modes/mode_transition.h.
+
+On a mode change the pager now slides, wipes or crossfades instead of
+snapping: the outgoing frame is cached once, the new mode renders as usual
+and the frame is composed band by band (row moves, copies, ordered-dither
+select), within a per-frame render budget. The native bench
+(devtools/mode_transition_bench.cpp) checks the compositor against a
+per-pixel reference on every rotation, then times 300 ms transitions at
+20 fps on the pager geometry: the new mode alone (snap), the engine, and
+the naive way (both modes rendered every frame). This prints the frame
+times and whether the budget check skips transitions that can't fit.
+
+Usage:
+    g++ -O2 -I. -o /tmp/mode-transition-bench devtools/mode_transition_bench.cpp
+    python -m devtools.mode_transition --bench --bin /tmp/mode-transition-bench
+"""
+
+import argparse
+import re
+import subprocess
+from typing import Dict, List
+
+LINE_RE = re.compile(r"^(check|transition=\S+|budget|total) ?(.*)$")
+
+
+def fields(text: str) -> Dict[str, str]:
+    return dict(kv.split("=", 1) for kv in text.split())
+
+
+def bench(binary: str, repeat: int) -> bool:
+    out = subprocess.run([binary, "-n", str(repeat)], capture_output=True, text=True)
+    checks: List[Dict[str, str]] = []
+    transitions = []
+    budget, total = None, None
+    for line in out.stdout.splitlines():
+        m = LINE_RE.match(line.strip())
+        if not m:
+            continue
+        if m.group(1) == "check":
+            checks.append(fields(m.group(2)))
+        elif m.group(1).startswith("transition="):
+            transitions.append((m.group(1).split("=", 1)[1], fields(m.group(2))))
+        elif m.group(1) == "budget":
+            budget = fields(m.group(2))
+        else:
+            total = fields(m.group(2))
+    if total is None:
+        print(out.stdout + out.stderr)
+        return False
+
+    bad = [c for c in checks if c["mismatches"] != "0"]
+    print(f"Compositor vs reference: {len(checks) - len(bad)}/{len(checks)} rotation/size/kind cases exact")
+    for c in bad:
+        print(f"  DIFFER rotation={c['rotation']} size={c['size']} kind={c['kind']}: {c['mismatches']} steps")
+
+    print(f"\n{'transition':<24}{'kind':<11}{'frames':>7}{'snap':>8}{'engine p50':>12}{'max':>8}"
+          f"{'compose':>9}{'naive p50':>11}{'max':>8}   (host us per frame)")
+    for name, t in transitions:
+        print(f"{name:<24}{t['kind']:<11}{t['frames']:>7}{float(t['snap_us']):>8.0f}"
+              f"{float(t['engine_p50_us']):>12.0f}{float(t['engine_max_us']):>8.0f}{float(t['compose_us']):>9.0f}"
+              f"{float(t['naive_p50_us']):>11.0f}{float(t['naive_max_us']):>8.0f}")
+    if budget:
+        print(f"\nBudget below the frame cost: {budget['started']} started, {budget['skipped']} skipped, "
+              f"{budget['frames']} composed")
+    ok = out.returncode == 0 and total.get("mismatches") == "0"
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: check the transition compositor and report frame times during transitions."""
+    parser = argparse.ArgumentParser(description='Display mode transition bench')
+    parser.add_argument('--bench', action='store_true', help='Run the checks and the timed transitions')
+    parser.add_argument('--bin', default='/tmp/mode-transition-bench', help='Built mode_transition_bench.cpp')
+    parser.add_argument('--repeat', type=int, default=50, help='Transitions per mode pair')
+    args = parser.parse_args()
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin, args.repeat) else 1)
+
+
+if __name__ == '__main__':
+    main()
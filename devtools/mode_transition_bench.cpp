@@ -0,0 +1,287 @@
+// Mode Transition Bench - host build of display_modes/mode_transition.h
+//
+// 1. Checks ModeTransition::compose_band against a per-pixel reference
+//    worked out in logical (rotated) coordinates: every rotation, every
+//    kind, every eased step 0..256, on the pager's 135x240 panel and on an
+//    odd size (partial last band).
+// 2. Times transitions on the pager geometry (135x240 panel, rotation 270,
+//    big-endian RGB565 as st7789v stores it). Modes are painted through a
+//    model of ESPHome's pixel path (draw_pixel_at with rotation, glyphs a
+//    pixel at a time). For each mode pair it runs a 300 ms transition at
+//    20 fps three ways:
+//      snap    render the new mode only (what the pager did before)
+//      engine  ModeTransition: render the new mode, compose from the cached
+//              outgoing frame
+//      naive   render both modes every frame and combine pixel by pixel
+//    and reports frame times (render + compose) per frame.
+// 3. Drives the budget: with a budget below the predicted cost every
+//    transition must be skipped (snap), never composed.
+//
+// Times are host times; the pager logs its own under get_state
+// (TRANSITION frame_avg / max / compose_max).
+//
+// Build:
+//   g++ -O2 -I. -o /tmp/mode-transition-bench devtools/mode_transition_bench.cpp
+//
+// Usage:
+//   mode-transition-bench [-n repeat]
+//   -> check rotation=<deg> size=<w>x<h> kind=<k> mismatches=<n>
+//      transition=<from>-><to> kind=<k> frames=<n> snap_us=<t> engine_p50_us=<t> engine_max_us=<t>
+//          compose_us=<t> naive_p50_us=<t> naive_max_us=<t>
+//      budget started=<n> skipped=<n> frames=<n>
+//      total mismatches=<n>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../display_modes/mode_transition.h"
+
+static unsigned long host_us() {
+    using namespace std::chrono;
+    return (unsigned long) duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- 1. Compositor vs logical reference ----
+
+struct Geometry {
+    int width, height, rotation;  // Panel (unrotated) size, rotation in degrees
+
+    int logical_width() const { return rotation == 90 || rotation == 270 ? height : width; }
+
+    // Logical (x, y) -> panel index, as ESPHome's draw_pixel_at
+    size_t index(int x, int y) const {
+        int ix = x, iy = y;
+        switch (rotation) {
+            case 90: ix = width - 1 - y; iy = x; break;
+            case 180: ix = width - 1 - x; iy = height - 1 - y; break;
+            case 270: ix = y; iy = height - 1 - x; break;
+        }
+        return (size_t) iy * width + ix;
+    }
+};
+
+static uint64_t check(const Geometry& g, TransitionKind kind, std::mt19937& rng) {
+    size_t pixels = (size_t) g.width * g.height;
+    std::vector<uint16_t> old_frame(pixels), new_frame(pixels), fb(pixels), want(pixels);
+    for (size_t i = 0; i < pixels; i++) {
+        old_frame[i] = (uint16_t) rng();
+        new_frame[i] = (uint16_t) rng();
+    }
+    int lw = g.logical_width(), lh = (int) (pixels / lw);
+    uint64_t mismatches = 0;
+    for (int eased = 0; eased <= 256; eased++) {
+        int shift = lw * eased >> 8;
+        for (int y = 0; y < lh; y++) {
+            for (int x = 0; x < lw; x++) {
+                size_t at = g.index(x, y);
+                uint16_t px = 0;
+                if (kind == TransitionKind::SLIDE) {
+                    px = x < lw - shift ? old_frame[g.index(x + shift, y)] : new_frame[g.index(x - (lw - shift), y)];
+                } else if (kind == TransitionKind::WIPE) {
+                    px = x < shift ? new_frame[at] : old_frame[at];
+                } else {
+                    int ix = (int) (at % g.width), iy = (int) (at / g.width);
+                    px = SIMD_BAYER4[iy & 3][ix & 3] < (eased >> 4) ? new_frame[at] : old_frame[at];
+                }
+                want[at] = px;
+            }
+        }
+        fb = new_frame;
+        for (int slot = 0; slot < ModeTransition::band_count(g.height); slot++) {
+            ModeTransition::compose_band(fb.data(), old_frame.data(), g.width, g.height, g.rotation, kind,
+                                         (uint16_t) eased, slot);
+        }
+        if (fb != want) mismatches++;
+    }
+    return mismatches;
+}
+
+// ---- 2. Pager model ----
+
+static const int PANEL_W = 135, PANEL_H = 240, ROTATION = 270;
+static const int LW = 240, LH = 135;
+
+struct PixelDisplay {
+    uint16_t* buf;
+    uint64_t pixels = 0;
+
+    __attribute__((noinline)) void draw_pixel(int x, int y, uint16_t c) {
+        if (x < 0 || y < 0 || x >= LW || y >= LH) return;
+        int ix = y, iy = PANEL_H - 1 - x;  // Rotation 270
+        buf[(size_t) iy * PANEL_W + ix] = (uint16_t) (c >> 8 | c << 8);  // st7789v keeps big-endian
+        pixels++;
+    }
+    uint16_t get_pixel(int x, int y) const {
+        uint16_t v = buf[(size_t) (PANEL_H - 1 - x) * PANEL_W + y];
+        return (uint16_t) (v >> 8 | v << 8);
+    }
+    void fill(uint16_t c) {
+        for (int y = 0; y < LH; y++)
+            for (int x = 0; x < LW; x++) draw_pixel(x, y, c);
+    }
+    void filled_rectangle(int x0, int y0, int w, int h, uint16_t c) {
+        for (int y = y0; y < y0 + h; y++)
+            for (int x = x0; x < x0 + w; x++) draw_pixel(x, y, c);
+    }
+    // Font::print tests every bit of an 8x12 cell; ~40% are ink
+    void text(int x0, int y0, const char* s, uint16_t c) {
+        for (int n = 0; s[n]; n++) {
+            uint32_t seed = (uint8_t) s[n] * 2654435761u;
+            for (int y = 0; y < 12; y++) {
+                for (int x = 0; x < 8; x++) {
+                    seed = seed * 1103515245u + 12345u;
+                    if ((seed >> 16) % 5 < 2) draw_pixel(x0 + n * 9 + x, y0 + y, c);
+                }
+            }
+        }
+    }
+};
+
+static uint16_t rgb(int r, int g, int b) { return (uint16_t) ((r >> 3) << 11 | (g >> 2) << 5 | (b >> 3)); }
+
+// Rough stand-ins for the pager's modes (clawd-pager.yaml display lambda)
+static void paint(PixelDisplay& d, const std::string& mode, uint32_t ms) {
+    d.fill(0);
+    int frame = (ms / 100) % 20;
+    if (mode == "IDLE") {
+        d.text(70, 30, "12:34", rgb(0, 255, 255));
+        d.text(40, 60, "LOBSTER READY!", rgb(255, 255, 255));
+        d.filled_rectangle(10, 110, 220, 2, rgb(100, 100, 100));
+        d.text(20, 116, "BAT 87%  WIFI -61", rgb(100, 100, 100));
+    } else if (mode == "LISTENING") {
+        for (int i = 0; i < 12; i++) {
+            int phase = (frame + i * 3) % 20, h = 10 + abs(10 - phase) * 3;
+            d.filled_rectangle(25 + i * 17, 68 - h, 12, h * 2, rgb(255 - i * 15, 50 + i * 15, 100));
+        }
+    } else if (mode == "PROCESSING") {
+        for (int i = 0; i < 8; i++) {
+            int y = 60 + abs(((frame + i * 5) % 20) - 10) * 4;
+            d.filled_rectangle(30 + i * 24, y, 14, 14, rgb(255, 127, 80));
+        }
+        d.text(60, 10, "THINKING...", rgb(255, 191, 0));
+    } else {  // QUESTION / PERMISSION: header bar and four lines of text
+        d.filled_rectangle(0, 0, 240, 28, rgb(255, 191, 0));
+        d.text(8, 8, mode.c_str(), 0);
+        for (int line = 0; line < 4; line++) d.text(5, 35 + line * 22, "Allow edit of main.cpp?", rgb(255, 255, 255));
+    }
+}
+
+static double percentile(std::vector<double> v, double q) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t) (q * v.size()))];
+}
+
+struct PairResult {
+    std::vector<double> snap, engine, naive, compose;
+};
+
+static void run_pair(const std::string& from, const std::string& to, int repeat, PairResult& r) {
+    std::vector<uint16_t> panel((size_t) PANEL_W * PANEL_H), scratch(panel.size());
+    PixelDisplay d{panel.data()};
+    PixelDisplay old_d{scratch.data()};
+    ModeTransition& mt = ModeTransition::instance();
+    uint8_t* fb = (uint8_t*) panel.data();
+    uint32_t t0 = 1000000;
+
+    for (int rep = 0; rep < repeat; rep++) {
+        // Settle on the old mode (0.5 s ticks), then switch; 20 fps while it runs
+        uint32_t now = t0 + rep * 10000;
+        for (int i = 0; i < 3; i++, now += 500) {
+            mt.begin_frame(fb, PANEL_W, PANEL_H, ROTATION, from.c_str(), now, host_us());
+            paint(d, from, now);
+            mt.end_frame(host_us(), host_us);
+        }
+        for (uint32_t t = 0; t <= ModeTransition::DURATION_MS; t += ModeTransition::FRAME_MS) {
+            uint32_t ms = now + t;
+            unsigned long start = host_us();
+            mt.begin_frame(fb, PANEL_W, PANEL_H, ROTATION, to.c_str(), ms, start);
+            paint(d, to, ms);
+            unsigned long painted = host_us();
+            uint32_t frames = mt.stats().frames;
+            mt.end_frame(painted, host_us);
+            unsigned long done = host_us();
+            r.snap.push_back((double) (painted - start));
+            if (mt.stats().frames != frames) {
+                r.engine.push_back((double) (done - start));
+                r.compose.push_back((double) (done - painted));
+            }
+
+            // Naive: both modes rendered, combined through the pixel API
+            start = host_us();
+            paint(old_d, from, ms);
+            paint(d, to, ms);
+            int shift = LW * ModeTransition::ease(t) >> 8;
+            for (int y = 0; y < LH; y++) {
+                for (int x = 0; x < LW; x++) {
+                    uint16_t px = x < LW - shift ? old_d.get_pixel(x + shift, y) : d.get_pixel(x - (LW - shift), y);
+                    old_d.draw_pixel(x, y, px);
+                }
+            }
+            r.naive.push_back((double) (host_us() - start));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int repeat = 50;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-n repeat]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    uint64_t total = 0;
+    std::mt19937 rng(7);
+    const int sizes[][2] = {{PANEL_W, PANEL_H}, {37, 53}};
+    for (const auto& size : sizes) {
+        for (int rotation = 0; rotation < 360; rotation += 90) {
+            for (int k = 1; k < (int) TransitionKind::COUNT; k++) {
+                Geometry g{size[0], size[1], rotation};
+                uint64_t bad = check(g, (TransitionKind) k, rng);
+                total += bad;
+                printf("check rotation=%d size=%dx%d kind=%s mismatches=%llu\n", rotation, g.width, g.height,
+                       ModeTransition::kind_name((TransitionKind) k), (unsigned long long) bad);
+            }
+        }
+    }
+
+    const char* pairs[][2] = {
+        {"IDLE", "LISTENING"}, {"LISTENING", "PROCESSING"}, {"PROCESSING", "QUESTION"}, {"QUESTION", "IDLE"},
+    };
+    for (const auto& pair : pairs) {
+        PairResult r;
+        run_pair(pair[0], pair[1], repeat, r);
+        printf("transition=%s->%s kind=%s frames=%zu snap_us=%.1f engine_p50_us=%.1f engine_max_us=%.1f "
+               "compose_us=%.1f naive_p50_us=%.1f naive_max_us=%.1f\n",
+               pair[0], pair[1], ModeTransition::kind_name(ModeTransition::kind_for(pair[0], pair[1])),
+               r.engine.size() / (size_t) repeat, percentile(r.snap, 0.5), percentile(r.engine, 0.5),
+               percentile(r.engine, 1.0), percentile(r.compose, 0.5), percentile(r.naive, 0.5),
+               percentile(r.naive, 1.0));
+    }
+
+    // Budget below any frame: every transition snaps
+    ModeTransition& mt = ModeTransition::instance();
+    ModeTransition::Stats before = mt.stats();
+    mt.set_budget_us(1);
+    PairResult tight;
+    run_pair("LISTENING", "PROCESSING", 5, tight);
+    run_pair("PROCESSING", "IDLE", 5, tight);
+    uint32_t started = mt.stats().started - before.started;
+    uint32_t skipped = mt.stats().skipped_budget - before.skipped_budget;
+    uint32_t frames = mt.stats().frames - before.frames;
+    printf("budget started=%u skipped=%u frames=%u\n", started, skipped, frames);
+    if (started != 0 || frames != 0 || skipped == 0) total++;
+
+    printf("total mismatches=%llu\n", (unsigned long long) total);
+    return total ? 1 : 0;
+}
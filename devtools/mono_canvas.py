@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""
+Mono Canvas - Fonts and bench driver for the 1-bit drawing engine.
+
+mono_canvas.h draws straight into 1-bit buffers (the ePaper framebuffer,
+ClawdMediaLink::image_buffer): word-wide fills for rectangles and
+horizontal lines, shift-and-OR blits for glyphs. This script rasterises
+MonoFont glyph sets with Pillow (the ePaper's Roboto Mono 12/16/24 when
+it can find it, any monospace TTF otherwise) and runs the native bench
+(devtools/mono_canvas_bench.cpp). The bench draws the EPAPER_DESIGN.md
+layouts through MonoCanvas and through a model of ESPHome's per-pixel
+path, checks the bits match, and reports operations and time per frame.
+
+--header writes a MonoFont as a C header, for drawing text with
+MonoCanvas::text() instead of the ESPHome font API.
+
+Usage:
+    g++ -O2 -DMONO_CANVAS_STATS -o /tmp/mono-canvas-bench devtools/mono_canvas_bench.cpp
+    python -m devtools.mono_canvas --bench --bin /tmp/mono-canvas-bench
+    python -m devtools.mono_canvas --bench --pbm /tmp/frames   # also write the frames
+
+    # MonoFont header (glyphs 0x20..0x7E)
+    python -m devtools.mono_canvas --header font_small.h --size 12 --name font_small
+"""
+
+import argparse
+import glob
+import os
+import re
+import struct
+import subprocess
+import tempfile
+from typing import Dict, List, Optional, Tuple
+
+try:
+    from PIL import Image, ImageDraw, ImageFont
+except ImportError:  # Only needed to build fonts
+    Image = None
+
+SIZES = (12, 16, 24)      # font_small, font_medium, font_large
+FIRST, LAST = 0x20, 0x7E
+FONT_GLOBS = (
+    "/usr/share/fonts/**/RobotoMono*Regular*.ttf",
+    "~/.local/share/fonts/**/RobotoMono*Regular*.ttf",
+    "/usr/share/fonts/**/DejaVuSansMono.ttf",
+    "/usr/share/fonts/**/LiberationMono-Regular.ttf",
+    "~/.rbenv/**/SourceCodePro-Regular.ttf",
+    "/usr/**/SourceCodePro-Regular.ttf",
+)
+LINE_RE = re.compile(r"^(frame=\S+|total) (.*)$")
+
+
+def find_font() -> Optional[str]:
+    """First monospace TTF found, Roboto Mono preferred."""
+    for pattern in FONT_GLOBS:
+        hits = sorted(glob.glob(os.path.expanduser(pattern), recursive=True))
+        if hits:
+            return hits[0]
+    return None
+
+
+def rasterise(path: Optional[str], size: int) -> Tuple[int, List[Tuple[int, int, int, int, int, int]], bytes]:
+    """One glyph set: (line_height, glyphs, bitmap).
+
+    glyphs are (offset_bits, w, h, x_off, y_off, advance), y_off from the
+    top of the line; each glyph is a packed MSB-first bitstream with stride
+    w, cropped to its ink.
+    """
+    font = ImageFont.truetype(path, size) if path else ImageFont.load_default(size)
+    ascent, descent = font.getmetrics()
+    bits: List[int] = []
+    glyphs = []
+    for code in range(FIRST, LAST + 1):
+        ch = chr(code)
+        advance = int(round(font.getlength(ch)))
+        img = Image.new("L", (size * 2, ascent + descent + 2), 0)
+        ImageDraw.Draw(img).text((0, 0), ch, font=font, fill=255)
+        box = img.point(lambda v: 255 if v >= 128 else 0).getbbox()
+        if box is None:
+            glyphs.append((len(bits), 0, 0, 0, 0, advance))
+            continue
+        left, top, right, bottom = box
+        for y in range(top, bottom):
+            for x in range(left, right):
+                bits.append(1 if img.getpixel((x, y)) >= 128 else 0)
+        w, h = right - left, bottom - top
+        glyphs.append((len(bits) - w * h, w, h, left, top, advance))
+    bitmap = bytearray((len(bits) + 7) // 8)
+    for i, b in enumerate(bits):
+        if b:
+            bitmap[i >> 3] |= 0x80 >> (i & 7)
+    return ascent + descent, glyphs, bytes(bitmap)
+
+
+def pack_fonts(sets) -> bytes:
+    """fonts.bin for mono_canvas_bench.cpp."""
+    out = bytearray(b"MFNT" + bytes([len(sets)]))
+    for line, glyphs, bitmap in sets:
+        out += struct.pack("<BBBI", FIRST, len(glyphs), line, len(bitmap))
+        for g in glyphs:
+            out += struct.pack("<IBBbbB", *g)
+        out += bitmap
+    return bytes(out)
+
+
+def write_header(path: str, name: str, line: int, glyphs, bitmap: bytes):
+    """MonoFont as a C header (the bitmap and glyph table stay in flash)."""
+    rows = [", ".join(f"0x{b:02X}" for b in bitmap[i:i + 16]) for i in range(0, len(bitmap), 16)]
+    with open(path, "w") as f:
+        f.write(f"// {name}: MonoFont generated by devtools/mono_canvas.py\n\n")
+        f.write("#pragma once\n#include \"mono_canvas.h\"\n\n")
+        f.write(f"static const uint8_t {name}_bitmap[] = {{\n")
+        f.write("".join(f"    {r},\n" for r in rows))
+        f.write("};\n\n")
+        f.write(f"static const MonoGlyph {name}_glyphs[] = {{\n")
+        for code, g in zip(range(FIRST, LAST + 1), glyphs):
+            f.write(f"    {{{g[0]}, {g[1]}, {g[2]}, {g[3]}, {g[4]}, {g[5]}}},  // {chr(code)!r}\n")
+        f.write("};\n\n")
+        f.write(f"static const MonoFont {name} = {{{name}_bitmap, {name}_glyphs, "
+                f"0x{FIRST:02X}, {len(glyphs)}, {line}}};\n")
+
+
+def parse(output: str) -> Dict[str, Dict[str, float]]:
+    """Bench lines -> {frame: {pixel_ops, canvas_ops, pixel_us, canvas_us, identical}}."""
+    rows = {}
+    for line in output.splitlines():
+        m = LINE_RE.match(line.strip())
+        if not m:
+            continue
+        name = m.group(1).split("=", 1)[-1]
+        rows[name] = {k: float(v) for k, v in (kv.split("=") for kv in m.group(2).split())}
+    return rows
+
+
+def bench(binary: str, font_path: Optional[str], repeat: int, pbm_dir: Optional[str]) -> bool:
+    print(f"Font: {font_path or 'Pillow default'} at {', '.join(map(str, SIZES))} px")
+    sets = [rasterise(font_path, size) for size in SIZES]
+    with tempfile.TemporaryDirectory() as tmp:
+        fonts = os.path.join(tmp, "fonts.bin")
+        with open(fonts, "wb") as f:
+            f.write(pack_fonts(sets))
+        cmd = [binary, fonts, "-n", str(repeat)]
+        if pbm_dir:
+            os.makedirs(pbm_dir, exist_ok=True)
+            cmd += ["-o", pbm_dir]
+        out = subprocess.run(cmd, capture_output=True, text=True)
+    rows = parse(out.stdout)
+    if "total" not in rows:
+        print(out.stdout + out.stderr)
+        return False
+
+    print(f"{'frame':<12}{'pixel ops':>11}{'canvas ops':>12}{'ratio':>8}"
+          f"{'pixel us':>10}{'canvas us':>11}{'speedup':>9}  bits")
+    for name, r in rows.items():
+        ratio = r["pixel_ops"] / max(r["canvas_ops"], 1)
+        speedup = r["pixel_us"] / max(r["canvas_us"], 1e-9)
+        print(f"{name:<12}{int(r['pixel_ops']):>11}{int(r['canvas_ops']):>12}{ratio:>7.1f}x"
+              f"{r['pixel_us']:>10.1f}{r['canvas_us']:>11.1f}{speedup:>8.1f}x  "
+              f"{'same' if r['identical'] else 'DIFFER'}")
+    if pbm_dir:
+        print(f"Frames written to {pbm_dir} (<frame>.pbm, <frame>-pixel.pbm)")
+    ok = out.returncode == 0 and all(r["identical"] for r in rows.values())
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: bench MonoCanvas against the pixel path, or write a MonoFont header."""
+    parser = argparse.ArgumentParser(description='1-bit canvas bench and font builder')
+    parser.add_argument('--bench', action='store_true', help='Render the ePaper layouts both ways and compare')
+    parser.add_argument('--bin', default='/tmp/mono-canvas-bench', help='Built mono_canvas_bench.cpp')
+    parser.add_argument('--font', help='TTF to rasterise (default: first monospace font found)')
+    parser.add_argument('--repeat', type=int, default=200, help='Timed renders per frame')
+    parser.add_argument('--pbm', help='Directory for the rendered frames')
+    parser.add_argument('--header', help='Write a MonoFont C header to this path')
+    parser.add_argument('--size', type=int, default=12, help='Pixel size for --header')
+    parser.add_argument('--name', default='mono_font', help='C identifier for --header')
+    args = parser.parse_args()
+
+    if Image is None:
+        raise SystemExit("Pillow is required: pip install pillow")
+    font_path = args.font or find_font()
+    if args.header:
+        line, glyphs, bitmap = rasterise(font_path, args.size)
+        write_header(args.header, args.name, line, glyphs, bitmap)
+        print(f"Wrote {args.header} ({len(glyphs)} glyphs, {len(bitmap)} bytes of bitmap)")
+        return
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin, font_path, args.repeat, args.pbm) else 1)
+
+
+if __name__ == '__main__':
+    main()
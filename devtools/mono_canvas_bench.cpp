@@ -0,0 +1,390 @@
+// Mono Canvas Bench - host build of mono_canvas.h
+//
+// Renders the four ePaper layouts of EPAPER_DESIGN.md (dashboard, question,
+// calendar, system monitor) twice: through MonoCanvas and through a model
+// of ESPHome's pixel path (DisplayBuffer::filled_rectangle -> horizontal_line
+// -> draw_pixel_at -> waveshare draw_absolute_pixel_internal, Font::print
+// testing every glyph pixel). Both must produce the same bits. Counts memory
+// operations (pixel writes and glyph bit reads vs word/byte reads and
+// writes) and time per frame.
+//
+// Also renders every frame shifted into the 240x135 image_buffer geometry
+// (ink = 1, clipped on all sides) and into a misaligned buffer (byte
+// fallback), and checks those against the pixel path too.
+//
+// Fonts come from mono_canvas.py (Pillow), little-endian:
+//   "MFNT" u8 fonts, then per font: u8 first, u8 count, u8 line_height,
+//   u32 bitmap_bytes, count x (u32 offset, u8 w, u8 h, i8 x_off, i8 y_off,
+//   u8 advance), bitmap. Fonts are small, medium, large (12/16/24 px).
+//
+// Build:
+//   g++ -O2 -DMONO_CANVAS_STATS -o /tmp/mono-canvas-bench devtools/mono_canvas_bench.cpp
+//
+// Usage:
+//   mono-canvas-bench fonts.bin [-n repeat] [-o pbm_dir]
+//   -> frame=<name> pixel_ops=<n> canvas_ops=<n> pixel_us=<t> canvas_us=<t> identical=<0|1>
+//      per frame, then: total ...
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../mono_canvas.h"
+
+struct LoadedFont {
+    std::vector<uint8_t> bitmap;
+    std::vector<MonoGlyph> glyphs;
+    MonoFont font;
+};
+
+static bool load_fonts(const char* path, std::vector<LoadedFont>& fonts) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> d;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) d.insert(d.end(), buf, buf + n);
+    fclose(f);
+    if (d.size() < 5 || memcmp(d.data(), "MFNT", 4) != 0) return false;
+    size_t pos = 5;
+    auto u32 = [&](size_t p) {
+        return (uint32_t) d[p] | (uint32_t) d[p + 1] << 8 | (uint32_t) d[p + 2] << 16 | (uint32_t) d[p + 3] << 24;
+    };
+    fonts.resize(d[4]);
+    for (LoadedFont& lf : fonts) {
+        if (pos + 7 > d.size()) return false;
+        uint8_t first = d[pos], count = d[pos + 1], line = d[pos + 2];
+        uint32_t bytes = u32(pos + 3);
+        pos += 7;
+        if (pos + count * 9u + bytes > d.size()) return false;
+        for (int i = 0; i < count; i++, pos += 9) {
+            lf.glyphs.push_back({u32(pos), d[pos + 4], d[pos + 5], (int8_t) d[pos + 6], (int8_t) d[pos + 7], d[pos + 8]});
+        }
+        lf.bitmap.assign(d.begin() + pos, d.begin() + pos + bytes);
+        pos += bytes;
+        lf.font = {lf.bitmap.data(), lf.glyphs.data(), first, count, line};
+    }
+    return fonts.size() >= 3;
+}
+
+// ESPHome's generic path, reduced to what a 1-bit waveshare panel runs
+class PixelDisplay {
+public:
+    PixelDisplay(uint8_t* buf, int width, int height, bool ink_is_set)
+        : buffer_(buf), width_(width), height_(height), ink_is_set_(ink_is_set) {}
+    virtual ~PixelDisplay() {}
+
+    uint64_t ops = 0;
+
+    void fill(bool on) {  // WaveshareEPaper::fill is a memset
+        size_t bytes = (size_t) (width_ * height_ + 7) / 8;
+        memset(buffer_, (on == ink_is_set_) ? 0xFF : 0x00, bytes);
+        ops += bytes / 4;
+    }
+    void draw_pixel_at(int x, int y, bool on) {
+        if (x < clip_x1_ || y < clip_y1_ || x >= clip_x2_ || y >= clip_y2_) return;
+        switch (rotation_) {  // DISPLAY_ROTATION_0_DEGREES on the pager
+            case 0: break;
+            case 180: x = width_ - x - 1; y = height_ - y - 1; break;
+        }
+        draw_absolute_pixel_internal(x, y, on);
+        feed_wdt();
+    }
+    void horizontal_line(int x, int y, int w, bool on) {
+        for (int i = x; i < x + w; i++) draw_pixel_at(i, y, on);
+    }
+    void vertical_line(int x, int y, int h, bool on) {
+        for (int i = y; i < y + h; i++) draw_pixel_at(x, i, on);
+    }
+    void filled_rectangle(int x, int y, int w, int h, bool on) {
+        for (int i = y; i < y + h; i++) horizontal_line(x, i, w, on);
+    }
+    void rectangle(int x, int y, int w, int h, bool on) {
+        horizontal_line(x, y, w, on);
+        horizontal_line(x, y + h - 1, w, on);
+        vertical_line(x, y, h, on);
+        vertical_line(x + w - 1, y, h, on);
+    }
+    int print(int x, int y, const MonoFont& font, const char* str, bool on) {
+        for (; *str; str++) {
+            uint8_t c = (uint8_t) *str;
+            if (c < font.first || c >= font.first + font.count) continue;
+            const MonoGlyph& g = font.glyphs[c - font.first];
+            for (int gy = 0; gy < g.height; gy++) {
+                for (int gx = 0; gx < g.width; gx++) {
+                    uint32_t pos = g.offset + gy * g.width + gx;
+                    ops++;
+                    if (font.bitmap[pos >> 3] & (0x80 >> (pos & 7))) draw_pixel_at(x + g.x_off + gx, y + g.y_off + gy, on);
+                }
+            }
+            x += g.advance;
+        }
+        return x;
+    }
+
+protected:
+    // App.feed_wdt(): an out-of-line call per pixel that mostly returns early
+    __attribute__((noinline)) void feed_wdt() {
+        if (++wdt_calls_ & 0xFFF) return;
+        asm volatile("" ::: "memory");
+    }
+
+    virtual void draw_absolute_pixel_internal(int x, int y, bool on) {
+        ops++;
+        if (x >= width_ || y >= height_ || x < 0 || y < 0) return;
+        const uint32_t pos = (x + y * width_) / 8u;
+        const uint8_t subpos = x & 0x07;
+        if (on == ink_is_set_) buffer_[pos] |= 0x80 >> subpos;
+        else buffer_[pos] &= ~(0x80 >> subpos);
+    }
+
+    uint8_t* buffer_;
+    int width_, height_;
+    bool ink_is_set_;
+    int rotation_ = 0;
+    uint32_t wdt_calls_ = 0;
+    int clip_x1_ = -32768, clip_y1_ = -32768, clip_x2_ = 32767, clip_y2_ = 32767;
+};
+
+// Same calls on both backends
+struct PixelPainter {
+    PixelDisplay& d;
+    void clear() { d.fill(false); }
+    void fill(int x, int y, int w, int h) { d.filled_rectangle(x, y, w, h, true); }
+    void erase(int x, int y, int w, int h) { d.filled_rectangle(x, y, w, h, false); }
+    void hline(int x, int y, int w) { d.horizontal_line(x, y, w, true); }
+    void vline(int x, int y, int h) { d.vertical_line(x, y, h, true); }
+    void rect(int x, int y, int w, int h) { d.rectangle(x, y, w, h, true); }
+    int text(int x, int y, const MonoFont& f, const char* s, bool on = true) { return d.print(x, y, f, s, on); }
+};
+
+struct CanvasPainter {
+    MonoCanvas& c;
+    void clear() { c.clear(false); }
+    void fill(int x, int y, int w, int h) { c.fill_rect(x, y, w, h, true); }
+    void erase(int x, int y, int w, int h) { c.fill_rect(x, y, w, h, false); }
+    void hline(int x, int y, int w) { c.hline(x, y, w, true); }
+    void vline(int x, int y, int h) { c.vline(x, y, h, true); }
+    void rect(int x, int y, int w, int h) { c.rect(x, y, w, h, true); }
+    int text(int x, int y, const MonoFont& f, const char* s, bool on = true) { return c.text(x, y, f, s, on); }
+};
+
+struct Fonts {
+    const MonoFont& small;
+    const MonoFont& medium;
+    const MonoFont& large;
+};
+
+// Header (30 px): clock left, battery right, divider
+template<typename P>
+static void header(P& p, const Fonts& f, int ox, int oy, const char* left) {
+    p.text(ox + 5, oy + 7, f.medium, left);
+    const char* batt = "85%";
+    int bx = ox + 195 - MonoCanvas::text_width(f.small, batt);
+    p.text(bx, oy + 9, f.small, batt);
+    p.rect(bx - 26, oy + 10, 20, 11);  // Battery outline, nub, level
+    p.fill(bx - 6, oy + 13, 2, 5);
+    p.fill(bx - 24, oy + 12, 14, 7);
+    p.hline(ox, oy + 30, 200);
+}
+
+template<typename P>
+static void frame_dashboard(P& p, const Fonts& f, int ox, int oy) {
+    p.rect(ox, oy, 200, 200);
+    header(p, f, ox, oy, "14:23");
+    p.text(ox + 5, oy + 35, f.small, "AGENT: Editing files...");
+    p.text(ox + 5, oy + 51, f.small, "Tool: grep_files");
+    p.hline(ox, oy + 80, 200);
+    p.text(ox + 5, oy + 85, f.small, "TASKS:");
+    p.fill(ox + 8, oy + 105, 4, 4);
+    p.text(ox + 16, oy + 100, f.small, "Awaiting approval");
+    p.fill(ox + 8, oy + 121, 4, 4);
+    p.text(ox + 16, oy + 116, f.small, "2 notifications pending");
+    p.hline(ox, oy + 140, 200);
+    p.text(ox + 5, oy + 145, f.small, "WIFI: ClawdNet");
+    p.text(ox + 5, oy + 161, f.small, "IP: 192.168.50.85");
+    p.text(ox + 5, oy + 177, f.small, "Uptime: 4h 23m");
+}
+
+template<typename P>
+static void frame_question(P& p, const Fonts& f, int ox, int oy) {
+    p.rect(ox, oy, 200, 200);
+    header(p, f, ox, oy, "14:23");
+    p.text(ox + 88, oy + 36, f.large, "?");
+    p.text(ox + 15, oy + 70, f.medium, "Delete 5 files?");
+    p.text(ox + 15, oy + 96, f.small, "/home/monroe/test.txt");
+    p.text(ox + 15, oy + 112, f.small, "/home/monroe/old.log");
+    p.text(ox + 15, oy + 128, f.small, "...and 3 more");
+    p.hline(ox, oy + 160, 200);
+    p.fill(ox + 15, oy + 167, 70, 26);  // YES: filled button, inverted text
+    p.text(ox + 33, oy + 172, f.medium, "YES", false);
+    p.rect(ox + 115, oy + 167, 70, 26);
+    p.text(ox + 137, oy + 172, f.medium, "NO");
+}
+
+template<typename P>
+static void frame_calendar(P& p, const Fonts& f, int ox, int oy) {
+    p.rect(ox, oy, 200, 200);
+    header(p, f, ox, oy, "14:23");
+    p.text(ox + 5, oy + 36, f.medium, "TODAY - Mon Feb 10");
+    p.text(ox + 5, oy + 62, f.small, "09:00  Morning standup");
+    p.text(ox + 5, oy + 78, f.small, "14:00  Code review");
+    p.text(ox + 5, oy + 94, f.small, "16:30  Deploy to prod");
+    p.vline(ox + 47, oy + 60, 52);
+    p.text(ox + 5, oy + 124, f.medium, "TOMORROW - Feb 11");
+    p.text(ox + 5, oy + 150, f.small, "10:00  Client meeting");
+    p.vline(ox + 47, oy + 148, 18);
+}
+
+template<typename P>
+static void frame_system(P& p, const Fonts& f, int ox, int oy) {
+    p.rect(ox, oy, 200, 200);
+    header(p, f, ox, oy, "fcfdev 14:23");
+    const char* names[] = {"CPU:", "MEM:", "DSK:"};
+    const char* pct[] = {"80%", "60%", "30%"};
+    const int level[] = {80, 60, 30};
+    for (int i = 0; i < 3; i++) {
+        int y = oy + 36 + i * 18;
+        p.text(ox + 5, y, f.small, names[i]);
+        p.rect(ox + 40, y + 2, 102, 12);
+        p.fill(ox + 41, y + 3, level[i], 10);
+        for (int t = 20; t < 100; t += 20) p.vline(ox + 41 + t, y + 3, 10);  // Tick marks
+        p.text(ox + 150, y, f.small, pct[i]);
+    }
+    p.text(ox + 5, oy + 94, f.small, "SERVICES:");
+    p.text(ox + 5, oy + 110, f.small, "+ clawd-bridge");
+    p.text(ox + 5, oy + 126, f.small, "+ clawdbot");
+    p.text(ox + 5, oy + 142, f.small, "x nginx (stopped)");
+    p.hline(ox, oy + 166, 200);
+    p.text(ox + 5, oy + 174, f.small, "NETWORK: 192.168.50.50");
+}
+
+typedef void (*PixelFrame)(PixelPainter&, const Fonts&, int, int);
+typedef void (*CanvasFrame)(CanvasPainter&, const Fonts&, int, int);
+
+struct Frame {
+    const char* name;
+    PixelFrame pixel;
+    CanvasFrame canvas;
+};
+
+static void write_pbm(const std::string& path, const uint8_t* buf, int w, int h, bool ink_is_set) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return;
+    fprintf(f, "P4\n%d %d\n", w, h);  // P4: 1 = black, rows padded to bytes
+    for (int y = 0; y < h; y++) {
+        for (int xb = 0; xb < (w + 7) / 8; xb++) {
+            uint8_t out = 0;
+            for (int b = 0; b < 8 && xb * 8 + b < w; b++) {
+                uint32_t pos = (uint32_t) y * w + xb * 8 + b;
+                bool set = buf[pos >> 3] & (0x80 >> (pos & 7));
+                if (set == ink_is_set) out |= 0x80 >> b;
+            }
+            fputc(out, f);
+        }
+    }
+    fclose(f);
+}
+
+int main(int argc, char** argv) {
+    const char* font_path = nullptr;
+    const char* out_dir = nullptr;
+    int repeat = 200;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-n" && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (a == "-o" && i + 1 < argc) out_dir = argv[++i];
+        else font_path = argv[i];
+    }
+    std::vector<LoadedFont> loaded;
+    if (!font_path || !load_fonts(font_path, loaded)) {
+        fprintf(stderr, "usage: %s fonts.bin [-n repeat] [-o pbm_dir]\n", argv[0]);
+        return 2;
+    }
+    Fonts fonts{loaded[0].font, loaded[1].font, loaded[2].font};
+    const Frame frames[] = {
+        {"dashboard", frame_dashboard<PixelPainter>, frame_dashboard<CanvasPainter>},
+        {"question", frame_question<PixelPainter>, frame_question<CanvasPainter>},
+        {"calendar", frame_calendar<PixelPainter>, frame_calendar<CanvasPainter>},
+        {"system", frame_system<PixelPainter>, frame_system<CanvasPainter>},
+    };
+
+    const int W = 200, H = 200, BYTES = W * H / 8;
+    const int IW = 240, IH = 135, IBYTES = IW * IH / 8;
+    alignas(4) static uint8_t ref[BYTES], out[BYTES];
+    alignas(4) static uint8_t iref[IBYTES], iout[IBYTES];
+    alignas(4) static uint8_t shifted[BYTES + 4];
+
+    uint64_t all_pixel = 0, all_canvas = 0;
+    double all_pixel_us = 0, all_canvas_us = 0;
+    bool all_identical = true;
+    for (const Frame& fr : frames) {
+        // Op counts from one frame
+        PixelDisplay pd(ref, W, H, false);
+        PixelPainter pp{pd};
+        pp.clear();
+        fr.pixel(pp, fonts, 0, 0);
+        MonoCanvas mc(out, W, H, MonoCanvas::INK_ZERO, W);
+        CanvasPainter cp{mc};
+        cp.clear();
+        fr.canvas(cp, fonts, 0, 0);
+        bool identical = memcmp(ref, out, BYTES) == 0;
+
+        // image_buffer geometry: ink = 1, clipped on every side
+        for (int shift = 0; shift < 2; shift++) {
+            int ox = shift ? 60 : -17, oy = shift ? -80 : -9;
+            PixelDisplay ipd(iref, IW, IH, true);
+            PixelPainter ipp{ipd};
+            ipp.clear();
+            fr.pixel(ipp, fonts, ox, oy);
+            MonoCanvas imc(iout, IW, IH);
+            CanvasPainter icp{imc};
+            icp.clear();
+            fr.canvas(icp, fonts, ox, oy);
+            identical = identical && memcmp(iref, iout, IBYTES) == 0;
+        }
+
+        // Misaligned buffer: byte fallback
+        MonoCanvas uc(shifted + 1, W, H, MonoCanvas::INK_ZERO, W);
+        CanvasPainter ucp{uc};
+        ucp.clear();
+        fr.canvas(ucp, fonts, 0, 0);
+        identical = identical && memcmp(ref, shifted + 1, BYTES) == 0;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; i++) {
+            PixelDisplay d(ref, W, H, false);
+            PixelPainter p{d};
+            p.clear();
+            fr.pixel(p, fonts, 0, 0);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; i++) {
+            MonoCanvas c(out, W, H, MonoCanvas::INK_ZERO, W);
+            CanvasPainter p{c};
+            p.clear();
+            fr.canvas(p, fonts, 0, 0);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        double pixel_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / repeat;
+        double canvas_us = std::chrono::duration<double, std::micro>(t2 - t1).count() / repeat;
+
+        if (out_dir) {
+            write_pbm(std::string(out_dir) + "/" + fr.name + ".pbm", out, W, H, false);
+            write_pbm(std::string(out_dir) + "/" + fr.name + "-pixel.pbm", ref, W, H, false);
+        }
+        printf("frame=%s pixel_ops=%llu canvas_ops=%u pixel_us=%.2f canvas_us=%.2f identical=%d\n", fr.name,
+               (unsigned long long) pd.ops, (unsigned) mc.ops(), pixel_us, canvas_us, identical ? 1 : 0);
+        all_pixel += pd.ops;
+        all_canvas += mc.ops();
+        all_pixel_us += pixel_us;
+        all_canvas_us += canvas_us;
+        all_identical = all_identical && identical;
+    }
+    printf("total pixel_ops=%llu canvas_ops=%llu pixel_us=%.2f canvas_us=%.2f identical=%d\n",
+           (unsigned long long) all_pixel, (unsigned long long) all_canvas, all_pixel_us, all_canvas_us,
+           all_identical ? 1 : 0);
+    return all_identical ? 0 : 1;
+}
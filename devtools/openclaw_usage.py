@@ -2,15 +2,38 @@
 """
 OpenClaw Usage Calculator
 Parses OpenClaw session JSONL files and calculates token usage and costs.
+
+Session files are append-only, so get_monthly_usage() keeps a checkpoint per
+file (inode, size, byte offset of the last complete line, CRC of the bytes
+just before it) together with that file's partial sums per (month, model).
+Reruns only parse appended bytes; a file that shrank or was replaced is
+rescanned from the start. Lines without
+a "usage" key are skipped before json.loads, and large backlogs are scanned
+across cores.
+
+Usage:
+    python -m devtools.openclaw_usage            # report
+    python -m devtools.openclaw_usage --json
+    python -m devtools.openclaw_usage --bench /tmp/corpus --size-mb 2048
 """
 
 import json
+import mmap
 import os
+import time
+import zlib
+from concurrent.futures import ProcessPoolExecutor
 from pathlib import Path
 from datetime import datetime, timedelta
-from typing import Dict, List, Tuple
+from typing import Dict, List, Optional, Tuple
 from collections import defaultdict
 
+CHECKPOINT_PATH = Path.home() / ".clawd" / "openclaw_usage_checkpoint.json"
+CHECKPOINT_VERSION = 1
+
+# Below this many unparsed bytes, process startup costs more than it saves
+PARALLEL_MIN_BYTES = 32 * 1024 * 1024
+
 # Model pricing (per 1M tokens)
 MODEL_PRICING = {
     # Anthropic Claude
@@ -57,49 +80,56 @@ def calculate_cost(model_id: str, input_tokens: int, output_tokens: int) -> floa
     return input_cost + output_cost
 
 
+def usage_record(entry: Dict) -> Optional[Dict]:
+    """Extract a usage record from one session entry (None if it has none)."""
+    # Look for message entries with usage data
+    if entry.get("type") != "message" or "message" not in entry:
+        return None
+    msg = entry["message"]
+    if "usage" not in msg or not msg["usage"]:
+        return None
+    usage = msg["usage"]
+
+    # Extract data
+    timestamp = entry.get("timestamp", "")
+    model = msg.get("model", "unknown")
+    input_tokens = usage.get("input", 0)
+    output_tokens = usage.get("output", 0)
+    cache_read = usage.get("cacheRead", 0)
+    cache_write = usage.get("cacheWrite", 0)
+
+    # Calculate cost (use provided cost if available, otherwise calculate)
+    if "cost" in usage and usage["cost"].get("total", 0) > 0:
+        cost = usage["cost"]["total"]
+    else:
+        cost = calculate_cost(model, input_tokens, output_tokens)
+
+    return {
+        "timestamp": timestamp,
+        "model": model,
+        "input_tokens": input_tokens,
+        "output_tokens": output_tokens,
+        "cache_read": cache_read,
+        "cache_write": cache_write,
+        "cost": cost,
+    }
+
+
 def parse_session_file(file_path: Path) -> List[Dict]:
     """Parse a session JSONL file and extract usage data."""
     usage_records = []
     
     try:
-        with open(file_path, 'r') as f:
+        with open(file_path, 'rb') as f:
             for line in f:
-                try:
-                    entry = json.loads(line.strip())
-                    
-                    # Look for message entries with usage data
-                    if entry.get("type") == "message" and "message" in entry:
-                        msg = entry["message"]
-                        if "usage" in msg and msg["usage"]:
-                            usage = msg["usage"]
-                            
-                            # Extract data
-                            timestamp = entry.get("timestamp", "")
-                            model = msg.get("model", "unknown")
-                            input_tokens = usage.get("input", 0)
-                            output_tokens = usage.get("output", 0)
-                            cache_read = usage.get("cacheRead", 0)
-                            cache_write = usage.get("cacheWrite", 0)
-                            
-                            # Calculate cost (use provided cost if available, otherwise calculate)
-                            if "cost" in usage and usage["cost"].get("total", 0) > 0:
-                                cost = usage["cost"]["total"]
-                            else:
-                                cost = calculate_cost(model, input_tokens, output_tokens)
-                            
-                            usage_records.append({
-                                "timestamp": timestamp,
-                                "model": model,
-                                "input_tokens": input_tokens,
-                                "output_tokens": output_tokens,
-                                "cache_read": cache_read,
-                                "cache_write": cache_write,
-                                "cost": cost,
-                            })
-                            
-                except json.JSONDecodeError:
+                # Cheap byte test first: most lines are not usage records
+                if b'"usage"' not in line:
                     continue
-                except Exception as e:
+                try:
+                    record = usage_record(json.loads(line))
+                    if record:
+                        usage_records.append(record)
+                except Exception:
                     # Skip malformed entries
                     continue
                     
@@ -109,6 +139,157 @@ def parse_session_file(file_path: Path) -> List[Dict]:
     return usage_records
 
 
+def scan_session_file(path: str, offset: int) -> Tuple[int, Dict[str, List[float]]]:
+    """
+    Parse complete lines from offset onward.
+
+    Returns:
+        (offset after the last complete line, sums keyed "YYYY-MM|model" as
+        [input_tokens, output_tokens, cache_tokens, cost])
+    """
+    sums: Dict[str, List[float]] = {}
+    size = os.path.getsize(path)
+    if size <= offset:
+        return offset, sums
+
+    with open(path, 'rb') as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+        # A trailing line without a newline may still be mid-write: leave it
+        end = data.rfind(b'\n', offset, size) + 1
+        if end <= offset:
+            return offset, sums
+        pos = offset
+        while True:
+            # Jump straight to the next line mentioning usage
+            hit = data.find(b'"usage"', pos, end)
+            if hit < 0:
+                break
+            start = data.rfind(b'\n', pos, hit) + 1 or pos
+            stop = data.find(b'\n', hit, end)
+            pos = stop + 1
+            try:
+                record = usage_record(json.loads(data[start:stop]))
+                if not record:
+                    continue
+                dt = datetime.fromisoformat(record["timestamp"].replace("Z", "+00:00"))
+            except Exception:
+                continue
+            key = f"{dt.strftime('%Y-%m')}|{record['model']}"
+            acc = sums.setdefault(key, [0, 0, 0, 0.0])
+            acc[0] += record["input_tokens"]
+            acc[1] += record["output_tokens"]
+            acc[2] += record["cache_read"] + record["cache_write"]
+            acc[3] += record["cost"]
+    return end, sums
+
+
+def _tail_crc(path: str, offset: int) -> int:
+    """CRC of the 64 bytes before offset; catches a rewritten file reusing the inode."""
+    with open(path, 'rb') as f:
+        f.seek(max(0, offset - 64))
+        return zlib.crc32(f.read(min(offset, 64)))
+
+
+def _merge_sums(into: Dict[str, List[float]], sums: Dict[str, List[float]]):
+    for key, values in sums.items():
+        acc = into.setdefault(key, [0, 0, 0, 0.0])
+        for i, v in enumerate(values):
+            acc[i] += v
+
+
+def _load_checkpoint(path: Path) -> Dict[str, Dict]:
+    try:
+        data = json.loads(path.read_text())
+        if data.get("version") == CHECKPOINT_VERSION:
+            return data["files"]
+    except Exception:
+        pass
+    return {}
+
+
+def _save_checkpoint(path: Path, files: Dict[str, Dict]):
+    try:
+        path.parent.mkdir(parents=True, exist_ok=True)
+        tmp = path.with_suffix(".tmp")
+        tmp.write_text(json.dumps({"version": CHECKPOINT_VERSION, "files": files}))
+        os.replace(tmp, path)
+    except OSError as e:
+        print(f"Could not save usage checkpoint: {e}")
+
+
+def aggregate_usage(session_files: List[Path], checkpoint_path: Optional[Path] = CHECKPOINT_PATH,
+                    workers: Optional[int] = None) -> Dict[str, List[float]]:
+    """
+    Sum usage per (month, model) across session files, parsing only new bytes.
+
+    Args:
+        session_files: JSONL files to include
+        checkpoint_path: Where per-file progress is kept (None = no checkpoint)
+        workers: Process count for large backlogs (default: CPU count)
+
+    Returns:
+        Sums keyed "YYYY-MM|model" as [input, output, cache, cost]
+    """
+    old = _load_checkpoint(checkpoint_path) if checkpoint_path else {}
+    files: Dict[str, Dict] = {}
+    jobs: List[Tuple[str, int]] = []
+    pending_bytes = 0
+
+    for session_file in session_files:
+        path = str(session_file)
+        try:
+            st = os.stat(path)
+        except OSError:
+            continue
+        entry = old.get(path)
+        # Same file, not truncated, same bytes before the offset: resume there
+        if (not entry or entry["inode"] != st.st_ino or st.st_size < entry["offset"]
+                or _tail_crc(path, entry["offset"]) != entry["tail_crc"]):
+            entry = {"inode": st.st_ino, "offset": 0, "tail_crc": 0, "sums": {}}
+        entry["size"] = st.st_size
+        files[path] = entry
+        if st.st_size > entry["offset"]:
+            jobs.append((path, entry["offset"]))
+            pending_bytes += st.st_size - entry["offset"]
+
+    if jobs:
+        if pending_bytes >= PARALLEL_MIN_BYTES and len(jobs) > 1 and (workers or os.cpu_count() or 1) > 1:
+            # Largest files first so one big file doesn't finish last
+            jobs.sort(key=lambda j: files[j[0]]["size"] - j[1], reverse=True)
+            with ProcessPoolExecutor(max_workers=workers) as pool:
+                results = list(pool.map(scan_session_file, *zip(*jobs), chunksize=1))
+        else:
+            results = []
+            for path, offset in jobs:
+                try:
+                    results.append(scan_session_file(path, offset))
+                except OSError as e:
+                    print(f"Error reading {path}: {e}")
+                    results.append((offset, {}))
+        for (path, _), (offset, sums) in zip(jobs, results):
+            files[path]["offset"] = offset
+            files[path]["tail_crc"] = _tail_crc(path, offset)
+            _merge_sums(files[path]["sums"], sums)
+
+        if checkpoint_path:
+            _save_checkpoint(checkpoint_path, files)
+
+    total: Dict[str, List[float]] = {}
+    for entry in files.values():
+        _merge_sums(total, entry["sums"])
+    return total
+
+
+def find_session_files(openclaw_dir: Path) -> List[Path]:
+    """All session JSONL files under ~/.openclaw/agents/*/sessions."""
+    session_files = []
+    for agent_dir in openclaw_dir.iterdir():
+        if agent_dir.is_dir():
+            sessions_dir = agent_dir / "sessions"
+            if sessions_dir.exists():
+                session_files.extend(sessions_dir.glob("*.jsonl"))
+    return session_files
+
+
 def get_monthly_usage(months_back: int = 4) -> Dict:
     """
     Calculate monthly token usage from OpenClaw session files.
@@ -134,18 +315,8 @@ def get_monthly_usage(months_back: int = 4) -> Dict:
             "by_model": {},
         }
     
-    # Find all session files
-    session_files = []
-    for agent_dir in openclaw_dir.iterdir():
-        if agent_dir.is_dir():
-            sessions_dir = agent_dir / "sessions"
-            if sessions_dir.exists():
-                session_files.extend(sessions_dir.glob("*.jsonl"))
-    
-    # Parse all sessions
-    all_usage = []
-    for session_file in session_files:
-        all_usage.extend(parse_session_file(session_file))
+    # Sum new bytes onto the checkpointed per-file totals
+    sums = aggregate_usage(find_session_files(openclaw_dir))
     
     # Organize by month
     monthly_data = defaultdict(lambda: {
@@ -155,11 +326,6 @@ def get_monthly_usage(months_back: int = 4) -> Dict:
         "cost": 0.0,
     })
     
-    model_data = defaultdict(lambda: {
-        "tokens": 0,
-        "cost": 0.0,
-    })
-    
     # Current month model data (FIXED: was accumulating all-time data)
     current_month_str = datetime.now().strftime("%Y-%m")
     current_month_model_data = defaultdict(lambda: {
@@ -167,28 +333,17 @@ def get_monthly_usage(months_back: int = 4) -> Dict:
         "cost": 0.0,
     })
     
-    for record in all_usage:
-        try:
-            dt = datetime.fromisoformat(record["timestamp"].replace("Z", "+00:00"))
-            month = dt.strftime("%Y-%m")
-            
-            monthly_data[month]["input_tokens"] += record["input_tokens"]
-            monthly_data[month]["output_tokens"] += record["output_tokens"]
-            monthly_data[month]["cache_tokens"] += record["cache_read"] + record["cache_write"]
-            monthly_data[month]["cost"] += record["cost"]
-            
-            # By-model breakdown (all-time)
-            model = record["model"]
-            model_data[model]["tokens"] += record["input_tokens"] + record["output_tokens"]
-            model_data[model]["cost"] += record["cost"]
-            
-            # Current month by-model breakdown (FIXED)
-            if month == current_month_str:
-                current_month_model_data[model]["tokens"] += record["input_tokens"] + record["output_tokens"]
-                current_month_model_data[model]["cost"] += record["cost"]
-            
-        except Exception as e:
-            continue
+    for key, (input_tokens, output_tokens, cache_tokens, cost) in sums.items():
+        month, model = key.split("|", 1)
+        monthly_data[month]["input_tokens"] += int(input_tokens)
+        monthly_data[month]["output_tokens"] += int(output_tokens)
+        monthly_data[month]["cache_tokens"] += int(cache_tokens)
+        monthly_data[month]["cost"] += cost
+        
+        # Current month by-model breakdown (FIXED)
+        if month == current_month_str:
+            current_month_model_data[model]["tokens"] += int(input_tokens + output_tokens)
+            current_month_model_data[model]["cost"] += cost
     
     # Build response
     current_month = datetime.now().strftime("%Y-%m")
@@ -237,11 +392,91 @@ def get_monthly_usage(months_back: int = 4) -> Dict:
     }
 
 
+def _write_synthetic_corpus(root: Path, size_mb: int, files: int = 64):
+    """Session-like JSONL: mostly tool/content lines, some usage records."""
+    models = ["claude-sonnet-4-5", "claude-opus-4-6", "gemini-3-flash-preview", "gpt-4o"]
+    filler = "x" * 600
+    per_file = size_mb * 1024 * 1024 // files
+    for i in range(files):
+        sessions = root / f"agent{i % 4}" / "sessions"
+        sessions.mkdir(parents=True, exist_ok=True)
+        with open(sessions / f"session{i}.jsonl", "w") as f:
+            written = n = 0
+            while written < per_file:
+                n += 1
+                if n % 4 == 0:
+                    line = json.dumps({
+                        "type": "message", "timestamp": f"2026-{1 + n % 10:02d}-15T12:00:00Z",
+                        "message": {"model": models[n % 4], "content": filler[:200],
+                                    "usage": {"input": n % 5000, "output": n % 900,
+                                              "cacheRead": n % 300, "cacheWrite": 0}}})
+                else:
+                    line = json.dumps({"type": "tool_result", "timestamp": "2026-03-01T00:00:00Z",
+                                       "content": filler})
+                f.write(line + "\n")
+                written += len(line) + 1
+
+
+def bench(corpus: Path, size_mb: int):
+    """Compare the full json.loads rescan with cold, warm and append-only runs."""
+    if not corpus.exists():
+        print(f"Writing {size_mb} MB synthetic corpus to {corpus}...")
+        _write_synthetic_corpus(corpus, size_mb)
+    session_files = find_session_files(corpus)
+    total_mb = sum(f.stat().st_size for f in session_files) / 1e6
+    checkpoint = corpus / "checkpoint.json"
+    if checkpoint.exists():
+        checkpoint.unlink()
+
+    start = time.perf_counter()
+    legacy: Dict[str, float] = defaultdict(float)
+    for session_file in session_files:
+        for record in parse_session_file(session_file):
+            legacy[record["model"]] += record["cost"]
+    t_legacy = time.perf_counter() - start
+
+    start = time.perf_counter()
+    cold = aggregate_usage(session_files, checkpoint)
+    t_cold = time.perf_counter() - start
+
+    start = time.perf_counter()
+    aggregate_usage(session_files, checkpoint)
+    t_warm = time.perf_counter() - start
+
+    # Append ~1% to a few files, as live sessions do
+    appended = 0
+    for session_file in session_files[:4]:
+        with open(session_file, "a") as f:
+            for _ in range(max(1, int(total_mb * 1e6 * 0.0025) // 300)):
+                line = json.dumps({"type": "message", "timestamp": "2026-10-01T00:00:00Z",
+                                   "message": {"model": "gpt-4o", "usage": {"input": 10, "output": 5}}})
+                f.write(line + "\n")
+                appended += len(line) + 1
+    start = time.perf_counter()
+    aggregate_usage(session_files, checkpoint)
+    t_append = time.perf_counter() - start
+
+    cold_by_model: Dict[str, float] = defaultdict(float)
+    for key, values in cold.items():
+        cold_by_model[key.split("|", 1)[1]] += values[3]
+    match = all(abs(legacy[m] - cold_by_model[m]) < 1e-6 for m in legacy)
+
+    print(f"Corpus: {len(session_files)} files, {total_mb:,.0f} MB")
+    print(f"  full rescan (parse_session_file):    {t_legacy:7.2f} s  {total_mb / t_legacy:8.0f} MB/s")
+    print(f"  cold aggregate ({os.cpu_count()} cores):        {t_cold:7.2f} s  {total_mb / t_cold:8.0f} MB/s")
+    print(f"  warm rerun (no new bytes):           {t_warm * 1000:7.1f} ms")
+    print(f"  rerun after {appended / 1e6:.1f} MB appended:      {t_append * 1000:7.1f} ms")
+    print(f"  totals match full rescan: {match}")
+
+
 def main():
     """CLI tool for testing."""
     import sys
     
-    if len(sys.argv) > 1 and sys.argv[1] == "--json":
+    if len(sys.argv) > 2 and sys.argv[1] == "--bench":
+        size_mb = int(sys.argv[sys.argv.index("--size-mb") + 1]) if "--size-mb" in sys.argv else 1024
+        bench(Path(sys.argv[2]).expanduser(), size_mb)
+    elif len(sys.argv) > 1 and sys.argv[1] == "--json":
         # Output JSON
         usage = get_monthly_usage()
         print(json.dumps(usage, indent=2))
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Page Index - Bench driver for display_modes/page_index.h.
+
+QUESTION mode used to word-wrap the whole message every frame. PageIndex
+wraps once per message into a fixed table of 16-bit line offsets, so the
+auto-scroll and B-button paging are lookups. The native bench
+(devtools/page_index_bench.cpp) builds the index for messages of 100 B to
+16 KB at two box sizes, checks every line against the old per-frame wrap,
+checks paging and truncation at PageIndex::MAX_LINES, and that nothing
+touches the heap. It reports the one-off build, the per-frame cost with the
+index against the old wrap, and memory: the index is a fixed table, the old
+wrap churned heap in proportion to the message every frame. Messages reach
+the pager cut to 4 KB (TextStore::MESSAGE_CAP); the larger sizes show the
+headroom and the MAX_LINES cut.
+
+Usage:
+    g++ -O2 -I. -Idevtools/host -o /tmp/page-index-bench devtools/page_index_bench.cpp
+    python -m devtools.page_index --bench --bin /tmp/page-index-bench
+"""
+
+import argparse
+import re
+import subprocess
+from typing import Dict, List
+
+LINE_RE = re.compile(r"^(size|total) (.*)$")
+
+
+def fields(text: str) -> Dict[str, str]:
+    return dict(kv.split("=", 1) for kv in text.split())
+
+
+def bench(binary: str, repeat: int) -> bool:
+    out = subprocess.run([binary, "-n", str(repeat)], capture_output=True, text=True)
+    sizes: List[Dict[str, str]] = []
+    total = None
+    for line in out.stdout.splitlines():
+        m = LINE_RE.match(line.strip())
+        if not m:
+            continue
+        if m.group(1) == "size":
+            sizes.append(fields(m.group(2)))
+        else:
+            total = fields(m.group(2))
+    if total is None or not sizes:
+        print(out.stdout + out.stderr)
+        return False
+
+    print(f"Index table: {sizes[0]['index_bytes']} bytes, fixed\n")
+    print(f"{'bytes':>6} {'box':>5} {'lines':>6} {'pages':>6} {'build us':>9} {'frame ns':>9} {'flip ns':>8}"
+          f" {'old frame us':>13} {'old heap/frame':>15}   check")
+    for s in sizes:
+        lines = s['lines'] + ('+' if s['truncated'] == '1' else '')
+        print(f"{s['bytes']:>6} {s['cpl'] + 'x' + s['lpp']:>5} {lines:>6} {s['pages']:>6}"
+              f" {float(s['build_us']):>9.1f} {float(s['ensure_ns']):>9.1f} {float(s['flip_ns']):>8.0f}"
+              f" {float(s['legacy_us']):>13.1f} {int(s['legacy_heap']):>15,}"
+              f"   {'ok' if s['ok'] == '1' else 'WRONG'}")
+    print("\n+ = cut at PageIndex::MAX_LINES; frame = ensure() with nothing changed")
+    ok = out.returncode == 0 and total.get("failures") == "0"
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: check and time the page index against the old per-frame wrap."""
+    parser = argparse.ArgumentParser(description='Pager page index bench')
+    parser.add_argument('--bench', action='store_true', help='Run page_index_bench.cpp and print the table')
+    parser.add_argument('--bin', default='/tmp/page-index-bench', help='Built page_index_bench.cpp')
+    parser.add_argument('--repeat', type=int, default=200, help='Timed builds per message')
+    args = parser.parse_args()
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin, args.repeat) else 1)
+
+
+if __name__ == '__main__':
+    main()
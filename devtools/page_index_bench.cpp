@@ -0,0 +1,179 @@
+// Page Index Bench - host build of display_modes/page_index.h
+//
+// Builds the index for generated messages of 100 B to 16 KB (words of 1-14
+// letters, a few over-long ones, blank lines between paragraphs) and
+// compares it with the word wrap QUESTION mode used to redo every frame,
+// kept here as legacy_wrap(). For each size and box geometry:
+//   lines      every line copy_line() returns equals the legacy line, up to
+//              MAX_LINES; truncated() is set exactly when legacy had more
+//   pages      page_count() and page_first_line() agree with the line count
+//   allocs     heap allocations while building, paging and copying lines
+//              (must be 0: the index is a fixed table)
+// and reports the one-off build time, the per-frame ensure() when nothing
+// changed, a page flip (page_first_line plus copying one page of lines)
+// and the legacy per-frame wrap with the heap it churned.
+//
+// Build:
+//   g++ -O2 -I. -Idevtools/host -o /tmp/page-index-bench devtools/page_index_bench.cpp
+//
+// Usage:
+//   page-index-bench [-n repeat]
+//   -> size bytes=<n> cpl=<c> lpp=<l> lines=<n> pages=<n> truncated=<0|1> build_us=<t> ensure_ns=<t>
+//          flip_ns=<t> legacy_us=<t> legacy_heap=<bytes> index_bytes=<n> allocs=<n> ok=<0|1>
+//      total failures=<n>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "display_modes/page_index.h"
+
+static bool g_counting = false;
+static uint32_t g_allocs = 0;
+static size_t g_alloc_bytes = 0;
+
+void* operator new(size_t size) {
+    if (g_counting) {
+        g_allocs++;
+        g_alloc_bytes += size;
+    }
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static int failures = 0;
+
+// The QUESTION wrap from before PageIndex, per paragraph and per frame
+static void wrap_paragraph(const std::string& para, size_t max_chars, std::vector<std::string>& lines) {
+    std::string current_line = "";
+    size_t word_start = 0;
+    while (word_start < para.length()) {
+        size_t word_end = para.find(' ', word_start);
+        if (word_end == std::string::npos) word_end = para.length();
+        std::string word = para.substr(word_start, word_end - word_start);
+
+        if (current_line.empty()) {
+            current_line = word;
+        } else if (current_line.length() + 1 + word.length() <= max_chars) {
+            current_line += " " + word;
+        } else {
+            lines.push_back(current_line);
+            current_line = word;
+        }
+        word_start = (word_end == para.length()) ? word_end : word_end + 1;
+    }
+    if (!current_line.empty()) lines.push_back(current_line);
+}
+
+static std::vector<std::string> legacy_wrap(const std::string& msg, size_t max_chars) {
+    std::string clean_msg = "";
+    for (char c : msg) {
+        if (c == '\n' || (c >= 32 && c <= 126)) clean_msg += c;
+    }
+    std::vector<std::string> lines;
+    size_t para_start = 0, para_end;
+    while ((para_end = clean_msg.find('\n', para_start)) != std::string::npos) {
+        std::string para = clean_msg.substr(para_start, para_end - para_start);
+        if (!para.empty()) wrap_paragraph(para, max_chars, lines);
+        para_start = para_end + 1;
+    }
+    std::string para = clean_msg.substr(para_start);
+    if (!para.empty()) wrap_paragraph(para, max_chars, lines);
+    return lines;
+}
+
+// Single spaces between words (the legacy wrap keeps doubled spaces that
+// copy_line collapses, so those aren't comparable line for line)
+static std::string message(size_t bytes, unsigned seed) {
+    uint32_t x = seed * 2654435761u + 1;
+    auto next = [&]() {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    };
+    std::string s;
+    while (s.size() < bytes) {
+        uint32_t r = next();
+        if (!s.empty()) s += r % 23 == 0 ? (r % 3 == 0 ? "\n\n" : "\n") : " ";
+        size_t len = r % 97 == 0 ? 30 + r % 20 : 1 + (r >> 8) % 14;  // Now and then a URL-sized word
+        for (size_t i = 0; i < len; i++) s += (char) ('a' + (next() >> 5) % 26);
+    }
+    s.resize(bytes);
+    if (s.back() == ' ' || s.back() == '\n') s.back() = 'z';
+    return s;
+}
+
+template <typename F>
+static double time_ns(int repeat, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) f(r);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / repeat;
+}
+
+static void run(size_t bytes, uint8_t cpl, uint8_t lpp, int repeat, unsigned seed) {
+    std::string msg = message(bytes, seed);
+    PageIndex& index = page_index();
+
+    g_allocs = 0;
+    g_counting = true;
+    double build_ns = time_ns(repeat, [&](int) { index.build(msg.data(), msg.size(), cpl, lpp); });
+    double ensure_ns = time_ns(repeat * 100, [&](int) { index.ensure(msg.data(), msg.size(), cpl, lpp); });
+    char buf[PageIndex::MAX_LINE_CHARS + 1];
+    volatile size_t sink = 0;
+    uint16_t pages = index.page_count();
+    double flip_ns = time_ns(repeat * 100, [&](int r) {
+        uint16_t first = index.page_first_line((uint16_t) (r * 7919u % pages));
+        for (uint16_t i = first; i < index.line_count() && i < first + lpp; i++) {
+            sink = sink + index.copy_line(msg.data(), msg.size(), i, buf, sizeof(buf));
+        }
+    });
+    g_counting = false;
+    uint32_t allocs = g_allocs;
+
+    std::vector<std::string> legacy;
+    g_alloc_bytes = 0;
+    g_counting = true;
+    double legacy_ns = time_ns(repeat, [&](int) { legacy = legacy_wrap(msg, cpl); });
+    g_counting = false;
+    size_t legacy_heap = g_alloc_bytes / repeat;
+
+    bool ok = allocs == 0;
+    size_t expect = legacy.size() < PageIndex::MAX_LINES ? legacy.size() : PageIndex::MAX_LINES;
+    ok &= index.line_count() == expect && index.truncated() == (legacy.size() > PageIndex::MAX_LINES);
+    for (uint16_t i = 0; ok && i < index.line_count(); i++) {
+        index.copy_line(msg.data(), msg.size(), i, buf, sizeof(buf));
+        ok = legacy[i] == buf;
+    }
+    ok &= pages == (index.line_count() + lpp - 1) / lpp;
+    for (uint16_t p = 0; ok && p < pages; p++) ok = index.page_first_line(p) == p * lpp && index.page_of_line(p * lpp) == p;
+    ok &= pages == 0 || index.page_first_line(pages + 5) == (pages - 1) * lpp;
+    if (!ok) failures++;
+
+    printf("size bytes=%zu cpl=%u lpp=%u lines=%u pages=%u truncated=%d build_us=%.1f ensure_ns=%.1f flip_ns=%.1f "
+           "legacy_us=%.1f legacy_heap=%zu index_bytes=%zu allocs=%u ok=%d\n",
+           bytes, cpl, lpp, index.line_count(), pages, index.truncated() ? 1 : 0, build_ns / 1000, ensure_ns,
+           flip_ns, legacy_ns / 1000, legacy_heap, PageIndex::storage_bytes(), allocs, ok ? 1 : 0);
+}
+
+int main(int argc, char** argv) {
+    int repeat = 200;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) repeat = atoi(argv[++i]);
+    }
+    if (repeat < 1) repeat = 1;
+
+    static const size_t SIZES[] = {100, 512, 1024, 2048, 4096, 8192, 16384};
+    unsigned seed = 1;
+    for (size_t bytes : SIZES) run(bytes, 24, 3, repeat, seed++);  // QUESTION on the StickC
+    for (size_t bytes : SIZES) run(bytes, 40, 8, repeat, seed++);  // A wider box
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,375 @@
+#!/usr/bin/env python3
+"""
+QR Encoder - Reference encoder and bench driver for qr_encoder.h.
+
+The pager encodes QR codes itself (byte mode, versions 1-10, ECC L/M), so
+the bridge sends the text instead of a 4 KB bitmap. This is a second,
+independent encoder written from ISO/IEC 18004's tables (error correction
+block structure, alignment positions, format and version information) with
+log/antilog Reed-Solomon, checked against the standard's worked examples
+before it is trusted. The native bench (devtools/qr_encoder_bench.cpp)
+checks capacities, version choice and the format/version fields against the
+standard and prints every symbol; this rebuilds each one and compares the
+version, ECC level, mask choice (lowest penalty) and every module.
+
+Usage:
+    g++ -O2 -I. -Idevtools/host -o /tmp/qr-encoder-bench devtools/qr_encoder_bench.cpp
+    python -m devtools.qr_encoder --bench --bin /tmp/qr-encoder-bench
+
+    from devtools.qr_encoder import encode
+    symbol = encode(b"https://example.com", "M")   # Symbol: version, ecc, mask, modules
+"""
+
+import argparse
+import re
+import subprocess
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Tuple
+
+# ISO/IEC 18004 Table 9, versions 1-10: (ECC codewords per block,
+# [(blocks, data codewords per block), ...])
+EC_BLOCKS: Dict[str, List[Tuple[int, List[Tuple[int, int]]]]] = {
+    "L": [(7, [(1, 19)]), (10, [(1, 34)]), (15, [(1, 55)]), (20, [(1, 80)]), (26, [(1, 108)]),
+          (18, [(2, 68)]), (20, [(2, 78)]), (24, [(2, 97)]), (30, [(2, 116)]), (18, [(2, 68), (2, 69)])],
+    "M": [(10, [(1, 16)]), (16, [(1, 28)]), (26, [(1, 44)]), (18, [(2, 32)]), (24, [(2, 43)]),
+          (16, [(4, 27)]), (18, [(4, 31)]), (22, [(2, 38), (2, 39)]), (22, [(3, 36), (2, 37)]),
+          (26, [(4, 43), (1, 44)])],
+}
+
+# Annex E: alignment pattern centre rows/columns
+ALIGNMENT = [[], [], [6, 18], [6, 22], [6, 26], [6, 30], [6, 34], [6, 22, 38], [6, 24, 42], [6, 26, 46],
+             [6, 28, 50]]
+
+# Table C.1: format information (masked), by ECC level and mask
+FORMAT = {
+    "L": ["111011111000100", "111001011110011", "111110110101010", "111100010011101",
+          "110011000101111", "110001100011000", "110110001000001", "110100101110110"],
+    "M": ["101010000010010", "101000100100101", "101111001111100", "101101101001011",
+          "100010111111001", "100000011001110", "100111110010111", "100101010100000"],
+}
+
+# Table D.1: version information
+VERSION_INFO = {7: "000111110010010100", 8: "001000010110111100", 9: "001001101010011001",
+                10: "001010010011010011"}
+
+MASKS = [
+    lambda i, j: (i + j) % 2 == 0,
+    lambda i, j: i % 2 == 0,
+    lambda i, j: j % 3 == 0,
+    lambda i, j: (i + j) % 3 == 0,
+    lambda i, j: (i // 2 + j // 3) % 2 == 0,
+    lambda i, j: (i * j) % 2 + (i * j) % 3 == 0,
+    lambda i, j: ((i * j) % 2 + (i * j) % 3) % 2 == 0,
+    lambda i, j: ((i + j) % 2 + (i * j) % 3) % 2 == 0,
+]  # i = row, j = column, as the standard writes them
+
+# GF(256) with the QR polynomial x^8 + x^4 + x^3 + x^2 + 1
+EXP = [0] * 512
+LOG = [0] * 256
+_x = 1
+for _i in range(255):
+    EXP[_i] = _x
+    LOG[_x] = _i
+    _x <<= 1
+    if _x & 0x100:
+        _x ^= 0x11D
+for _i in range(255, 512):
+    EXP[_i] = EXP[_i - 255]
+
+
+def rs_ecc(data: List[int], n: int) -> List[int]:
+    """n Reed-Solomon check codewords for data (generator roots a^0..a^(n-1))."""
+    gen = [1]
+    for k in range(n):
+        nxt = [0] * (len(gen) + 1)
+        for i, g in enumerate(gen):
+            nxt[i] ^= g
+            if g:
+                nxt[i + 1] ^= EXP[LOG[g] + k]
+        gen = nxt
+    rem = list(data) + [0] * n
+    for i in range(len(data)):
+        c = rem[i]
+        if c:
+            for j in range(1, n + 1):
+                if gen[j]:
+                    rem[i + j] ^= EXP[LOG[gen[j]] + LOG[c]]
+    return rem[len(data):]
+
+
+# Worked examples (ISO/IEC 18004 Annex I, and the "HELLO WORLD" 1-M
+# example that tutorials use): data codewords -> check codewords
+RS_VECTORS = [
+    ([16, 32, 12, 86, 97, 128, 236, 17, 236, 17, 236, 17, 236, 17, 236, 17],
+     [165, 36, 212, 193, 237, 54, 199, 135, 44, 85]),
+    ([32, 91, 11, 120, 209, 114, 220, 77, 67, 64, 236, 17, 236, 17, 236, 17],
+     [196, 35, 39, 119, 235, 215, 231, 226, 93, 23]),
+]
+
+
+def data_capacity(version: int, ecc: str) -> int:
+    return sum(count * size for count, size in EC_BLOCKS[ecc][version - 1][1])
+
+
+def byte_capacity(version: int, ecc: str) -> int:
+    count_bits = 8 if version <= 9 else 16
+    return (data_capacity(version, ecc) * 8 - 4 - count_bits) // 8
+
+
+@dataclass
+class Symbol:
+    version: int
+    ecc: str
+    mask: int
+    modules: List[List[bool]]     # [row][column], True = dark
+    penalties: List[int]          # Per mask
+
+
+def _codewords(text: bytes, version: int, ecc: str) -> List[int]:
+    bits: List[int] = []
+
+    def put(value: int, n: int):
+        bits.extend((value >> (n - 1 - i)) & 1 for i in range(n))
+
+    capacity = data_capacity(version, ecc) * 8
+    put(0b0100, 4)
+    put(len(text), 8 if version <= 9 else 16)
+    for b in text:
+        put(b, 8)
+    put(0, min(4, capacity - len(bits)))
+    while len(bits) % 8:
+        bits.append(0)
+    data = [int("".join(map(str, bits[i:i + 8])), 2) for i in range(0, len(bits), 8)]
+    used = len(data)
+    while len(data) < capacity // 8:
+        data.append((0xEC, 0x11)[(len(data) - used) % 2])
+
+    ecc_len, groups = EC_BLOCKS[ecc][version - 1]
+    blocks: List[List[int]] = []
+    pos = 0
+    for count, size in groups:
+        for _ in range(count):
+            blocks.append(data[pos:pos + size])
+            pos += size
+    checks = [rs_ecc(b, ecc_len) for b in blocks]
+    out = []
+    for i in range(max(len(b) for b in blocks)):
+        out.extend(b[i] for b in blocks if i < len(b))
+    for i in range(ecc_len):
+        out.extend(c[i] for c in checks)
+    return out
+
+
+def _function_grid(version: int) -> Tuple[List[List[Optional[bool]]], int]:
+    n = 17 + 4 * version
+    grid: List[List[Optional[bool]]] = [[None] * n for _ in range(n)]
+
+    def finder(r0: int, c0: int):
+        for r in range(-1, 8):
+            for c in range(-1, 8):
+                rr, cc = r0 + r, c0 + c
+                if 0 <= rr < n and 0 <= cc < n:
+                    ring = max(abs(r - 3), abs(c - 3))
+                    grid[rr][cc] = ring in (0, 1, 3)
+
+    finder(0, 0)
+    finder(0, n - 7)
+    finder(n - 7, 0)
+    for i in range(8, n - 8):
+        grid[6][i] = grid[i][6] = i % 2 == 0
+    centres = ALIGNMENT[version]
+    for r in centres:
+        for c in centres:
+            if (r, c) in ((6, 6), (6, n - 7), (n - 7, 6)):
+                continue  # Overlaps a finder
+            for dr in range(-2, 3):
+                for dc in range(-2, 3):
+                    grid[r + dr][c + dc] = max(abs(dr), abs(dc)) != 1
+    # Format areas (filled per mask), the dark module, version areas
+    for i in range(9):
+        if grid[8][i] is None:
+            grid[8][i] = False
+        if grid[i][8] is None:
+            grid[i][8] = False
+    for i in range(8):
+        grid[8][n - 1 - i] = False
+        grid[n - 1 - i][8] = False
+    grid[n - 8][8] = True
+    if version >= 7:
+        info = VERSION_INFO[version][::-1]  # Bit 0 first
+        for k in range(18):
+            bit = info[k] == "1"
+            grid[k // 3][n - 11 + k % 3] = bit
+            grid[n - 11 + k % 3][k // 3] = bit
+    return grid, n
+
+
+def _place_format(grid: List[List[bool]], n: int, ecc: str, mask: int):
+    bits = [b == "1" for b in FORMAT[ecc][mask]]  # bits[0] = bit 14
+    # Around the top-left finder: bits 14..9 along row 8, then 8, 7 at the
+    # corner, 6..0 up column 8 (skipping the timing row)
+    cols = [0, 1, 2, 3, 4, 5, 7]
+    for k, c in enumerate(cols):
+        grid[8][c] = bits[k]
+    grid[8][8] = bits[7]
+    rows = [7, 5, 4, 3, 2, 1, 0]
+    for k, r in enumerate(rows):
+        grid[r][8] = bits[8 + k]
+    # Split copy: bits 14..8 up the bottom-left column, 7..0 along row 8 right
+    for k in range(7):
+        grid[n - 1 - k][8] = bits[k]
+    for k in range(8):
+        grid[8][n - 8 + k] = bits[7 + k]
+
+
+def _penalty(m: List[List[bool]]) -> int:
+    n = len(m)
+    score = 0
+    lines = [row for row in m] + [[m[r][c] for r in range(n)] for c in range(n)]
+    finder_like = ("00001011101", "10111010000")
+    for line in lines:
+        run = 1
+        for i in range(1, n + 1):
+            if i < n and line[i] == line[i - 1]:
+                run += 1
+                continue
+            if run >= 5:
+                score += 3 + (run - 5)
+            run = 1
+        s = "".join("1" if x else "0" for x in line)
+        score += 40 * sum(s[i:i + 11] in finder_like for i in range(n - 10))
+    for r in range(n - 1):
+        for c in range(n - 1):
+            if m[r][c] == m[r][c + 1] == m[r + 1][c] == m[r + 1][c + 1]:
+                score += 3
+    dark = sum(sum(row) for row in m)
+    score += 10 * (abs(dark * 100 / (n * n) - 50) // 5)
+    return int(score)
+
+
+def encode(text: bytes, ecc: str = "M", boost_ecc: bool = False) -> Optional[Symbol]:
+    """Smallest version 1-10 that fits, byte mode; None if too long."""
+    version = next((v for v in range(1, 11) if len(text) <= byte_capacity(v, ecc)), None)
+    if version is None:
+        return None
+    if boost_ecc and ecc == "L" and len(text) <= byte_capacity(version, "M"):
+        ecc = "M"
+
+    grid, n = _function_grid(version)
+    stream = _codewords(text, version, ecc)
+    bits = [(cw >> (7 - k)) & 1 for cw in stream for k in range(8)]
+    data_cells: List[Tuple[int, int]] = []
+    col = n - 1
+    upward = True
+    while col > 0:
+        if col == 6:
+            col -= 1
+        rows = range(n - 1, -1, -1) if upward else range(n)
+        for r in rows:
+            for c in (col, col - 1):
+                if grid[r][c] is None:
+                    data_cells.append((r, c))
+        upward = not upward
+        col -= 2
+
+    best = None
+    penalties = []
+    for mask in range(8):
+        m = [[bool(x) for x in row] for row in grid]
+        for k, (r, c) in enumerate(data_cells):
+            bit = bits[k] if k < len(bits) else 0  # Remainder bits are 0
+            m[r][c] = bool(bit) ^ MASKS[mask](r, c)
+        _place_format(m, n, ecc, mask)
+        p = _penalty(m)
+        penalties.append(p)
+        if best is None or p < best[0]:
+            best = (p, mask, m)
+    return Symbol(version, ecc, best[1], best[2], penalties)
+
+
+LINE_RE = re.compile(r"^(check|symbol|total) (.*)$")
+
+
+def fields(text: str) -> Dict[str, str]:
+    return dict(kv.split("=", 1) for kv in text.split())
+
+
+def _rows(symbol: Symbol) -> List[str]:
+    out = []
+    for row in symbol.modules:
+        value = 0
+        width = (len(row) + 7) // 8 * 8
+        for c, dark in enumerate(row):
+            if dark:
+                value |= 1 << (width - 1 - c)
+        out.append(f"{value:0{width // 4}x}")
+    return out
+
+
+def bench(binary: str, repeat: int) -> bool:
+    rs_ok = all(rs_ecc(d, len(e)) == e for d, e in RS_VECTORS)
+    print(f"Reference Reed-Solomon on the standard's worked examples: {'ok' if rs_ok else 'WRONG'}")
+
+    out = subprocess.run([binary, "-n", str(repeat)], capture_output=True, text=True)
+    checks: List[Dict[str, str]] = []
+    symbols: List[Dict[str, str]] = []
+    total = None
+    for line in out.stdout.splitlines():
+        m = LINE_RE.match(line.strip())
+        if not m:
+            continue
+        f = fields(m.group(2))
+        if m.group(1) == "check":
+            checks.append(f)
+        elif m.group(1) == "symbol":
+            symbols.append(f)
+        else:
+            total = f
+    if total is None:
+        print(out.stdout + out.stderr)
+        return False
+
+    bad_checks = [c for c in checks if c["ok"] != "1"]
+    print(f"Against the standard's tables: {len(checks) - len(bad_checks)}/{len(checks)} checks pass")
+    for c in bad_checks:
+        print(f"  FAIL {c['name']}")
+
+    print(f"\n{'bytes':>6} {'ecc':>4} {'ver':>4} {'mask':>5} {'ref mask':>9} {'penalty':>8} {'modules':>8}"
+          f" {'encode us':>10}")
+    mismatches = 0
+    masks_seen = set()
+    for s in symbols:
+        text = bytes.fromhex(s["text"])
+        ref = encode(text, s["ecc"], s["boost"] == "1")
+        same = (ref is not None and ref.version == int(s["version"]) and ref.ecc == s["got_ecc"]
+                and ref.mask == int(s["mask"]) and _rows(ref) == s["rows"].split(","))
+        if not same:
+            mismatches += 1
+        masks_seen.add(int(s["mask"]))
+        ref_mask = ref.mask if ref else "-"
+        penalty = ref.penalties[ref.mask] if ref else "-"
+        print(f"{len(text):>6} {s['got_ecc']:>4} {s['version']:>4} {s['mask']:>5} {ref_mask:>9} {penalty:>8}"
+              f" {'same' if same else 'DIFFER':>8} {float(s['encode_us']):>10.1f}")
+    print(f"\n{len(symbols) - mismatches}/{len(symbols)} symbols identical to the reference; "
+          f"masks chosen: {sorted(masks_seen)}")
+
+    ok = rs_ok and out.returncode == 0 and total.get("failures") == "0" and mismatches == 0 and symbols
+    print("PASS" if ok else "FAIL")
+    return bool(ok)
+
+
+def main():
+    """CLI: check the on-device QR encoder against the reference encoder."""
+    parser = argparse.ArgumentParser(description='QR encoder reference check')
+    parser.add_argument('--bench', action='store_true', help='Run qr_encoder_bench.cpp and compare every symbol')
+    parser.add_argument('--bin', default='/tmp/qr-encoder-bench', help='Built qr_encoder_bench.cpp')
+    parser.add_argument('--repeat', type=int, default=20, help='Timed encodes per symbol')
+    args = parser.parse_args()
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin, args.repeat) else 1)
+
+
+if __name__ == '__main__':
+    main()
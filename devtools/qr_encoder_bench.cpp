@@ -0,0 +1,215 @@
+// QR Encoder Bench - host build of qr_encoder.h against the standard's tables
+//
+// Encodes payloads from 1 byte to the version 10 limit at ECC L and M (and
+// L with boost_ecc) through the real QrCode, and checks each symbol against
+// values from ISO/IEC 18004 rather than against the encoder's own code:
+//   capacity   byte_capacity() for versions 1-10 at L and M equals the
+//              standard's byte-mode capacity table
+//   version    the smallest version whose capacity fits the payload; one
+//              byte past the version 10 limit is refused
+//   format     both copies of the 15-bit format field read off the symbol
+//              equal the standard's entry for (ECC level, mask)
+//   vinfo      version 7+: both 18-bit version fields equal the table
+//   boost      boost_ecc picks M exactly when it fits the same version
+// Every symbol is printed (payload and module rows) so devtools/qr_encoder.py
+// can rebuild it with its independent reference encoder and compare the
+// codewords, the mask choice and every module.
+//
+// Build:
+//   g++ -O2 -I. -Idevtools/host -o /tmp/qr-encoder-bench devtools/qr_encoder_bench.cpp
+//
+// Usage:
+//   qr-encoder-bench [-n repeat]
+//   -> check name=<check> ok=<0|1>
+//      symbol text=<hex> ecc=<L|M> boost=<0|1> version=<v> got_ecc=<L|M> mask=<m> encode_us=<t>
+//          rows=<hex>,<hex>,...
+//      total failures=<n>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "qr_encoder.h"
+
+// ISO/IEC 18004 Table 7, byte mode, versions 1-10
+static const uint16_t CAPACITY[2][11] = {
+    {0, 17, 32, 53, 78, 106, 134, 154, 192, 230, 271},  // L
+    {0, 14, 26, 42, 62, 84, 106, 122, 152, 180, 213},   // M
+};
+
+// ISO/IEC 18004 Table C.1: format information after masking, by ECC and mask
+static const char* FORMAT[2][8] = {
+    {"111011111000100", "111001011110011", "111110110101010", "111100010011101",
+     "110011000101111", "110001100011000", "110110001000001", "110100101110110"},  // L
+    {"101010000010010", "101000100100101", "101111001111100", "101101101001011",
+     "100010111111001", "100000011001110", "100111110010111", "100101010100000"},  // M
+};
+
+// ISO/IEC 18004 Table D.1: version information, versions 7-10
+static const char* VERSION_INFO[11] = {
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    "000111110010010100", "001000010110111100", "001001101010011001", "001010010011010011",
+};
+
+static int failures = 0;
+
+static void check(const char* name, bool ok) {
+    if (!ok) failures++;
+    printf("check name=%s ok=%d\n", name, ok ? 1 : 0);
+}
+
+// Format bits, most significant first, as read from the copy around the
+// top-left finder and from the split copy (bottom-left / top-right)
+static std::string format_bits(const QrCode& q, bool second) {
+    int n = q.size();
+    std::string s;
+    for (int i = 14; i >= 0; i--) {
+        int x, y;
+        if (!second) {
+            if (i <= 5) x = 8, y = i;
+            else if (i == 6) x = 8, y = 7;
+            else if (i == 7) x = 8, y = 8;
+            else if (i == 8) x = 7, y = 8;
+            else x = 14 - i, y = 8;
+        } else {
+            if (i < 8) x = n - 1 - i, y = 8;
+            else x = 8, y = n - 15 + i;
+        }
+        s += q.module(x, y) ? '1' : '0';
+    }
+    return s;
+}
+
+// Version bits, most significant first; second = the bottom-left block
+static std::string version_bits(const QrCode& q, bool second) {
+    int n = q.size();
+    std::string s;
+    for (int i = 17; i >= 0; i--) {
+        int a = n - 11 + i % 3, b = i / 3;
+        s += (second ? q.module(b, a) : q.module(a, b)) ? '1' : '0';
+    }
+    return s;
+}
+
+static std::string hex(const uint8_t* p, size_t n) {
+    std::string s;
+    char b[3];
+    for (size_t i = 0; i < n; i++) {
+        snprintf(b, sizeof(b), "%02x", p[i]);
+        s += b;
+    }
+    return s;
+}
+
+// Payload of n bytes: URL-like text, then every byte value so the encoder
+// sees control and high bytes too
+static std::string payload(size_t n, unsigned seed) {
+    static const char* URL = "https://clawd.local/pair?code=";
+    std::string s;
+    for (size_t i = 0; i < n; i++) {
+        s += i < strlen(URL) ? URL[i] : (char) ((i * 37 + seed * 101) & 0xFF);
+    }
+    return s;
+}
+
+struct Result {
+    bool version_ok, format_ok, vinfo_ok;
+};
+
+static Result emit(const std::string& text, QrEcc ecc, bool boost, int repeat) {
+    QrCode q;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = false;
+    for (int r = 0; r < repeat; r++) ok = q.encode(text.data(), text.size(), ecc, boost);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repeat;
+
+    Result res = {false, false, false};
+    int want = 0;
+    for (int v = 1; v <= 10 && !want; v++) {
+        if (text.size() <= CAPACITY[(int) ecc][v]) want = v;
+    }
+    if (!ok) {
+        res.version_ok = want == 0;
+        res.format_ok = res.vinfo_ok = true;
+        return res;
+    }
+    res.version_ok = q.version() == want && q.size() == 17 + 4 * want;
+    const char* fmt = FORMAT[(int) q.ecc()][q.mask()];
+    res.format_ok = format_bits(q, false) == fmt && format_bits(q, true) == fmt &&
+                    q.module(8, q.size() - 8);  // Always-dark module
+    res.vinfo_ok = q.version() < 7 ||
+                   (version_bits(q, false) == VERSION_INFO[q.version()] &&
+                    version_bits(q, true) == VERSION_INFO[q.version()]);
+
+    std::string rows;
+    for (int y = 0; y < q.size(); y++) {
+        uint8_t row[8] = {0};
+        for (int x = 0; x < q.size(); x++) {
+            if (q.module(x, y)) row[x >> 3] |= 0x80 >> (x & 7);
+        }
+        if (y) rows += ',';
+        rows += hex(row, (q.size() + 7) / 8);
+    }
+    printf("symbol text=%s ecc=%c boost=%d version=%d got_ecc=%c mask=%d encode_us=%.1f rows=%s\n",
+           hex((const uint8_t*) text.data(), text.size()).c_str(), ecc == QrEcc::LOW ? 'L' : 'M', boost ? 1 : 0,
+           q.version(), q.ecc() == QrEcc::LOW ? 'L' : 'M', q.mask(), us, rows.c_str());
+    return res;
+}
+
+int main(int argc, char** argv) {
+    int repeat = 20;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) repeat = atoi(argv[++i]);
+    }
+    if (repeat < 1) repeat = 1;
+
+    bool capacity_ok = true;
+    for (int e = 0; e < 2; e++) {
+        for (uint8_t v = 1; v <= 10; v++) capacity_ok &= QrCode::byte_capacity(v, (QrEcc) e) == CAPACITY[e][v];
+    }
+    check("capacity", capacity_ok);
+
+    // Each version's first and last payload length, at both levels, plus
+    // a few short ones (mask choice varies most on small symbols)
+    bool version_ok = true, format_ok = true, vinfo_ok = true;
+    unsigned seed = 1;
+    for (int e = 0; e < 2; e++) {
+        QrEcc ecc = (QrEcc) e;
+        std::vector<size_t> lengths = {1, 5, 9};
+        for (int v = 1; v <= 10; v++) {
+            lengths.push_back(CAPACITY[e][v - 1] + 1);
+            lengths.push_back(CAPACITY[e][v]);
+        }
+        lengths.push_back(CAPACITY[e][10] + 1);  // Refused
+        for (size_t n : lengths) {
+            Result r = emit(payload(n, seed++), ecc, false, repeat);
+            version_ok &= r.version_ok;
+            format_ok &= r.format_ok;
+            vinfo_ok &= r.vinfo_ok;
+        }
+    }
+    check("version", version_ok);
+    check("format", format_ok);
+    check("vinfo", vinfo_ok);
+
+    // boost_ecc: M when the payload fits M in the version L needs
+    bool boost_ok = true;
+    for (int v = 1; v <= 10; v++) {
+        for (size_t n : {(size_t) CAPACITY[0][v - 1] + 1, (size_t) CAPACITY[1][v], (size_t) CAPACITY[1][v] + 1}) {
+            if (n <= CAPACITY[0][v - 1] || n > CAPACITY[0][v]) continue;  // Needs version v at L
+            QrCode q;
+            std::string text = payload(n, seed++);
+            boost_ok &= q.encode(text.data(), text.size(), QrEcc::LOW, true);
+            bool fits_m = n <= CAPACITY[1][v];
+            boost_ok &= q.version() == v && q.ecc() == (fits_m ? QrEcc::MEDIUM : QrEcc::LOW);
+        }
+    }
+    Result r = emit("https://github.com/", QrEcc::LOW, true, repeat);
+    check("boost", boost_ok && r.version_ok && r.format_ok);
+
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
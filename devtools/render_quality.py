@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""
+Render Quality - Bench driver for display_modes/render_quality.h.
+
+The animated modes (ListeningMode, ProcessingMode, AgentMode) now draw at
+three quality tiers - full, reduced, static - and declare what a frame
+costs at each in pixel writes. RenderQuality picks a tier every frame from
+battery level, charger and the measured render time against the frame
+budget. The native bench (devtools/render_quality_bench.cpp) renders the
+real mode classes through a host stand-in for ESPHome's display
+(devtools/host/esphome.h), checks the declared costs against counted pixel
+writes, checks tier selection (thresholds, hysteresis, budget, static
+reuse) and runs recording, CPU-contention and battery-drain scenarios
+against always drawing full. This prints the cost table and the scenarios.
+
+Usage:
+    g++ -O2 -I. -Idevtools/host -o /tmp/render-quality-bench devtools/render_quality_bench.cpp
+    python -m devtools.render_quality --bench --bin /tmp/render-quality-bench
+"""
+
+import argparse
+import re
+import subprocess
+from typing import Dict, List
+
+LINE_RE = re.compile(r"^(tier|check|scenario|total) (.*)$")
+
+
+def fields(text: str) -> Dict[str, str]:
+    return dict(kv.split("=", 1) for kv in text.split())
+
+
+def bench(binary: str, repeat: int) -> bool:
+    out = subprocess.run([binary, "-n", str(repeat)], capture_output=True, text=True)
+    tiers: List[Dict[str, str]] = []
+    checks: List[Dict[str, str]] = []
+    scenarios: List[Dict[str, str]] = []
+    total = None
+    for line in out.stdout.splitlines():
+        m = LINE_RE.match(line.strip())
+        if not m:
+            continue
+        f = fields(m.group(2))
+        if m.group(1) == "tier":
+            tiers.append(f)
+        elif m.group(1) == "check":
+            checks.append(f)
+        elif m.group(1) == "scenario":
+            scenarios.append(f)
+        else:
+            total = f
+    if total is None:
+        print(out.stdout + out.stderr)
+        return False
+
+    print(f"{'mode':<12}{'tier':<9}{'declared px':>12}{'worst px':>10}{'avg px':>9}{'host us':>9}   check")
+    for t in tiers:
+        print(f"{t['mode']:<12}{t['tier']:<9}{t['declared_px']:>12}{t['max_px']:>10}{t['avg_px']:>9}"
+              f"{float(t['host_us']):>9.1f}   {'ok' if t['ok'] == '1' else 'WRONG'}")
+
+    bad = [c for c in checks if c["ok"] != "1"]
+    print(f"\nTier selection: {len(checks) - len(bad)}/{len(checks)} checks pass")
+    for c in bad:
+        print(f"  FAIL {c['name']}")
+
+    print(f"\n{'scenario':<26}{'full':>6}{'reduced':>8}{'static':>7}{'reused':>7}{'changes':>8}"
+          f"{'over budget':>13}{'always full':>13}{'pixels saved':>14}")
+    for s in scenarios:
+        saved = 1 - int(s["pixels"]) / max(1, int(s["fixed_pixels"]))
+        print(f"{s['name']:<26}{s['full']:>6}{s['reduced']:>8}{s['static']:>7}{s['reused']:>7}{s['changes']:>8}"
+              f"{s['over_budget']:>13}{s['fixed_over_budget']:>13}{saved:>13.0%}")
+    ok = out.returncode == 0 and total.get("failures") == "0"
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: check the render quality tiers and report cost per tier."""
+    parser = argparse.ArgumentParser(description='Display mode quality tier bench')
+    parser.add_argument('--bench', action='store_true', help='Run the cost, selection and scenario checks')
+    parser.add_argument('--bin', default='/tmp/render-quality-bench', help='Built render_quality_bench.cpp')
+    parser.add_argument('--repeat', type=int, default=20, help='Timed passes per mode and tier')
+    args = parser.parse_args()
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin, args.repeat) else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,313 @@
+// Render Quality Bench - host build of display_modes/render_quality.h and
+// the animated modes' quality tiers
+//
+// 1. Cost per tier: renders ListeningMode, ProcessingMode and AgentMode
+//    at every tier over a few animation cycles through the host ESPHome
+//    stand-in (devtools/host/esphome.h, the pager's panel) and counts
+//    draw_pixel_at calls. The declared RenderCost must cover the worst
+//    frame (and not overstate it by more than 15%); STATIC frames must be
+//    identical at every millis, FULL ones must move.
+// 2. Tier selection: battery thresholds with hysteresis, charging, the
+//    budget (down at once, up after UPGRADE_FRAMES with headroom), and the
+//    STATIC reuse rules around transitions.
+// 3. Scenarios on the pager model: render time = counted pixel writes x
+//    ns per pixel x load, where ns per pixel is the ESP32's (modeled, see
+//    ESP32_NS_PER_PIXEL). LISTENING while recording (tighter budget),
+//    AGENT under CPU contention, PROCESSING on a draining battery (30% ->
+//    5%, then the charger goes in). Compared with always drawing FULL:
+//    frames over the budget, pixel writes; and STATIC frames reused.
+//
+// Build:
+//   g++ -O2 -I. -Idevtools/host -o /tmp/render-quality-bench devtools/render_quality_bench.cpp
+//
+// Usage:
+//   render-quality-bench [-n repeat]
+//   -> tier mode=<m> tier=<t> declared_px=<n> max_px=<n> avg_px=<n> host_us=<t> still=<0|1> ok=<0|1>
+//      check name=<c> ok=<0|1>
+//      scenario name=<s> frames=<n> full=<n> reduced=<n> static=<n> reused=<n> changes=<n>
+//          over_budget=<n> fixed_over_budget=<n> pixels=<n> fixed_pixels=<n>
+//      total failures=<n>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "esphome.h"
+
+static unsigned long host_us() {
+    using namespace std::chrono;
+    return (unsigned long) duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+#include "display_modes/agent_mode.h"
+#include "display_modes/listening_mode.h"
+#include "display_modes/processing_mode.h"
+
+using esphome::display::HostDisplay;
+
+// draw_pixel_at + the st7789v's draw_absolute_pixel_internal on the
+// pager's ESP32 at 240 MHz (virtual call, rotation, clip, 565 pack, store)
+static const double ESP32_NS_PER_PIXEL = 160.0;
+
+// What the YAML sets while recording (clawd-pager.yaml, 1 s interval)
+static const uint32_t RECORDING_BUDGET_US = 6500;
+
+static int failures = 0;
+
+static void check(const char* name, bool ok) {
+    printf("check name=%s ok=%d\n", name, ok ? 1 : 0);
+    if (!ok) failures++;
+}
+
+struct NamedMode {
+    const char* name;
+    DisplayMode* mode;
+};
+
+static ListeningMode listening;
+static ProcessingMode processing;
+static AgentMode agent;
+static const NamedMode MODES[] = {{"LISTENING", &listening}, {"PROCESSING", &processing}, {"AGENT", &agent}};
+
+static uint64_t hash_buffer(const std::vector<uint16_t>& b) {
+    uint64_t h = 1469598103934665603ull;
+    for (uint16_t v : b) h = (h ^ v) * 1099511628211ull;
+    return h;
+}
+
+// ---- 1. Declared cost vs counted pixel writes ----
+
+static void cost_per_tier(int repeat) {
+    static const std::string message = "Edit main.cpp";
+    for (const NamedMode& nm : MODES) {
+        for (int t = 0; t < (int) RenderTier::COUNT; t++) {
+            RenderTier tier = (RenderTier) t;
+            HostDisplay d;
+            uint64_t max_px = 0, sum_px = 0, first_hash = 0;
+            int frames = 0;
+            bool still = true;
+            // 3.2 s covers every cycle (AgentMode's code rain is 40 x 80 ms)
+            for (uint32_t ms = 0; ms < 3200; ms += 10, frames++) {
+                d.pixel_calls = 0;
+                nm.mode->render(d, ms, message, tier);
+                max_px = std::max(max_px, d.pixel_calls);
+                sum_px += d.pixel_calls;
+                uint64_t h = hash_buffer(d.buffer);
+                if (ms == 0) first_hash = h;
+                else if (h != first_hash) still = false;
+            }
+            unsigned long t0 = host_us();
+            for (int r = 0; r < repeat; r++)
+                for (uint32_t ms = 0; ms < 3200; ms += 10) nm.mode->render(d, ms, message, tier);
+            double us = (double) (host_us() - t0) / ((double) repeat * frames);
+
+            uint32_t declared = nm.mode->cost().at(tier);
+            bool ok = max_px <= declared && declared <= max_px * 115 / 100;
+            ok = ok && (tier == RenderTier::STATIC ? still : tier == RenderTier::FULL ? !still : true);
+            printf("tier mode=%s tier=%s declared_px=%u max_px=%llu avg_px=%llu host_us=%.1f still=%d ok=%d\n",
+                   nm.name, render_tier_name(tier), declared, (unsigned long long) max_px,
+                   (unsigned long long) (sum_px / frames), us, still ? 1 : 0, ok ? 1 : 0);
+            if (!ok) failures++;
+        }
+    }
+}
+
+// ---- 2. Tier selection ----
+
+static const RenderCost COST = {{40000, 30000, 20000}};
+
+static void selection_checks() {
+    {
+        RenderQuality q;
+        struct Step {
+            int32_t battery_x10;
+            bool charging;
+            RenderTier want;
+        };
+        static const Step STEPS[] = {
+            {500, false, RenderTier::FULL},    {201, false, RenderTier::FULL},    {199, false, RenderTier::REDUCED},
+            {230, false, RenderTier::REDUCED}, {249, false, RenderTier::REDUCED}, {250, false, RenderTier::FULL},
+            {150, false, RenderTier::REDUCED}, {99, false, RenderTier::STATIC},   {120, false, RenderTier::STATIC},
+            {149, false, RenderTier::STATIC},  {150, false, RenderTier::REDUCED}, {40, false, RenderTier::STATIC},
+            {40, true, RenderTier::FULL},      {45, false, RenderTier::STATIC},   {260, false, RenderTier::FULL},
+        };
+        bool ok = true;
+        for (const Step& s : STEPS) {
+            q.set_power(s.battery_x10, s.charging);
+            RenderTier got = q.choose(COST);
+            if (got != s.want) {
+                printf("  battery=%d charging=%d tier=%s want=%s\n", s.battery_x10, s.charging, render_tier_name(got),
+                       render_tier_name(s.want));
+                ok = false;
+            }
+        }
+        check("battery_thresholds_hysteresis_charging", ok);
+    }
+    {
+        // 0.5 us/px: FULL 20 ms, REDUCED 15 ms, STATIC 10 ms against 16 ms
+        RenderQuality q;
+        q.set_budget_us(16000);
+        bool ok = q.choose(COST) == RenderTier::FULL;  // Nothing measured yet
+        q.frame_done(RenderTier::FULL, COST, 20000, 1);
+        ok = ok && q.choose(COST) == RenderTier::REDUCED;
+        for (int i = 0; i < 20; i++) {
+            q.frame_done(RenderTier::REDUCED, COST, 15000, 1);
+            ok = ok && q.choose(COST) == RenderTier::REDUCED;
+        }
+        check("budget_down_immediately", ok);
+
+        // Load drops to 0.3 us/px: FULL 12 ms fits, with headroom (12.8 ms)
+        int waited = 0;
+        q.frame_done(RenderTier::REDUCED, COST, 9000, 1);
+        while (q.choose(COST) != RenderTier::FULL && waited < 100) {
+            waited++;
+            q.frame_done(RenderTier::REDUCED, COST, 9000, 1);
+        }
+        check("budget_up_after_upgrade_frames", waited + 1 >= RenderQuality::UPGRADE_FRAMES && waited < 40);
+
+        // FULL predicted between 80% and 100% of the budget: fits, no upgrade
+        RenderQuality border;
+        border.set_budget_us(16000);
+        border.frame_done(RenderTier::FULL, COST, 20000, 1);
+        border.choose(COST);
+        bool stays = true;
+        for (int i = 0; i < 50; i++) {
+            border.frame_done(RenderTier::REDUCED, COST, 10950, 1);  // FULL ~14.6 ms: fits, over 80%
+            stays = stays && border.choose(COST) == RenderTier::REDUCED;
+        }
+        check("no_upgrade_without_headroom", stays && border.stats().changes == 1);
+    }
+    {
+        // Battery and budget: the worse wins
+        RenderQuality q;
+        q.set_budget_us(16000);
+        q.frame_done(RenderTier::FULL, COST, 20000, 1);
+        q.set_power(150, false);
+        bool ok = q.choose(COST) == RenderTier::REDUCED;
+        q.set_power(50, false);
+        ok = ok && q.choose(COST) == RenderTier::STATIC && q.stats().battery_limited == 1;
+        check("worse_of_battery_and_budget", ok);
+    }
+    {
+        RenderQuality q;
+        q.set_power(50, false);
+        RenderTier t = q.choose(COST);
+        bool ok = t == RenderTier::STATIC;
+        ok = ok && !q.reuse_static(t, 7, true);  // Nothing on screen yet
+        q.frame_done(t, COST, 1000, 7);
+        ok = ok && q.reuse_static(q.choose(COST), 7, true);
+        ok = ok && !q.reuse_static(q.choose(COST), 8, true);  // Message changed
+        q.frame_done(RenderTier::STATIC, COST, 1000, 8);
+        ok = ok && q.reuse_static(q.choose(COST), 8, true);
+        // A transition frame: drawn, then composed over
+        ok = ok && !q.reuse_static(q.choose(COST), 8, false);
+        q.frame_done(RenderTier::STATIC, COST, 1000, 8);
+        ok = ok && !q.reuse_static(q.choose(COST), 8, true);
+        q.frame_done(RenderTier::STATIC, COST, 1000, 8);
+        ok = ok && q.reuse_static(q.choose(COST), 8, true);
+        q.invalidate();
+        ok = ok && !q.reuse_static(q.choose(COST), 8, true);
+        check("static_reuse_rules", ok);
+    }
+}
+
+// ---- 3. Scenarios on the pager model ----
+
+struct Scenario {
+    uint32_t frames = 0, tiers[(int) RenderTier::COUNT] = {}, reused = 0, changes = 0, over = 0, fixed_over = 0;
+    uint64_t pixels = 0, fixed_pixels = 0;
+};
+
+// One frame the way DisplayModeManager::render_mode draws it; render time
+// from the counted pixel writes
+static void frame(RenderQuality& q, HostDisplay& d, DisplayMode* mode, uint32_t ms, double load, Scenario& s) {
+    static const std::string message = "Edit main.cpp";
+    s.frames++;
+    d.pixel_calls = 0;
+    mode->render(d, ms, message, RenderTier::FULL);
+    uint32_t fixed_us = (uint32_t) (d.pixel_calls * ESP32_NS_PER_PIXEL * load / 1000);
+    s.fixed_pixels += d.pixel_calls;
+    if (fixed_us > q.budget_us()) s.fixed_over++;
+
+    RenderCost cost = mode->cost();
+    RenderTier tier = q.choose(cost);
+    if (q.reuse_static(tier, 1, true)) {
+        s.reused++;
+        return;
+    }
+    d.pixel_calls = 0;
+    mode->render(d, ms, message, tier);
+    uint32_t us = (uint32_t) (d.pixel_calls * ESP32_NS_PER_PIXEL * load / 1000);
+    s.pixels += d.pixel_calls;
+    s.tiers[(int) tier]++;
+    if (us > q.budget_us()) s.over++;
+    q.frame_done(tier, cost, us, 1);
+}
+
+static void report(const char* name, const RenderQuality& q, Scenario& s) {
+    s.changes = q.stats().changes;
+    printf("scenario name=%s frames=%u full=%u reduced=%u static=%u reused=%u changes=%u over_budget=%u "
+           "fixed_over_budget=%u pixels=%llu fixed_pixels=%llu\n",
+           name, s.frames, s.tiers[0], s.tiers[1], s.tiers[2], s.reused, s.changes, s.over, s.fixed_over,
+           (unsigned long long) s.pixels, (unsigned long long) s.fixed_pixels);
+}
+
+static void scenarios() {
+    // Recording: the loop has to get back to the audio stream quickly, so
+    // the YAML drops the budget to RECORDING_BUDGET_US while LISTENING
+    // records (frames 200-399); frame times jitter by up to 10%
+    {
+        RenderQuality q;
+        HostDisplay d;
+        Scenario s;
+        for (uint32_t i = 0; i < 600; i++) {
+            q.set_budget_us(i >= 200 && i < 400 ? RECORDING_BUDGET_US : RenderQuality::DEFAULT_BUDGET_US);
+            frame(q, d, &listening, i * 50, 1.0 + (i * 7 % 11) / 100.0, s);
+        }
+        report("listening_recording", q, s);
+        check("recording_deadlines_hold", s.fixed_over >= 150 && s.over <= 1 && s.tiers[1] >= 195);
+    }
+    // CPU contention: every pixel 1.6x dearer from frame 300 against a 10 ms
+    // budget; the first contended frame is drawn before it's been measured
+    {
+        RenderQuality q;
+        q.set_budget_us(10000);
+        HostDisplay d;
+        Scenario s;
+        for (uint32_t i = 0; i < 600; i++) frame(q, d, &agent, i * 50, i >= 300 ? 1.6 : 1.0, s);
+        report("agent_contention", q, s);
+        check("contention_deadlines_hold", s.fixed_over >= 290 && s.over <= 2 && s.tiers[1] >= 290);
+    }
+    // Battery: 30% -> 5% over 500 frames at 2 fps (the 0.5 s tick), then
+    // the charger goes in
+    {
+        RenderQuality q;
+        HostDisplay d;
+        Scenario s;
+        for (uint32_t i = 0; i < 700; i++) {
+            bool charging = i >= 500;
+            int32_t battery = charging ? 50 + (int32_t) (i - 500) : 300 - (int32_t) (i * 250 / 500);
+            q.set_power(battery, charging);
+            frame(q, d, &processing, i * 500, 1.0, s);
+        }
+        report("processing_battery_drain", q, s);
+        check("battery_drain_tiers", s.tiers[0] > 0 && s.tiers[1] > 0 && s.reused > 0 && s.changes <= 3 &&
+                                         q.tier() == RenderTier::FULL);
+    }
+}
+
+int main(int argc, char** argv) {
+    int repeat = 20;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) repeat = std::max(1, atoi(argv[++i]));
+    }
+    cost_per_tier(repeat);
+    selection_checks();
+    scenarios();
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,318 @@
+#!/usr/bin/env python3
+"""
+Screen Capture Decoder - Rebuilds pager screenshots from capture_screen packets.
+
+The firmware (screen_capture.h) streams the framebuffer as PackBits-compressed
+row bands over UDP. This module reassembles the bands, converts the panel's
+pixel format to RGB, undoes the display rotation and writes a PNG.
+
+Usage:
+    # Listen for captures and save them as PNGs
+    python -m devtools.screen_capture --port 12346 --out ~/.clawd/captures
+
+    # Then trigger one from the bridge/HA:
+    #   capture_screen(port=12346)
+
+    # From the bridge, for packets arriving on the audio port:
+    from devtools.screen_capture import CaptureAssembler, is_capture_packet
+    if is_capture_packet(data):
+        frame = assembler.feed(data)
+        if frame:
+            frame.save_png("screen.png")
+
+Frames can be compared with Frame.diff() to check the host simulator
+against the real device frame by frame.
+
+The firmware side is checked on the host by devtools/screen_capture_bench.cpp:
+real ScreenCapture, a C++ decoder, every frame compared byte for byte, and
+whether a capture finishes inside one display redraw:
+
+    g++ -O2 -I. -Idevtools/host -o /tmp/screen-capture-bench devtools/screen_capture_bench.cpp
+    python -m devtools.screen_capture --bench --bin /tmp/screen-capture-bench
+"""
+
+import argparse
+import re
+import socket
+import struct
+import subprocess
+import zlib
+from dataclasses import dataclass, field
+from datetime import datetime
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+MAGIC = b"\xff\xffCP"
+HEADER = struct.Struct("<4sBBBBHHHH")
+
+FLAG_LAST = 0x01
+FLAG_TORN = 0x02
+
+FORMAT_RGB565_BE = 0
+FORMAT_RGB332 = 1
+FORMAT_MONO1 = 2
+
+# Pixels the device never sent (lost packets) show up magenta
+MISSING = (255, 0, 255)
+
+RGB = Tuple[int, int, int]
+
+
+def is_capture_packet(data: bytes) -> bool:
+    """Check whether a UDP payload is a screen capture chunk."""
+    return len(data) >= HEADER.size and data[:4] == MAGIC
+
+
+@dataclass
+class CapturePacket:
+    """One row band of a capture."""
+    capture_id: int
+    flags: int
+    pixel_format: int
+    rotation: int
+    width: int
+    height: int
+    first_row: int
+    rows: int
+    payload: bytes
+
+    @classmethod
+    def parse(cls, data: bytes) -> 'CapturePacket':
+        magic, cid, flags, fmt, rot, w, h, first, rows = HEADER.unpack_from(data)
+        if magic != MAGIC:
+            raise ValueError("Not a capture packet")
+        return cls(cid, flags, fmt, rot, w, h, first, rows, bytes(data[HEADER.size:]))
+
+
+def unpack_bits(payload: bytes, unit: int, units_per_row: int, rows: int) -> List[bytes]:
+    """Undo the firmware's PackBits encoding; returns raw bytes per row."""
+    out = []
+    pos = 0
+    for _ in range(rows):
+        row = bytearray()
+        need = units_per_row * unit
+        while len(row) < need:
+            if pos >= len(payload):
+                raise ValueError("Truncated capture payload")
+            h = payload[pos]
+            pos += 1
+            if h & 0x80:
+                count = (h & 0x7F) + 1
+                row += payload[pos:pos + unit] * count
+                pos += unit
+            else:
+                count = h + 1
+                row += payload[pos:pos + count * unit]
+                pos += count * unit
+        out.append(bytes(row[:need]))
+    return out
+
+
+def row_to_rgb(row: bytes, pixel_format: int, width: int) -> List[RGB]:
+    """Convert one raw panel row to RGB tuples."""
+    if pixel_format == FORMAT_RGB565_BE:
+        pixels = []
+        for i in range(width):
+            v = (row[2 * i] << 8) | row[2 * i + 1]
+            r, g, b = (v >> 11) & 0x1F, (v >> 5) & 0x3F, v & 0x1F
+            pixels.append(((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)))
+        return pixels
+    if pixel_format == FORMAT_RGB332:
+        return [(((v >> 5) & 7) * 255 // 7, ((v >> 2) & 7) * 255 // 7, (v & 3) * 85)
+                for v in row[:width]]
+    if pixel_format == FORMAT_MONO1:
+        # waveshare_epaper: bit set = white (COLOR_OFF), clear = black ink
+        return [(255, 255, 255) if row[x >> 3] & (0x80 >> (x & 7)) else (0, 0, 0)
+                for x in range(width)]
+    raise ValueError(f"Unknown pixel format {pixel_format}")
+
+
+@dataclass
+class Frame:
+    """A fully assembled screenshot in logical (rotated) orientation."""
+    width: int
+    height: int
+    pixels: List[List[RGB]]
+    torn: bool = False
+    missing_rows: int = 0
+    compressed_bytes: int = 0
+    captured_at: str = field(default_factory=lambda: datetime.now().isoformat(timespec='milliseconds'))
+
+    def to_png(self) -> bytes:
+        """Encode as an 8-bit RGB PNG (stdlib only)."""
+        raw = bytearray()
+        for row in self.pixels:
+            raw.append(0)  # Filter type: None
+            for r, g, b in row:
+                raw += bytes((r, g, b))
+
+        def chunk(tag: bytes, body: bytes) -> bytes:
+            return (struct.pack(">I", len(body)) + tag + body +
+                    struct.pack(">I", zlib.crc32(tag + body) & 0xFFFFFFFF))
+
+        ihdr = struct.pack(">IIBBBBB", self.width, self.height, 8, 2, 0, 0, 0)
+        return (b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", ihdr) +
+                chunk(b"IDAT", zlib.compress(bytes(raw), 9)) + chunk(b"IEND", b""))
+
+    def save_png(self, path) -> Path:
+        path = Path(path).expanduser()
+        path.parent.mkdir(parents=True, exist_ok=True)
+        path.write_bytes(self.to_png())
+        return path
+
+    def diff(self, other: 'Frame') -> Dict[str, object]:
+        """Compare two frames: differing pixel count and bounding box."""
+        if (self.width, self.height) != (other.width, other.height):
+            return {"same_size": False, "changed": self.width * self.height, "bbox": None}
+        changed = 0
+        x0, y0, x1, y1 = self.width, self.height, -1, -1
+        for y, (a, b) in enumerate(zip(self.pixels, other.pixels)):
+            for x, (pa, pb) in enumerate(zip(a, b)):
+                if pa != pb:
+                    changed += 1
+                    x0, y0 = min(x0, x), min(y0, y)
+                    x1, y1 = max(x1, x), max(y1, y)
+        bbox = (x0, y0, x1, y1) if changed else None
+        return {"same_size": True, "changed": changed, "bbox": bbox}
+
+
+class CaptureAssembler:
+    """Collects row bands per capture_id and emits a Frame when complete."""
+
+    def __init__(self):
+        self._rows: Dict[int, Dict[int, bytes]] = {}
+        self._meta: Dict[int, CapturePacket] = {}
+        self._bytes: Dict[int, int] = {}
+
+    def feed(self, data: bytes) -> Optional[Frame]:
+        """Add one UDP payload. Returns the Frame once the last band arrives."""
+        pkt = CapturePacket.parse(data)
+        unit = 2 if pkt.pixel_format == FORMAT_RGB565_BE else 1
+        units = (pkt.width + 7) // 8 if pkt.pixel_format == FORMAT_MONO1 else pkt.width
+
+        # A new id means the previous capture was abandoned
+        if pkt.capture_id not in self._meta:
+            self._rows.clear()
+            self._meta.clear()
+            self._bytes.clear()
+            self._rows[pkt.capture_id] = {}
+            self._bytes[pkt.capture_id] = 0
+        self._meta[pkt.capture_id] = pkt
+        self._bytes[pkt.capture_id] += len(data)
+
+        rows = unpack_bits(pkt.payload, unit, units, pkt.rows)
+        for i, row in enumerate(rows):
+            # Later bands win: the device restarts on a fresh frame mid-capture
+            self._rows[pkt.capture_id][pkt.first_row + i] = row
+
+        if not pkt.flags & FLAG_LAST:
+            return None
+        return self._finish(pkt.capture_id)
+
+    def _finish(self, capture_id: int) -> Frame:
+        meta = self._meta.pop(capture_id)
+        rows = self._rows.pop(capture_id)
+        total_bytes = self._bytes.pop(capture_id)
+        w, h = meta.width, meta.height
+
+        panel = []
+        missing = 0
+        for y in range(h):
+            if y in rows:
+                panel.append(row_to_rgb(rows[y], meta.pixel_format, w))
+            else:
+                panel.append([MISSING] * w)
+                missing += 1
+
+        frame = rotate(panel, w, h, meta.rotation)
+        frame.torn = bool(meta.flags & FLAG_TORN)
+        frame.missing_rows = missing
+        frame.compressed_bytes = total_bytes
+        return frame
+
+
+def rotate(panel: List[List[RGB]], w: int, h: int, rotation: int) -> Frame:
+    """Map panel (unrotated) pixels to the logical view ESPHome draws into."""
+    if rotation == 0:
+        return Frame(w, h, panel)
+    if rotation == 2:  # 180
+        return Frame(w, h, [list(reversed(row)) for row in reversed(panel)])
+    if rotation == 1:  # 90: panel (xi, yi) = (W - 1 - y, x)
+        return Frame(h, w, [[panel[x][w - 1 - y] for x in range(h)] for y in range(w)])
+    # 270: panel (xi, yi) = (y, H - 1 - x)
+    return Frame(h, w, [[panel[h - 1 - x][y] for x in range(h)] for y in range(w)])
+
+
+BENCH_LINE_RE = re.compile(r"^(capture|total) (.*)$")
+
+
+def bench(binary: str, phases: int) -> bool:
+    """Run screen_capture_bench.cpp and summarize it per scene."""
+    out = subprocess.run([binary, "-n", str(phases)], capture_output=True, text=True)
+    scenes: Dict[str, List[Dict[str, str]]] = {}
+    total = None
+    for line in out.stdout.splitlines():
+        m = BENCH_LINE_RE.match(line.strip())
+        if not m:
+            continue
+        f = dict(kv.split("=", 1) for kv in m.group(2).split())
+        if m.group(1) == "total":
+            total = f
+        else:
+            scenes.setdefault(f["scene"], []).append(f)
+    if total is None:
+        print(out.stdout + out.stderr)
+        return False
+
+    print(f"{'scene':<12}{'raw':>8}{'wire':>8}{'packets':>9}{'loop calls':>12}{'torn':>6}{'match':>7}")
+    for name, runs in scenes.items():
+        r = runs[0]
+        print(f"{name:<12}{r['raw']:>8}{r['bytes']:>8}{r['packets']:>9}{max(int(x['calls']) for x in runs):>12}"
+              f"{sum(x['torn'] == '1' for x in runs):>6}{sum(x['match'] == '1' for x in runs):>4}/{len(runs)}")
+    ok = out.returncode == 0 and total.get("failures") == "0"
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: listen for capture packets and write PNGs, or bench the firmware encoder."""
+    parser = argparse.ArgumentParser(description='Clawd Pager screen capture receiver')
+    parser.add_argument('--port', type=int, default=12346, help='UDP port to listen on')
+    parser.add_argument('--out', default='~/.clawd/captures', help='Output directory')
+    parser.add_argument('--count', type=int, default=0, help='Exit after N captures (0 = forever)')
+    parser.add_argument('--bench', action='store_true', help='Run the host build of screen_capture.h')
+    parser.add_argument('--bin', default='/tmp/screen-capture-bench', help='Built screen_capture_bench.cpp')
+    parser.add_argument('--phases', type=int, default=5, help='Capture request phases per scene')
+    args = parser.parse_args()
+    if args.bench:
+        raise SystemExit(0 if bench(args.bin, args.phases) else 1)
+
+    out_dir = Path(args.out).expanduser()
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(('0.0.0.0', args.port))
+    print(f"Listening for captures on UDP {args.port}...")
+
+    assembler = CaptureAssembler()
+    saved = 0
+    while args.count == 0 or saved < args.count:
+        data, addr = sock.recvfrom(2048)
+        if not is_capture_packet(data):
+            continue
+        try:
+            frame = assembler.feed(data)
+        except ValueError as e:
+            print(f"Bad packet from {addr[0]}: {e}")
+            continue
+        if frame is None:
+            continue
+
+        name = f"capture_{datetime.now().strftime('%Y%m%d_%H%M%S')}.png"
+        path = frame.save_png(out_dir / name)
+        print(f"Saved {path} ({frame.width}x{frame.height}, {frame.compressed_bytes} bytes on the wire"
+              f"{', TORN' if frame.torn else ''}"
+              f"{f', {frame.missing_rows} rows missing' if frame.missing_rows else ''})")
+        saved += 1
+
+
+if __name__ == '__main__':
+    main()
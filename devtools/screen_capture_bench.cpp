@@ -0,0 +1,230 @@
+// Screen Capture Bench - host build of screen_capture.h with a C++ decoder
+//
+// Captures frames through the real ScreenCapture and decodes the packets
+// it sends with CaptureDecoder below (the C++ twin of
+// devtools/screen_capture.py's CaptureAssembler), then compares the result
+// with the framebuffer byte for byte. Timing follows clawd-pager.yaml: the
+// display redraws every 500 ms (on_frame, then the mode draws), loop() runs
+// every 20 ms; the capture is requested at -n different phases of the
+// redraw. Scenes:
+//   LISTENING, PROCESSING, AGENT   the animated modes on the st7789v
+//                                   (devtools/host/esphome.h, RGB565, 270)
+//   noise565                        random RGB565: nothing compresses
+//   noise332                        random RGB332, same panel
+//   mono                            the 200x200 ePaper, 1 bit/pixel
+// Per capture it checks: decoded frame == framebuffer, not torn, every
+// packet <= MAX_PACKET, and sent in loop() calls that span less than one
+// redraw (calls = how many of them sent anything).
+//
+// Build:
+//   g++ -O2 -I. -Idevtools/host -o /tmp/screen-capture-bench devtools/screen_capture_bench.cpp
+//
+// Usage:
+//   screen-capture-bench [-n phases]
+//   -> capture scene=<s> phase_ms=<t> packets=<n> bytes=<n> raw=<n> calls=<n> done_ms=<t>
+//          torn=<0|1> match=<0|1> ok=<0|1>
+//      total failures=<n>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "esphome.h"
+#include "screen_capture.h"
+#include "display_modes/agent_mode.h"
+#include "display_modes/listening_mode.h"
+#include "display_modes/processing_mode.h"
+
+using esphome::display::DisplayBuffer;
+using esphome::display::HostDisplay;
+
+static const uint16_t CAPTURE_PORT = 12346;
+static const uint32_t REDRAW_MS = 500;
+static const uint32_t LOOP_MS = 20;
+
+// Reassembles one capture into raw panel rows, as screen_capture.py does
+class CaptureDecoder {
+public:
+    bool failed = false;
+    bool torn = false;
+    int capture_id = -1;
+    uint8_t format = 0, rotation = 0;
+    uint16_t width = 0, height = 0;
+    std::vector<uint8_t> frame;
+    std::vector<bool> have_row;
+
+    // One packet; true when it was the capture's last
+    bool feed(const uint8_t* p, size_t len) {
+        if (len < ScreenCapture::HEADER_SIZE || len > ScreenCapture::MAX_PACKET || p[0] != 0xFF || p[1] != 0xFF ||
+            p[2] != 'C' || p[3] != 'P') {
+            failed = true;
+            return false;
+        }
+        if (p[4] != capture_id) {
+            capture_id = p[4];
+            format = p[6];
+            rotation = p[7];
+            width = (uint16_t) (p[8] | p[9] << 8);
+            height = (uint16_t) (p[10] | p[11] << 8);
+            frame.assign(row_bytes() * height, 0);
+            have_row.assign(height, false);
+        }
+        uint16_t first = (uint16_t) (p[12] | p[13] << 8);
+        uint16_t rows = (uint16_t) (p[14] | p[15] << 8);
+        size_t pos = ScreenCapture::HEADER_SIZE;
+        size_t unit = format == (uint8_t) CaptureFormat::RGB565_BE ? 2 : 1;
+        for (uint16_t r = first; r < first + rows; r++) {
+            if (r >= height) {
+                failed = true;
+                return false;
+            }
+            uint8_t* row = &frame[(size_t) r * row_bytes()];
+            size_t filled = 0;
+            while (filled < row_bytes()) {
+                if (pos >= len) {
+                    failed = true;
+                    return false;
+                }
+                uint8_t h = p[pos++];
+                size_t count = (h & 0x7F) + 1;
+                size_t n = h & 0x80 ? unit : count * unit;
+                if (pos + n > len || filled + count * unit > row_bytes()) {
+                    failed = true;
+                    return false;
+                }
+                for (size_t i = 0; i < (h & 0x80 ? count : 1); i++) {
+                    memcpy(row + filled, p + pos, n);
+                    filled += n;
+                }
+                pos += n;
+            }
+            have_row[r] = true;
+        }
+        if (pos != len) failed = true;  // Trailing bytes: the encoder and decoder disagree
+        torn = (p[5] & CAPTURE_FLAG_TORN) != 0;
+        return (p[5] & CAPTURE_FLAG_LAST) != 0;
+    }
+
+    size_t row_bytes() const {
+        if (format == (uint8_t) CaptureFormat::RGB565_BE) return (size_t) width * 2;
+        if (format == (uint8_t) CaptureFormat::RGB332) return width;
+        return (width + 7) / 8;
+    }
+
+    bool complete() const {
+        for (bool b : have_row)
+            if (!b) return false;
+        return !failed && !have_row.empty();
+    }
+};
+
+// A panel of raw bytes, for the formats HostDisplay doesn't draw
+class RawDisplay : public DisplayBuffer {
+public:
+    RawDisplay(int w, int h, size_t bytes) : data(bytes, 0), w_(w), h_(h) { buffer_ = data.data(); }
+    RawDisplay(const RawDisplay&) = delete;
+
+    std::vector<uint8_t> data;
+
+protected:
+    void draw_absolute_pixel_internal(int x, int y, esphome::Color color) override {}
+    int get_width_internal() override { return w_; }
+    int get_height_internal() override { return h_; }
+
+private:
+    int w_, h_;
+};
+
+struct Scene {
+    const char* name;
+    CaptureFormat format;
+    DisplayMode* mode;  // Null: random bytes every redraw
+};
+
+static ListeningMode listening;
+static ProcessingMode processing;
+static AgentMode agent;
+
+static int failures = 0;
+
+static void run(const Scene& scene, uint32_t phase_ms, unsigned seed) {
+    std::mt19937 rng(seed);
+    HostDisplay host;
+    RawDisplay mono(200, 200, 200 * 200 / 8);
+    RawDisplay rgb332(135, 240, 135 * 240);
+    DisplayBuffer* d = scene.mode || scene.format == CaptureFormat::RGB565_BE ? (DisplayBuffer*) &host
+                       : scene.format == CaptureFormat::RGB332              ? (DisplayBuffer*) &rgb332
+                                                                            : (DisplayBuffer*) &mono;
+    const uint8_t* fb = FrameBufferPeek::buffer(d);
+    size_t fb_bytes = d == &host ? host.buffer.size() * 2 : d == &rgb332 ? rgb332.data.size() : mono.data.size();
+
+    ScreenCapture capture;
+    capture.set_format(scene.format);
+    CaptureDecoder decoder;
+    bool requested = false, done = false;
+    int calls = 0;
+    uint32_t done_ms = 0, request_ms = REDRAW_MS + phase_ms;
+    size_t max_packet = 0;
+    host_udp_sent().clear();
+
+    for (uint32_t now = 0; now < 10 * REDRAW_MS && !done; now += LOOP_MS) {
+        if (!requested && now >= request_ms) {
+            capture.request(CAPTURE_PORT);
+            requested = true;
+        }
+        if (now % REDRAW_MS == 0) {
+            capture.on_frame(*d);
+            if (scene.mode) {
+                scene.mode->render(*d, now, "Edit main.cpp", RenderTier::FULL);
+            } else {
+                uint8_t* w = FrameBufferPeek::writable_buffer(d);
+                for (size_t i = 0; i < fb_bytes; i++) w[i] = (uint8_t) rng();
+            }
+        }
+        capture.loop();
+        if (!host_udp_sent().empty()) calls++;
+        for (const HostDatagram& p : host_udp_sent()) {
+            max_packet = std::max(max_packet, p.data.size());
+            if (p.dst_port != CAPTURE_PORT) decoder.failed = true;
+            if (decoder.feed(p.data.data(), p.data.size())) {
+                done = true;
+                done_ms = now - request_ms;
+            }
+        }
+        host_udp_sent().clear();
+    }
+
+    // Decoded while the frame it came from is still on screen: compare with it
+    bool match = done && decoder.complete() && decoder.frame.size() == fb_bytes &&
+                 memcmp(decoder.frame.data(), fb, fb_bytes) == 0 &&
+                 decoder.rotation == (uint8_t) (FrameBufferPeek::rotation(d) / 90);
+    // Requested mid-redraw, the capture starts at the next one
+    bool ok = match && !decoder.torn && max_packet <= ScreenCapture::MAX_PACKET && done_ms < 2 * REDRAW_MS &&
+              (uint32_t) calls * LOOP_MS < REDRAW_MS;
+    if (!ok) failures++;
+    printf("capture scene=%s phase_ms=%u packets=%u bytes=%u raw=%zu calls=%d done_ms=%u torn=%d match=%d ok=%d\n",
+           scene.name, phase_ms, (unsigned) capture.packets_sent(), (unsigned) capture.bytes_sent(), fb_bytes, calls,
+           done_ms, decoder.torn ? 1 : 0, match ? 1 : 0, ok ? 1 : 0);
+}
+
+int main(int argc, char** argv) {
+    int phases = 5;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) phases = atoi(argv[++i]);
+    }
+    audio_streamer().begin("127.0.0.1", 12345);
+
+    static const Scene SCENES[] = {
+        {"LISTENING", CaptureFormat::RGB565_BE, &listening}, {"PROCESSING", CaptureFormat::RGB565_BE, &processing},
+        {"AGENT", CaptureFormat::RGB565_BE, &agent},         {"noise565", CaptureFormat::RGB565_BE, nullptr},
+        {"noise332", CaptureFormat::RGB332, nullptr},        {"mono", CaptureFormat::MONO1, nullptr},
+    };
+    for (const Scene& s : SCENES) {
+        for (int k = 0; k < phases; k++) run(s, (uint32_t) (k * REDRAW_MS / phases), (unsigned) k + 1);
+    }
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""
+Session Board Encoder - Bridge side of the pager's multi-session status board.
+
+Keeps the last state sent for each board slot and turns session updates into
+the compact per-slot delta strings that the board_update service parses
+(format documented in display_modes/session_board.h). Only changed fields
+are sent, and an update that changes nothing sends nothing.
+
+Usage:
+    from devtools.session_board import SessionBoardEncoder
+    board = SessionBoardEncoder()
+    delta = board.update("a1b2c3d4", tool="Edit", detail="main.cpp", status="R")
+    if delta:
+        api.execute_service("board_update", {"delta": delta})
+    delta = board.remove("a1b2c3d4")
+
+    # Bytes on the wire and rows redrawn vs full set_display updates
+    python -m devtools.session_board --bench
+"""
+
+import argparse
+import random
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional
+
+MAX_SLOTS = 8
+ID_CHARS = 8
+TOOL_CHARS = 12
+DETAIL_CHARS = 24
+
+STATUS_RUNNING = "R"
+STATUS_WAITING = "W"
+STATUS_DONE = "D"
+STATUS_ERROR = "E"
+STATUS_IDLE = "I"
+
+
+@dataclass
+class SlotState:
+    """Mirror of the device's SessionBoard::Slot, as last sent."""
+    session_id: str = ""
+    tool: str = ""
+    detail: str = ""
+    status: str = STATUS_IDLE
+    progress: Optional[int] = None
+
+
+def _clean(value: str, limit: int) -> str:
+    # '|' and newlines are delta separators; the device truncates anyway
+    return value.replace("|", "/").replace("\n", " ")[:limit]
+
+
+@dataclass
+class SessionBoardEncoder:
+    """Assigns sessions to slots and encodes per-slot deltas."""
+    slots: List[Optional[SlotState]] = field(default_factory=lambda: [None] * MAX_SLOTS)
+    _slot_of: Dict[str, int] = field(default_factory=dict)
+
+    def slot_for(self, session_id: str) -> Optional[int]:
+        """Existing slot for a session, else the first free one (None if full)."""
+        sid = session_id[:ID_CHARS]
+        if sid in self._slot_of:
+            return self._slot_of[sid]
+        for i, slot in enumerate(self.slots):
+            if slot is None:
+                return i
+        return None
+
+    def update(self, session_id: str, tool: Optional[str] = None, detail: Optional[str] = None,
+               status: Optional[str] = None, progress: Optional[int] = None) -> str:
+        """Apply a session update; returns the delta line ('' if nothing changed)."""
+        sid = _clean(session_id, ID_CHARS)
+        index = self.slot_for(sid)
+        if index is None:
+            return ""
+
+        fields = []
+        slot = self.slots[index]
+        if slot is None:
+            slot = self.slots[index] = SlotState(session_id=sid)
+            self._slot_of[sid] = index
+            fields.append(f"i={sid}")
+
+        if tool is not None and _clean(tool, TOOL_CHARS) != slot.tool:
+            slot.tool = _clean(tool, TOOL_CHARS)
+            fields.append(f"t={slot.tool}")
+        if detail is not None and _clean(detail, DETAIL_CHARS) != slot.detail:
+            slot.detail = _clean(detail, DETAIL_CHARS)
+            fields.append(f"d={slot.detail}")
+        if status is not None and status[:1] != slot.status:
+            slot.status = status[:1]
+            fields.append(f"s={slot.status}")
+        if progress is not None:
+            progress = max(0, min(100, progress))
+            if progress != slot.progress:
+                slot.progress = progress
+                fields.append(f"p={progress}")
+
+        if not fields:
+            return ""
+        return f"{index}|" + "|".join(fields)
+
+    def remove(self, session_id: str) -> str:
+        """Free a session's slot; returns the clear delta ('' if unknown)."""
+        index = self._slot_of.pop(session_id[:ID_CHARS], None)
+        if index is None:
+            return ""
+        self.slots[index] = None
+        return f"{index}|x"
+
+    @staticmethod
+    def batch(deltas: List[str]) -> str:
+        """Join several slot deltas into one board_update call."""
+        return "\n".join(d for d in deltas if d)
+
+
+TOOLS = ["Edit", "Read", "Bash", "Grep", "Glob", "WebFetch", "Task", "Write"]
+FILES = ["main.cpp", "session_board.h", "dashboard_server.py", "clawd-pager.yaml",
+         "README.md", "event_logger.py", "audio_player.h", "CMakeLists.txt"]
+
+
+def _full_text(slot: SlotState) -> str:
+    # What the single-screen set_display path sends for the same information
+    return f"{slot.tool}: {slot.detail}\n{slot.status} {slot.progress or 0}%"
+
+
+def bench(sessions: int, updates: int, seed: int = 1) -> Dict[str, float]:
+    """Simulate random agent activity; compare delta vs full-screen updates."""
+    rng = random.Random(seed)
+    board = SessionBoardEncoder()
+    ids = [f"{rng.getrandbits(32):08x}" for _ in range(sessions)]
+    progress = {sid: 0 for sid in ids}
+
+    delta_bytes = full_bytes = calls = rows = 0
+    for sid in ids:
+        delta = board.update(sid, tool=rng.choice(TOOLS), detail=rng.choice(FILES), status="R", progress=0)
+        delta_bytes += len(delta)
+
+    for _ in range(updates):
+        sid = rng.choice(ids)
+        roll = rng.random()
+        if roll < 0.6:
+            progress[sid] = min(100, progress[sid] + rng.randint(1, 15))
+            delta = board.update(sid, progress=progress[sid])
+        elif roll < 0.9:
+            delta = board.update(sid, tool=rng.choice(TOOLS), detail=rng.choice(FILES), status="R")
+        else:
+            delta = board.update(sid, status=rng.choice("WRD"))
+
+        index = board.slot_for(sid)
+        full_bytes += len(_full_text(board.slots[index])) + len("AGENT_EDIT")
+        if delta:
+            calls += 1
+            rows += 1
+            delta_bytes += len(delta)
+
+    screen_rows = MAX_SLOTS + 1  # Full redraw: header plus every row
+    return {
+        "sessions": sessions,
+        "updates": updates,
+        "delta_bytes_per_update": delta_bytes / updates,
+        "full_bytes_per_update": full_bytes / updates,
+        "calls_sent": calls,
+        "rows_redrawn_per_update": rows / updates,
+        "full_redraw_rows": screen_rows,
+    }
+
+
+def main():
+    """CLI: run the delta vs full-update benchmark."""
+    parser = argparse.ArgumentParser(description='Session board delta encoder')
+    parser.add_argument('--bench', action='store_true', help='Benchmark 1, 4 and 8 concurrent sessions')
+    parser.add_argument('--updates', type=int, default=10000, help='Updates per benchmark run')
+    args = parser.parse_args()
+
+    if not args.bench:
+        parser.print_help()
+        return
+
+    print(f"{'sessions':>8} {'delta B/upd':>12} {'full B/upd':>11} {'rows/upd':>9} {'full rows':>10}")
+    for n in (1, 4, 8):
+        r = bench(n, args.updates)
+        print(f"{r['sessions']:>8} {r['delta_bytes_per_update']:>12.1f} {r['full_bytes_per_update']:>11.1f} "
+              f"{r['rows_redrawn_per_update']:>9.2f} {r['full_redraw_rows']:>10}")
+
+
+if __name__ == '__main__':
+    main()
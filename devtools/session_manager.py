@@ -22,16 +22,35 @@ Usage:
     session = mgr.load_session(session_id)
     for event in session.events:
         print(event)
+
+It also keeps the pager's multi-session board (display_modes/session_board.h)
+in step with the Claude Code sessions it sees: agent events carrying the
+hook's session_id become per-slot deltas, handed to board_sink (the
+dashboard points it at the pager's board_update service).
+
+    mgr.board_sink = lambda delta: api.execute_service("board_update", {"delta": delta})
+    mgr.track_agent_event("TOOL_START", {"session_id": sid, "tool": "Edit", "display_text": "main.cpp"})
 """
 
 import json
 import gzip
+import time
 from datetime import datetime
 from pathlib import Path
-from typing import List, Optional, Dict, Any
+from typing import Callable, List, Optional, Dict, Any
 from dataclasses import dataclass, asdict, field
 
 from .event_logger import EventLogger, EventSource, PagerEvent, get_logger
+from .session_board import ID_CHARS, STATUS_RUNNING, STATUS_WAITING, SessionBoardEncoder
+
+# Agent events that move a session's board row, and the status they set
+BOARD_STATUS = {
+    "TOOL_START": STATUS_RUNNING,
+    "TOOL_END": STATUS_RUNNING,
+    "AGENT_WORKING": STATUS_RUNNING,
+    "AGENT_WAITING": STATUS_WAITING,
+    "WAITING": STATUS_WAITING,          # As claude_hook.build_event names it
+}
 
 
 @dataclass
@@ -92,6 +111,11 @@ class SessionManager:
         self.current_session: Optional[SessionRecording] = None
         self._recording = False
 
+        # Multi-session board: one row per Claude Code session seen
+        self.board = SessionBoardEncoder()
+        self.board_sink: Optional[Callable[[str], None]] = None
+        self._board_seen: Dict[str, float] = {}  # Board id (first ID_CHARS) -> last update
+
     @property
     def is_recording(self) -> bool:
         """Check if a session is currently being recorded."""
@@ -152,6 +176,41 @@ class SessionManager:
         if self.current_session:
             self.current_session.events.append(event.to_dict())
 
+    def track_agent_event(self, event_type: str, data: Dict[str, Any]) -> str:
+        """
+        Update the pager's session board from an agent event.
+
+        Args:
+            event_type: TOOL_START, TOOL_END, AGENT_WORKING, AGENT_WAITING or WAITING
+            data: Event data; needs the hook's session_id
+
+        Returns:
+            The board_update delta sent to board_sink ('' if nothing changed)
+        """
+        status = BOARD_STATUS.get(event_type)
+        session_id = str(data.get("session_id") or "")
+        if status is None or not session_id:
+            return ""
+
+        waiting = status == STATUS_WAITING
+        tool = None if waiting else data.get("tool")
+        detail = "waiting for you" if waiting else (
+            data.get("display_text") or data.get("file") or data.get("command"))
+
+        deltas = []
+        if self.board.slot_for(session_id) is None and self._board_seen:
+            # Board full: the session that has been quiet longest gives up its row
+            stalest = min(self._board_seen, key=self._board_seen.get)
+            deltas.append(self.board.remove(stalest))
+            del self._board_seen[stalest]
+        deltas.append(self.board.update(session_id, tool=tool, detail=detail, status=status))
+        self._board_seen[session_id[:ID_CHARS]] = time.monotonic()
+
+        delta = SessionBoardEncoder.batch(deltas)
+        if delta and self.board_sink is not None:
+            self.board_sink(delta)
+        return delta
+
     def end_session(self) -> Optional[str]:
         """
         End the current recording session and save to disk.
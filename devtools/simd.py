@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+SIMD - Kernel x backend matrix for simd.h.
+
+simd.h writes the audio and raster kernels (mix, gain, peak, RGB565 blend,
+ordered-dither select and 1-bit dither) once over a small vector layer with
+SSE2, NEON and scalar backends, plus hand-written ESP32-S3 PIE versions of
+mix and peak. The native bench (devtools/simd_bench.cpp) checks each backend
+against the scalar reference bit for bit and times it. This runs one or
+more bench builds (e.g. with and without auto-vectorisation, or an AArch64
+build under qemu) and prints ns per element, speedup over the reference in
+the same build, and any mismatches.
+
+Usage:
+    g++ -O2 -o /tmp/simd-bench devtools/simd_bench.cpp
+    g++ -O2 -fno-tree-vectorize -o /tmp/simd-bench-novec devtools/simd_bench.cpp
+    python -m devtools.simd --bench --bin /tmp/simd-bench --bin /tmp/simd-bench-novec
+"""
+
+import argparse
+import os
+import re
+import subprocess
+from typing import Dict, List, Tuple
+
+LINE_RE = re.compile(r"^kernel=(\S+) backend=(\S+) ns_per_elem=(\S+) mismatches=(\d+)$")
+
+
+def parse(output: str) -> Dict[Tuple[str, str], Tuple[float, int]]:
+    """Bench lines -> {(kernel, backend): (ns_per_elem, mismatches)}."""
+    rows = {}
+    for line in output.splitlines():
+        m = LINE_RE.match(line.strip())
+        if m:
+            rows[(m.group(1), m.group(2))] = (float(m.group(3)), int(m.group(4)))
+    return rows
+
+
+def bench(binaries: List[str], repeat: int) -> bool:
+    ok = True
+    for binary in binaries:
+        out = subprocess.run([binary, "-n", str(repeat)], capture_output=True, text=True)
+        rows = parse(out.stdout)
+        if not rows:
+            print(out.stdout + out.stderr)
+            return False
+        kernels = list(dict.fromkeys(k for k, _ in rows))
+        backends = list(dict.fromkeys(b for _, b in rows))
+        print(f"{os.path.basename(binary)} (ns/element, speedup over ref)")
+        print(f"  {'kernel':<15}" + "".join(f"{b:>22}" for b in backends))
+        for kernel in kernels:
+            ref = rows.get((kernel, "ref"), (0.0, 0))[0]
+            cells = []
+            for backend in backends:
+                ns, bad = rows[(kernel, backend)]
+                cell = f"{ns:.3f} {ref / ns if ns else 0:.1f}x"
+                cells.append(f"{cell + (' DIFFER' if bad else ''):>22}")
+            print(f"  {kernel:<15}" + "".join(cells))
+        total = [line for line in out.stdout.splitlines() if line.startswith("total")]
+        print(f"  {total[0] if total else 'no total line'}")
+        ok = ok and out.returncode == 0
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: check simd.h backends against the reference and print the timing matrix."""
+    parser = argparse.ArgumentParser(description='simd.h kernel x backend matrix')
+    parser.add_argument('--bench', action='store_true', help='Run the bench builds and print the matrix')
+    parser.add_argument('--bin', action='append', help='Built simd_bench.cpp (repeatable)')
+    parser.add_argument('--repeat', type=int, default=200, help='Timed runs per kernel')
+    args = parser.parse_args()
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin or ['/tmp/simd-bench'], args.repeat) else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,204 @@
+// SIMD Bench - host build of simd.h
+//
+// Runs every kernel of simd.h on every backend this build has (SimdRef,
+// SimdKernels over SimdLanesScalar, and SSE2 on x86-64 or NEON on AArch64)
+// and checks each against SimdRef bit for bit: random data at every length
+// 0..80 and every start offset 0..7 (unaligned loads, tails), saturation
+// edges (-32768, 32767), every shift, alpha, dither level and pattern phase,
+// and the bits dither_1bit must leave alone past n. Then times each kernel on
+// a 240x135 frame worth of elements (32400; 101 ms of 16 kHz audio).
+//
+// SimdPie (ESP32-S3) only builds for the device; Simd::begin() checks it
+// there.
+//
+// Build:
+//   g++ -O2 -o /tmp/simd-bench devtools/simd_bench.cpp
+//   g++ -O2 -fno-tree-vectorize -o /tmp/simd-bench-novec devtools/simd_bench.cpp   # SimdRef as the ESP32 sees it
+//   aarch64-linux-gnu-g++ -O2 -static -o /tmp/simd-bench-neon devtools/simd_bench.cpp
+//
+// Usage:
+//   simd-bench [-n repeat]
+//   -> kernel=<name> backend=<name> ns_per_elem=<t> mismatches=<n>
+//      per kernel and backend, then: total checks=<n> mismatches=<n>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../simd.h"
+
+struct Backend {
+    const char* name;
+    void (*mix_s16)(int16_t*, const int16_t*, const int16_t*, size_t);
+    void (*gain_s16)(int16_t*, const int16_t*, size_t, int16_t, uint8_t);
+    int32_t (*peak_s16)(const int16_t*, size_t);
+    void (*blend_rgb565)(uint16_t*, const uint16_t*, const uint16_t*, size_t, uint8_t);
+    void (*dither_select_rgb565)(uint16_t*, const uint16_t*, const uint16_t*, size_t, int, int, uint8_t);
+    void (*dither_1bit)(uint8_t*, const uint8_t*, size_t, int, int);
+};
+
+template<typename K>
+static Backend make_backend(const char* name) {
+    return {name, K::mix_s16, K::gain_s16, K::peak_s16, K::blend_rgb565, K::dither_select_rgb565, K::dither_1bit};
+}
+
+static const char* KERNELS[] = {"mix_s16", "gain_s16", "peak_s16", "blend_rgb565", "dither_select", "dither_1bit"};
+static const int KERNEL_COUNT = 6;
+
+static std::mt19937 rng(12345);
+
+// Random samples with the saturation edges mixed in
+static void fill_s16(int16_t* p, size_t n) {
+    static const int16_t EDGES[] = {-32768, 32767, 0, -1, 1, -32767, 16384, -16384};
+    for (size_t i = 0; i < n; i++) p[i] = rng() % 5 == 0 ? EDGES[rng() % 8] : (int16_t) rng();
+}
+
+static void fill_u8(uint8_t* p, size_t n) {
+    for (size_t i = 0; i < n; i++) p[i] = (uint8_t) rng();
+}
+
+struct Checker {
+    uint64_t checks = 0;
+    uint64_t mismatches[KERNEL_COUNT] = {};
+
+    void expect(int kernel, bool same) {
+        checks++;
+        if (!same) mismatches[kernel]++;
+    }
+};
+
+static void check(const Backend& be, Checker& c) {
+    const size_t MAX = 96;
+    int16_t a[MAX], b[MAX], want[MAX], got[MAX];
+    uint8_t gray[MAX], bits_want[MAX], bits_got[MAX];
+    for (size_t n = 0; n <= 80; n++) {
+        for (size_t off = 0; off < 8; off++) {
+            fill_s16(a, MAX);
+            fill_s16(b, MAX);
+            fill_u8(gray, MAX);
+            const int16_t* pa = a + off;
+            const int16_t* pb = b + off;
+            const uint16_t* ua = (const uint16_t*) pa;
+            const uint16_t* ub = (const uint16_t*) pb;
+
+            SimdRef::mix_s16(want, pa, pb, n);
+            be.mix_s16(got + off, pa, pb, n);
+            c.expect(0, memcmp(want, got + off, n * 2) == 0);
+
+            for (uint8_t shift = 0; shift < 16; shift++) {
+                int16_t gain = rng() % 4 == 0 ? (int16_t) (rng() % 2 ? -32768 : 32767) : (int16_t) rng();
+                SimdRef::gain_s16(want, pa, n, gain, shift);
+                be.gain_s16(got, pa, n, gain, shift);
+                c.expect(1, memcmp(want, got, n * 2) == 0);
+            }
+
+            c.expect(2, be.peak_s16(pa, n) == SimdRef::peak_s16(pa, n));
+
+            for (uint8_t alpha = 0; alpha <= 32; alpha++) {
+                SimdRef::blend_rgb565((uint16_t*) want, ua, ub, n, alpha);
+                be.blend_rgb565((uint16_t*) got, ua, ub, n, alpha);
+                c.expect(3, memcmp(want, got, n * 2) == 0);
+            }
+
+            for (int phase = 0; phase < 16; phase++) {
+                int x0 = phase & 3, y = phase >> 2;
+                for (uint8_t level = 0; level <= 16; level++) {
+                    SimdRef::dither_select_rgb565((uint16_t*) want, ua, ub, n, x0, y, level);
+                    be.dither_select_rgb565((uint16_t*) got, ua, ub, n, x0, y, level);
+                    c.expect(4, memcmp(want, got, n * 2) == 0);
+                }
+                // Same junk in both so the bits past n must survive
+                fill_u8(bits_want, MAX);
+                memcpy(bits_got, bits_want, MAX);
+                SimdRef::dither_1bit(bits_want, gray + off, n, x0 + (int) off, y);
+                be.dither_1bit(bits_got, gray + off, n, x0 + (int) off, y);
+                c.expect(5, memcmp(bits_want, bits_got, MAX) == 0);
+            }
+        }
+    }
+    // Longest run: all -32768 (peak 32768), sums that saturate both ways
+    for (size_t i = 0; i < MAX; i++) a[i] = -32768, b[i] = (int16_t) (i & 1 ? 32767 : -32768);
+    c.expect(2, be.peak_s16(a, MAX) == 32768);
+    SimdRef::mix_s16(want, a, b, MAX);
+    be.mix_s16(got, a, b, MAX);
+    c.expect(0, memcmp(want, got, sizeof(want)) == 0);
+}
+
+template<typename F>
+static double time_ns(int repeat, size_t n, F fn) {
+    fn();  // Warm the caches
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / repeat / n;
+}
+
+static volatile int32_t sink;
+
+static void bench(const Backend& be, int repeat, double ns[KERNEL_COUNT]) {
+    const size_t N = 240 * 135;
+    std::vector<int16_t> a(N), b(N), out(N);
+    std::vector<uint8_t> gray(N), bits(N / 8);
+    fill_s16(a.data(), N);
+    fill_s16(b.data(), N);
+    fill_u8(gray.data(), N);
+    const uint16_t* ua = (const uint16_t*) a.data();
+    const uint16_t* ub = (const uint16_t*) b.data();
+    uint16_t* uo = (uint16_t*) out.data();
+
+    ns[0] = time_ns(repeat, N, [&] { be.mix_s16(out.data(), a.data(), b.data(), N); });
+    ns[1] = time_ns(repeat, N, [&] { be.gain_s16(out.data(), a.data(), N, 3, 1); });
+    ns[2] = time_ns(repeat, N, [&] { sink = be.peak_s16(a.data(), N); });
+    // Raster kernels run a row at a time, as a frame transition would
+    ns[3] = time_ns(repeat, N, [&] {
+        for (size_t y = 0; y < 135; y++) be.blend_rgb565(uo + y * 240, ua + y * 240, ub + y * 240, 240, 12);
+    });
+    ns[4] = time_ns(repeat, N, [&] {
+        for (int y = 0; y < 135; y++) be.dither_select_rgb565(uo + y * 240, ua + y * 240, ub + y * 240, 240, 0, y, 6);
+    });
+    ns[5] = time_ns(repeat, N, [&] {
+        for (int y = 0; y < 135; y++) be.dither_1bit(bits.data() + y * 30, gray.data() + y * 240, 240, 0, y);
+    });
+}
+
+int main(int argc, char** argv) {
+    int repeat = 200;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-n repeat]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Backend> backends;
+    backends.push_back(make_backend<SimdRef>("ref"));
+    backends.push_back(make_backend<SimdKernels<SimdLanesScalar>>(SimdLanesScalar::name()));
+#if CLAWD_SIMD_SSE2
+    backends.push_back(make_backend<SimdKernels<SimdLanesSse2>>(SimdLanesSse2::name()));
+#endif
+#if CLAWD_SIMD_NEON
+    backends.push_back(make_backend<SimdKernels<SimdLanesNeon>>(SimdLanesNeon::name()));
+#endif
+
+    uint64_t checks = 0, mismatches = 0;
+    for (const Backend& be : backends) {
+        Checker c;
+        check(be, c);
+        double ns[KERNEL_COUNT];
+        bench(be, repeat, ns);
+        checks += c.checks;
+        for (int k = 0; k < KERNEL_COUNT; k++) {
+            printf("kernel=%s backend=%s ns_per_elem=%.4f mismatches=%llu\n", KERNELS[k], be.name, ns[k],
+                   (unsigned long long) c.mismatches[k]);
+            mismatches += c.mismatches[k];
+        }
+    }
+    printf("total checks=%llu mismatches=%llu\n", (unsigned long long) checks, (unsigned long long) mismatches);
+    return mismatches ? 1 : 0;
+}
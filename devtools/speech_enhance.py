@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""
+Speech Enhance - Noise suppression for pager mic audio before STT.
+
+AudioStreamer sends raw 16 kHz mono PCM, and in a noisy office the STT
+often fails, so the user has to record again. This stage cleans each
+utterance first with STFT noise suppression:
+
+- The noise spectrum is estimated from the frames before speech starts (the
+  pager starts streaming on button hold, before the user speaks). It then
+  keeps adapting slowly during pauses.
+- Gain per bin is a Wiener filter with decision-directed a priori SNR (the
+  default), or power spectral subtraction with over-subtraction. Both use a
+  gain floor, so residual noise stays smooth rather than "musical".
+- All per-frame work is vectorized over frequency bins with numpy.
+- Utterances from different pagers run in parallel on a process pool.
+
+numpy is optional: without it enhance_pcm() returns the audio unchanged, so
+the bridge keeps working and simply skips this stage.
+
+Usage:
+    # Enhance a WAV file
+    python -m devtools.speech_enhance noisy.wav clean.wav
+
+    # From the bridge, after the STOP marker:
+    from devtools.speech_enhance import EnhancePool
+    pool = EnhancePool()
+    pcm = await pool.enhance_async(pcm)     # or pool.submit(pcm).result()
+
+    # Real-time factor and SNR improvement on synthetic office fixtures
+    python -m devtools.speech_enhance --bench
+"""
+
+import argparse
+import asyncio
+import logging
+import os
+import time
+import wave
+from concurrent.futures import Future, ProcessPoolExecutor
+from typing import Dict, List, Optional
+
+try:
+    import numpy as np
+except ImportError:  # Enhancement becomes a pass-through
+    np = None
+
+logger = logging.getLogger("SpeechEnhance")
+
+SAMPLE_RATE = 16000
+FRAME = 512                 # 32 ms analysis window
+HOP = FRAME // 2            # 50% overlap; periodic Hann sums to 1
+NOISE_SECONDS = 0.25        # Leading audio assumed to be speech-free
+NOISE_ADAPT = 0.98          # Noise PSD smoothing in frames judged noise-only
+NOISE_GATE = 2.5            # Frame power below this x noise counts as noise
+DD_ALPHA = 0.98             # Decision-directed smoothing
+GAIN_FLOOR = 0.1            # -20 dB: limits musical noise
+OVERSUBTRACT = 2.0          # Spectral subtraction factor
+
+_warned = False
+
+
+def _available() -> bool:
+    global _warned
+    if np is None and not _warned:
+        logger.warning("numpy not installed; speech enhancement disabled")
+        _warned = True
+    return np is not None
+
+
+def enhance(samples, method: str = "wiener", noise_seconds: float = NOISE_SECONDS):
+    """Enhance float samples (numpy array, any scale). Returns a same-length array."""
+    n = len(samples)
+    if n < FRAME:
+        return samples.copy()
+
+    window = np.hanning(FRAME + 1)[:FRAME]           # Periodic Hann
+    pad = FRAME - HOP
+    padded = np.concatenate([np.zeros(pad), samples, np.zeros(FRAME)])
+    count = (len(padded) - FRAME) // HOP + 1
+    frames = np.lib.stride_tricks.as_strided(
+        padded, shape=(count, FRAME), strides=(padded.strides[0] * HOP, padded.strides[0]))
+    spectra = np.fft.rfft(frames * window, axis=1)
+    power = spectra.real ** 2 + spectra.imag ** 2
+
+    lead = max(1, min(count, int(noise_seconds * SAMPLE_RATE / HOP)))
+    noise = power[:lead].mean(axis=0) + 1e-10
+
+    gains = np.empty_like(power)
+    prev_clean = noise.copy()  # |S|^2 estimate of the previous frame
+    for i in range(count):
+        p = power[i]
+        if i >= lead and p.sum() < NOISE_GATE * noise.sum():
+            noise = NOISE_ADAPT * noise + (1 - NOISE_ADAPT) * p
+        if method == "subtract":
+            g = np.sqrt(np.maximum(1.0 - OVERSUBTRACT * noise / (p + 1e-10), 0.0))
+        else:
+            post = p / noise                                      # a posteriori SNR
+            prio = DD_ALPHA * prev_clean / noise + (1 - DD_ALPHA) * np.maximum(post - 1.0, 0.0)
+            g = prio / (1.0 + prio)
+        g = np.maximum(g, GAIN_FLOOR)
+        gains[i] = g
+        prev_clean = g * g * p
+
+    out_frames = np.fft.irfft(spectra * gains, n=FRAME, axis=1)
+    out = np.zeros(len(padded))
+    for i in range(count):  # Overlap-add (count x 512 slices, cheap next to the FFTs)
+        out[i * HOP:i * HOP + FRAME] += out_frames[i]
+    return out[pad:pad + n]
+
+
+def enhance_pcm(pcm: bytes, method: str = "wiener") -> bytes:
+    """Enhance 16-bit little-endian mono PCM at 16 kHz. Pass-through without numpy."""
+    if not _available() or len(pcm) < 2 * FRAME:
+        return pcm
+    samples = np.frombuffer(pcm[:len(pcm) // 2 * 2], dtype="<i2").astype(np.float64)
+    out = enhance(samples, method)
+    return np.clip(np.round(out), -32768, 32767).astype("<i2").tobytes()
+
+
+class EnhancePool:
+    """Process pool so several pagers' utterances are enhanced in parallel."""
+
+    def __init__(self, workers: Optional[int] = None, method: str = "wiener"):
+        self.method = method
+        self.workers = workers or os.cpu_count() or 1
+        self._executor = ProcessPoolExecutor(max_workers=self.workers) if np is not None else None
+
+    def submit(self, pcm: bytes) -> Future:
+        if self._executor is None:
+            f: Future = Future()
+            f.set_result(pcm)
+            return f
+        return self._executor.submit(enhance_pcm, pcm, self.method)
+
+    async def enhance_async(self, pcm: bytes) -> bytes:
+        return await asyncio.wrap_future(self.submit(pcm))
+
+    def close(self):
+        if self._executor:
+            self._executor.shutdown()
+
+
+def snr_db(clean, test) -> float:
+    noise = test - clean
+    return 10 * np.log10(np.sum(clean ** 2) / max(np.sum(noise ** 2), 1e-10))
+
+
+def make_fixture(seconds: float, seed: int, snr: float):
+    """Synthetic utterance in office noise: (clean, noisy) float arrays.
+
+    Speech stand-in: voiced syllables (harmonics of a gliding pitch shaped by
+    two formant peaks) with pauses, after a silent lead-in like a real button
+    press. Noise: pink noise, 50 Hz hum and a keyboard-like click train.
+    """
+    rng = np.random.default_rng(seed)
+    n = int(seconds * SAMPLE_RATE)
+    t = np.arange(n) / SAMPLE_RATE
+    clean = np.zeros(n)
+    pos = int(0.4 * SAMPLE_RATE)
+    while pos < n - SAMPLE_RATE // 5:
+        length = int(rng.uniform(0.12, 0.3) * SAMPLE_RATE)
+        seg = t[:length]
+        f0 = rng.uniform(100, 220) * (1 + 0.2 * seg / seg[-1])
+        phase = 2 * np.pi * np.cumsum(f0) / SAMPLE_RATE
+        formants = rng.uniform(400, 900), rng.uniform(1100, 2400)
+        voice = np.zeros(length)
+        for h in range(1, 30):
+            freq = h * f0.mean()
+            if freq > 7000:
+                break
+            amp = sum(1 / (1 + ((freq - fm) / 150) ** 2) for fm in formants) + 0.05
+            voice += amp * np.sin(h * phase)
+        voice *= np.hanning(length)
+        clean[pos:pos + length] += voice
+        pos += length + int(rng.uniform(0.03, 0.25) * SAMPLE_RATE)
+    clean *= 6000 / np.sqrt(np.mean(clean[clean != 0] ** 2))
+
+    white = rng.standard_normal(n + 1)
+    pink = np.fft.irfft(np.fft.rfft(white) / np.sqrt(np.arange(1, n // 2 + 2)), n=n + 1)[:n]
+    noise = pink / np.std(pink) + 0.3 * np.sin(2 * np.pi * 50 * t)
+    clicks = np.zeros(n)
+    clicks[rng.integers(0, n, int(seconds * 6))] = rng.uniform(2, 5, int(seconds * 6))
+    noise += np.convolve(clicks, np.exp(-np.arange(80) / 12.0), mode="same")
+    noise *= np.sqrt(np.mean(clean ** 2) / np.mean(noise ** 2)) / 10 ** (snr / 20)
+    return clean, clean + noise
+
+
+def bench(sessions: int, seconds: float, workers: int, method: str):
+    """Report per-core real-time factor and SNR improvement, then pool throughput."""
+    fixtures = [make_fixture(seconds, seed, snr)
+                for seed, snr in enumerate([0.0, 5.0, 10.0] * ((sessions + 2) // 3))][:sessions]
+
+    print(f"Speech enhancement ({method}), {len(fixtures)} fixtures of {seconds:.0f} s:")
+    print(f"  {'input SNR':>10} {'output SNR':>11} {'improvement':>12} {'RTF/core':>9}")
+    rtfs: List[float] = []
+    for clean, noisy in fixtures[:3]:
+        start = time.perf_counter()
+        out = enhance(noisy, method)
+        rtf = (time.perf_counter() - start) / seconds
+        rtfs.append(rtf)
+        before, after = snr_db(clean, noisy), snr_db(clean, out)
+        print(f"  {before:9.1f}dB {after:10.1f}dB {after - before:+11.1f}dB {rtf:9.4f}")
+    print(f"  mean RTF {sum(rtfs) / len(rtfs):.4f} "
+          f"(one core handles ~{len(rtfs) / sum(rtfs):.0f} concurrent real-time streams)")
+
+    pcm = [np.clip(noisy, -32768, 32767).astype("<i2").tobytes() for _, noisy in fixtures]
+    pool = EnhancePool(workers, method)
+    pool.submit(pcm[0]).result()  # Warm up worker processes
+    start = time.perf_counter()
+    for f in [pool.submit(p) for p in pcm]:
+        f.result()
+    elapsed = time.perf_counter() - start
+    pool.close()
+    print(f"Pool: {len(pcm)} sessions on {pool.workers} workers in {elapsed:.2f} s "
+          f"({len(pcm) * seconds / elapsed:.0f}x real time overall)")
+
+
+def main():
+    """CLI: enhance a WAV file or run the benchmark."""
+    parser = argparse.ArgumentParser(description='Pager speech enhancement')
+    parser.add_argument('input', nargs='?', help='16 kHz mono 16-bit WAV')
+    parser.add_argument('output', nargs='?', help='Enhanced WAV')
+    parser.add_argument('--method', choices=['wiener', 'subtract'], default='wiener')
+    parser.add_argument('--bench', action='store_true', help='Benchmark on synthetic fixtures')
+    parser.add_argument('--sessions', type=int, default=12, help='Sessions for the pool benchmark')
+    parser.add_argument('--seconds', type=float, default=6.0)
+    parser.add_argument('--workers', type=int, default=None)
+    args = parser.parse_args()
+
+    if args.bench:
+        if not _available():
+            return
+        bench(args.sessions, args.seconds, args.workers or os.cpu_count() or 1, args.method)
+        return
+    if not args.input or not args.output:
+        parser.print_help()
+        return
+
+    with wave.open(args.input, "rb") as w:
+        if w.getnchannels() != 1 or w.getsampwidth() != 2 or w.getframerate() != SAMPLE_RATE:
+            print("Expected 16 kHz mono 16-bit WAV")
+            return
+        pcm = w.readframes(w.getnframes())
+    start = time.perf_counter()
+    out = enhance_pcm(pcm, args.method)
+    elapsed = time.perf_counter() - start
+    with wave.open(args.output, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(SAMPLE_RATE)
+        w.writeframes(out)
+    print(f"Enhanced {len(pcm) / 2 / SAMPLE_RATE:.1f} s of audio in {elapsed * 1000:.0f} ms")
+
+
+if __name__ == '__main__':
+    main()
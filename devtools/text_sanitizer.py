@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+Text Sanitizer - Bench driver for display_modes/text_sanitizer.h.
+
+Bridge text is reduced to the font's printable ASCII once, at publish time,
+by sanitize_text(): plain ASCII runs are copied a machine word at a time
+and common UTF-8 punctuation (smart quotes, dashes, arrows, the ► ○ plan
+markers) is transliterated instead of dropped. The native bench
+(devtools/text_sanitizer_bench.cpp) checks it against a strict
+byte-by-byte UTF-8 decoder on malformed and boundary sequences at every
+word alignment, in place and into a buffer, and on random byte mixes, then
+times it against the decoder and the old clean_text loop. --transcript
+feeds it the assistant text of real Claude Code sessions (JSONL transcripts)
+as well as the built-in sample.
+
+Usage:
+    g++ -O2 -I. -Idevtools/host -o /tmp/text-sanitizer-bench devtools/text_sanitizer_bench.cpp
+    python -m devtools.text_sanitizer --bench --bin /tmp/text-sanitizer-bench
+    python -m devtools.text_sanitizer --bench --transcript ~/.claude/projects/<project>/<session>.jsonl
+"""
+
+import argparse
+import json
+import re
+import subprocess
+import tempfile
+from typing import Dict, List, Optional
+
+LINE_RE = re.compile(r"^(check|speed|total) (.*)$")
+
+
+def fields(text: str) -> Dict[str, str]:
+    return dict(kv.split("=", 1) for kv in text.split())
+
+
+def transcript_text(paths: List[str]) -> str:
+    """Assistant text blocks from Claude Code JSONL transcripts, in order."""
+    parts = []
+    for path in paths:
+        with open(path, encoding="utf-8", errors="replace") as f:
+            for line in f:
+                try:
+                    entry = json.loads(line)
+                except json.JSONDecodeError:
+                    continue
+                if entry.get("type") != "assistant":
+                    continue
+                content = entry.get("message", {}).get("content", [])
+                if isinstance(content, str):
+                    parts.append(content)
+                    continue
+                for block in content:
+                    if isinstance(block, dict) and block.get("type") == "text":
+                        parts.append(block.get("text", ""))
+    return "\n".join(parts)
+
+
+def bench(binary: str, repeat: int, transcripts: Optional[List[str]] = None) -> bool:
+    cmd = [binary, "-n", str(repeat)]
+    tmp = None
+    if transcripts:
+        text = transcript_text(transcripts)
+        if not text:
+            print(f"No assistant text in {', '.join(transcripts)}")
+            return False
+        tmp = tempfile.NamedTemporaryFile("wb", suffix=".txt")
+        tmp.write(text.encode("utf-8"))
+        tmp.flush()
+        cmd += ["-f", tmp.name]
+    try:
+        out = subprocess.run(cmd, capture_output=True, text=True)
+    finally:
+        if tmp:
+            tmp.close()
+
+    checks: List[Dict[str, str]] = []
+    speeds: List[Dict[str, str]] = []
+    total = None
+    for line in out.stdout.splitlines():
+        m = LINE_RE.match(line.strip())
+        if not m:
+            continue
+        f = fields(m.group(2))
+        if m.group(1) == "check":
+            checks.append(f)
+        elif m.group(1) == "speed":
+            speeds.append(f)
+        else:
+            total = f
+    if total is None:
+        print(out.stdout + out.stderr)
+        return False
+
+    print("Word-at-a-time against the strict scalar decoder:")
+    for c in checks:
+        print(f"  {c['name']:<8} {int(c['cases']):>8,} cases   {'ok' if c['ok'] == '1' else 'DIFFER'}")
+    if out.stderr:
+        print(out.stderr.rstrip())
+
+    names = {"builtin": "built-in sample", "ascii": "same, ASCII only", "file": "transcripts"}
+    print(f"\n{'input':<18} {'KB':>6} {'UTF-8 B':>8} {'MB/s':>7} {'scalar':>7} {'old loop':>9}"
+          f" {'kept':>8} {'old kept':>9}")
+    for s in speeds:
+        print(f"{names.get(s['input'], s['input']):<18} {int(s['bytes']) / 1024:>6.0f} {int(s['utf8']):>8,}"
+              f" {float(s['swar_mb_s']):>7.0f} {float(s['scalar_mb_s']):>7.0f} {float(s['legacy_mb_s']):>9.0f}"
+              f" {int(s['kept']):>8,} {int(s['legacy_kept']):>9,}")
+    print("\nkept > old kept: characters the old loop dropped that now show transliterated")
+    ok = out.returncode == 0 and total.get("failures") == "0"
+    print("PASS" if ok else "FAIL")
+    return ok
+
+
+def main():
+    """CLI: check the SWAR sanitizer against the scalar decoder and time it."""
+    parser = argparse.ArgumentParser(description='Pager text sanitizer bench')
+    parser.add_argument('--bench', action='store_true', help='Run text_sanitizer_bench.cpp and print the tables')
+    parser.add_argument('--bin', default='/tmp/text-sanitizer-bench', help='Built text_sanitizer_bench.cpp')
+    parser.add_argument('--repeat', type=int, default=200, help='Timed passes over each input')
+    parser.add_argument('--transcript', nargs='+', help='Claude Code JSONL transcripts to time on')
+    args = parser.parse_args()
+    if not args.bench:
+        parser.print_help()
+        return
+    raise SystemExit(0 if bench(args.bin, args.repeat, args.transcript) else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,313 @@
+// Text Sanitizer Bench - host build of display_modes/text_sanitizer.h
+//
+// Checks sanitize_text() (word-at-a-time, in place or into a buffer)
+// against scalar_sanitize() below, a byte-by-byte decoder written from the
+// Unicode well-formedness table (3-7) that shares only the transliteration
+// table, and times both against the loop it replaced (clean_text: keep
+// '\n' and 0x20..0x7E, drop the rest, append to a std::string). Checks:
+//   edges      malformed and boundary UTF-8 - truncated sequences, overlong
+//              forms, surrogates, past U+10FFFF, stray continuations, F5..FF,
+//              4-byte characters - plus every TABLE entry, each against its
+//              expected bytes and at every offset 0..15 inside ASCII (so it
+//              lands on every word alignment), out of place and in place
+//   fuzz       random mixes of ASCII runs, valid and broken UTF-8 and random
+//              bytes: same output as the scalar decoder, in place too
+//   string     the std::string overload matches the buffer one
+// Throughput runs on a transcript: Claude-style text built in, or a file
+// (-f) such as assistant text pulled from a real session by
+// devtools/text_sanitizer.py --transcript.
+//
+// Build:
+//   g++ -O2 -I. -Idevtools/host -o /tmp/text-sanitizer-bench devtools/text_sanitizer_bench.cpp
+//
+// Usage:
+//   text-sanitizer-bench [-n repeat] [-f transcript.txt]
+//   -> check name=<check> cases=<n> ok=<0|1>
+//      speed input=<name> bytes=<n> utf8=<n> swar_mb_s=<r> scalar_mb_s=<r> legacy_mb_s=<r> kept=<n> legacy_kept=<n>
+//      total failures=<n>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "display_modes/text_sanitizer.h"
+
+static int failures = 0;
+
+static void check(const char* name, size_t cases, bool ok) {
+    if (!ok) failures++;
+    printf("check name=%s cases=%zu ok=%d\n", name, cases, ok ? 1 : 0);
+}
+
+// Reference: one byte at a time, strict UTF-8 (Unicode Table 3-7). An
+// ill-formed sequence drops its lead byte and resumes at the next byte.
+static std::string scalar_sanitize(const std::string& in) {
+    std::string out;
+    size_t i = 0;
+    while (i < in.size()) {
+        uint8_t c = (uint8_t) in[i];
+        if (c < 0x80) {
+            if (c == '\n' || (c >= 0x20 && c <= 0x7E)) out += (char) c;
+            else if (c == '\t') out += ' ';
+            i++;
+            continue;
+        }
+        size_t n = 0;
+        uint8_t lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) n = 2;
+        else if (c == 0xE0) n = 3, lo = 0xA0;
+        else if (c == 0xED) n = 3, hi = 0x9F;
+        else if (c >= 0xE1 && c <= 0xEF) n = 3;
+        else if (c == 0xF0) n = 4, lo = 0x90;
+        else if (c == 0xF4) n = 4, hi = 0x8F;
+        else if (c >= 0xF1 && c <= 0xF3) n = 4;
+        bool ok = n != 0 && i + n <= in.size();
+        for (size_t k = 1; ok && k < n; k++) {
+            uint8_t b = (uint8_t) in[i + k];
+            ok = k == 1 ? (b >= lo && b <= hi) : (b >= 0x80 && b <= 0xBF);
+        }
+        if (!ok) {
+            i++;
+            continue;
+        }
+        uint32_t cp = c & (0xFF >> (n + 1));
+        for (size_t k = 1; k < n; k++) cp = (cp << 6) | ((uint8_t) in[i + k] & 0x3F);
+        if (const char* rep = text_sanitizer::lookup(cp)) out += rep;
+        i += n;
+    }
+    return out;
+}
+
+// What DisplayMode::clean_text and the YAML filters did before
+static std::string legacy_clean(const std::string& msg) {
+    std::string result;
+    for (char c : msg) {
+        if (c == '\n' || (c >= 32 && c <= 126)) {
+            result += c;
+        }
+    }
+    return result;
+}
+
+static std::string swar(const std::string& in, bool in_place) {
+    if (in_place) {
+        std::string s = in;
+        s.resize(sanitize_text(&s[0], s.size(), &s[0]));
+        return s;
+    }
+    std::vector<char> buf(in.size() + 1);
+    return std::string(buf.data(), sanitize_text(in.data(), in.size(), buf.data()));
+}
+
+static std::string utf8(uint32_t cp) {
+    std::string s;
+    if (cp < 0x80) {
+        s += (char) cp;
+    } else if (cp < 0x800) {
+        s += (char) (0xC0 | cp >> 6);
+        s += (char) (0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        s += (char) (0xE0 | cp >> 12);
+        s += (char) (0x80 | (cp >> 6 & 0x3F));
+        s += (char) (0x80 | (cp & 0x3F));
+    } else {
+        s += (char) (0xF0 | cp >> 18);
+        s += (char) (0x80 | (cp >> 12 & 0x3F));
+        s += (char) (0x80 | (cp >> 6 & 0x3F));
+        s += (char) (0x80 | (cp & 0x3F));
+    }
+    return s;
+}
+
+struct Edge {
+    std::string in, want;
+};
+
+static std::vector<Edge> edges() {
+    std::vector<Edge> e = {
+        {"plain ascii", "plain ascii"},
+        {"tab\there", "tab here"},
+        {std::string("nul\0del\x7f" "cr\r\nbell\a", 17), "nuldelcr\nbell"},
+        {"\xC3", ""},                        // Truncated 2-byte
+        {"\xE2\x80", ""},                    // Truncated 3-byte
+        {"\xF0\x9F\x98", ""},                // Truncated 4-byte
+        {"\xE2\x80x", "x"},                  // Lead then ASCII
+        {"\xE2\x80\xE2\x80\x94", "--"},      // Truncated, then an em dash
+        {"\x80\xBF\x80", ""},                // Stray continuations
+        {"\xC0\x80\xC1\xBF", ""},            // Overlong 2-byte (C0, C1)
+        {"\xE0\x82\xA0", ""},                // Overlong U+00A0 (would be " ")
+        {"\xE0\x9F\xBF", ""},                // Overlong, top of the E0 hole
+        {"\xE0\xA0\x80", ""},                // Smallest valid 3-byte (unmapped)
+        {"\xF0\x80\x80\xA0", ""},            // Overlong 4-byte
+        {"\xED\xA0\x80\xED\xBF\xBF", ""},    // Surrogates
+        {"\xF4\x90\x80\x80", ""},            // Past U+10FFFF
+        {"\xF5\x80\x80\x80\xFF\xFE", ""},    // Never valid lead bytes
+        {"\xF0\x9F\x98\x80 ok", " ok"},      // Emoji: no glyph
+        {"\xF4\x8F\xBF\xBF", ""},            // U+10FFFF
+        {"\xC2\xA0", " "},                   // Smallest mapped 2-byte
+        {"\xE2\x96\xBA Task\n\xE2\x97\x8B Next", "> Task\no Next"},  // AGENT_PLAN markers
+        {"\xE2\x80\x9Cquote\xE2\x80\x9D \xE2\x80\x94 it\xE2\x80\x99s\xE2\x80\xA6", "\"quote\" -- it's..."},
+    };
+    for (const text_sanitizer::Translit& t : text_sanitizer::TABLE) e.push_back({utf8(t.codepoint), t.ascii});
+    return e;
+}
+
+static uint32_t g_rng = 12345;
+static uint32_t rnd() {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static std::string fuzz_case() {
+    static const uint32_t CODEPOINTS[] = {0xA0, 0xE9, 0x2014, 0x2019, 0x25BA, 0x25CB, 0x4E2D, 0x1F600, 0x10FFFF, 0x7FF,
+                                          0x800, 0xFFFF, 0x10000};
+    std::string s;
+    size_t parts = 1 + rnd() % 12;
+    for (size_t p = 0; p < parts; p++) {
+        switch (rnd() % 6) {
+            case 0: {
+                size_t n = rnd() % 20;
+                for (size_t i = 0; i < n; i++) s += (char) (0x20 + rnd() % 95);
+                break;
+            }
+            case 1:
+                s += utf8(CODEPOINTS[rnd() % (sizeof(CODEPOINTS) / sizeof(CODEPOINTS[0]))]);
+                break;
+            case 2: {
+                std::string u = utf8(text_sanitizer::TABLE[rnd() % (sizeof(text_sanitizer::TABLE) /
+                                                                   sizeof(text_sanitizer::TABLE[0]))].codepoint);
+                s += u.substr(0, 1 + rnd() % u.size());  // Sometimes cut short
+                break;
+            }
+            case 3:
+                s += (char) (0x80 + rnd() % 0x80);  // Any high byte
+                break;
+            case 4: {
+                s += (char) (0xC0 + rnd() % 0x40);  // Any lead, any continuations: overlong, surrogate, too big
+                size_t n = 1 + rnd() % 3;
+                for (size_t i = 0; i < n; i++) s += (char) (0x80 + rnd() % 0x40);
+                break;
+            }
+            default:
+                s += (char) (rnd() % 0x20);  // Control bytes
+                break;
+        }
+    }
+    return s;
+}
+
+// Claude-style transcript text: prose with smart punctuation, a plan with
+// the bridge's markers, code, a path and the odd emoji
+static std::string builtin_transcript() {
+    static const char* PARAS[] = {
+        "I\xE2\x80\x99ll start by reading the config \xE2\x80\x94 the wrap logic lives in "
+        "`display_modes/page_index.h`, and the YAML calls it from the QUESTION branch.\n",
+        "\xE2\x96\xBA Read the failing test\n\xE2\x97\x8B Fix the off-by-one in build()\n"
+        "\xE2\x97\x8B Re-run the bench\n",
+        "The function returns early when `len == 0`; otherwise it walks the buffer word by word "
+        "(4 bytes on the ESP32) and falls back to the scalar path on the first non-ASCII byte.\n",
+        "```cpp\nfor (size_t i = 0; i < n; i++) {\n\tif (s[i] == '\\n') lines++;\n}\n```\n",
+        "Done \xE2\x9C\x93 \xE2\x80\x94 all 14 checks pass. \xF0\x9F\x8E\x89 Want me to commit this?\n",
+        "\xE2\x80\x9CShould I also update the README?\xE2\x80\x9D \xE2\x86\x92 yes, the usage section "
+        "still mentions pager_display\xE2\x80\xA6\n",
+    };
+    std::string s;
+    for (size_t k = 0; s.size() < 64 * 1024; k++) s += PARAS[k % (sizeof(PARAS) / sizeof(PARAS[0]))];
+    return s;
+}
+
+template <typename F>
+static double mb_s(const std::string& text, int repeat, F f) {
+    volatile size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) sink = sink + f(text);
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return text.size() * (double) repeat / s / 1e6;
+}
+
+static void speed(const char* name, const std::string& text, int repeat) {
+    std::vector<char> buf(text.size() + 1);
+    size_t high = 0;
+    for (char c : text) high += (uint8_t) c >= 0x80;
+    double fast = mb_s(text, repeat, [&](const std::string& t) { return sanitize_text(t.data(), t.size(), buf.data()); });
+    double scalar = mb_s(text, repeat, [](const std::string& t) { return scalar_sanitize(t).size(); });
+    double legacy = mb_s(text, repeat, [](const std::string& t) { return legacy_clean(t).size(); });
+    bool ok = swar(text, false) == scalar_sanitize(text);
+    if (!ok) failures++;
+    printf("speed input=%s bytes=%zu utf8=%zu swar_mb_s=%.0f scalar_mb_s=%.0f legacy_mb_s=%.0f kept=%zu "
+           "legacy_kept=%zu ok=%d\n",
+           name, text.size(), high, fast, scalar, legacy, swar(text, false).size(), legacy_clean(text).size(),
+           ok ? 1 : 0);
+}
+
+int main(int argc, char** argv) {
+    int repeat = 200;
+    const char* file = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) file = argv[++i];
+    }
+    if (repeat < 1) repeat = 1;
+
+    // Each edge alone, then at every offset inside ASCII, both ways
+    std::vector<Edge> cases = edges();
+    size_t count = 0;
+    bool edges_ok = true;
+    for (const Edge& e : cases) {
+        for (size_t off = 0; off < 16; off++) {
+            std::string pad(off, 'a');
+            std::string in = pad + e.in + "tail0123456789";
+            std::string want = pad + e.want + "tail0123456789";
+            for (bool in_place : {false, true}) {
+                bool ok = swar(in, in_place) == want && scalar_sanitize(in) == want;
+                if (!ok && off == 0) fprintf(stderr, "edge %zu in_place=%d differs\n", &e - &cases[0], in_place);
+                edges_ok &= ok;
+                count++;
+            }
+        }
+        bool ok = swar(e.in, false) == e.want && scalar_sanitize(e.in) == e.want;
+        edges_ok &= ok;
+        count++;
+    }
+    check("edges", count, edges_ok);
+
+    bool fuzz_ok = true;
+    const size_t FUZZ = 200000;
+    for (size_t k = 0; k < FUZZ; k++) {
+        std::string in = fuzz_case();
+        std::string want = scalar_sanitize(in);
+        fuzz_ok &= swar(in, false) == want && swar(in, true) == want;
+    }
+    check("fuzz", FUZZ, fuzz_ok);
+
+    bool string_ok = true;
+    for (const Edge& e : cases) string_ok &= sanitize_text(e.in) == e.want;
+    check("string", cases.size(), string_ok);
+
+    std::string transcript = builtin_transcript();
+    speed("builtin", transcript, repeat);
+    speed("ascii", legacy_clean(transcript), repeat);
+    if (file) {
+        FILE* f = fopen(file, "rb");
+        std::string text;
+        if (f) {
+            char chunk[4096];
+            size_t n;
+            while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) text.append(chunk, n);
+            fclose(f);
+        }
+        if (text.empty()) {
+            fprintf(stderr, "cannot read %s\n", file);
+            failures++;
+        } else {
+            speed("file", text, repeat);
+        }
+    }
+    printf("total failures=%d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+// Text Store Bench - host stress test of display_modes/text_store.h
+//
+// One writer thread publishes messages into text_store().message as fast
+// as it can (publish_sanitized, like set_display); one reader thread takes
+// views the way the display lambda does and checks each one. Message k is
+// "k=<8 hex>;" followed by one repeated letter picked by k, 1000..4499
+// bytes long, so the longer ones cross MESSAGE_CAP. Checks:
+//   torn        a view whose length, letters or terminator don't belong to
+//               the message its header names (must be 0)
+//   order       a view older than one the reader already saw (must be 0)
+//   truncated   truncated() equals the number of over-cap publishes
+//   latest      writer-side latest() (the Home Assistant mirror) that isn't
+//               the message just published (must be 0)
+//   allocs      heap allocations on the writer thread while publishing
+//               (must be 0: the store never allocates)
+// Also runs clean under -fsanitize=thread.
+//
+// Build:
+//   g++ -O2 -pthread -I. -Idevtools/host -o /tmp/text-store-bench devtools/text_store_bench.cpp
+//
+// Usage:
+//   text-store-bench [-n milliseconds]
+//   -> stress ms=<t> published=<n> per_s=<n> views=<n> fresh=<n> torn=<n> order=<n> truncated=<n>
+//          over_cap=<n> latest=<n> allocs=<n> ok=<0|1>
+//      total failures=<n>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include "display_modes/text_store.h"
+
+static thread_local bool t_counting = false;
+static std::atomic<uint32_t> g_allocs{0};
+
+void* operator new(size_t size) {
+    if (t_counting) g_allocs.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static const size_t CAP = TextStore::MESSAGE_CAP;
+static const size_t HEADER = 11;  // "k=%08x;"
+
+static size_t length_of(uint32_t k) { return 1000 + (size_t) (k * 7919u % 3500); }
+static char letter_of(uint32_t k) { return (char) ('a' + k % 26); }
+
+int main(int argc, char** argv) {
+    int ms = 2000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) ms = atoi(argv[++i]);
+    }
+
+    TextBuffer<CAP>& message = text_store().message;
+    std::atomic<bool> stop{false};
+    uint32_t published = 0, over_cap = 0, latest = 0;
+    uint64_t views = 0, fresh = 0, torn = 0, order = 0;
+
+    std::thread reader([&]() {
+        uint32_t last_seq = 0, last_k = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            TextView v = message.view();
+            views++;
+            if (v.seq == 0 || v.seq == last_seq) continue;
+            fresh++;
+            if (v.seq < last_seq) {
+                order++;
+                continue;
+            }
+            uint32_t k = 0;
+            bool ok = v.len >= HEADER && sscanf(v.ptr, "k=%8x;", &k) == 1;
+            size_t want = ok ? length_of(k) : 0;
+            ok = ok && v.len == (want > CAP ? CAP : want) && v.ptr[v.len] == '\0';
+            for (size_t i = HEADER; ok && i < v.len; i++) ok = v.ptr[i] == letter_of(k);
+            if (ok && last_seq != 0 && k <= last_k) order++;
+            if (!ok) torn++;
+            last_seq = v.seq;
+            last_k = k;
+        }
+    });
+
+    static char scratch[4500];
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::milliseconds(ms);
+    t_counting = true;
+    for (uint32_t k = 1; std::chrono::steady_clock::now() < end; k++) {
+        size_t len = length_of(k);
+        snprintf(scratch, sizeof(scratch), "k=%08x;", (unsigned) k);
+        memset(scratch + HEADER, letter_of(k), len - HEADER);
+        message.publish_sanitized(scratch, len);
+        published++;
+        if (len > CAP) over_cap++;
+        TextView mine = message.latest();
+        if (mine.seq != published || mine.len != (len > CAP ? CAP : len) || memcmp(mine.ptr, scratch, HEADER)) {
+            latest++;
+        }
+    }
+    t_counting = false;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stop = true;
+    reader.join();
+
+    uint32_t allocs = g_allocs.load();
+    bool ok = fresh > 0 && torn == 0 && order == 0 && message.truncated() == over_cap && latest == 0 &&
+              allocs == 0;
+    printf("stress ms=%d published=%u per_s=%.0f views=%llu fresh=%llu torn=%llu order=%llu truncated=%u "
+           "over_cap=%u latest=%u allocs=%u ok=%d\n",
+           ms, published, published / elapsed, (unsigned long long) views, (unsigned long long) fresh,
+           (unsigned long long) torn, (unsigned long long) order, message.truncated(), over_cap, latest, allocs,
+           ok ? 1 : 0);
+    int failures = ok ? 0 : 1;
+    printf("total failures=%d\n", failures);
+    return failures;
+}
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+TTS Stream Sender - Streams speech to the ePaper pager's AudioPlayer.
+
+Downlink counterpart of the mic stream: 16 kHz mono PCM is cut into 20 ms
+frames, optionally IMA ADPCM encoded (4:1), and sent one frame per UDP
+datagram in the packet layout documented in audio_player.h.
+
+Usage:
+    # Stream a 16 kHz mono WAV (e.g. output of the TTS engine)
+    python -m devtools.tts_stream reply.wav --host 192.168.1.50
+
+    # Raw PCM instead of ADPCM (4x the bandwidth, no codec loss)
+    python -m devtools.tts_stream reply.wav --host 192.168.1.50 --pcm
+
+    # From the bridge:
+    from devtools.tts_stream import TtsStreamer
+    TtsStreamer("192.168.1.50").send_pcm(pcm_bytes)
+"""
+
+import argparse
+import socket
+import struct
+import time
+import wave
+from typing import Iterator, Tuple
+
+SAMPLE_RATE = 16000
+FRAME_SAMPLES = 320          # 20 ms
+FRAME_SECONDS = FRAME_SAMPLES / SAMPLE_RATE
+DEFAULT_PORT = 12347
+
+CODEC_PCM16 = 0
+CODEC_IMA_ADPCM = 1
+FLAG_START = 0x01
+FLAG_END = 0x02
+
+HEADER = struct.Struct("<HBBhBx")
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767]
+INDEX = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+
+class AdpcmEncoder:
+    """IMA ADPCM encoder; state carries across frames like the decoder's."""
+
+    def __init__(self):
+        self.predictor = 0
+        self.step_index = 0
+
+    def encode(self, samples) -> Tuple[int, int, bytes]:
+        """Encode one frame. Returns (predictor, step_index) at frame start and the data."""
+        start = (self.predictor, self.step_index)
+        out = bytearray((len(samples) + 1) // 2)
+        for i, s in enumerate(samples):
+            step = STEPS[self.step_index]
+            diff = s - self.predictor
+            nibble = 0
+            if diff < 0:
+                nibble = 8
+                diff = -diff
+            if diff >= step:
+                nibble |= 4
+                diff -= step
+            if diff >= step >> 1:
+                nibble |= 2
+                diff -= step >> 1
+            if diff >= step >> 2:
+                nibble |= 1
+
+            # Track the decoder exactly so both sides stay in lockstep
+            delta = step >> 3
+            if nibble & 4:
+                delta += step
+            if nibble & 2:
+                delta += step >> 1
+            if nibble & 1:
+                delta += step >> 2
+            self.predictor += -delta if nibble & 8 else delta
+            self.predictor = max(-32768, min(32767, self.predictor))
+            self.step_index = max(0, min(88, self.step_index + INDEX[nibble]))
+
+            out[i // 2] |= nibble << 4 if i & 1 else nibble
+        return start[0], start[1], bytes(out)
+
+
+def frames(pcm: bytes) -> Iterator[Tuple[int, bytes]]:
+    """Split 16-bit PCM into frames, zero-padding the last one."""
+    frame_bytes = FRAME_SAMPLES * 2
+    count = max(1, (len(pcm) + frame_bytes - 1) // frame_bytes)
+    for i in range(count):
+        chunk = pcm[i * frame_bytes:(i + 1) * frame_bytes]
+        yield i, chunk.ljust(frame_bytes, b"\x00")
+
+
+class TtsStreamer:
+    """Paces frames out at real time to the pager's AudioPlayer port."""
+
+    def __init__(self, host: str, port: int = DEFAULT_PORT, adpcm: bool = True):
+        self.addr = (host, port)
+        self.adpcm = adpcm
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.seq = 0
+
+    def packets(self, pcm: bytes) -> Iterator[bytes]:
+        encoder = AdpcmEncoder()
+        all_frames = list(frames(pcm))
+        for i, chunk in all_frames:
+            flags = (FLAG_START if i == 0 else 0) | (FLAG_END if i == len(all_frames) - 1 else 0)
+            seq = (self.seq + i) & 0xFFFF
+            if self.adpcm:
+                samples = struct.unpack(f"<{FRAME_SAMPLES}h", chunk)
+                predictor, step_index, data = encoder.encode(samples)
+                yield HEADER.pack(seq, CODEC_IMA_ADPCM, flags, predictor, step_index) + data
+            else:
+                yield HEADER.pack(seq, CODEC_PCM16, flags, 0, 0) + chunk
+        self.seq = (self.seq + len(all_frames)) & 0xFFFF
+
+    def send_pcm(self, pcm: bytes) -> int:
+        """Send 16 kHz mono PCM16 at real-time pace. Returns frames sent."""
+        start = time.monotonic()
+        sent = 0
+        for sent, packet in enumerate(self.packets(pcm), 1):
+            self.sock.sendto(packet, self.addr)
+            # Pace on the absolute schedule so sleep error doesn't accumulate
+            delay = start + sent * FRAME_SECONDS - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+        return sent
+
+
+def read_wav(path: str) -> bytes:
+    with wave.open(path, "rb") as w:
+        if w.getnchannels() != 1 or w.getsampwidth() != 2 or w.getframerate() != SAMPLE_RATE:
+            raise ValueError(f"{path}: need 16 kHz mono 16-bit WAV")
+        return w.readframes(w.getnframes())
+
+
+def main():
+    """CLI: stream a WAV file to the pager."""
+    parser = argparse.ArgumentParser(description='Stream TTS audio to the ePaper pager')
+    parser.add_argument('wav', help='16 kHz mono 16-bit WAV file')
+    parser.add_argument('--host', required=True, help='Pager IP address')
+    parser.add_argument('--port', type=int, default=DEFAULT_PORT, help='Pager AudioPlayer port')
+    parser.add_argument('--pcm', action='store_true', help='Send raw PCM instead of IMA ADPCM')
+    args = parser.parse_args()
+
+    pcm = read_wav(args.wav)
+    streamer = TtsStreamer(args.host, args.port, adpcm=not args.pcm)
+    count = streamer.send_pcm(pcm)
+    print(f"Sent {count} frames ({count * FRAME_SECONDS:.2f}s) to {args.host}:{args.port}")
+
+
+if __name__ == '__main__':
+    main()
@@ -4,17 +4,22 @@
 
 // AGENT MODE - Matrix-style code rain with bouncing ball
 // Shown when Claude Code is actively using tools
+// Tiers: FULL six rows of code rain under a filled overlay, ball with
+// shadow and glow; REDUCED every other row, none behind the overlay (so
+// it needn't be filled), bare ball; STATIC no rain, the ball at rest
 
 class AgentMode : public DisplayMode {
 public:
-    void render(esphome::display::DisplayBuffer& it, uint32_t millis, const std::string& message) override {
+    void render(esphome::display::DisplayBuffer& it, uint32_t millis, const std::string& message,
+                RenderTier tier = RenderTier::FULL) override {
         it.fill(esphome::Color::BLACK);
         int code_frame = (millis / 80) % 40;  // Fast animation
 
         // Matrix-style falling code effect
-        for (int col = 0; col < 12; col++) {
+        int row_step = tier == RenderTier::FULL ? 1 : 2;
+        for (int col = 0; col < 12 && tier != RenderTier::STATIC; col++) {
             int offset = (col * 7 + code_frame * 3) % 40;
-            for (int row = 0; row < 6; row++) {
+            for (int row = 0; row < 6; row += row_step) {
                 int y = (row * 22 + offset) % 135;
                 int brightness = 255 - (row * 40);
                 if (brightness < 50) brightness = 50;
@@ -22,14 +27,22 @@ public:
 
                 // Random "characters" (just rectangles of varying sizes)
                 int char_w = 3 + ((col + row + code_frame) % 4);
-                it.filled_rectangle(20 + col * 18, y, char_w, 8, code_color);
+                int x = 20 + col * 18;
+                if (tier != RenderTier::FULL && x + char_w > 40 && x < 200 && y + 8 > 45 && y < 95) continue;
+                it.filled_rectangle(x, y, char_w, 8, code_color);
             }
         }
 
         // Agent status overlay
-        it.filled_rectangle(40, 45, 160, 50, esphome::Color(0, 0, 0));
+        if (tier == RenderTier::FULL) it.filled_rectangle(40, 45, 160, 50, esphome::Color(0, 0, 0));
         it.rectangle(40, 45, 160, 50, Colors::CYAN);
 
+        if (tier == RenderTier::STATIC) {
+            it.filled_circle(115, 102, 6, Colors::CYAN);
+            it.filled_circle(115 - 1, 102 - 1, 2, esphome::Color(255, 255, 255));
+            return;
+        }
+
         // Bouncing ball animation (Pixar style!)
         float ball_time = (millis % 1200) / 1200.0;  // 1.2s cycle
         float bounce_height;
@@ -55,6 +68,11 @@ public:
             ball_radius = 4;
         }
 
+        if (tier == RenderTier::REDUCED) {
+            it.filled_circle(115, ball_y, ball_radius + ball_w_scale, Colors::CYAN);
+            return;
+        }
+
         // Shadow
         int shadow_w = 10 + (108 - ball_y) / 3;
         it.filled_rectangle(115 - shadow_w / 2, 110, shadow_w, 2, esphome::Color(0, 0, 0, 100));
@@ -69,4 +87,13 @@ public:
         // Text rendering would require font references
         // In a full implementation, pass fonts to render() or make them members
     }
+
+    RenderCost cost() const override {
+        return {{FULL_PIXELS, REDUCED_PIXELS, STATIC_PIXELS}};
+    }
+
+    // Worst frames, counted by devtools/render_quality_bench.cpp
+    static const uint32_t FULL_PIXELS = 44000;
+    static const uint32_t REDUCED_PIXELS = 34000;
+    static const uint32_t STATIC_PIXELS = 33000;
 };
@@ -1,8 +1,11 @@
 #pragma once
 #include "esphome.h"
+#include "text_sanitizer.h"
+#include "render_quality.h"
 
 // Base class for all display modes
-// Each mode implements render() to draw its unique animation/UI
+// Each mode implements render() to draw its unique animation/UI, at the
+// quality tier the manager picks (render_quality.h)
 
 class DisplayMode {
 public:
@@ -12,7 +15,17 @@ public:
     // @param it: ESPHome display buffer to draw on
     // @param millis: Current uptime in milliseconds (for animations)
     // @param message: Display text from text sensor
-    virtual void render(esphome::display::DisplayBuffer& it, uint32_t millis, const std::string& message) = 0;
+    // @param tier: FULL, REDUCED (cheaper primitives) or STATIC (a still frame, same for any millis)
+    virtual void render(esphome::display::DisplayBuffer& it, uint32_t millis, const std::string& message,
+                        RenderTier tier = RenderTier::FULL) = 0;
+
+    // Pixel writes of the worst frame at each tier, fill included. Default:
+    // a mode with no tiers draws about a screen fill whatever the tier
+    virtual RenderCost cost() const {
+        return {{SCREEN_PIXELS, SCREEN_PIXELS, SCREEN_PIXELS}};
+    }
+
+    static const uint32_t SCREEN_PIXELS = 240 * 135;
 
 protected:
     // Shared color palette
@@ -29,15 +42,9 @@ protected:
         static esphome::Color DIM;
     };
 
-    // Helper: Clean message text (remove control chars)
+    // Helper: Clean message text (drop control chars, UTF-8 punctuation -> ASCII)
     std::string clean_text(const std::string& msg) {
-        std::string result;
-        for (char c : msg) {
-            if (c == '\n' || (c >= 32 && c <= 126)) {
-                result += c;
-            }
-        }
-        return result;
+        return sanitize_text(msg);
     }
 
     // Helper: Word-wrap text to max_chars per line
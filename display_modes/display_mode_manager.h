@@ -3,11 +3,19 @@
 #include "listening_mode.h"
 #include "processing_mode.h"
 #include "agent_mode.h"
+#include "mode_transition.h"
+#include "render_quality.h"
+#include "screen_capture.h"
 // TODO: Include other modes (CONFIRM, AWAITING, DOCKED, QUESTION, RESPONSE, ALERT, IDLE)
 
 // DisplayModeManager - Routes rendering to the appropriate mode class
 // Usage in YAML display lambda:
-//   DisplayModeManager::render(it, id(display_mode).state, id(pager_display).state);
+//   DisplayModeManager::render(it, id(display_mode).state, text_store().message.view().str());
+// Mode changes animate through ModeTransition (mode_transition.h); drive
+// the extra frames from an interval:
+//   if (mode_transition().frame_due(millis())) id(main_display).update();
+// Animated modes draw at the tier RenderQuality (render_quality.h) picks
+// from battery, charging and the measured render time.
 
 class DisplayModeManager {
 private:
@@ -21,32 +29,59 @@ public:
     // Main render dispatcher
     // @param it: ESPHome display buffer
     // @param mode: Current mode string (from display_mode text sensor)
-    // @param message: Display text (from pager_display text sensor)
+    // @param message: Display text (from text_store().message)
     static void render(esphome::display::DisplayBuffer& it,
                       const std::string& mode,
                       const std::string& message) {
 
         uint32_t millis = esphome::millis();
+        // Caches the outgoing frame on a mode change, composes the transition on return
+        TransitionScope transition(FrameBufferPeek::writable_buffer(&it), FrameBufferPeek::width(&it),
+                                   FrameBufferPeek::height(&it), FrameBufferPeek::rotation(&it), mode.c_str(),
+                                   ::millis, ::micros);
 
-        // TODO: YOU IMPLEMENT THIS ROUTING LOGIC
-        //
-        // Route to the correct mode based on the mode string.
-        // Consider:
-        // - How to handle unknown modes (default/fallback?)
-        // - Whether to use if/else chain or switch/map
-        // - How to handle the hybrid approach (some modes in C++, some in YAML)
-        //
-        // Example pattern:
-        // if (mode == "LISTENING") {
-        //     listening_mode.render(it, millis, message);
-        // } else if (mode == "PROCESSING") {
-        //     processing_mode.render(it, millis, message);
-        // } ...
-        //
-        // Or you could keep some modes in YAML and only migrate the animation-heavy ones
-
-        // For now, default to black screen
-        it.fill(esphome::Color::BLACK);
+        // TODO: Route the remaining modes (CONFIRM, QUESTION, RESPONSE, ...);
+        // until then they stay in the YAML lambda (hybrid) and draw black here
+        if (!render_mode(it, mode, message, millis, !mode_transition().active())) {
+            render_quality().invalidate();
+            it.fill(esphome::Color::BLACK);
+        }
+    }
+
+    // Draws an animated mode at the tier RenderQuality picks; false if the
+    // mode has no class yet. reuse: the buffer still holds the last frame
+    // drawn here (nothing else drew since), so an unchanged STATIC frame is
+    // left as it is
+    static bool render_mode(esphome::display::DisplayBuffer& it, const std::string& mode,
+                            const std::string& message, uint32_t millis, bool reuse = false) {
+        DisplayMode* m = mode_for(mode);
+        if (!m) return false;
+        RenderQuality& quality = render_quality();
+        RenderCost cost = m->cost();
+        RenderTier tier = quality.choose(cost);
+        uint32_t key = frame_key(mode, message);
+        if (quality.reuse_static(tier, key, reuse)) return true;
+        uint32_t t0 = ::micros();
+        m->render(it, millis, message, tier);
+        quality.frame_done(tier, cost, ::micros() - t0, key);
+        return true;
+    }
+
+    static DisplayMode* mode_for(const std::string& mode) {
+        if (mode == "LISTENING") return &listening_mode;
+        if (mode == "PROCESSING") return &processing_mode;
+        if (mode == "AGENT") return &agent_mode;
+        return nullptr;
+    }
+
+private:
+    // FNV-1a over mode and message: same key, same static frame
+    static uint32_t frame_key(const std::string& mode, const std::string& message) {
+        uint32_t h = 2166136261u;
+        for (char c : mode) h = (h ^ (uint8_t) c) * 16777619u;
+        h = (h ^ 0xFF) * 16777619u;
+        for (char c : message) h = (h ^ (uint8_t) c) * 16777619u;
+        return h;
     }
 };
 
@@ -3,12 +3,15 @@
 
 // LISTENING MODE - Rainbow waveform animation
 // Shown when user holds Button A for voice recording
+// Tiers: FULL bouncy waveform and mic; REDUCED thin bars at a third of
+// the swing, mic still; STATIC the REDUCED waveform frozen at frame 0
 
 class ListeningMode : public DisplayMode {
 public:
-    void render(esphome::display::DisplayBuffer& it, uint32_t millis, const std::string& message) override {
+    void render(esphome::display::DisplayBuffer& it, uint32_t millis, const std::string& message,
+                RenderTier tier = RenderTier::FULL) override {
         it.fill(esphome::Color::BLACK);
-        int frame = (millis / 100) % 20;  // Animation frame
+        int frame = tier == RenderTier::STATIC ? 0 : (millis / 100) % 20;  // Animation frame
 
         // Rainbow colors for waveform bars
         esphome::Color rainbow[] = {
@@ -29,13 +32,26 @@ public:
         // Bouncy rainbow waveform
         for (int i = 0; i < 12; i++) {
             int phase = (frame + i * 3) % 20;
-            int h = 10 + abs(10 - phase) * 3;
-            it.filled_rectangle(25 + i * 17, 68 - h, 12, h * 2, rainbow[i]);
+            if (tier == RenderTier::FULL) {
+                int h = 10 + abs(10 - phase) * 3;
+                it.filled_rectangle(25 + i * 17, 68 - h, 12, h * 2, rainbow[i]);
+            } else {
+                int h = 6 + abs(10 - phase);
+                it.filled_rectangle(28 + i * 17, 68 - h, 6, h * 2, rainbow[i]);
+            }
         }
 
         // Cute bouncing mic icon (circle with lines)
-        int bounce = abs((frame % 10) - 5);
+        int bounce = tier == RenderTier::FULL ? abs((frame % 10) - 5) : 0;
         it.filled_circle(120, 115 + bounce, 8, esphome::Color::WHITE);
         it.filled_rectangle(117, 123 + bounce, 6, 8, esphome::Color::WHITE);
     }
+
+    RenderCost cost() const override {
+        return {{FULL_PIXELS, REDUCED_PIXELS, REDUCED_PIXELS}};
+    }
+
+    // Worst frames, counted by devtools/render_quality_bench.cpp
+    static const uint32_t FULL_PIXELS = 40500;
+    static const uint32_t REDUCED_PIXELS = 34500;
 };
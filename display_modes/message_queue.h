@@ -0,0 +1,345 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "text_sanitizer.h"
+
+// MessageQueue - Priority queue between set_display/alert and the screen
+//
+// set_display and alert used to overwrite the screen on every call, so an
+// agent burst (AGENT_READ -> AGENT_SEARCH -> AGENT_BASH within a second)
+// cost a redraw and a beep per tool, and a tool update could bury a
+// PERMISSION prompt. Now the services push() here, and poll() decides
+// what the screen should show next:
+//
+//   class    modes                       dwell   TTL    queued as
+//   PROMPT   PERMISSION QUESTION CONFIRM  90 s    90 s   FIFO
+//   ALERT    ALERT QR IMAGE               3 s     120 s  FIFO
+//   STATUS   any other mode (BOARD...)    1 s     -      latest state
+//   AGENT    AGENT_*                      1.5 s   -      latest state
+//
+// - A higher class replaces the screen at once; an equal or lower one
+//   waits until the shown message has been up for its dwell. A prompt's
+//   dwell is the permission hook's timeout: it stays until answered on
+//   the device or the bridge has given up on it.
+// - AGENT and STATUS messages describe "what the agent is doing now", so a
+//   new one replaces any that are still queued (a burst coalesces to its
+//   latest). Prompts and alerts are events and queue in order.
+// - A queued prompt or alert that waits longer than its TTL is dropped.
+//   The queued state message never expires: it is the newest state, so
+//   once a prompt is answered the screen shows where the agent is now
+//   rather than the state from before the prompt. An alert outlives a
+//   prompt's full dwell.
+// - "CLEAR" retracts prompts: the bridge sends it when a prompt was
+//   resolved elsewhere (answered at the terminal, hook timed out). Queued
+//   prompts are dropped and the one on screen loses its dwell, so the
+//   newest state shows at once (IDLE with CLEAR's text if there is none).
+//   Answering on the device changes the screen, which ends the dwell too.
+// - Beeps: SILENT / SILENT_* never beep; consecutive AGENT screens beep
+//   only on the first, so a burst costs one blip.
+// - Local screens (button responses, LISTENING...) are noticed through
+//   poll()'s shown_mode and held like STATUS, so an answered
+//   prompt's feedback screen is not cut short by a tool update. hold
+//   (while recording) keeps everything queued.
+//
+// Text is sanitized into one static pool on push. One entry and
+// STATE_RESERVE bytes of the pool are kept for the state message (states
+// coalesce, so there is never more than one), which therefore always gets
+// in: cut to fit at worst, never dropped. Prompts and alerts share the
+// rest; one that does not fit evicts the oldest alerts, takes back what a
+// queued state borrowed past its reserve, and is otherwise truncated. With
+// the rest full of prompts a new prompt or alert is dropped (the bridge
+// retries it). devtools/message_queue.py models the same policy and
+// replays hook bursts against it.
+//
+// Usage in YAML:
+//   set_display:  message_queue().push(my_mode.c_str(), my_text.data(), my_text.size(), MsgSound::BLIP, millis());
+//   20 ms tick:   QueuedMessage m;
+//                 if (message_queue().poll(millis(), id(display_mode).state.c_str(), id(is_recording), &m)) ...
+
+enum class MsgClass : uint8_t {
+    AGENT = 0,
+    STATUS = 1,
+    ALERT = 2,
+    PROMPT = 3,
+};
+
+enum class MsgSound : uint8_t {
+    NONE = 0,
+    BLIP = 1,
+    ALERT = 2,
+};
+
+// What to put on screen; text is valid until the next push() or poll()
+struct QueuedMessage {
+    const char* mode;
+    const char* text;
+    size_t len;
+    MsgClass cls;
+    MsgSound sound;     // Already NONE when the beep is suppressed
+    uint32_t waited_ms; // Time from push to screen
+};
+
+class MessageQueue {
+public:
+    static const uint8_t MAX_PENDING = 6;   // One of them kept for the state message
+    static const size_t POOL_BYTES = 6144;  // Room for a full 4 KB QUESTION and the rest
+    static const size_t STATE_RESERVE = 512;
+    static const uint8_t MODE_CHARS = 15;
+
+    struct Stats {
+        uint32_t pushed;
+        uint32_t shown;
+        uint32_t coalesced;   // Replaced in the queue before being shown
+        uint32_t expired;     // TTL ran out in the queue
+        uint32_t retracted;   // Prompts dropped or cut short by CLEAR
+        uint32_t evicted;     // Pushed out of a full pool
+        uint32_t beeps;
+        uint32_t beeps_saved;
+        uint32_t max_prompt_wait_ms;
+    };
+
+    static MessageQueue& instance() {
+        static MessageQueue inst;
+        return inst;
+    }
+
+    static MsgClass classify(const char* mode) {
+        if (strncmp(mode, "AGENT_", 6) == 0) return MsgClass::AGENT;
+        if (strcmp(mode, "PERMISSION") == 0 || strcmp(mode, "QUESTION") == 0 || strcmp(mode, "CONFIRM") == 0) {
+            return MsgClass::PROMPT;
+        }
+        if (strcmp(mode, "ALERT") == 0 || strcmp(mode, "QR") == 0 || strcmp(mode, "IMAGE") == 0) {
+            return MsgClass::ALERT;
+        }
+        return MsgClass::STATUS;
+    }
+
+    static uint32_t dwell_ms(MsgClass c) {
+        static const uint32_t DWELL[4] = {1500, 1000, 3000, 90000};
+        return DWELL[(int) c];
+    }
+
+    // 0: kept until superseded
+    static uint32_t ttl_ms(MsgClass c) {
+        static const uint32_t TTL[4] = {0, 0, 120000, 90000};
+        return TTL[(int) c];
+    }
+
+    // Queue a message; "SILENT_<mode>" shows <mode> without a sound
+    void push(const char* mode, const char* text, size_t len, MsgSound sound, uint32_t now_ms) {
+        release_taken();
+        _stats.pushed++;
+        if (strncmp(mode, "SILENT_", 7) == 0) {
+            mode += 7;
+            sound = MsgSound::NONE;
+        } else if (strcmp(mode, "SILENT") == 0) {
+            sound = MsgSound::NONE;
+        }
+        if (strcmp(mode, "CLEAR") == 0) {
+            retract_prompts(now_ms);
+            for (int i = 0; i < _count; i++) {
+                if (_pending[i].cls <= MsgClass::STATUS) return;  // The newest state shows next
+            }
+            mode = "IDLE";
+            sound = MsgSound::NONE;
+        }
+        MsgClass cls = classify(mode);
+
+        if (cls <= MsgClass::STATUS) {
+            // State messages supersede any state still waiting; the slot and
+            // at least STATE_RESERVE bytes are then free
+            for (int i = _count - 1; i >= 0; i--) {
+                if (_pending[i].cls <= MsgClass::STATUS) {
+                    remove(i);
+                    _stats.coalesced++;
+                }
+            }
+        } else {
+            // Events get the rest: evict the oldest alerts to make room
+            const size_t event_pool = POOL_BYTES - STATE_RESERVE;
+            while (event_count() >= MAX_PENDING - 1 || event_bytes() + len > event_pool) {
+                int victim = -1;
+                for (int i = 0; i < _count && victim < 0; i++) {
+                    if (_pending[i].cls == MsgClass::ALERT) victim = i;
+                }
+                if (victim < 0) break;
+                remove(victim);
+                _stats.evicted++;
+            }
+            if (event_count() >= MAX_PENDING - 1 || event_bytes() >= event_pool) {
+                _stats.evicted++;
+                return;  // Full of prompts: the newest waits for the bridge to retry
+            }
+            if (event_bytes() + len > event_pool) len = event_pool - event_bytes();
+            // A queued state past its reserve gives the bytes back
+            for (int i = 0; i < _count && _pool_used + len > POOL_BYTES; i++) {
+                if (_pending[i].cls <= MsgClass::STATUS) shrink(i, POOL_BYTES - len - event_bytes());
+            }
+        }
+        if (_pool_used + len > POOL_BYTES) len = POOL_BYTES - _pool_used;
+
+        Entry& e = _pending[_count++];
+        strncpy(e.mode, mode, MODE_CHARS);
+        e.mode[MODE_CHARS] = '\0';
+        e.cls = cls;
+        e.sound = sound;
+        e.queued_ms = now_ms;
+        e.offset = (uint16_t) _pool_used;
+        e.len = (uint16_t) sanitize_text(text, len, _pool + _pool_used);
+        _pool_used += e.len;
+    }
+
+    // Next message to show, if one is due. shown_mode is what the screen
+    // shows now (display_mode state); hold defers everything.
+    bool poll(uint32_t now_ms, const char* shown_mode, bool hold, QueuedMessage* out) {
+        release_taken();
+        if (shown_mode && (!_has_current || strncmp(shown_mode, _current_mode, MODE_CHARS) != 0)) {
+            // Changed on the device: buttons, recording, QR, board
+            strncpy(_current_mode, shown_mode, MODE_CHARS);
+            _current_mode[MODE_CHARS] = '\0';
+            _current_cls = MsgClass::STATUS;
+            _shown_ms = now_ms;
+            _has_current = true;
+        }
+        for (int i = _count - 1; i >= 0; i--) {
+            uint32_t ttl = ttl_ms(_pending[i].cls);
+            if (ttl && now_ms - _pending[i].queued_ms > ttl) {
+                remove(i);
+                _stats.expired++;
+            }
+        }
+        if (hold || _count == 0) return false;
+
+        int best = 0;
+        for (int i = 1; i < _count; i++) {
+            if (_pending[i].cls > _pending[best].cls) best = i;  // Oldest within a class
+        }
+        const Entry& e = _pending[best];
+        if (_has_current && e.cls <= _current_cls && now_ms - _shown_ms < dwell_ms(_current_cls)) return false;
+
+        bool quiet_burst = e.cls == MsgClass::AGENT && _has_current && _current_cls == MsgClass::AGENT;
+        MsgSound sound = e.sound;
+        if (sound != MsgSound::NONE && quiet_burst) {
+            sound = MsgSound::NONE;
+            _stats.beeps_saved++;
+        }
+        if (sound != MsgSound::NONE) _stats.beeps++;
+
+        strncpy(_current_mode, e.mode, MODE_CHARS + 1);
+        _current_cls = e.cls;
+        _shown_ms = now_ms;
+        _has_current = true;
+        _stats.shown++;
+        uint32_t waited = now_ms - e.queued_ms;
+        if (e.cls == MsgClass::PROMPT && waited > _stats.max_prompt_wait_ms) _stats.max_prompt_wait_ms = waited;
+
+        out->mode = _current_mode;
+        out->text = _pool + e.offset;
+        out->len = e.len;
+        out->cls = e.cls;
+        out->sound = sound;
+        out->waited_ms = waited;
+        _taken = best;  // Text stays in the pool until the next call
+        return true;
+    }
+
+    // Prompts resolved off the device: drop the queued ones, and end the
+    // dwell of the one on screen so whatever is queued replaces it
+    void retract_prompts(uint32_t now_ms) {
+        release_taken();
+        for (int i = _count - 1; i >= 0; i--) {
+            if (_pending[i].cls == MsgClass::PROMPT) {
+                remove(i);
+                _stats.retracted++;
+            }
+        }
+        if (_has_current && _current_cls == MsgClass::PROMPT) {
+            _current_cls = MsgClass::AGENT;
+            _shown_ms = now_ms - dwell_ms(MsgClass::AGENT);
+            _stats.retracted++;
+        }
+    }
+
+    uint8_t pending() const { return _count - (_taken >= 0 ? 1 : 0); }
+    const Stats& stats() const { return _stats; }
+
+    // Static footprint (for memory budgeting)
+    static constexpr size_t storage_bytes() {
+        return sizeof(MessageQueue);
+    }
+
+private:
+    struct Entry {
+        char mode[MODE_CHARS + 1];
+        MsgClass cls;
+        MsgSound sound;
+        uint16_t offset;
+        uint16_t len;
+        uint32_t queued_ms;
+    };
+
+    MessageQueue() : _count(0), _taken(-1), _pool_used(0), _has_current(false), _current_cls(MsgClass::STATUS),
+                     _shown_ms(0), _stats() {
+        _current_mode[0] = '\0';
+    }
+
+    void release_taken() {
+        if (_taken >= 0) {
+            remove(_taken);
+            _taken = -1;
+        }
+    }
+
+    int event_count() const {
+        int n = 0;
+        for (int i = 0; i < _count; i++) n += _pending[i].cls >= MsgClass::ALERT;
+        return n;
+    }
+
+    size_t event_bytes() const {
+        size_t n = 0;
+        for (int i = 0; i < _count; i++) {
+            if (_pending[i].cls >= MsgClass::ALERT) n += _pending[i].len;
+        }
+        return n;
+    }
+
+    // Entries keep push order, and their text is packed in the same order
+    void remove(int i) {
+        uint16_t off = _pending[i].offset, len = _pending[i].len;
+        memmove(_pool + off, _pool + off + len, _pool_used - off - len);
+        _pool_used -= len;
+        for (int j = i; j < _count - 1; j++) {
+            _pending[j] = _pending[j + 1];
+            _pending[j].offset -= len;
+        }
+        _count--;
+    }
+
+    // Cut entry i's text to len bytes (sanitized text is ASCII: any cut is clean)
+    void shrink(int i, size_t len) {
+        uint16_t cut = (uint16_t) (_pending[i].len - len);
+        size_t end = _pending[i].offset + _pending[i].len;
+        memmove(_pool + end - cut, _pool + end, _pool_used - end);
+        _pool_used -= cut;
+        _pending[i].len = (uint16_t) len;
+        for (int j = i + 1; j < _count; j++) _pending[j].offset -= cut;
+    }
+
+    Entry _pending[MAX_PENDING];
+    int8_t _count;
+    int8_t _taken;
+    size_t _pool_used;
+    char _pool[POOL_BYTES];
+    bool _has_current;
+    MsgClass _current_cls;
+    char _current_mode[MODE_CHARS + 1];
+    uint32_t _shown_ms;
+    Stats _stats;
+};
+
+// Global accessor
+inline MessageQueue& message_queue() {
+    return MessageQueue::instance();
+}
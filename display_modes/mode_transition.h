@@ -0,0 +1,327 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include "message_queue.h"
+#include "simd.h"
+
+// ModeTransition - Slide / wipe / crossfade between display modes
+//
+// Mode changes used to snap on the next display tick. Drawing a transition
+// the obvious way means rendering both modes every frame; instead, on a
+// mode change the outgoing mode's last frame (still in the panel buffer,
+// since the lambda hasn't drawn yet) is copied aside once, the new mode
+// renders as usual, and the frame is then composed band by band from the
+// two with cheap ops only:
+//
+//   SLIDE      new mode pushes the old one out to the left (row memmoves)
+//   WIPE       new mode revealed left to right over the old one (copies)
+//   CROSSFADE  ordered-dither crossfade (Simd::dither_select_rgb565)
+//
+//   to / from                         kind
+//   BOARD (redraws changed rows only) NONE - snap as before
+//   AGENT_* -> AGENT_*                NONE - tool bursts change mode often
+//   PERMISSION QUESTION CONFIRM ALERT WIPE
+//   IDLE DOCKED (either side)         SLIDE
+//   anything else                     CROSSFADE
+//
+// Everything runs in panel buffer coordinates: "left" is the logical
+// (rotated) left, so on the pager (rotation 270) a slide moves whole
+// panel rows and a wipe copies whole rows.
+//
+// Budget: while a transition runs, the 20 ms interval redraws the display
+// every FRAME_MS (20 fps; the SPI write of a 240x135 RGB565 frame takes
+// ~26 ms of that). Render + compose must fit in budget_us. The cost is
+// predicted from the recent render time and the measured cost per band;
+// a transition that wouldn't fit is skipped (snap), and one that stops
+// fitting mid-way is dropped for the new mode (never a half-composed
+// frame). Progress follows the clock, so a slow frame shortens a
+// transition instead of stretching it.
+//
+// The outgoing frame (width x height x 2 bytes, 64.8 KB on the pager) is
+// allocated at the start of a transition and freed at the end; if the heap
+// can't give it, the mode snaps.
+//
+// Usage (display lambda, RGB565 panel buffer):
+//   TransitionScope transition_scope(FrameBufferPeek::writable_buffer(&it), FrameBufferPeek::width(&it),
+//                                    FrameBufferPeek::height(&it), FrameBufferPeek::rotation(&it),
+//                                    id(display_mode).state.c_str(), millis, micros);
+//   ... draw the mode ...   // Composed when the scope ends
+// and from a 20 ms interval:
+//   if (mode_transition().frame_due(millis())) id(main_display).update();
+
+enum class TransitionKind : uint8_t {
+    NONE = 0,
+    SLIDE = 1,
+    WIPE = 2,
+    CROSSFADE = 3,
+    COUNT = 4,
+};
+
+class ModeTransition {
+public:
+    typedef unsigned long (*Clock)();
+
+    static const uint32_t FRAME_MS = 50;
+    static const uint32_t DURATION_MS = 300;
+    static const uint32_t DEFAULT_BUDGET_US = 20000;
+    static const int BAND_ROWS = 16;
+    static const uint8_t MODE_CHARS = 15;
+
+    struct Stats {
+        uint32_t started;
+        uint32_t completed;
+        uint32_t dropped;         // Stopped fitting the budget mid-way
+        uint32_t skipped_budget;  // Wouldn't have fitted: snapped
+        uint32_t skipped_memory;  // No heap for the outgoing frame: snapped
+        uint32_t snapped;         // TransitionKind::NONE or disabled
+        uint32_t frames;          // Composed frames
+        uint32_t over_budget;     // Composed frames that overran anyway
+        uint32_t max_frame_us;    // Render + compose
+        uint64_t sum_frame_us;
+        uint32_t max_compose_us;
+    };
+
+    static ModeTransition& instance() {
+        static ModeTransition inst;
+        return inst;
+    }
+
+    static TransitionKind kind_for(const char* from, const char* to) {
+        if (strcmp(from, "BOARD") == 0 || strcmp(to, "BOARD") == 0) return TransitionKind::NONE;
+        MsgClass to_cls = MessageQueue::classify(to);
+        if (to_cls == MsgClass::AGENT && MessageQueue::classify(from) == MsgClass::AGENT) return TransitionKind::NONE;
+        if (to_cls == MsgClass::PROMPT || to_cls == MsgClass::ALERT) return TransitionKind::WIPE;
+        if (is_home(from) || is_home(to)) return TransitionKind::SLIDE;
+        return TransitionKind::CROSSFADE;
+    }
+
+    static const char* kind_name(TransitionKind kind) {
+        static const char* NAMES[] = {"none", "slide", "wipe", "crossfade"};
+        return NAMES[(int) kind];
+    }
+
+    static int band_count(int height) { return (height + BAND_ROWS - 1) / BAND_ROWS; }
+
+    // 0..256 of the way through, eased out (fast start, soft landing)
+    static uint16_t ease(uint32_t elapsed_ms) {
+        uint32_t p = elapsed_ms >= DURATION_MS ? 256 : elapsed_ms * 256 / DURATION_MS;
+        return (uint16_t) (256 - (256 - p) * (256 - p) / 256);
+    }
+
+    // Compose band `slot` of a frame: fb holds the new mode, old the
+    // outgoing one (both width x height RGB565, any byte order). Slots run
+    // 0..band_count()-1 in the order the bands must be done (a slide
+    // across rows moves rows in place, like memmove).
+    static void compose_band(uint16_t* fb, const uint16_t* old, int width, int height, int rotation,
+                             TransitionKind kind, uint16_t eased, int slot) {
+        bool across_rows = rotation == 90 || rotation == 270;  // Logical x runs along panel rows
+        bool reversed = rotation == 180 || rotation == 270;    // ... from the far end
+        int length = across_rows ? height : width;
+        int shift = length * eased >> 8;                        // Pixels of the new mode in view
+        bool backwards = kind == TransitionKind::SLIDE && across_rows && !reversed;
+        int bands = band_count(height);
+        int band = backwards ? bands - 1 - slot : slot;
+        int first = band * BAND_ROWS, last = first + BAND_ROWS < height ? first + BAND_ROWS : height;
+
+        for (int i = first; i < last; i++) {
+            int r = backwards ? first + last - 1 - i : i;
+            uint16_t* row = fb + (size_t) r * width;
+            const uint16_t* old_row = old + (size_t) r * width;
+            switch (kind) {
+                case TransitionKind::CROSSFADE:
+                    Simd::dither_select_rgb565(row, old_row, row, width, 0, r, (uint8_t) (eased >> 4));
+                    break;
+                case TransitionKind::WIPE:
+                    if (!across_rows) {
+                        if (reversed) memcpy(row, old_row, (size_t) (width - shift) * 2);
+                        else memcpy(row + shift, old_row + shift, (size_t) (width - shift) * 2);
+                    } else if (reversed ? r < length - shift : r >= shift) {
+                        memcpy(row, old_row, (size_t) width * 2);
+                    }
+                    break;
+                case TransitionKind::SLIDE:
+                    if (!across_rows) {
+                        if (reversed) {
+                            memmove(row, row + (width - shift), (size_t) shift * 2);
+                            memcpy(row + shift, old_row, (size_t) (width - shift) * 2);
+                        } else {
+                            memmove(row + (width - shift), row, (size_t) shift * 2);
+                            memcpy(row, old_row + shift, (size_t) (width - shift) * 2);
+                        }
+                    } else if (reversed) {
+                        if (r < shift) memcpy(row, fb + (size_t) (r + length - shift) * width, (size_t) width * 2);
+                        else memcpy(row, old + (size_t) (r - shift) * width, (size_t) width * 2);
+                    } else {
+                        if (r >= length - shift) memcpy(row, fb + (size_t) (r - (length - shift)) * width, (size_t) width * 2);
+                        else memcpy(row, old + (size_t) (r + shift) * width, (size_t) width * 2);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    void set_budget_us(uint32_t us) { _budget_us = us; }
+
+    void set_enabled(bool on) {
+        _enabled = on;
+        if (!on) finish();
+    }
+
+    // Top of the display lambda, before drawing. fb is the panel's RGB565
+    // buffer (width x height, unrotated; rotation in degrees)
+    void begin_frame(uint8_t* fb, int width, int height, int rotation, const char* mode, uint32_t now_ms,
+                     uint32_t now_us) {
+        _frame_start_us = now_us;
+        _frame_ms = now_ms;
+        if (strncmp(mode, _mode, MODE_CHARS) == 0) return;
+
+        char from[MODE_CHARS + 1];
+        memcpy(from, _mode, sizeof(from));
+        strncpy(_mode, mode, MODE_CHARS);
+        _mode[MODE_CHARS] = '\0';
+        if (from[0] == '\0') return;  // First frame since boot
+
+        TransitionKind kind = kind_for(from, _mode);
+        if (kind == TransitionKind::NONE || !_enabled || fb == nullptr) {
+            _stats.snapped++;
+            finish();
+            return;
+        }
+        if (_render_avg_us + (uint32_t) band_count(height) * _band_us[(int) kind] > _budget_us) {
+            _stats.skipped_budget++;
+            finish();
+            return;
+        }
+        size_t pixels = (size_t) width * height;
+        if (_old != nullptr && _old_pixels != pixels) finish();
+        if (_old == nullptr) {
+            _old = new (std::nothrow) uint16_t[pixels];
+            if (_old == nullptr) {
+                _stats.skipped_memory++;
+                finish();
+                return;
+            }
+            _old_pixels = pixels;
+        }
+        // The outgoing frame as it is on the glass (mid-transition: the composed one)
+        memcpy(_old, fb, pixels * 2);
+        _fb = (uint16_t*) fb;
+        _width = width;
+        _height = height;
+        _rotation = rotation;
+        _kind = kind;
+        _start_ms = now_ms;
+        _active = true;
+        _stats.started++;
+    }
+
+    // End of the display lambda: compose this frame of the transition
+    void end_frame(uint32_t now_us, Clock clock_us) {
+        uint32_t render_us = now_us - _frame_start_us;
+        _render_avg_us = _render_avg_us ? (_render_avg_us * 7 + render_us) / 8 : render_us;
+        if (!_active) return;
+
+        uint32_t elapsed = _frame_ms - _start_ms;
+        if (elapsed >= DURATION_MS) {
+            // This frame is the new mode alone
+            _stats.completed++;
+            finish();
+            return;
+        }
+        int bands = band_count(_height);
+        if (render_us + (uint32_t) bands * _band_us[(int) _kind] > _budget_us) {
+            _stats.dropped++;
+            finish();
+            return;
+        }
+
+        uint16_t eased = ease(elapsed);
+        uint32_t start = clock_us();
+        for (int slot = 0; slot < bands; slot++) {
+            compose_band(_fb, _old, _width, _height, _rotation, _kind, eased, slot);
+        }
+        uint32_t compose_us = clock_us() - start;
+        uint32_t per_band = compose_us / bands + 1;
+        _band_us[(int) _kind] = (_band_us[(int) _kind] * 3 + per_band) / 4;
+
+        uint32_t frame_us = render_us + compose_us;
+        _stats.frames++;
+        _stats.sum_frame_us += frame_us;
+        if (frame_us > _stats.max_frame_us) _stats.max_frame_us = frame_us;
+        if (compose_us > _stats.max_compose_us) _stats.max_compose_us = compose_us;
+        if (frame_us > _budget_us) _stats.over_budget++;
+        _last_frame_ms = _frame_ms;
+    }
+
+    bool active() const { return _active; }
+    TransitionKind kind() const { return _active ? _kind : TransitionKind::NONE; }
+
+    // Next transition frame is due (drive the display's update() from an interval)
+    bool frame_due(uint32_t now_ms) const { return _active && now_ms - _last_frame_ms >= FRAME_MS; }
+
+    uint32_t band_us(TransitionKind kind) const { return _band_us[(int) kind]; }
+    uint32_t render_avg_us() const { return _render_avg_us; }
+    const Stats& stats() const { return _stats; }
+
+private:
+    ModeTransition() : _enabled(true), _active(false), _kind(TransitionKind::NONE), _budget_us(DEFAULT_BUDGET_US),
+                       _render_avg_us(0), _frame_start_us(0), _frame_ms(0), _start_ms(0), _last_frame_ms(0),
+                       _fb(nullptr), _old(nullptr), _old_pixels(0), _width(0), _height(0), _rotation(0), _stats() {
+        _mode[0] = '\0';
+        // Until measured: a generous guess for the ESP32 (one band = 16 rows of 135 px)
+        for (int k = 0; k < (int) TransitionKind::COUNT; k++) _band_us[k] = 300;
+    }
+
+    static bool is_home(const char* mode) { return strcmp(mode, "IDLE") == 0 || strcmp(mode, "DOCKED") == 0; }
+
+    void finish() {
+        _active = false;
+        delete[] _old;
+        _old = nullptr;
+        _old_pixels = 0;
+    }
+
+    bool _enabled;
+    bool _active;
+    TransitionKind _kind;
+    uint32_t _budget_us;
+    uint32_t _render_avg_us;
+    uint32_t _band_us[(int) TransitionKind::COUNT];
+    uint32_t _frame_start_us;
+    uint32_t _frame_ms;
+    uint32_t _start_ms;
+    uint32_t _last_frame_ms;
+    char _mode[MODE_CHARS + 1];
+    uint16_t* _fb;
+    uint16_t* _old;
+    size_t _old_pixels;
+    int _width;
+    int _height;
+    int _rotation;
+    Stats _stats;
+};
+
+// Begins a frame on construction, composes it on destruction (covers every
+// return path of the display lambda)
+class TransitionScope {
+public:
+    TransitionScope(uint8_t* fb, int width, int height, int rotation, const char* mode,
+                    ModeTransition::Clock clock_ms, ModeTransition::Clock clock_us)
+        : _us(clock_us) {
+        ModeTransition::instance().begin_frame(fb, width, height, rotation, mode, (uint32_t) clock_ms(),
+                                               (uint32_t) clock_us());
+    }
+    ~TransitionScope() { ModeTransition::instance().end_frame((uint32_t) _us(), _us); }
+
+private:
+    ModeTransition::Clock _us;
+};
+
+// Global accessor
+inline ModeTransition& mode_transition() {
+    return ModeTransition::instance();
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// PageIndex - Line/page offsets for long messages, built once per message
+// The QUESTION screen used to re-wrap the whole message every frame. Instead we
+// word-wrap once (when the message or box geometry changes) and remember where
+// each line starts, so auto-scroll and B-button paging are plain array lookups.
+//
+// Fonts are monospace (Roboto Mono), so the box width is a character count.
+// Offsets point into the caller's text; keep it alive while rendering.
+//
+// Usage in YAML:
+//   on a new message:  page_index().invalidate();
+//   display lambda:    page_index().ensure(msg.data(), msg.size(), 24, 3);
+//                      char buf[PageIndex::MAX_LINE_CHARS + 1];
+//                      page_index().copy_line(msg.data(), msg.size(), i, buf, sizeof(buf));
+
+class PageIndex {
+public:
+    // Messages reach us cut to TextStore::MESSAGE_CAP (4 KB): 768 lines hold
+    // all of one down to ~5 chars/line. Lines past MAX_LINES are dropped
+    // (the index itself takes up to 64 KB of text, ~18 KB at 24 chars/line).
+    static const uint16_t MAX_LINES = 768;
+    static const uint8_t MAX_LINE_CHARS = 64;
+
+    static PageIndex& instance() {
+        static PageIndex inst;
+        return inst;
+    }
+
+    // Mark the index stale (call when the message text changes)
+    void invalidate() { _valid = false; }
+
+    // Rebuild only if the message or geometry changed since the last build
+    void ensure(const char* text, size_t len, uint8_t chars_per_line, uint8_t lines_per_page) {
+        if (_valid && chars_per_line == _chars_per_line && lines_per_page == _lines_per_page &&
+            len == _text_len) {
+            return;
+        }
+        build(text, len, chars_per_line, lines_per_page);
+    }
+    void ensure(const std::string& text, uint8_t chars_per_line, uint8_t lines_per_page) {
+        ensure(text.data(), text.size(), chars_per_line, lines_per_page);
+    }
+
+    // Word-wrap the text and record line spans
+    // Mirrors the old YAML wrap: paragraphs split on '\n', empty paragraphs
+    // skipped, words joined by one space, over-long words left unbroken.
+    void build(const std::string& text, uint8_t chars_per_line, uint8_t lines_per_page) {
+        build(text.data(), text.size(), chars_per_line, lines_per_page);
+    }
+    void build(const char* text, size_t len, uint8_t chars_per_line, uint8_t lines_per_page) {
+        if (chars_per_line == 0) chars_per_line = 1;
+        if (chars_per_line > MAX_LINE_CHARS) chars_per_line = MAX_LINE_CHARS;
+        if (lines_per_page == 0) lines_per_page = 1;
+
+        _chars_per_line = chars_per_line;
+        _lines_per_page = lines_per_page;
+        _text_len = len;
+        _line_count = 0;
+        _truncated = false;
+
+        const char* s = text;
+        size_t n = len;
+        if (n > 0xFFFF) {
+            n = 0xFFFF;  // Offsets are 16-bit; anything past 64 KB is dropped
+            _truncated = true;
+        }
+
+        size_t pos = 0;
+        bool line_open = false;
+        uint16_t line_start = 0, line_end = 0;
+        uint16_t line_chars = 0;
+
+        while (pos < n) {
+            char c = s[pos];
+            if (c == '\n') {
+                if (line_open) push_line(line_start, line_end);
+                line_open = false;
+                pos++;
+                continue;
+            }
+            if (c == ' ') {
+                pos++;
+                continue;
+            }
+
+            // Scan one word, counting only printable characters
+            size_t word_start = pos;
+            uint16_t word_chars = 0;
+            while (pos < n && s[pos] != ' ' && s[pos] != '\n') {
+                if (is_printable(s[pos])) word_chars++;
+                pos++;
+            }
+            if (word_chars == 0) continue;  // Only control bytes
+
+            if (!line_open) {
+                line_start = word_start;
+                line_chars = word_chars;
+                line_open = true;
+            } else if (line_chars + 1 + word_chars <= chars_per_line) {
+                line_chars += 1 + word_chars;
+            } else {
+                push_line(line_start, line_end);
+                line_start = word_start;
+                line_chars = word_chars;
+            }
+            line_end = pos;
+        }
+        if (line_open) push_line(line_start, line_end);
+
+        _valid = true;
+    }
+
+    uint16_t line_count() const { return _line_count; }
+    uint8_t lines_per_page() const { return _lines_per_page; }
+    bool truncated() const { return _truncated; }
+
+    uint16_t page_count() const {
+        return (_line_count + _lines_per_page - 1) / _lines_per_page;
+    }
+
+    // First line of a page (clamped to the last page)
+    uint16_t page_first_line(uint16_t page) const {
+        uint16_t pages = page_count();
+        if (pages == 0) return 0;
+        if (page >= pages) page = pages - 1;
+        return page * _lines_per_page;
+    }
+
+    // Page containing a given line
+    uint16_t page_of_line(uint16_t line) const {
+        return line / _lines_per_page;
+    }
+
+    // Copy a line into a caller buffer (null-terminated, no allocation)
+    // Control bytes are dropped and runs of spaces collapse to one, matching
+    // the widths used when wrapping. Returns number of chars written.
+    size_t copy_line(const std::string& text, uint16_t line, char* out, size_t out_size) const {
+        return copy_line(text.data(), text.size(), line, out, out_size);
+    }
+    size_t copy_line(const char* text, size_t len, uint16_t line, char* out, size_t out_size) const {
+        if (out_size == 0) return 0;
+        out[0] = '\0';
+        if (line >= _line_count || len != _text_len) return 0;
+
+        const char* s = text;
+        size_t end = _starts[line] + _lengths[line];
+        size_t w = 0;
+        bool prev_space = false;
+        for (size_t i = _starts[line]; i < end && w + 1 < out_size; i++) {
+            char c = s[i];
+            if (c == ' ') {
+                if (!prev_space) out[w++] = ' ';
+                prev_space = true;
+            } else if (is_printable(c)) {
+                out[w++] = c;
+                prev_space = false;
+            }
+        }
+        out[w] = '\0';
+        return w;
+    }
+
+    // Static footprint of the index (for memory budgeting)
+    static constexpr size_t storage_bytes() {
+        return sizeof(PageIndex);
+    }
+
+private:
+    PageIndex() : _valid(false), _truncated(false), _chars_per_line(0), _lines_per_page(1),
+                  _line_count(0), _text_len(0) {}
+
+    static bool is_printable(char c) {
+        return c >= 32 && c <= 126;
+    }
+
+    void push_line(uint16_t start, uint16_t end) {
+        if (_line_count >= MAX_LINES) {
+            _truncated = true;
+            return;
+        }
+        _starts[_line_count] = start;
+        _lengths[_line_count] = end - start;
+        _line_count++;
+    }
+
+    bool _valid;
+    bool _truncated;
+    uint8_t _chars_per_line;
+    uint8_t _lines_per_page;
+    uint16_t _line_count;
+    size_t _text_len;
+    uint16_t _starts[MAX_LINES];
+    uint16_t _lengths[MAX_LINES];
+};
+
+// Global accessor
+inline PageIndex& page_index() {
+    return PageIndex::instance();
+}
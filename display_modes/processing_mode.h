@@ -3,10 +3,13 @@
 
 // PROCESSING MODE - Bouncing balls with shadows/glow (Pixar style!)
 // Shown when Claude is thinking about a request
+// Tiers: FULL dots with shadow, glow and highlight; REDUCED bouncing dots
+// only; STATIC the dots at rest in a row
 
 class ProcessingMode : public DisplayMode {
 public:
-    void render(esphome::display::DisplayBuffer& it, uint32_t millis, const std::string& message) override {
+    void render(esphome::display::DisplayBuffer& it, uint32_t millis, const std::string& message,
+                RenderTier tier = RenderTier::FULL) override {
         it.fill(esphome::Color::BLACK);
         int frame = (millis / 100) % 20;
 
@@ -22,6 +25,11 @@ public:
             esphome::Color(255, 100, 200)   // Pink
         };
 
+        if (tier == RenderTier::STATIC) {
+            for (int i = 0; i < 8; i++) it.filled_circle(50 + i * 22, 62, 6, dot_colors[i]);
+            return;
+        }
+
         // Bouncing dots in a wave with shadows and glow
         for (int i = 0; i < 8; i++) {
             int bounce = abs(((frame * 2 + i * 5) % 30) - 15);
@@ -29,6 +37,11 @@ public:
             int y = 55 + bounce;
             int size = 6 + (bounce / 5);
 
+            if (tier == RenderTier::REDUCED) {
+                it.filled_circle(x, y, size, dot_colors[i]);
+                continue;
+            }
+
             // Shadow below (gets bigger when higher)
             int shadow_y = 70;
             int shadow_w = (size + 2) * 2;
@@ -49,4 +62,13 @@ public:
         // Text labels would need font references - omitted for now
         // In practice, you'll pass fonts to render() or store them as members
     }
+
+    RenderCost cost() const override {
+        return {{FULL_PIXELS, REDUCED_PIXELS, STATIC_PIXELS}};
+    }
+
+    // Worst frames, counted by devtools/render_quality_bench.cpp
+    static const uint32_t FULL_PIXELS = 38500;
+    static const uint32_t REDUCED_PIXELS = 35000;
+    static const uint32_t STATIC_PIXELS = 34000;
 };
@@ -0,0 +1,200 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// RenderQuality - Picks a detail tier for the animated display modes
+//
+// Each animated DisplayMode draws at three tiers and declares what a frame
+// costs at each, in pixel writes (the screen fill included; the pager's
+// time goes into draw_pixel_at, one call per pixel):
+//
+//   FULL     the animation as designed
+//   REDUCED  fewer and smaller primitives, no glow/shadow passes
+//   STATIC   a still frame that doesn't depend on the clock (UX_BACKLOG
+//            "static icons instead" on low battery)
+//
+// Every frame the manager asks for a tier, the worse of:
+//   battery  charging: FULL; under LOW_BATTERY_X10: REDUCED; under
+//            CRITICAL_BATTERY_X10: STATIC. Coming back up needs
+//            HYSTERESIS_X10 more, so a battery reading that wobbles
+//            across a threshold doesn't flip tiers
+//   budget   the best tier whose predicted time fits budget_us. The
+//            prediction is declared pixels x the measured ns per pixel,
+//            so a mode that declares more costs more before it has ever
+//            been drawn. The ns per pixel follows a slower frame at once
+//            and a faster one by a running average: going down is
+//            immediate; going back up waits UPGRADE_FRAMES frames with the
+//            better tier predicted under HEADROOM_PCT of the budget
+//
+// A STATIC frame that is already on screen (same mode and message, no
+// transition in between) doesn't need drawing again: reuse_static() says
+// when the whole render can be skipped.
+//
+// Usage (display lambda; DisplayModeManager::render_mode does this):
+//   RenderTier tier = render_quality().choose(mode.cost());
+//   if (render_quality().reuse_static(tier, key, nothing_else_drew)) return;
+//   uint32_t t0 = micros();
+//   mode.render(it, millis(), message, tier);
+//   render_quality().frame_done(tier, mode.cost(), micros() - t0, key);
+// and from the 1 s interval:
+//   render_quality().set_power(battery_pct * 10, charging);
+
+enum class RenderTier : uint8_t {
+    FULL = 0,
+    REDUCED = 1,
+    STATIC = 2,
+    COUNT = 3,
+};
+
+inline const char* render_tier_name(RenderTier t) {
+    static const char* NAMES[] = {"full", "reduced", "static"};
+    return t < RenderTier::COUNT ? NAMES[(int) t] : "?";
+}
+
+// Declared per-frame cost of each tier, pixel writes (worst frame)
+struct RenderCost {
+    uint32_t pixels[(int) RenderTier::COUNT];
+
+    uint32_t at(RenderTier t) const { return pixels[(int) t]; }
+};
+
+class RenderQuality {
+public:
+    static const uint32_t DEFAULT_BUDGET_US = 16000;  // Leaves ModeTransition's 20 ms room to compose
+    static const int32_t LOW_BATTERY_X10 = 200;
+    static const int32_t CRITICAL_BATTERY_X10 = 100;
+    static const int32_t HYSTERESIS_X10 = 50;
+    static const uint8_t UPGRADE_FRAMES = 8;
+    static const uint32_t HEADROOM_PCT = 80;
+
+    struct Stats {
+        uint32_t frames[(int) RenderTier::COUNT];  // Rendered, per tier
+        uint32_t reused;          // STATIC frames left on screen, not redrawn
+        uint32_t battery_limited; // Frames below the budget's tier because of the battery
+        uint32_t budget_limited;  // Frames below FULL because of the budget
+        uint32_t over_budget;     // Rendered frames that overran anyway
+        uint32_t changes;         // Tier changes
+        uint32_t max_render_us;
+    };
+
+    static RenderQuality& instance() {
+        static RenderQuality inst;
+        return inst;
+    }
+
+    // Public for devtools/render_quality_bench.cpp (a fresh governor per
+    // scenario); the pager uses instance()
+    RenderQuality() : _budget_us(DEFAULT_BUDGET_US), _battery_cap(RenderTier::FULL), _budget_tier(RenderTier::FULL),
+                      _tier(RenderTier::FULL), _calm(0), _ns_per_px_x16(0), _last_key(0), _last_static(false),
+                      _allowed(false), _stats() {}
+
+    void set_budget_us(uint32_t us) { _budget_us = us; }
+
+    // From the 1 s interval; battery in % x10 (MetricsTsdb fixed point)
+    void set_power(int32_t battery_x10, bool charging) {
+        RenderTier t = _battery_cap;
+        if (charging) {
+            t = RenderTier::FULL;
+        } else {
+            RenderTier down = battery_x10 < CRITICAL_BATTERY_X10 ? RenderTier::STATIC
+                              : battery_x10 < LOW_BATTERY_X10    ? RenderTier::REDUCED
+                                                                 : RenderTier::FULL;
+            RenderTier up = battery_x10 < CRITICAL_BATTERY_X10 + HYSTERESIS_X10 ? RenderTier::STATIC
+                            : battery_x10 < LOW_BATTERY_X10 + HYSTERESIS_X10    ? RenderTier::REDUCED
+                                                                                : RenderTier::FULL;
+            if (down > t) t = down;
+            else if (up < t) t = up;
+        }
+        _battery_cap = t;
+    }
+
+    // Tier for this frame, top of the render
+    RenderTier choose(const RenderCost& cost) {
+        RenderTier fit = RenderTier::FULL;
+        while (fit < RenderTier::STATIC && predict_us(cost, fit) > _budget_us) fit = worse(fit);
+
+        if (fit > _budget_tier) {
+            _budget_tier = fit;
+            _calm = 0;
+        } else if (fit < _budget_tier) {
+            RenderTier up = better(_budget_tier);
+            if ((uint64_t) predict_us(cost, up) * 100 <= (uint64_t) _budget_us * HEADROOM_PCT) {
+                if (++_calm >= UPGRADE_FRAMES) {
+                    _budget_tier = up;
+                    _calm = 0;
+                }
+            } else {
+                _calm = 0;
+            }
+        } else {
+            _calm = 0;
+        }
+
+        RenderTier t = _battery_cap > _budget_tier ? _battery_cap : _budget_tier;
+        if (_battery_cap > _budget_tier) _stats.battery_limited++;
+        else if (_budget_tier > RenderTier::FULL) _stats.budget_limited++;
+        if (t != _tier) _stats.changes++;
+        _tier = t;
+        return t;
+    }
+
+    // Before each render: true when tier is STATIC and the same static
+    // frame (key: mode and message) is still on screen. allowed is false
+    // when this frame will be drawn over (a transition composes it), which
+    // also keeps the next frame from reusing it
+    bool reuse_static(RenderTier tier, uint32_t key, bool allowed) {
+        _allowed = allowed;
+        if (!allowed || tier != RenderTier::STATIC || !_last_static || key != _last_key) return false;
+        _stats.reused++;
+        return true;
+    }
+
+    // Something else drew on the screen: the next static frame is redrawn
+    void invalidate() { _last_static = false; }
+
+    // After rendering at tier: calibrates ns per pixel from the render time
+    // (up at once, down by a running average)
+    void frame_done(RenderTier tier, const RenderCost& cost, uint32_t render_us, uint32_t key) {
+        _stats.frames[(int) tier]++;
+        if (render_us > _budget_us) _stats.over_budget++;
+        if (render_us > _stats.max_render_us) _stats.max_render_us = render_us;
+        _last_key = key;
+        _last_static = tier == RenderTier::STATIC && _allowed;
+        uint32_t px = cost.at(tier);
+        if (!px) return;
+        uint32_t sample = (uint32_t) ((uint64_t) render_us * 16000 / px);
+        _ns_per_px_x16 = sample > _ns_per_px_x16 ? sample : (_ns_per_px_x16 * 7 + sample) / 8;
+    }
+
+    // 0 until a frame has been measured (everything fits)
+    uint32_t predict_us(const RenderCost& cost, RenderTier tier) const {
+        return (uint32_t) ((uint64_t) cost.at(tier) * _ns_per_px_x16 / 16000);
+    }
+
+    RenderTier tier() const { return _tier; }
+    RenderTier battery_cap() const { return _battery_cap; }
+    RenderTier budget_tier() const { return _budget_tier; }
+    uint32_t budget_us() const { return _budget_us; }
+    uint32_t ns_per_pixel_x16() const { return _ns_per_px_x16; }
+    const Stats& stats() const { return _stats; }
+
+private:
+    static RenderTier worse(RenderTier t) { return (RenderTier) ((int) t + 1); }
+    static RenderTier better(RenderTier t) { return (RenderTier) ((int) t - 1); }
+
+    uint32_t _budget_us;
+    RenderTier _battery_cap;
+    RenderTier _budget_tier;
+    RenderTier _tier;
+    uint8_t _calm;
+    uint32_t _ns_per_px_x16;  // ns x16
+    uint32_t _last_key;
+    bool _last_static;
+    bool _allowed;  // Last reuse_static()
+    Stats _stats;
+};
+
+// Global accessor
+inline RenderQuality& render_quality() {
+    return RenderQuality::instance();
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "text_sanitizer.h"
+
+// Session Board - fixed-slot status rows for concurrent Claude sessions
+//
+// Each slot holds one session's id, tool, detail, status and progress.
+// The bridge sends small per-slot deltas instead of re-sending a whole
+// screen, and the display lambda redraws only rows whose content changed.
+//
+// Delta format (board_update service), one delta per line:
+//   <slot>|<key>=<value>|<key>=<value>...
+//   keys: i=session id  t=tool  d=detail  s=status char  p=progress 0-100
+//   <slot>|x  clears the slot
+// Omitted keys keep their value. A new session id resets the slot first.
+//   "2|i=a1b2|t=Edit|d=main.cpp|s=R|p=0"
+//   "2|p=40"
+//   "0|s=W\n3|x"
+//
+// Status chars: R running, W waiting for input, D done, E error, I idle.
+
+class SessionBoard {
+public:
+    static const uint8_t MAX_SLOTS = 8;
+    static const uint8_t ID_CHARS = 8;
+    static const uint8_t TOOL_CHARS = 12;
+    static const uint8_t DETAIL_CHARS = 24;
+
+    struct Slot {
+        bool used;
+        char status;
+        uint8_t progress;  // 0-100, 255 = none
+        char id[ID_CHARS + 1];
+        char tool[TOOL_CHARS + 1];
+        char detail[DETAIL_CHARS + 1];
+        uint32_t updated_ms;
+    };
+
+    static SessionBoard& instance() {
+        static SessionBoard inst;
+        return inst;
+    }
+
+    // Apply a delta message; returns number of slot deltas applied
+    int apply(const std::string& delta, uint32_t now_ms) {
+        int applied = 0;
+        size_t pos = 0;
+        while (pos < delta.size()) {
+            size_t end = delta.find('\n', pos);
+            if (end == std::string::npos) end = delta.size();
+            if (apply_line(delta.data() + pos, end - pos, now_ms)) applied++;
+            pos = end + 1;
+        }
+        return applied;
+    }
+
+    // Force every row (and the header) to redraw, e.g. on entering BOARD mode
+    void invalidate() {
+        _dirty = 0xFF;
+        _header_dirty = true;
+    }
+
+    // Returns and clears the set of rows to redraw (bit n = slot n)
+    uint8_t take_dirty() {
+        uint8_t d = _dirty;
+        _dirty = 0;
+        return d;
+    }
+
+    bool take_header_dirty() {
+        bool d = _header_dirty;
+        _header_dirty = false;
+        return d;
+    }
+
+    const Slot& slot(uint8_t i) const { return _slots[i]; }
+
+    uint8_t active_count() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < MAX_SLOTS; i++) n += _slots[i].used;
+        return n;
+    }
+
+    // Count of slots waiting on the user (for the header/beep)
+    uint8_t waiting_count() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < MAX_SLOTS; i++) n += _slots[i].used && _slots[i].status == 'W';
+        return n;
+    }
+
+    // Rows redrawn since boot (redraw-work counter for get_state)
+    uint32_t rows_drawn() const { return _rows_drawn; }
+    void count_rows_drawn(uint8_t mask) {
+        for (uint8_t i = 0; i < MAX_SLOTS; i++) _rows_drawn += (mask >> i) & 1;
+    }
+
+private:
+    SessionBoard() : _dirty(0), _header_dirty(true), _rows_drawn(0) {
+        for (uint8_t i = 0; i < MAX_SLOTS; i++) clear_slot(_slots[i]);
+    }
+
+    static void clear_slot(Slot& s) {
+        memset(&s, 0, sizeof(s));
+        s.status = 'I';
+        s.progress = 255;
+    }
+
+    static bool same_content(const Slot& a, const Slot& b) {
+        return a.used == b.used && a.status == b.status && a.progress == b.progress &&
+               strcmp(a.id, b.id) == 0 && strcmp(a.tool, b.tool) == 0 &&
+               strcmp(a.detail, b.detail) == 0;
+    }
+
+    bool apply_line(const char* line, size_t len, uint32_t now_ms) {
+        if (len == 0 || line[0] < '0' || line[0] >= '0' + MAX_SLOTS) return false;
+        uint8_t index = line[0] - '0';
+        Slot& s = _slots[index];
+        Slot before = s;
+
+        size_t pos = 1;
+        while (pos < len) {
+            if (line[pos] != '|') return false;
+            pos++;
+            size_t end = pos;
+            while (end < len && line[end] != '|') end++;
+            apply_field(s, line + pos, end - pos);
+            pos = end;
+        }
+        s.updated_ms = now_ms;
+
+        // Only rows whose visible content changed are redrawn
+        if (!same_content(before, s)) {
+            _dirty |= 1 << index;
+            if (before.used != s.used || before.status != s.status) _header_dirty = true;
+        }
+        return true;
+    }
+
+    void apply_field(Slot& s, const char* f, size_t len) {
+        if (len == 1 && f[0] == 'x') {
+            clear_slot(s);
+            return;
+        }
+        if (len < 2 || f[1] != '=') return;
+        const char* v = f + 2;
+        size_t vlen = len - 2;
+
+        switch (f[0]) {
+            case 'i':
+                if (vlen != strnlen(s.id, ID_CHARS) || strncmp(s.id, v, vlen) != 0) {
+                    clear_slot(s);  // Different session took over the slot
+                    copy_field(s.id, ID_CHARS, v, vlen);
+                }
+                break;
+            case 't': copy_field(s.tool, TOOL_CHARS, v, vlen); break;
+            case 'd': copy_field(s.detail, DETAIL_CHARS, v, vlen); break;
+            case 's': s.status = vlen ? v[0] : 'I'; break;
+            case 'p': {
+                int p = 0;
+                for (size_t i = 0; i < vlen && v[i] >= '0' && v[i] <= '9'; i++) {
+                    p = p * 10 + (v[i] - '0');
+                    if (p > 100) p = 100;  // Clamped as it goes: a long digit run can't overflow
+                }
+                s.progress = vlen ? p : 255;
+                break;
+            }
+            default: return;
+        }
+        s.used = true;
+    }
+
+    // Fixed-width copy, sanitized to ASCII so rows render with the YAML fonts
+    static void copy_field(char* dst, size_t cap, const char* v, size_t vlen) {
+        char tmp[64];
+        if (vlen > sizeof(tmp)) vlen = sizeof(tmp);
+        memcpy(tmp, v, vlen);
+        size_t n = sanitize_text(tmp, vlen, tmp);
+        if (n > cap) n = cap;
+        memset(dst, 0, cap + 1);
+        memcpy(dst, tmp, n);
+    }
+
+    Slot _slots[MAX_SLOTS];
+    uint8_t _dirty;
+    bool _header_dirty;
+    uint32_t _rows_drawn;
+};
+
+// Global accessor
+inline SessionBoard& session_board() {
+    return SessionBoard::instance();
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Text sanitizer - Reduce bridge text to the font's printable ASCII glyphs
+// Single pass, word-at-a-time (SWAR): pure ASCII runs are copied a whole
+// machine word per step (4 bytes on ESP32, 8 on the host). Common UTF-8
+// punctuation is transliterated instead of dropped, so smart quotes, dashes
+// and the bridge's todo markers (► ○) survive as ' " - > o.
+//
+// Every replacement is no longer than its UTF-8 source, so output never
+// grows: out may alias in (in-place) and needs at most len bytes.
+//
+//   char buf[256];
+//   size_t n = sanitize_text(msg.data(), msg.size(), buf);   // caller buffer
+//   std::string clean = sanitize_text(msg);                   // one allocation
+
+namespace text_sanitizer {
+
+typedef uintptr_t word_t;
+
+static const word_t ONES = ~word_t(0) / 0xFF;  // 0x0101...01
+static const word_t HIGHS = ONES * 0x80;       // 0x8080...80
+
+// True if every byte of w is in 0x20..0x7E (no control, DEL or UTF-8 bytes)
+inline bool word_is_plain_ascii(word_t w) {
+    word_t high = w & HIGHS;                         // UTF-8 lead/continuation
+    word_t ctrl = (w - ONES * 0x20) & ~w & HIGHS;    // byte < 0x20
+    word_t x = w ^ (ONES * 0x7F);
+    word_t del = (x - ONES) & ~x & HIGHS;            // byte == 0x7F
+    return (high | ctrl | del) == 0;
+}
+
+struct Translit {
+    uint32_t codepoint;
+    const char* ascii;
+};
+
+// Sorted by codepoint (binary search). Keep each replacement no longer than
+// the UTF-8 encoding of its codepoint (2 bytes below U+0800, else 3).
+static const Translit TABLE[] = {
+    {0x00A0, " "},    // no-break space
+    {0x00AB, "<<"},   // «
+    {0x00B0, "o"},    // °
+    {0x00B7, "."},    // ·
+    {0x00BB, ">>"},   // »
+    {0x00D7, "x"},    // ×
+    {0x2010, "-"},    // hyphen
+    {0x2011, "-"},    // non-breaking hyphen
+    {0x2012, "-"},    // figure dash
+    {0x2013, "-"},    // en dash
+    {0x2014, "--"},   // em dash
+    {0x2018, "'"},    // ‘
+    {0x2019, "'"},    // ’
+    {0x201A, ","},    // ‚
+    {0x201C, "\""},   // “
+    {0x201D, "\""},   // ”
+    {0x2022, "*"},    // •
+    {0x2026, "..."},  // …
+    {0x2032, "'"},    // ′
+    {0x2033, "\""},   // ″
+    {0x2190, "<-"},   // ←
+    {0x2192, "->"},   // →
+    {0x21D2, "=>"},   // ⇒
+    {0x2212, "-"},    // minus sign
+    {0x2260, "!="},   // ≠
+    {0x2264, "<="},   // ≤
+    {0x2265, ">="},   // ≥
+    {0x25A0, "#"},    // ■
+    {0x25A1, "o"},    // □
+    {0x25B6, ">"},    // ▶
+    {0x25BA, ">"},    // ► (AGENT_PLAN active item)
+    {0x25CB, "o"},    // ○ (AGENT_PLAN pending item)
+    {0x25CF, "*"},    // ●
+    {0x2713, "v"},    // ✓
+    {0x2714, "v"},    // ✔
+    {0x2717, "x"},    // ✗
+    {0x2718, "x"},    // ✘
+};
+
+inline const char* lookup(uint32_t cp) {
+    size_t lo = 0, hi = sizeof(TABLE) / sizeof(TABLE[0]);
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (TABLE[mid].codepoint < cp) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo < sizeof(TABLE) / sizeof(TABLE[0]) && TABLE[lo].codepoint == cp) return TABLE[lo].ascii;
+    return nullptr;
+}
+
+}  // namespace text_sanitizer
+
+// Sanitize len bytes from in into out (capacity >= len; may equal in)
+// Keeps '\n' and printable ASCII, turns '\t' into a space, transliterates
+// known UTF-8 sequences and drops everything else. Returns bytes written.
+inline size_t sanitize_text(const char* in, size_t len, char* out) {
+    using namespace text_sanitizer;
+    const size_t W = sizeof(word_t);
+    size_t i = 0, o = 0;
+
+    while (i < len) {
+        // Fast path: copy whole words while they are plain ASCII
+        while (i + W <= len) {
+            word_t w;
+            memcpy(&w, in + i, W);
+            if (!word_is_plain_ascii(w)) break;
+            memmove(out + o, in + i, W);
+            i += W;
+            o += W;
+        }
+        if (i >= len) break;
+
+        uint8_t c = (uint8_t) in[i];
+        if (c < 0x80) {
+            if ((c >= 32 && c <= 126) || c == '\n') out[o++] = (char) c;
+            else if (c == '\t') out[o++] = ' ';
+            i++;
+            continue;
+        }
+
+        // Multi-byte UTF-8: decode, validate continuation bytes, transliterate
+        // The second byte's range also rules out overlong forms (E0, F0),
+        // surrogates (ED) and code points past U+10FFFF (F4)
+        size_t n;
+        uint32_t cp;
+        uint8_t lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) { n = 2; cp = c & 0x1F; }
+        else if (c >= 0xE0 && c <= 0xEF) { n = 3; cp = c & 0x0F; }
+        else if (c >= 0xF0 && c <= 0xF4) { n = 4; cp = c & 0x07; }
+        else { i++; continue; }  // Stray continuation or invalid lead byte
+        if (c == 0xE0) lo = 0xA0;
+        else if (c == 0xED) hi = 0x9F;
+        else if (c == 0xF0) lo = 0x90;
+        else if (c == 0xF4) hi = 0x8F;
+
+        if (i + n > len) { i++; continue; }
+        bool valid = true;
+        for (size_t k = 1; k < n; k++) {
+            uint8_t cc = (uint8_t) in[i + k];
+            if (k == 1 ? (cc < lo || cc > hi) : (cc & 0xC0) != 0x80) { valid = false; break; }
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        if (!valid) { i++; continue; }
+
+        const char* rep = lookup(cp);
+        i += n;
+        if (rep) {
+            while (*rep) out[o++] = *rep++;  // Never longer than n, so o <= i
+        }
+    }
+    return o;
+}
+
+// Convenience: sanitize a std::string with a single allocation
+inline std::string sanitize_text(const std::string& text) {
+    std::string result(text);
+    if (!result.empty()) {
+        result.resize(sanitize_text(result.data(), result.size(), &result[0]));
+    }
+    return result;
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include "text_sanitizer.h"
+
+// TextStore - Fixed-capacity pager text (message, weather) in static memory
+// The message used to live in a text_sensor: every publish reallocated its
+// std::string, and the display lambda copied it again every frame. Here each
+// field owns its buffers for the life of the firmware; publishing copies into
+// the back buffer and flips it to the front, and the render path reads the
+// front through a TextView without copying.
+//
+// Each field is a double buffer with one spare: the writer fills the back
+// buffer and flips it atomically, and the spare keeps the buffer a reader is
+// still drawing from out of the writer's way, so neither side ever waits.
+// One writer context and one reader context per field (on the device both
+// are the main loop; the split is what lets a render task run beside it).
+//
+// Usage in YAML:
+//   set_display service:  text_store().message.publish_sanitized(my_text);
+//   display lambda:       TextView msg = text_store().message.view();
+//                         if (msg.seq != last_seq) { ...new message... }
+//   HA text_sensor:       TextView msg = text_store().message.latest();
+
+// Read-only view of a published text; valid until the reader's next view()
+// Mirrors the parts of std::string the render code uses.
+struct TextView {
+    static const size_t npos = std::string::npos;
+
+    const char* ptr;
+    size_t len;
+    uint32_t seq;   // Bumped on every publish (0 = never published)
+
+    const char* data() const { return ptr; }
+    const char* c_str() const { return ptr; }  // Buffers are null-terminated
+    size_t size() const { return len; }
+    size_t length() const { return len; }
+    bool empty() const { return len == 0; }
+    char operator[](size_t i) const { return ptr[i]; }
+    const char* begin() const { return ptr; }
+    const char* end() const { return ptr + len; }
+
+    size_t find(char c, size_t pos = 0) const {
+        if (pos >= len) return npos;
+        const void* hit = memchr(ptr + pos, c, len - pos);
+        return hit ? (size_t) (static_cast<const char*>(hit) - ptr) : npos;
+    }
+
+    // Allocates: only for short fragments (a line, a filename)
+    std::string substr(size_t pos, size_t n = npos) const {
+        if (pos > len) pos = len;
+        if (n > len - pos) n = len - pos;
+        return std::string(ptr + pos, n);
+    }
+    std::string str() const { return std::string(ptr, len); }
+
+    bool operator==(const char* s) const {
+        size_t n = strlen(s);
+        return n == len && memcmp(ptr, s, n) == 0;
+    }
+    bool operator!=(const char* s) const { return !(*this == s); }
+};
+
+template <size_t CAPACITY>
+class TextBuffer {
+public:
+    static const size_t CAP = CAPACITY;
+
+    TextBuffer() : _write(0), _middle(1), _read(2), _last(1), _seq(0), _truncated(0) {
+        for (uint8_t i = 0; i < 3; i++) {
+            _slots[i].text[0] = '\0';
+            _slots[i].len = 0;
+            _slots[i].seq = 0;
+        }
+    }
+
+    // Copy len bytes in (truncated to CAP) and make them current
+    void publish(const char* text, size_t len) {
+        Slot& s = _slots[_write];
+        if (len > CAP) {
+            len = CAP;
+            _truncated++;
+        }
+        memcpy(s.text, text, len);
+        commit(len);
+    }
+    void publish(const char* text) { publish(text, strlen(text)); }
+    void publish(const std::string& text) { publish(text.data(), text.size()); }
+
+    // Sanitize straight into the back buffer (output never grows)
+    void publish_sanitized(const char* text, size_t len) {
+        if (len > CAP) {
+            len = CAP;  // A cut UTF-8 sequence at the end is dropped
+            _truncated++;
+        }
+        commit(sanitize_text(text, len, _slots[_write].text));
+    }
+    void publish_sanitized(const std::string& text) {
+        publish_sanitized(text.data(), text.size());
+    }
+
+    // Front buffer; switches to the newest publish if there is one
+    TextView view() {
+        if (_middle.load(std::memory_order_acquire) & FRESH) {
+            _read = _middle.exchange(_read, std::memory_order_acq_rel) & INDEX;
+        }
+        const Slot& s = _slots[_read];
+        return TextView{s.text, s.len, s.seq};
+    }
+
+    // Writer side: the last publish, valid until the writer's next one
+    // (nobody writes a published buffer before then). For mirroring the
+    // text elsewhere, e.g. the Home Assistant sensors, without a second reader.
+    TextView latest() const {
+        const Slot& s = _slots[_last];
+        return TextView{s.text, s.len, s.seq};
+    }
+
+    uint32_t seq() const { return _seq; }
+    uint32_t truncated() const { return _truncated; }
+
+private:
+    static const uint8_t INDEX = 0x03;
+    static const uint8_t FRESH = 0x80;
+
+    struct Slot {
+        char text[CAPACITY + 1];
+        uint32_t len;
+        uint32_t seq;
+    };
+
+    // Flip: the filled back buffer becomes the front, and the writer takes
+    // whichever buffer the reader is not holding
+    void commit(size_t len) {
+        Slot& s = _slots[_write];
+        s.text[len] = '\0';
+        s.len = (uint32_t) len;
+        s.seq = ++_seq;
+        _last = _write;
+        _write = _middle.exchange(_write | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    Slot _slots[3];
+    uint8_t _write;                 // Writer-owned
+    std::atomic<uint8_t> _middle;   // Last published (FRESH until a reader takes it)
+    uint8_t _read;                  // Reader-owned
+    uint8_t _last;                  // Writer-owned: newest published
+    uint32_t _seq;
+    uint32_t _truncated;
+};
+
+class TextStore {
+public:
+    // The longest message the pager shows. QUESTION/AGENT_PLAN messages run
+    // to a few KB; longer ones are cut here (counted in truncated()), and
+    // MessageQueue::POOL_BYTES is sized to queue one this long. Three
+    // buffers of it are 12 KB of static RAM. PageIndex::MAX_LINES covers it
+    // down to ~5 characters per line; raise both together.
+    static const size_t MESSAGE_CAP = 4096;
+    static const size_t WEATHER_CAP = 64;
+
+    static TextStore& instance() {
+        static TextStore inst;
+        return inst;
+    }
+
+    TextBuffer<MESSAGE_CAP> message;
+    TextBuffer<WEATHER_CAP> weather;
+
+    // Static footprint of the store (for memory budgeting)
+    static constexpr size_t storage_bytes() {
+        return sizeof(TextStore);
+    }
+
+private:
+    TextStore() {}
+};
+
+// Global accessor
+inline TextStore& text_store() {
+    return TextStore::instance();
+}
@@ -0,0 +1,321 @@
+// ePaper Pipeline for Clawd Pager
+// Non-blocking refresh for the SSD1681 panel (1.54in) behind waveshare_epaper
+
+#pragma once
+#include "esphome.h"
+
+// waveshare_epaper composes, sends and then waits on BUSY inside update(),
+// stalling the loop for ~2 s per full refresh (and ~0.4 s per partial):
+// API calls, buttons and WiFi all wait behind the panel. Here the display
+// component only keeps its buffer and lambda (update_interval: never) and
+// this pipeline drives the controller:
+//
+//   request() -> compose -> diff ------> transfer -----> refresh
+//                (lambda    (rows that   (once BUSY      (0x22/0x20,
+//                 to RAM)    changed)     is low)         BUSY goes high)
+//
+// - BUSY is awaited by a falling-edge interrupt; loop() only checks the
+//   flag (a pin read after MIN_BUSY_MS and a timeout are backstops for a
+//   missed edge). Nothing here blocks.
+// - The next frame is composed and diffed while the panel is still busy.
+//   Requests that arrive meanwhile coalesce: the latest frame wins, and a
+//   frame identical to the panel is dropped.
+// - Partial refreshes send only the changed row band: 0x24 gets the new
+//   rows, 0x26 the panel's current rows (SSD1681 partial refresh drives the
+//   pixels where the two RAMs differ). 0x26 also covers the previous band
+//   so both RAMs agree everywhere else.
+// - Every FULL_EVERY partials (or on request(true)) the whole frame goes
+//   out with a full refresh to clear ghosting.
+// - Transfers go out CHUNK_ROWS rows per loop() pass (2.5 KB of SPI, ~10 ms
+//   at the 2 MHz default data rate).
+//
+// devtools/epaper_pipeline.py simulates this against the blocking path
+// and reports loop latency during refreshes.
+//
+// Usage (clawd-pager-epaper.yaml):
+//   display: update_interval: never
+//   on_boot:  epaper_pipeline().begin(id(epaper_display), 9);
+//   interval: 10ms -> epaper_pipeline().loop();
+//   anywhere: epaper_pipeline().request();   // instead of component.update
+
+// The driver's SPI helpers and Display::do_update_() are protected
+class EpaperPeek : public esphome::waveshare_epaper::WaveshareEPaperBase {
+public:
+    static void compose(esphome::waveshare_epaper::WaveshareEPaperBase* d) {
+        static_cast<EpaperPeek*>(d)->do_update_();
+    }
+    static uint8_t* buffer(esphome::waveshare_epaper::WaveshareEPaperBase* d) {
+        return static_cast<EpaperPeek*>(d)->buffer_;
+    }
+    static void command(esphome::waveshare_epaper::WaveshareEPaperBase* d, uint8_t cmd,
+                        const uint8_t* data = nullptr, size_t len = 0) {
+        d->command(cmd);
+        if (len) write(d, data, len);
+    }
+    static void write(esphome::waveshare_epaper::WaveshareEPaperBase* d, const uint8_t* data, size_t len) {
+        EpaperPeek* p = static_cast<EpaperPeek*>(d);
+        p->start_data_();
+        p->write_array(data, len);
+        p->end_data_();
+    }
+};
+
+class EpaperPipeline {
+public:
+    static const int WIDTH = 200;
+    static const int HEIGHT = 200;
+    static const int ROW_BYTES = WIDTH / 8;
+    static const int CHUNK_ROWS = 100;
+    static const uint8_t FULL_EVERY = 30;           // Partials between full refreshes
+    static const uint32_t MIN_BUSY_MS = 5;          // Before trusting a LOW pin read
+    static const uint32_t INIT_TIMEOUT_MS = 500;
+    static const uint32_t FULL_TIMEOUT_MS = 5000;
+    static const uint32_t PARTIAL_TIMEOUT_MS = 2000;
+
+    struct Stats {
+        uint32_t requests;
+        uint32_t composed;
+        uint32_t coalesced;       // Composed, then replaced before transfer
+        uint32_t unchanged;       // Same as the panel: no refresh
+        uint32_t full;
+        uint32_t partial;
+        uint32_t timeouts;        // BUSY never fell (or the edge was missed)
+        uint32_t rows_sent;
+        uint32_t last_busy_ms;
+        uint32_t max_busy_ms;
+        uint32_t max_pass_us;     // Longest loop() pass
+        uint32_t max_compose_us;
+    };
+
+    static EpaperPipeline& instance() {
+        static EpaperPipeline inst;
+        return inst;
+    }
+
+    // @param display: the waveshare_epaper component (update_interval: never)
+    // @param busy_gpio: BUSY pin, high while the controller works
+    void begin(esphome::waveshare_epaper::WaveshareEPaperBase* display, uint8_t busy_gpio) {
+        _display = display;
+        _busy_gpio = busy_gpio;
+        attachInterrupt(digitalPinToInterrupt(busy_gpio), on_busy_fall, FALLING);
+        // Own the controller setup too, so it matches the commands below
+        _busy_fell = false;
+        EpaperPeek::command(_display, 0x12);  // SWRESET
+        start_busy(State::INIT, INIT_TIMEOUT_MS);
+        _panel_valid = false;
+    }
+
+    // Schedule a frame; full forces a full refresh
+    void request(bool full = false) {
+        _wanted = true;
+        _force_full = _force_full || full;
+        _stats.requests++;
+    }
+
+    void loop() {
+        if (!_display) return;
+        uint32_t start = micros();
+        if (_state == State::INIT || _state == State::BUSY) poll_busy();
+        // Compose whenever the next frame is wanted, even mid-refresh: the
+        // buffer is only read while transferring
+        if (_wanted && _state != State::TRANSFER) stage();
+        if (_state == State::IDLE && _staged) start_transfer();
+        if (_state == State::TRANSFER) transfer_chunk();
+        uint32_t pass = micros() - start;
+        if (pass > _stats.max_pass_us) _stats.max_pass_us = pass;
+    }
+
+    bool busy() const { return _state != State::IDLE; }
+    const Stats& stats() const { return _stats; }
+
+    void log_summary() {
+        ESP_LOGI("ePaper", "requests=%u composed=%u coalesced=%u unchanged=%u full=%u partial=%u timeouts=%u",
+                 _stats.requests, _stats.composed, _stats.coalesced, _stats.unchanged, _stats.full,
+                 _stats.partial, _stats.timeouts);
+        ESP_LOGI("ePaper", "rows_sent=%u busy_ms last=%u max=%u max_pass_us=%u max_compose_us=%u",
+                 _stats.rows_sent, _stats.last_busy_ms, _stats.max_busy_ms, _stats.max_pass_us,
+                 _stats.max_compose_us);
+    }
+
+private:
+    enum class State : uint8_t {
+        INIT,      // SWRESET running
+        IDLE,      // Panel ready
+        TRANSFER,  // Sending RAM, CHUNK_ROWS per pass
+        BUSY,      // Refresh running
+    };
+
+    enum class Phase : uint8_t {
+        OLD_RAM,   // 0x26 <- panel rows
+        NEW_RAM,   // 0x24 <- composed rows
+    };
+
+    EpaperPipeline() {}
+
+    static void IRAM_ATTR on_busy_fall() { _busy_fell = true; }
+
+    void start_busy(State state, uint32_t timeout_ms) {
+        _state = state;
+        _busy_since = millis();
+        _busy_timeout = timeout_ms;
+    }
+
+    void poll_busy() {
+        uint32_t elapsed = millis() - _busy_since;
+        bool done = _busy_fell || (elapsed >= MIN_BUSY_MS && digitalRead(_busy_gpio) == LOW);
+        if (!done && elapsed < _busy_timeout) return;
+        if (!done) {
+            _stats.timeouts++;
+            ESP_LOGW("ePaper", "BUSY still high after %u ms", elapsed);
+        }
+        if (_state == State::INIT) {
+            configure();
+            _state = State::IDLE;
+            return;
+        }
+        _stats.last_busy_ms = elapsed;
+        if (elapsed > _stats.max_busy_ms) _stats.max_busy_ms = elapsed;
+        ESP_LOGD("ePaper", "%s refresh done in %u ms", _refresh_full ? "full" : "partial", elapsed);
+        _state = State::IDLE;
+    }
+
+    void configure() {
+        const uint8_t driver[] = {(uint8_t) ((HEIGHT - 1) & 0xFF), (uint8_t) ((HEIGHT - 1) >> 8), 0x00};
+        const uint8_t entry = 0x03;   // X then Y increment
+        const uint8_t border = 0x05;
+        const uint8_t sensor = 0x80;  // Internal temperature sensor
+        EpaperPeek::command(_display, 0x01, driver, sizeof(driver));
+        EpaperPeek::command(_display, 0x11, &entry, 1);
+        EpaperPeek::command(_display, 0x3C, &border, 1);
+        EpaperPeek::command(_display, 0x18, &sensor, 1);
+    }
+
+    // Compose the next frame and find the rows that differ from the panel
+    void stage() {
+        uint32_t start = micros();
+        EpaperPeek::compose(_display);
+        uint32_t took = micros() - start;
+        if (took > _stats.max_compose_us) _stats.max_compose_us = took;
+        _stats.composed++;
+        if (_staged) _stats.coalesced++;
+        _wanted = false;
+
+        const uint8_t* frame = EpaperPeek::buffer(_display);
+        bool full = _force_full || !_panel_valid || _partials >= FULL_EVERY;
+        int first = 0, last = HEIGHT;
+        if (!full) {
+            while (first < HEIGHT && memcmp(frame + first * ROW_BYTES, _panel + first * ROW_BYTES, ROW_BYTES) == 0) {
+                first++;
+            }
+            while (last > first && memcmp(frame + (last - 1) * ROW_BYTES, _panel + (last - 1) * ROW_BYTES,
+                                          ROW_BYTES) == 0) {
+                last--;
+            }
+            if (first == last) {
+                _stats.unchanged++;
+                _staged = false;
+                return;
+            }
+        }
+        _staged = true;
+        _band_first = first;
+        _band_last = last;
+        _stage_full = full;
+    }
+
+    void start_transfer() {
+        _staged = false;
+        _refresh_full = _stage_full;
+        _force_full = _force_full && !_refresh_full;
+        // 0x26 also gets the previous band back in step with 0x24
+        _old_first = _band_first < _prev_first ? _band_first : _prev_first;
+        _old_last = _band_last > _prev_last ? _band_last : _prev_last;
+        _phase = _refresh_full ? Phase::NEW_RAM : Phase::OLD_RAM;
+        begin_phase();
+        _state = State::TRANSFER;
+    }
+
+    void begin_phase() {
+        int first = _phase == Phase::OLD_RAM ? _old_first : _band_first;
+        int last = _phase == Phase::OLD_RAM ? _old_last : _band_last;
+        const uint8_t x_range[] = {0x00, (uint8_t) (ROW_BYTES - 1)};
+        const uint8_t y_range[] = {(uint8_t) (first & 0xFF), (uint8_t) (first >> 8), (uint8_t) ((last - 1) & 0xFF),
+                                   (uint8_t) ((last - 1) >> 8)};
+        const uint8_t x_start = 0x00;
+        const uint8_t y_start[] = {(uint8_t) (first & 0xFF), (uint8_t) (first >> 8)};
+        EpaperPeek::command(_display, 0x44, x_range, sizeof(x_range));
+        EpaperPeek::command(_display, 0x45, y_range, sizeof(y_range));
+        EpaperPeek::command(_display, 0x4E, &x_start, 1);
+        EpaperPeek::command(_display, 0x4F, y_start, sizeof(y_start));
+        EpaperPeek::command(_display, _phase == Phase::OLD_RAM ? 0x26 : 0x24);
+        _row = first;
+        _row_end = last;
+    }
+
+    void transfer_chunk() {
+        int rows = _row_end - _row < CHUNK_ROWS ? _row_end - _row : CHUNK_ROWS;
+        const uint8_t* src = _phase == Phase::OLD_RAM ? _panel : EpaperPeek::buffer(_display);
+        EpaperPeek::write(_display, src + _row * ROW_BYTES, rows * ROW_BYTES);
+        _row += rows;
+        _stats.rows_sent += rows;
+        if (_row < _row_end) return;
+        if (_phase == Phase::OLD_RAM) {
+            _phase = Phase::NEW_RAM;
+            begin_phase();
+            return;
+        }
+        refresh();
+    }
+
+    void refresh() {
+        const uint8_t* frame = EpaperPeek::buffer(_display);
+        memcpy(_panel + _band_first * ROW_BYTES, frame + _band_first * ROW_BYTES,
+               (_band_last - _band_first) * ROW_BYTES);
+        _panel_valid = true;
+        _prev_first = _band_first;
+        _prev_last = _band_last;
+        if (_refresh_full) {
+            _partials = 0;
+            _stats.full++;
+        } else {
+            _partials++;
+            _stats.partial++;
+        }
+        const uint8_t mode = _refresh_full ? 0xF7 : 0xFC;  // Full: load temperature + LUT; partial: mode 2
+        _busy_fell = false;
+        EpaperPeek::command(_display, 0x22, &mode, 1);
+        EpaperPeek::command(_display, 0x20);  // Master activation: BUSY goes high
+        start_busy(State::BUSY, _refresh_full ? FULL_TIMEOUT_MS : PARTIAL_TIMEOUT_MS);
+    }
+
+    esphome::waveshare_epaper::WaveshareEPaperBase* _display = nullptr;
+    uint8_t _busy_gpio = 0;
+    static volatile bool _busy_fell;
+
+    State _state = State::IDLE;
+    Phase _phase = Phase::NEW_RAM;
+    uint32_t _busy_since = 0;
+    uint32_t _busy_timeout = 0;
+
+    bool _wanted = false;
+    bool _force_full = false;
+    bool _staged = false;
+    bool _stage_full = false;
+    bool _refresh_full = false;
+    bool _panel_valid = false;
+    uint8_t _partials = 0;
+    int _band_first = 0, _band_last = 0;
+    int _prev_first = 0, _prev_last = 0;
+    int _old_first = 0, _old_last = 0;
+    int _row = 0, _row_end = 0;
+
+    uint8_t _panel[ROW_BYTES * HEIGHT];  // What the panel shows now
+    Stats _stats = {};
+};
+
+volatile bool EpaperPipeline::_busy_fell = false;
+
+// Global accessor
+inline EpaperPipeline& epaper_pipeline() {
+    return EpaperPipeline::instance();
+}
@@ -0,0 +1,260 @@
+// Fleet Telemetry for Clawd Pager
+// State deltas and metric histograms pushed to the bridge's fleet aggregator
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "metrics_tsdb.h"
+
+// The dashboard polled each pager's state through the API, which doesn't
+// scale past a few devices. Each pager now pushes a report every
+// REPORT_MS to devtools/fleet_aggregator.cpp over UDP:
+// - a state datagram with the fields that changed since the last report,
+//   all of them every KEYFRAME_EVERY reports, so a restarted aggregator
+//   catches up
+// - a metrics datagram with a histogram of each timing metric (loop and
+//   frame time) over the report period
+// A lost datagram is fine: state heals on the next change or keyframe,
+// and a histogram is only one period of samples.
+//
+// Datagram (little-endian), sent with AudioStreamer::send_datagram:
+//   0  FF FF 'F' 'T'   magic (same FF FF prefix as the other side channels)
+//   4  device          u32, fleet_device_id() of the MAC
+//   8  seq             u16, per datagram
+//   10 type            u8, FLEET_STATE / FLEET_METRICS
+//   11 count           u8, entries that follow
+//   12 entries
+//     STATE:   field u8, len u8, value (numbers: i32, text: len bytes)
+//     METRICS: metric u8 (Metric), buckets u8, samples u16,
+//              then buckets x (bucket u8, count u16)
+//
+// Metric values are fixed point as in MetricsTsdb (frame time x10);
+// histogram buckets are FLEET_BUCKET_UPPER (ms x10, log-spaced, the last
+// one open). Battery, charging and RSSI arrive through the same
+// MetricsTsdb tap and go out as state fields.
+//
+// Usage:
+//   fleet_reporter().begin(fleet_device_id(ESP.getEfuseMac()), ESPHOME_PROJECT_VERSION);
+//   metrics_tsdb().set_tap([](Metric m, int32_t v, uint32_t now) { fleet_reporter().observe(m, v); });
+//   // 1 s interval:
+//   fleet_reporter().set_text(FleetField::MODE, id(display_mode).state.c_str());
+//   uint8_t pkt[FleetReporter::MAX_DATAGRAM];
+//   while (size_t n = fleet_reporter().poll(millis(), pkt, sizeof(pkt))) audio_streamer().send_datagram(pkt, n, 12348);
+
+static const uint8_t FLEET_MAGIC[4] = {0xFF, 0xFF, 'F', 'T'};
+static const size_t FLEET_HEADER_SIZE = 12;
+static const uint8_t FLEET_STATE = 1;
+static const uint8_t FLEET_METRICS = 2;
+static const uint8_t FLEET_TEXT_MAX = 31;
+
+enum class FleetField : uint8_t {
+    BATTERY = 0,       // % x10
+    CHARGING = 1,      // 0/1
+    RSSI = 2,          // dBm
+    HEAP_FREE = 3,     // bytes
+    HEAP_LARGEST = 4,  // bytes, largest free block
+    UPTIME_S = 5,
+    MODE = 6,          // text
+    FIRMWARE = 7,      // text, ESPHOME_PROJECT_VERSION
+    COUNT = 8,
+};
+
+inline bool fleet_field_is_text(FleetField f) {
+    return f == FleetField::MODE || f == FleetField::FIRMWARE;
+}
+
+// Device id from the 48-bit MAC as ESP.getEfuseMac() returns it (first MAC
+// byte lowest). The low 32 bits alone are the 3-byte OUI plus one byte, so
+// a fleet would share 256 ids. The 24 NIC bits are kept whole (unique
+// within an OUI) and the OUI folds into the top byte.
+inline uint32_t fleet_device_id(uint64_t efuse_mac) {
+    uint8_t oui = (uint8_t) (efuse_mac ^ efuse_mac >> 8 ^ efuse_mac >> 16);
+    return (uint32_t) (efuse_mac >> 24 & 0xFFFFFF) | (uint32_t) oui << 24;
+}
+
+static const uint8_t FLEET_BUCKETS = 32;
+// Upper bound (exclusive) of each bucket but the last, in ms x10
+static const uint16_t FLEET_BUCKET_UPPER[FLEET_BUCKETS - 1] = {
+    10,  20,  30,  40,  50,  60,  80,  100,  120,  140,  160,  180,  200,  220,  250,  280,
+    320, 360, 400, 450, 500, 600, 700, 800, 1000, 1250, 1500, 2000, 3000, 5000, 10000,
+};
+
+inline uint8_t fleet_bucket(int32_t value) {
+    uint8_t b = 0;
+    while (b < FLEET_BUCKETS - 1 && value >= FLEET_BUCKET_UPPER[b]) b++;
+    return b;
+}
+
+class FleetReporter {
+public:
+    static const uint32_t REPORT_MS = 10000;
+    static const uint8_t KEYFRAME_EVERY = 6;
+    static const size_t MAX_DATAGRAM = 256;
+
+    static FleetReporter& instance() {
+        static FleetReporter inst;
+        return inst;
+    }
+
+    void begin(uint32_t device_id, const char* firmware) {
+        _device = device_id;
+        set_text(FleetField::FIRMWARE, firmware);
+    }
+
+    void set(FleetField f, int32_t value) {
+        if (_value[(int) f] == value && (_known & bit(f))) return;
+        _value[(int) f] = value;
+        _known |= bit(f);
+        _dirty |= bit(f);
+    }
+
+    void set_text(FleetField f, const char* text) {
+        char* dst = f == FleetField::MODE ? _mode : _firmware;
+        if ((_known & bit(f)) && strncmp(dst, text, FLEET_TEXT_MAX) == 0) return;
+        strncpy(dst, text, FLEET_TEXT_MAX);
+        dst[FLEET_TEXT_MAX] = '\0';
+        _known |= bit(f);
+        _dirty |= bit(f);
+    }
+
+    // From the MetricsTsdb tap: gauges become state, timings histograms
+    void observe(Metric m, int32_t value) {
+        switch (m) {
+            case Metric::BATTERY: set(FleetField::BATTERY, value); break;
+            case Metric::CHARGING: set(FleetField::CHARGING, value ? 1 : 0); break;
+            case Metric::RSSI: set(FleetField::RSSI, value); break;
+            case Metric::LOOP_MS:
+            case Metric::FRAME_MS: {
+                Histogram& h = _hist[m == Metric::LOOP_MS ? 0 : 1];
+                uint16_t& c = h.counts[fleet_bucket(value)];
+                if (c < 0xFFFF) c++;
+                if (h.samples < 0xFFFF) h.samples++;
+                break;
+            }
+            default: break;
+        }
+    }
+
+    // Next datagram of a due report into out (state, then metrics); 0 when
+    // there's nothing (more) to send
+    size_t poll(uint32_t now_ms, uint8_t* out, size_t cap) {
+        if (_device == 0 || cap < MAX_DATAGRAM) return 0;
+        if (_step == 0) {
+            if (now_ms - _last_report_ms < REPORT_MS) return 0;
+            _last_report_ms = now_ms;
+            _step = 1;
+            if (++_reports >= KEYFRAME_EVERY) {
+                _reports = 0;
+                _dirty = _known;
+            }
+        }
+        if (_step == 1) {
+            _step = 2;
+            if (_dirty) return encode_state(out);
+        }
+        _step = 0;
+        return encode_metrics(out);
+    }
+
+    uint32_t device() const { return _device; }
+    uint16_t seq() const { return _seq; }
+
+    // Public for devtools/fleet_aggregator.cpp --loadgen (one per simulated
+    // pager); the pager itself uses instance()
+    FleetReporter() : _device(0), _seq(0), _known(0), _dirty(0), _last_report_ms(0), _reports(0), _step(0) {
+        memset(_value, 0, sizeof(_value));
+        memset(_hist, 0, sizeof(_hist));
+        _mode[0] = _firmware[0] = '\0';
+    }
+
+private:
+    struct Histogram {
+        uint16_t counts[FLEET_BUCKETS];
+        uint16_t samples;
+    };
+
+    static uint16_t bit(FleetField f) { return (uint16_t) (1u << (int) f); }
+
+    size_t header(uint8_t* out, uint8_t type) {
+        memcpy(out, FLEET_MAGIC, 4);
+        put32(out + 4, _device);
+        out[8] = (uint8_t) _seq;
+        out[9] = (uint8_t) (_seq >> 8);
+        _seq++;
+        out[10] = type;
+        out[11] = 0;
+        return FLEET_HEADER_SIZE;
+    }
+
+    // Every field fits: 6 numbers x 6 + 2 texts x (2 + 31) < MAX_DATAGRAM
+    size_t encode_state(uint8_t* out) {
+        size_t n = header(out, FLEET_STATE);
+        for (uint8_t f = 0; f < (uint8_t) FleetField::COUNT; f++) {
+            if (!(_dirty & (1u << f))) continue;
+            out[n++] = f;
+            if (fleet_field_is_text((FleetField) f)) {
+                const char* text = (FleetField) f == FleetField::MODE ? _mode : _firmware;
+                uint8_t len = (uint8_t) strlen(text);
+                out[n++] = len;
+                memcpy(out + n, text, len);
+                n += len;
+            } else {
+                out[n++] = 4;
+                put32(out + n, (uint32_t) _value[f]);
+                n += 4;
+            }
+            out[11]++;
+        }
+        _dirty = 0;
+        return n;
+    }
+
+    // Non-empty buckets only: a steady pager sends a few per metric
+    size_t encode_metrics(uint8_t* out) {
+        size_t n = header(out, FLEET_METRICS);
+        static const Metric METRICS[2] = {Metric::LOOP_MS, Metric::FRAME_MS};
+        for (int i = 0; i < 2; i++) {
+            Histogram& h = _hist[i];
+            size_t at = n;
+            out[n++] = (uint8_t) METRICS[i];
+            out[n++] = 0;
+            out[n++] = (uint8_t) h.samples;
+            out[n++] = (uint8_t) (h.samples >> 8);
+            for (uint8_t b = 0; b < FLEET_BUCKETS; b++) {
+                if (!h.counts[b]) continue;
+                out[n++] = b;
+                out[n++] = (uint8_t) h.counts[b];
+                out[n++] = (uint8_t) (h.counts[b] >> 8);
+                out[at + 1]++;
+            }
+            out[11]++;
+            memset(&h, 0, sizeof(h));
+        }
+        return n;
+    }
+
+    static void put32(uint8_t* p, uint32_t v) {
+        p[0] = (uint8_t) v;
+        p[1] = (uint8_t) (v >> 8);
+        p[2] = (uint8_t) (v >> 16);
+        p[3] = (uint8_t) (v >> 24);
+    }
+
+    uint32_t _device;
+    uint16_t _seq;
+    uint16_t _known;
+    uint16_t _dirty;
+    int32_t _value[(int) FleetField::COUNT];
+    char _mode[FLEET_TEXT_MAX + 1];
+    char _firmware[FLEET_TEXT_MAX + 1];
+    Histogram _hist[2];
+    uint32_t _last_report_ms;
+    uint8_t _reports;
+    uint8_t _step;
+};
+
+// Global accessor
+inline FleetReporter& fleet_reporter() {
+    return FleetReporter::instance();
+}
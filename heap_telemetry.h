@@ -0,0 +1,377 @@
+// Heap Telemetry for Clawd Pager
+// Tracks free heap, largest free block and per-subsystem allocations
+
+#pragma once
+#include "esphome.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#if defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// Per-subsystem accounting: code runs inside a MemScope, and every
+// operator new/delete in that scope is charged to its tag (live bytes,
+// high-water mark, allocation count, failures).
+//
+//   { MemScope scope(MemTag::DISPLAY); ...render... }
+//
+// The tag belongs to the task that opened the scope (the ESPHome loop
+// task, where every lambda runs). WiFi, lwIP and other tasks allocating
+// meanwhile are charged to OTHER, and a MemScope opened on another task
+// while one is open on the loop task is ignored.
+//
+// Arenas: a tag can be given a bump arena for short-lived allocations
+// (e.g. per-frame word-wrap strings). Allocations under that tag, on the
+// scope's task only, come from the arena until it is full, then spill to
+// the heap. reset() it where a frame starts (top of the display lambda):
+// it only rewinds once nothing from it is alive, so an object that
+// outlives its frame keeps the arena from rewinding (later allocations
+// spill) instead of being overwritten.
+//
+// The operator new/delete hook is compiled only with
+// -DHEAP_TELEMETRY_HOOK_NEW, and this header must then be included by
+// exactly one translation unit (ESPHome puts `includes:` in main.cpp).
+// Without the hook, heap-wide numbers still work and tags stay at zero.
+//
+// The hook also records the last TRACE_SIZE alloc/free events; dump them
+// with dump_trace() and replay on the host with devtools/heap_replay.py.
+
+enum class MemTag : uint8_t {
+    OTHER = 0,
+    DISPLAY = 1,
+    AUDIO = 2,
+    API = 3,
+    MEDIA = 4,
+    COUNT = 5,
+};
+
+class Arena {
+public:
+    Arena(uint8_t* base, size_t capacity)
+        : _base(base), _capacity(capacity), _used(0), _peak(0), _live(0), _held(0) {}
+
+    void* alloc(size_t size) {
+        size_t start = (_used + 7) & ~(size_t) 7;
+        if (start + size > _capacity) return nullptr;
+        _used = start + size;
+        if (_used > _peak) _peak = _used;
+        _live++;
+        return _base + start;
+    }
+
+    // One arena allocation freed (from any task)
+    void release() { _live--; }
+
+    // Rewind; refused while anything allocated from it is still alive
+    bool reset() {
+        if (_live.load() != 0) {
+            _held++;
+            return false;
+        }
+        _used = 0;
+        return true;
+    }
+    bool owns(const void* p) const {
+        return p >= _base && p < _base + _capacity;
+    }
+    size_t used() const { return _used; }
+    size_t peak() const { return _peak; }
+    size_t capacity() const { return _capacity; }
+    uint32_t live() const { return _live.load(); }
+    uint32_t held() const { return _held; }
+
+private:
+    uint8_t* _base;
+    size_t _capacity;
+    size_t _used;
+    size_t _peak;
+    std::atomic<uint32_t> _live;
+    uint32_t _held;  // reset() calls refused
+};
+
+template <size_t N>
+class StaticArena : public Arena {
+public:
+    StaticArena() : Arena(_storage, N) {}
+
+private:
+    alignas(8) uint8_t _storage[N];
+};
+
+class HeapTelemetry {
+public:
+    static const uint8_t TAGS = (uint8_t) MemTag::COUNT;
+    static const uint16_t TRACE_SIZE = 256;
+
+    struct TagStats {
+        std::atomic<int32_t> live;      // Bytes currently allocated
+        std::atomic<int32_t> peak;      // High-water mark of live
+        std::atomic<uint32_t> allocs;
+        std::atomic<uint32_t> failures;
+        std::atomic<uint32_t> spills;   // Arena full, fell back to heap
+    };
+
+    struct TraceEntry {
+        uint32_t ms;
+        uint32_t id;      // Allocation serial (pairs frees with allocs)
+        uint32_t size;
+        uint8_t tag;
+        uint8_t op;       // 'A' alloc, 'F' free, 'X' failed
+        uint8_t arena;
+    };
+
+    static HeapTelemetry& instance() {
+        static HeapTelemetry inst;
+        return inst;
+    }
+
+    // Innermost MemScope's tag on the task that opened it, OTHER elsewhere
+    MemTag current() const { return _owner.load() == this_task() ? _current : MemTag::OTHER; }
+
+    bool in_scope() const { return _owner.load() == this_task(); }
+
+    // False (ignored) while another task has a scope open
+    bool set_current(MemTag tag) {
+        const void* owner = _owner.load();
+        if (owner != nullptr && owner != this_task()) return false;
+        _current = tag;
+        _owner = this_task();
+        return true;
+    }
+
+    // Outermost scope closed: any task may open the next one
+    void release_current() {
+        _current = MemTag::OTHER;
+        _owner = nullptr;
+    }
+
+    // Set once (boot or first frame); OTHER never gets one
+    void set_arena(MemTag tag, Arena* arena) {
+        if (tag != MemTag::OTHER) _arenas[(uint8_t) tag] = arena;
+    }
+    Arena* arena(MemTag tag) const { return _arenas[(uint8_t) tag]; }
+
+    const TagStats& stats(MemTag tag) const { return _stats[(uint8_t) tag]; }
+
+    static const char* tag_name(MemTag tag) {
+        static const char* NAMES[] = {"other", "display", "audio", "api", "media"};
+        return NAMES[(uint8_t) tag];
+    }
+
+    // Heap-wide numbers (internal 8-bit capable RAM)
+    static uint32_t free_bytes() {
+#if defined(ESP_PLATFORM)
+        return heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#else
+        return 0;
+#endif
+    }
+    static uint32_t largest_free_block() {
+#if defined(ESP_PLATFORM)
+        return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#else
+        return 0;
+#endif
+    }
+    static uint32_t min_free_ever() {
+#if defined(ESP_PLATFORM)
+        return heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+#else
+        return 0;
+#endif
+    }
+
+    // 0 = one contiguous free region, 100 = free memory is all crumbs
+    static uint8_t fragmentation_pct() {
+        uint32_t free = free_bytes();
+        if (free == 0) return 0;
+        return 100 - (uint8_t) ((uint64_t) largest_free_block() * 100 / free);
+    }
+
+    // Called from the allocation hook
+    void on_alloc(MemTag tag, uint32_t id, size_t size, bool from_arena) {
+        TagStats& s = _stats[(uint8_t) tag];
+        int32_t live = s.live.fetch_add((int32_t) size) + (int32_t) size;
+        int32_t peak = s.peak.load();
+        while (live > peak && !s.peak.compare_exchange_weak(peak, live)) {}
+        s.allocs++;
+        trace(tag, id, size, 'A', from_arena);
+    }
+
+    void on_free(MemTag tag, uint32_t id, size_t size, bool from_arena) {
+        _stats[(uint8_t) tag].live -= (int32_t) size;
+        trace(tag, id, size, 'F', from_arena);
+    }
+
+    void on_failure(MemTag tag, size_t size) {
+        _stats[(uint8_t) tag].failures++;
+        trace(tag, 0, size, 'X', false);
+    }
+
+    void on_spill(MemTag tag) { _stats[(uint8_t) tag].spills++; }
+
+    uint32_t next_id() { return ++_next_id; }
+
+    // Reset high-water marks to current live bytes (e.g. after boot settles)
+    void reset_peaks() {
+        for (uint8_t i = 0; i < TAGS; i++) _stats[i].peak = _stats[i].live.load();
+    }
+
+    // One STATE-style line for get_state / dashboards
+    void log_summary() const {
+        ESP_LOGI("HEAP", "free=%u largest=%u min=%u frag=%u%%",
+                 (unsigned) free_bytes(), (unsigned) largest_free_block(),
+                 (unsigned) min_free_ever(), fragmentation_pct());
+        for (uint8_t i = 0; i < TAGS; i++) {
+            const TagStats& s = _stats[i];
+            const Arena* a = _arenas[i];
+            ESP_LOGI("HEAP", "tag=%s live=%d peak=%d allocs=%u fail=%u spill=%u arena=%u/%u held=%u",
+                     tag_name((MemTag) i), (int) s.live.load(), (int) s.peak.load(),
+                     (unsigned) s.allocs.load(), (unsigned) s.failures.load(),
+                     (unsigned) s.spills.load(), a ? (unsigned) a->peak() : 0,
+                     a ? (unsigned) a->capacity() : 0, a ? (unsigned) a->held() : 0);
+        }
+    }
+
+    // Oldest-first trace, one line per event, for devtools/heap_replay.py
+    void dump_trace() const {
+        uint32_t written = _trace_written.load();
+        uint16_t count = written < TRACE_SIZE ? (uint16_t) written : TRACE_SIZE;
+        uint16_t start = (uint16_t) ((written - count) % TRACE_SIZE);
+        ESP_LOGI("HEAPTRACE", "begin count=%u free=%u largest=%u", count,
+                 (unsigned) free_bytes(), (unsigned) largest_free_block());
+        for (uint16_t i = 0; i < count; i++) {
+            const TraceEntry& e = _trace[(start + i) % TRACE_SIZE];
+            ESP_LOGI("HEAPTRACE", "%u %c %u %u %s%s", (unsigned) e.ms, e.op, (unsigned) e.id,
+                     (unsigned) e.size, tag_name((MemTag) e.tag), e.arena ? " arena" : "");
+        }
+        ESP_LOGI("HEAPTRACE", "end");
+    }
+
+private:
+    HeapTelemetry() : _current(MemTag::OTHER), _owner(nullptr), _next_id(0), _trace_written(0) {
+        for (uint8_t i = 0; i < TAGS; i++) _arenas[i] = nullptr;
+    }
+
+    static const void* this_task() {
+#if defined(ESP_PLATFORM)
+        return xTaskGetCurrentTaskHandle();
+#else
+        static thread_local char task;
+        return &task;
+#endif
+    }
+
+    void trace(MemTag tag, uint32_t id, size_t size, uint8_t op, bool from_arena) {
+        // Every task allocates: claim a slot, so two never write the same one
+        TraceEntry& e = _trace[_trace_written.fetch_add(1) % TRACE_SIZE];
+        e.ms = millis();
+        e.id = id;
+        e.size = (uint32_t) size;
+        e.tag = (uint8_t) tag;
+        e.op = op;
+        e.arena = from_arena;
+    }
+
+    MemTag _current;
+    std::atomic<const void*> _owner;  // Task whose scope set _current
+    Arena* _arenas[TAGS];
+    TagStats _stats[TAGS];
+    std::atomic<uint32_t> _next_id;
+    TraceEntry _trace[TRACE_SIZE];
+    std::atomic<uint32_t> _trace_written;
+};
+
+// Global accessor
+inline HeapTelemetry& heap_telemetry() {
+    return HeapTelemetry::instance();
+}
+
+// Charge allocations in this scope (on this task) to a subsystem
+class MemScope {
+public:
+    explicit MemScope(MemTag tag) : _prev(heap_telemetry().current()), _outermost(!heap_telemetry().in_scope()) {
+        _active = heap_telemetry().set_current(tag);
+    }
+    ~MemScope() {
+        if (!_active) return;
+        if (_outermost) heap_telemetry().release_current();
+        else heap_telemetry().set_current(_prev);
+    }
+
+private:
+    MemTag _prev;
+    bool _outermost;
+    bool _active;
+};
+
+#ifdef HEAP_TELEMETRY_HOOK_NEW
+// 8-byte header keeps the 8-byte alignment operator new must return
+namespace heap_telemetry_hook {
+
+struct Header {
+    uint32_t size;
+    uint32_t info;  // id << 8 | arena << 7 | tag
+};
+
+inline void* allocate(size_t size) {
+    HeapTelemetry& ht = heap_telemetry();
+    MemTag tag = ht.current();
+    bool from_arena = false;
+    void* raw = nullptr;
+
+    if (Arena* arena = ht.arena(tag)) {
+        raw = arena->alloc(size + sizeof(Header));
+        from_arena = raw != nullptr;
+        if (!from_arena) ht.on_spill(tag);
+    }
+    if (raw == nullptr) raw = malloc(size + sizeof(Header));
+    if (raw == nullptr) {
+        ht.on_failure(tag, size);
+        return nullptr;
+    }
+
+    uint32_t id = ht.next_id() & 0xFFFFFF;
+    Header* h = static_cast<Header*>(raw);
+    h->size = (uint32_t) size;
+    h->info = (id << 8) | (from_arena ? 0x80 : 0) | (uint8_t) tag;
+    ht.on_alloc(tag, id, size, from_arena);
+    return h + 1;
+}
+
+inline void release(void* p) {
+    if (p == nullptr) return;
+    Header* h = static_cast<Header*>(p) - 1;
+    MemTag tag = (MemTag) (h->info & 0x7F);
+    bool from_arena = h->info & 0x80;
+    heap_telemetry().on_free(tag, h->info >> 8, h->size, from_arena);
+    if (from_arena) heap_telemetry().arena(tag)->release();  // Memory comes back at reset()
+    else free(h);
+}
+
+}  // namespace heap_telemetry_hook
+
+void* operator new(size_t size) {
+    void* p = heap_telemetry_hook::allocate(size);
+    if (p == nullptr) abort();  // Built without exceptions: fail loudly
+    return p;
+}
+void* operator new[](size_t size) {
+    void* p = heap_telemetry_hook::allocate(size);
+    if (p == nullptr) abort();
+    return p;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return heap_telemetry_hook::allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return heap_telemetry_hook::allocate(size);
+}
+void operator delete(void* p) noexcept { heap_telemetry_hook::release(p); }
+void operator delete[](void* p) noexcept { heap_telemetry_hook::release(p); }
+void operator delete(void* p, size_t) noexcept { heap_telemetry_hook::release(p); }
+void operator delete[](void* p, size_t) noexcept { heap_telemetry_hook::release(p); }
+#endif
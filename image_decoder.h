@@ -0,0 +1,1091 @@
+// Image Decoder for Clawd Pager
+// Strip-wise baseline JPEG and PNG decoding with integer downscaling, so
+// push_image can take a real picture instead of a pre-converted bitmap.
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <functional>
+
+// Output is 8-bit grayscale, one row at a time, through a RowSink; nothing
+// holds a whole decoded frame. Dither1Bit turns rows into the 1-bit
+// image_buffer format (MSB first, 1 = dark, like QrCode::render_1bit).
+//
+// Scale is a shift: 0 = 1/1, 1 = 1/2, 2 = 1/4, 3 = 1/8.
+// - JPEG scales inside the IDCT: each NxN output pixel is the 8x8 IDCT
+//   averaged over its cell, folded into the basis tables, so it costs less
+//   than a full IDCT and matches a box filter of the full decode (1/8 is
+//   DC only, no IDCT at all). Only luma is transformed: chroma is
+//   entropy-decoded to keep the bitstream in step, then dropped.
+// - PNG box-averages each 2^s x 2^s cell as scanlines are unfiltered.
+//
+// Working memory:
+// - JpegDecoder (~9 KB) keeps its tables and one MCU row of scaled luma in
+//   the object. Keep the static instance (image_decoder()), not a stack copy.
+// - PngDecoder (~11 KB) also never allocates: the zlib window (up to
+//   WINDOW_BYTES), two scanlines (up to MAX_STRIDE) and the box sums live
+//   in the object. A PNG whose zlib header declares a larger window, or
+//   whose rows are longer, is refused before any output. Standard encoders
+//   declare 32 KB; devtools/image_decode.py writes or re-deflates PNGs
+//   with a 1-4 KB window.
+//
+// Limits: baseline/extended Huffman JPEG only (no progressive, no
+// arithmetic), 1 or 3 components. PNG: no Adam7 interlace, CRC and Adler
+// unchecked (the API transport already is). Scaled width is at most
+// MAX_WIDTH.
+//
+// Usage:
+//   Dither1Bit dither(image_buffer, 240, 135);
+//   image_decoder().decode(data.data(), data.size(), 240, 135, dither.sink());
+
+typedef std::function<void(int y, const uint8_t* gray, int width)> RowSink;
+
+enum class ImageFormat : uint8_t {
+    UNKNOWN = 0,
+    JPEG = 1,
+    PNG = 2,
+};
+
+struct ImageInfo {
+    ImageFormat format;
+    int width;
+    int height;
+};
+
+namespace image_decoder_detail {
+
+inline uint16_t be16(const uint8_t* p) { return (uint16_t) (p[0] << 8 | p[1]); }
+inline uint32_t be32(const uint8_t* p) {
+    return (uint32_t) p[0] << 24 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 8 | p[3];
+}
+inline uint8_t clamp8(int v) { return v < 0 ? 0 : (v > 255 ? 255 : (uint8_t) v); }
+
+static const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+}  // namespace image_decoder_detail
+
+// Format and size from the header, without decoding
+inline bool image_probe(const uint8_t* data, size_t len, ImageInfo* info) {
+    using namespace image_decoder_detail;
+    info->format = ImageFormat::UNKNOWN;
+    if (len >= 24 && memcmp(data, PNG_SIGNATURE, 8) == 0 && memcmp(data + 12, "IHDR", 4) == 0) {
+        info->format = ImageFormat::PNG;
+        info->width = (int) be32(data + 16);
+        info->height = (int) be32(data + 20);
+        return true;
+    }
+    if (len < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+    size_t p = 2;
+    while (p + 4 <= len) {
+        if (data[p] != 0xFF) return false;
+        uint8_t m = data[p + 1];
+        if (m == 0xFF) { p++; continue; }
+        uint16_t seg = be16(data + p + 2);
+        if ((m >= 0xC0 && m <= 0xC3) || (m >= 0xC5 && m <= 0xC7) || (m >= 0xC9 && m <= 0xCB) ||
+            (m >= 0xCD && m <= 0xCF)) {
+            if (p + 9 > len) return false;
+            info->format = ImageFormat::JPEG;
+            info->height = be16(data + p + 5);
+            info->width = be16(data + p + 7);
+            return true;
+        }
+        p += 2 + seg;
+    }
+    return false;
+}
+
+// Smallest downscale (shift 0..3) that fits max_w x max_h, or 3 if none does
+inline uint8_t image_pick_scale(int width, int height, int max_w, int max_h) {
+    for (uint8_t s = 0; s < 3; s++) {
+        if (((width + (1 << s) - 1) >> s) <= max_w && ((height + (1 << s) - 1) >> s) <= max_h) return s;
+    }
+    return 3;
+}
+
+class JpegDecoder {
+public:
+    static const int MAX_WIDTH = 256;                 // Scaled output width
+    static const int MAX_ROW_BYTES = MAX_WIDTH * 16;  // One MCU row at 2x2 sampling
+
+    bool decode(const uint8_t* data, size_t len, uint8_t shift, const RowSink& sink) {
+        _error = nullptr;
+        _data = data;
+        _len = len;
+        _shift = shift > 3 ? 3 : shift;
+        _ncomp = 0;
+        _restart_interval = 0;
+        _width = _height = 0;
+        return parse(sink);
+    }
+
+    const char* error() const { return _error ? _error : "ok"; }
+    int width() const { return _width; }
+    int height() const { return _height; }
+
+private:
+    struct Huffman {
+        uint16_t fast[256];        // (length << 8) | value for codes <= 8 bits
+        int32_t maxcode[18];
+        int32_t valptr[17];
+        int32_t mincode[17];
+        uint8_t values[256];
+        bool present;
+    };
+
+    struct Component {
+        uint8_t id, h, v, tq, td, ta;
+        int dc_pred;
+    };
+
+    bool fail(const char* why) {
+        _error = why;
+        return false;
+    }
+
+    bool parse(const RowSink& sink) {
+        using namespace image_decoder_detail;
+        if (_len < 4 || _data[0] != 0xFF || _data[1] != 0xD8) return fail("not a JPEG");
+        for (int i = 0; i < 4; i++) _qt_present[i] = false;
+        for (int i = 0; i < 2; i++) _dc[i].present = _ac[i].present = false;
+        size_t p = 2;
+        while (p + 4 <= _len) {
+            if (_data[p] != 0xFF) return fail("bad marker");
+            uint8_t m = _data[p + 1];
+            if (m == 0xFF) { p++; continue; }
+            if (m == 0xD9) break;
+            uint16_t seg = be16(_data + p + 2);
+            const uint8_t* s = _data + p + 4;
+            size_t n = seg >= 2 ? seg - 2 : 0;
+            if (p + 2 + seg > _len) return fail("truncated segment");
+            switch (m) {
+                case 0xC0:
+                case 0xC1:
+                    if (!read_sof(s, n)) return false;
+                    break;
+                case 0xC2:
+                case 0xC6:
+                case 0xCA:
+                case 0xCE:
+                    return fail("progressive JPEG not supported");
+                case 0xC3: case 0xC5: case 0xC7: case 0xC9: case 0xCB: case 0xCD: case 0xCF:
+                    return fail("unsupported JPEG process");
+                case 0xC4:
+                    if (!read_dht(s, n)) return false;
+                    break;
+                case 0xDB:
+                    if (!read_dqt(s, n)) return false;
+                    break;
+                case 0xDD:
+                    if (n < 2) return fail("bad DRI");
+                    _restart_interval = be16(s);
+                    break;
+                case 0xDA: {
+                    if (!read_sos(s, n)) return false;
+                    _p = s + n;
+                    _end = _data + _len;
+                    return decode_scan(sink);
+                }
+                default:
+                    break;  // APPn, COM, ...
+            }
+            p += 2 + seg;
+        }
+        return fail("no image data");
+    }
+
+    bool read_sof(const uint8_t* s, size_t n) {
+        using namespace image_decoder_detail;
+        if (n < 6 || s[0] != 8) return fail("only 8-bit JPEG supported");
+        _height = be16(s + 1);
+        _width = be16(s + 3);
+        _ncomp = s[5];
+        if (_width == 0 || _height == 0) return fail("bad size");
+        if (_ncomp != 1 && _ncomp != 3) return fail("only gray or YCbCr JPEG supported");
+        if (n < 6 + 3u * _ncomp) return fail("bad SOF");
+        _hmax = _vmax = 1;
+        for (int i = 0; i < _ncomp; i++) {
+            Component& c = _comp[i];
+            c.id = s[6 + i * 3];
+            c.h = s[7 + i * 3] >> 4;
+            c.v = s[7 + i * 3] & 15;
+            c.tq = s[8 + i * 3] & 3;
+            if (c.h < 1 || c.h > 2 || c.v < 1 || c.v > 2) return fail("unsupported sampling");
+            if (c.h > _hmax) _hmax = c.h;
+            if (c.v > _vmax) _vmax = c.v;
+        }
+        if (_ncomp == 1) _comp[0].h = _comp[0].v = _hmax = _vmax = 1;
+        if (_comp[0].h != _hmax || _comp[0].v != _vmax) return fail("unsupported sampling");
+        return true;
+    }
+
+    bool read_dqt(const uint8_t* s, size_t n) {
+        size_t p = 0;
+        while (p < n) {
+            uint8_t pq = s[p] >> 4, tq = s[p] & 3;
+            p++;
+            if (p + (pq ? 128 : 64) > n) return fail("bad DQT");
+            for (int k = 0; k < 64; k++) {
+                _qt[tq][k] = pq ? (uint16_t) (s[p + 2 * k] << 8 | s[p + 2 * k + 1]) : s[p + k];
+            }
+            _qt_present[tq] = true;
+            p += pq ? 128 : 64;
+        }
+        return true;
+    }
+
+    bool read_dht(const uint8_t* s, size_t n) {
+        size_t p = 0;
+        while (p + 17 <= n) {
+            uint8_t tc = s[p] >> 4, th = s[p] & 15;
+            if (tc > 1) return fail("bad DHT");
+            if (th > 1) return fail("only two Huffman tables per class supported");
+            const uint8_t* bits = s + p + 1;
+            int total = 0;
+            for (int i = 0; i < 16; i++) total += bits[i];
+            if (total > 256 || p + 17 + total > n) return fail("bad DHT");
+            Huffman& h = tc ? _ac[th] : _dc[th];
+            memcpy(h.values, s + p + 17, total);
+            if (!build_huffman(h, bits)) return fail("bad DHT");
+            p += 17 + total;
+        }
+        return true;
+    }
+
+    // False if the counts don't form a prefix code (more codes of a length
+    // than are left), which would also run past the fast table
+    static bool build_huffman(Huffman& h, const uint8_t* bits) {
+        h.present = false;
+        memset(h.fast, 0, sizeof(h.fast));
+        int code = 0, k = 0;
+        for (int len = 1; len <= 16; len++) {
+            if (code + bits[len - 1] > (1 << len)) return false;
+            h.valptr[len] = k;
+            h.mincode[len] = code;
+            for (int i = 0; i < bits[len - 1]; i++, k++, code++) {
+                if (len <= 8) {
+                    int shift = 8 - len;
+                    for (int j = 0; j < (1 << shift); j++) {
+                        h.fast[(code << shift) | j] = (uint16_t) (len << 8 | h.values[k]);
+                    }
+                }
+            }
+            h.maxcode[len] = bits[len - 1] ? code - 1 : -1;
+            code <<= 1;
+        }
+        h.maxcode[17] = 0x7FFFFFFF;
+        h.present = true;
+        return true;
+    }
+
+    bool read_sos(const uint8_t* s, size_t n) {
+        if (n < 1) return fail("bad SOS");
+        int ns = s[0];
+        if (ns != _ncomp) return fail("multi-scan JPEG not supported");
+        if (n < 1 + 2u * ns + 3) return fail("bad SOS");
+        for (int i = 0; i < ns; i++) {
+            uint8_t id = s[1 + i * 2];
+            int c = 0;
+            while (c < _ncomp && _comp[c].id != id) c++;
+            if (c == _ncomp) return fail("bad SOS component");
+            _comp[c].td = s[2 + i * 2] >> 4 & 1;
+            _comp[c].ta = s[2 + i * 2] & 1;
+            if (!_dc[_comp[c].td].present || !_ac[_comp[c].ta].present) return fail("missing Huffman table");
+            if (!_qt_present[_comp[c].tq]) return fail("missing quant table");
+        }
+        return true;
+    }
+
+    // --- Entropy decoding ---
+
+    void reset_bits() {
+        _bits = 0;
+        _nbits = 0;
+        _marker = false;
+    }
+
+    void fill() {
+        while (_nbits <= 24) {
+            uint32_t b = 0;
+            if (!_marker && _p < _end) {
+                b = *_p;
+                if (b == 0xFF) {
+                    uint8_t next = _p + 1 < _end ? _p[1] : 0xD9;
+                    if (next == 0x00) {
+                        _p += 2;
+                    } else {
+                        _marker = true;  // RSTn/EOI: feed zeros until the caller resyncs
+                        b = 0;
+                    }
+                } else {
+                    _p++;
+                }
+            }
+            _bits |= b << (24 - _nbits);
+            _nbits += 8;
+        }
+    }
+
+    int get_bits(int n) {
+        if (n == 0) return 0;
+        fill();
+        int v = (int) (_bits >> (32 - n));
+        _bits <<= n;
+        _nbits -= n;
+        return v;
+    }
+
+    int receive_extend(int s) {
+        if (s == 0) return 0;
+        int v = get_bits(s);
+        return v < (1 << (s - 1)) ? v - (1 << s) + 1 : v;
+    }
+
+    int decode_huffman(const Huffman& h) {
+        fill();
+        uint16_t e = h.fast[_bits >> 24];
+        if (e) {
+            int len = e >> 8;
+            _bits <<= len;
+            _nbits -= len;
+            return e & 0xFF;
+        }
+        for (int len = 9; len <= 16; len++) {
+            int32_t code = (int32_t) (_bits >> (32 - len));
+            if (code <= h.maxcode[len]) {
+                _bits <<= len;
+                _nbits -= len;
+                return h.values[h.valptr[len] + code - h.mincode[len]];
+            }
+        }
+        return -1;
+    }
+
+    // Decode one block; coefficients are kept only for luma (keep != nullptr)
+    bool decode_block(Component& c, float* keep, const uint16_t* q) {
+        int t = decode_huffman(_dc[c.td]);
+        if (t < 0 || t > 15) return fail("bad Huffman code");
+        c.dc_pred += receive_extend(t);
+        if (keep) {
+            keep[0] = (float) (c.dc_pred * q[0]);
+            if (_shift < 3) {
+                for (int i = 1; i < 64; i++) keep[i] = 0;
+            }
+        }
+        for (int k = 1; k < 64;) {
+            int rs = decode_huffman(_ac[c.ta]);
+            if (rs < 0) return fail("bad Huffman code");
+            int r = rs >> 4, s = rs & 15;
+            if (s == 0) {
+                if (r != 15) break;  // EOB
+                k += 16;
+                continue;
+            }
+            k += r;
+            if (k > 63) return fail("bad AC run");
+            int v = receive_extend(s);
+            if (keep && _shift < 3) keep[ZIGZAG[k]] = (float) (v * q[k]);
+            k++;
+        }
+        return true;
+    }
+
+    // 8x8 IDCT box-averaged down to NxN, into out (stride in bytes)
+    void idct(const float* coef, uint8_t* out, int stride) {
+        using namespace image_decoder_detail;
+        int n = 8 >> _shift;
+        if (n == 1) {
+            out[0] = clamp8((int) lrintf(coef[0] / 8.0f) + 128);
+            return;
+        }
+        const float* t = _cos[_shift];
+        float tmp[64];
+        for (int v = 0; v < 8; v++) {
+            const float* row = coef + v * 8;
+            bool zero = true;
+            for (int u = 1; u < 8 && zero; u++) zero = row[u] == 0;
+            for (int x = 0; x < n; x++) {
+                float sum = row[0] * t[x * 8];
+                if (!zero) {
+                    for (int u = 1; u < 8; u++) sum += row[u] * t[x * 8 + u];
+                }
+                tmp[v * n + x] = sum;
+            }
+        }
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                float sum = 0;
+                for (int v = 0; v < 8; v++) sum += tmp[v * n + x] * t[y * 8 + v];
+                out[y * stride + x] = clamp8((int) lrintf(sum) + 128);
+            }
+        }
+    }
+
+    // _cos[s][x * 8 + u]: basis u averaged over output cell x, 2^s pixels wide
+    void build_cos() {
+        const float PI = 3.14159265358979f;
+        for (int s = 0; s < 3; s++) {
+            int n = 8 >> s, cell = 1 << s;
+            for (int x = 0; x < n; x++) {
+                for (int u = 0; u < 8; u++) {
+                    float cu = u == 0 ? 0.70710678f : 1.0f;
+                    float sum = 0;
+                    for (int k = 0; k < cell; k++) sum += cosf((2 * (x * cell + k) + 1) * u * PI / 16);
+                    _cos[s][x * 8 + u] = 0.5f * cu * sum / cell;
+                }
+            }
+        }
+    }
+
+    bool restart() {
+        // Skip to just past the RSTn marker
+        while (_p + 1 < _end && !(_p[0] == 0xFF && _p[1] >= 0xD0 && _p[1] <= 0xD7)) _p++;
+        if (_p + 1 >= _end) return fail("missing restart marker");
+        _p += 2;
+        reset_bits();
+        for (int i = 0; i < _ncomp; i++) _comp[i].dc_pred = 0;
+        return true;
+    }
+
+    bool decode_scan(const RowSink& sink) {
+        if (!_cos_ready) {
+            build_cos();
+            _cos_ready = true;
+        }
+        int bs = 8 >> _shift;                       // Scaled block size
+        int mcu_w = 8 * _hmax, mcu_h = 8 * _vmax;
+        int mcus_x = (_width + mcu_w - 1) / mcu_w;
+        int mcus_y = (_height + mcu_h - 1) / mcu_h;
+        int row_w = mcus_x * _hmax * bs;            // Scaled pixels in the MCU row buffer
+        int rows = _vmax * bs;
+        int out_w = (_width + (1 << _shift) - 1) >> _shift;
+        int out_h = (_height + (1 << _shift) - 1) >> _shift;
+        if (out_w > MAX_WIDTH || row_w * rows > MAX_ROW_BYTES) return fail("image too wide for this scale");
+
+        reset_bits();
+        for (int i = 0; i < _ncomp; i++) _comp[i].dc_pred = 0;
+        float coef[64];
+        int mcu_count = 0;
+        int y_out = 0;
+        for (int my = 0; my < mcus_y; my++) {
+            for (int mx = 0; mx < mcus_x; mx++) {
+                if (_restart_interval && mcu_count && mcu_count % _restart_interval == 0) {
+                    if (!restart()) return false;
+                }
+                mcu_count++;
+                for (int ci = 0; ci < _ncomp; ci++) {
+                    Component& c = _comp[ci];
+                    for (int by = 0; by < c.v; by++) {
+                        for (int bx = 0; bx < c.h; bx++) {
+                            bool luma = ci == 0;
+                            if (!decode_block(c, luma ? coef : nullptr, _qt[c.tq])) return false;
+                            if (luma) {
+                                int x = (mx * _hmax + bx) * bs;
+                                idct(coef, _row + by * bs * row_w + x, row_w);
+                            }
+                        }
+                    }
+                }
+            }
+            for (int r = 0; r < rows && y_out < out_h; r++, y_out++) {
+                sink(y_out, _row + r * row_w, out_w);
+            }
+        }
+        return true;
+    }
+
+    static const uint8_t ZIGZAG[64];
+
+    const uint8_t* _data;
+    size_t _len;
+    const uint8_t* _p;
+    const uint8_t* _end;
+    uint32_t _bits;
+    int _nbits;
+    bool _marker;
+    const char* _error = nullptr;
+    uint8_t _shift;
+    int _width, _height;
+    int _ncomp;
+    int _hmax, _vmax;
+    uint16_t _restart_interval;
+    Component _comp[3];
+    uint16_t _qt[4][64];
+    bool _qt_present[4];
+    Huffman _dc[2];
+    Huffman _ac[2];
+    float _cos[3][64];
+    bool _cos_ready = false;
+    uint8_t _row[MAX_ROW_BYTES];
+};
+
+// Natural (row-major) index of each zigzag position
+const uint8_t JpegDecoder::ZIGZAG[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+class PngDecoder {
+public:
+    static const int MAX_WIDTH = 256;       // Scaled output width
+    static const int MAX_SOURCE_WIDTH = 4096;
+    static const uint32_t WINDOW_BYTES = 4096;  // zlib CINFO <= 4
+    static const size_t MAX_STRIDE = 2048;      // Bytes per unfiltered row: 680 px RGB, 512 px RGBA
+
+    bool decode(const uint8_t* data, size_t len, uint8_t shift, const RowSink& sink) {
+        _error = nullptr;
+        _data = data;
+        _len = len;
+        _shift = shift > 3 ? 3 : shift;
+        _working = 0;
+        return parse(sink);
+    }
+
+    const char* error() const { return _error ? _error : "ok"; }
+    int width() const { return _width; }
+    int height() const { return _height; }
+    size_t working_bytes() const { return _working; }  // Of the static buffers, last decode
+
+private:
+    bool fail(const char* why) {
+        _error = why;
+        return false;
+    }
+
+    bool parse(const RowSink& sink) {
+        using namespace image_decoder_detail;
+        if (_len < 33 || memcmp(_data, PNG_SIGNATURE, 8) != 0) return fail("not a PNG");
+        if (memcmp(_data + 12, "IHDR", 4) != 0) return fail("missing IHDR");
+        const uint8_t* h = _data + 16;
+        _width = (int) be32(h);
+        _height = (int) be32(h + 4);
+        _depth = h[8];
+        _color = h[9];
+        if (h[12] != 0) return fail("interlaced PNG not supported");
+        if (_width <= 0 || _height <= 0 || _width > MAX_SOURCE_WIDTH) return fail("bad size");
+        switch (_color) {
+            case 0: _channels = 1; break;
+            case 2: _channels = 3; break;
+            case 3: _channels = 1; break;
+            case 4: _channels = 2; break;
+            case 6: _channels = 4; break;
+            default: return fail("bad color type");
+        }
+        if (_depth != 1 && _depth != 2 && _depth != 4 && _depth != 8 && _depth != 16) return fail("bad bit depth");
+        if ((_color == 2 || _color == 4 || _color == 6) && _depth < 8) return fail("bad bit depth");
+        if (_color == 3 && _depth == 16) return fail("bad bit depth");
+        _out_w = (_width + (1 << _shift) - 1) >> _shift;
+        if (_out_w > MAX_WIDTH) return fail("image too wide for this scale");
+        int bits_pp = _channels * _depth;
+        _bpp = (bits_pp + 7) / 8;
+        _stride = ((size_t) _width * bits_pp + 7) / 8;
+        if (_stride > MAX_STRIDE) return fail("PNG rows too long");
+
+        // Palette and transparency come before the first IDAT
+        for (int i = 0; i < 256; i++) _palette[i] = (uint8_t) i;
+        _trns_gray = -1;
+        size_t p = 8;
+        _idat = nullptr;
+        while (p + 12 <= _len) {
+            uint32_t n = be32(_data + p);
+            const uint8_t* type = _data + p + 4;
+            const uint8_t* body = _data + p + 8;
+            if (p + 12 + n > _len) return fail("truncated chunk");
+            if (memcmp(type, "PLTE", 4) == 0) {
+                for (uint32_t i = 0; i < n / 3 && i < 256; i++) {
+                    _palette[i] = gray(body[i * 3], body[i * 3 + 1], body[i * 3 + 2]);
+                }
+            } else if (memcmp(type, "tRNS", 4) == 0) {
+                if (_color == 3) {
+                    for (uint32_t i = 0; i < n && i < 256; i++) _palette[i] = over_white(_palette[i], body[i]);
+                } else if (_color == 0 && n >= 2) {
+                    _trns_gray = be16(body);
+                }
+            } else if (memcmp(type, "IDAT", 4) == 0) {
+                _idat = _data + p;
+                break;
+            }
+            p += 12 + n;
+        }
+        if (!_idat) return fail("no image data");
+        _chunk = _idat + 8;
+        _chunk_end = _chunk + be32(_idat);
+        return inflate(sink);
+    }
+
+    static uint8_t gray(int r, int g, int b) { return (uint8_t) ((r * 77 + g * 150 + b * 29 + 128) >> 8); }
+    static uint8_t over_white(int v, int a) { return (uint8_t) ((v * a + 255 * (255 - a) + 127) / 255); }
+
+    // --- zlib stream across IDAT chunks ---
+
+    int next_byte() {
+        using namespace image_decoder_detail;
+        while (_chunk >= _chunk_end) {
+            const uint8_t* next = _chunk_end + 4;  // Skip CRC
+            if (next + 8 > _data + _len || memcmp(next + 4, "IDAT", 4) != 0) return -1;
+            _chunk = next + 8;
+            _chunk_end = _chunk + be32(next);
+            if (_chunk_end > _data + _len) return -1;
+        }
+        return *_chunk++;
+    }
+
+    int bits(int need) {
+        while (_bitcnt < need) {
+            int b = next_byte();
+            if (b < 0) {
+                _eof = true;
+                b = 0;
+            }
+            _bitbuf |= (uint32_t) b << _bitcnt;
+            _bitcnt += 8;
+        }
+        int v = (int) (_bitbuf & ((1u << need) - 1));
+        _bitbuf >>= need;
+        _bitcnt -= need;
+        return v;
+    }
+
+    struct Huffman {
+        uint16_t count[16];
+        uint16_t symbol[288];
+    };
+
+    static int build(Huffman& h, const uint8_t* lengths, int n) {
+        for (int i = 0; i < 16; i++) h.count[i] = 0;
+        for (int i = 0; i < n; i++) h.count[lengths[i]]++;
+        if (h.count[0] == n) return 0;
+        int left = 1;
+        for (int len = 1; len < 16; len++) {
+            left <<= 1;
+            left -= h.count[len];
+            if (left < 0) return -1;
+        }
+        uint16_t offs[16];
+        offs[1] = 0;
+        for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + h.count[len];
+        for (int i = 0; i < n; i++) {
+            if (lengths[i]) h.symbol[offs[lengths[i]]++] = (uint16_t) i;
+        }
+        return left;
+    }
+
+    int decode(const Huffman& h) {
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len < 16; len++) {
+            code |= bits(1);
+            int count = h.count[len];
+            if (code - count < first) return h.symbol[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    bool inflate(const RowSink& sink) {
+        int cmf = next_byte(), flg = next_byte();
+        if (cmf < 0 || flg < 0 || (cmf & 15) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) {
+            return fail("bad zlib header");
+        }
+        _window_size = 1u << ((cmf >> 4) + 8);
+        if (_window_size > 32768) return fail("bad zlib window");
+        if (_window_size > WINDOW_BYTES) return fail("zlib window over 4 KB");
+
+        _working = _window_size + 2 * (_stride + 1) + _out_w * sizeof(uint16_t) * 2;
+        _prev = _lines;
+        _cur = _lines + _stride + 1;
+        memset(_prev, 0, _stride + 1);
+        memset(_sums, 0, _out_w * sizeof(uint16_t) * 2);
+        _wpos = 0;
+        _line_pos = 0;
+        _y = 0;
+        _y_out = 0;
+        _rows_in_sum = 0;
+        _bitbuf = 0;
+        _bitcnt = 0;
+        _eof = false;
+        _sink = &sink;
+
+        int last;
+        do {
+            last = bits(1);
+            int type = bits(2);
+            bool ok;
+            if (type == 0) ok = stored();
+            else if (type == 1) ok = fixed();
+            else if (type == 2) ok = dynamic();
+            else return fail("bad deflate block");
+            if (!ok) return false;
+            if (_eof) return fail("truncated image data");
+        } while (!last && _y < _height);
+
+        if (_y < _height) return fail("truncated image data");
+        return true;
+    }
+
+    void put(uint8_t b) {
+        _window[_wpos++ & (_window_size - 1)] = b;
+        if (_y >= _height) return;
+        _cur[_line_pos++] = b;
+        if (_line_pos == _stride + 1) {
+            scanline();
+            _line_pos = 0;
+        }
+    }
+
+    bool stored() {
+        _bitbuf = 0;
+        _bitcnt = 0;
+        int lo = next_byte(), hi = next_byte(), nlo = next_byte(), nhi = next_byte();
+        if (nhi < 0) return fail("truncated image data");
+        int n = lo | hi << 8;
+        if ((n ^ 0xFFFF) != (nlo | nhi << 8)) return fail("bad stored block");
+        while (n--) {
+            int b = next_byte();
+            if (b < 0) return fail("truncated image data");
+            put((uint8_t) b);
+        }
+        return true;
+    }
+
+    bool fixed() {
+        uint8_t lengths[288];
+        int i = 0;
+        for (; i < 144; i++) lengths[i] = 8;
+        for (; i < 256; i++) lengths[i] = 9;
+        for (; i < 280; i++) lengths[i] = 7;
+        for (; i < 288; i++) lengths[i] = 8;
+        build(_lit, lengths, 288);
+        for (i = 0; i < 30; i++) lengths[i] = 5;
+        build(_dist, lengths, 30);
+        return codes(_lit, _dist);
+    }
+
+    bool dynamic() {
+        static const uint8_t ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        int nlen = bits(5) + 257, ndist = bits(5) + 1, ncode = bits(4) + 4;
+        if (nlen > 286 || ndist > 30) return fail("bad deflate lengths");
+        uint8_t lengths[320];
+        int i = 0;
+        for (; i < ncode; i++) lengths[ORDER[i]] = (uint8_t) bits(3);
+        for (; i < 19; i++) lengths[ORDER[i]] = 0;
+        if (build(_lit, lengths, 19) != 0) return fail("bad deflate code lengths");
+        for (i = 0; i < nlen + ndist;) {
+            int sym = decode(_lit);
+            if (sym < 0) return fail("bad deflate code");
+            if (sym < 16) {
+                lengths[i++] = (uint8_t) sym;
+                continue;
+            }
+            int len = 0, rep;
+            if (sym == 16) {
+                if (i == 0) return fail("bad deflate repeat");
+                len = lengths[i - 1];
+                rep = 3 + bits(2);
+            } else if (sym == 17) {
+                rep = 3 + bits(3);
+            } else {
+                rep = 11 + bits(7);
+            }
+            if (i + rep > nlen + ndist) return fail("bad deflate repeat");
+            while (rep--) lengths[i++] = (uint8_t) len;
+        }
+        int err = build(_lit, lengths, nlen);
+        if (err < 0 || (err > 0 && nlen - _lit.count[0] != 1)) return fail("bad literal code");
+        err = build(_dist, lengths + nlen, ndist);
+        if (err < 0 || (err > 0 && ndist - _dist.count[0] != 1)) return fail("bad distance code");
+        return codes(_lit, _dist);
+    }
+
+    bool codes(const Huffman& lit, const Huffman& dist) {
+        static const uint16_t LBASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                           35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t LEXT[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                         3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t DBASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                           257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                           8193, 12289, 16385, 24577};
+        static const uint8_t DEXT[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                         7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        for (;;) {
+            int sym = decode(lit);
+            if (sym < 0 || _eof) return fail("bad deflate code");
+            if (sym < 256) {
+                put((uint8_t) sym);
+            } else if (sym == 256) {
+                return true;
+            } else {
+                sym -= 257;
+                if (sym >= 29) return fail("bad length code");
+                int len = LBASE[sym] + bits(LEXT[sym]);
+                int ds = decode(dist);
+                if (ds < 0 || ds >= 30) return fail("bad distance code");
+                uint32_t d = DBASE[ds] + bits(DEXT[ds]);
+                if (d > _wpos || d > _window_size) return fail("distance too far back");
+                while (len--) put(_window[(_wpos - d) & (_window_size - 1)]);
+            }
+        }
+    }
+
+    // --- Scanlines ---
+
+    static uint8_t paeth(int a, int b, int c) {
+        int p = a + b - c;
+        int pa = p > a ? p - a : a - p;
+        int pb = p > b ? p - b : b - p;
+        int pc = p > c ? p - c : c - p;
+        if (pa <= pb && pa <= pc) return (uint8_t) a;
+        return (uint8_t) (pb <= pc ? b : c);
+    }
+
+    void scanline() {
+        uint8_t* line = _cur + 1;
+        const uint8_t* prev = _prev + 1;
+        size_t n = _stride;
+        int bpp = _bpp;
+        switch (_cur[0]) {
+            case 1:
+                for (size_t i = bpp; i < n; i++) line[i] += line[i - bpp];
+                break;
+            case 2:
+                for (size_t i = 0; i < n; i++) line[i] += prev[i];
+                break;
+            case 3:
+                for (size_t i = 0; i < n; i++) {
+                    int left = i >= (size_t) bpp ? line[i - bpp] : 0;
+                    line[i] += (uint8_t) ((left + prev[i]) >> 1);
+                }
+                break;
+            case 4:
+                for (size_t i = 0; i < n; i++) {
+                    int left = i >= (size_t) bpp ? line[i - bpp] : 0;
+                    int upleft = i >= (size_t) bpp ? prev[i - bpp] : 0;
+                    line[i] += paeth(left, prev[i], upleft);
+                }
+                break;
+            default:
+                break;
+        }
+
+        // Gray per pixel, summed into the current box row
+        int cell = _shift;
+        for (int x = 0; x < _width; x++) {
+            _sums[x >> cell] += pixel(line, x);
+        }
+        _rows_in_sum++;
+        _y++;
+        if (_rows_in_sum == (1 << _shift) || _y == _height) emit_row();
+
+        uint8_t* t = _prev;
+        _prev = _cur;
+        _cur = t;
+    }
+
+    uint8_t pixel(const uint8_t* line, int x) const {
+        switch (_color) {
+            case 0: {
+                int v = sample(line, x);
+                if (_trns_gray >= 0 && v == _trns_gray) return 255;
+                return (uint8_t) scale_sample(v);
+            }
+            case 3:
+                return _palette[sample(line, x)];
+            case 2: {
+                int s = _depth == 16 ? 2 : 1;
+                const uint8_t* p = line + x * 3 * s;
+                return gray(p[0], p[s], p[2 * s]);
+            }
+            case 4: {
+                int s = _depth == 16 ? 2 : 1;
+                const uint8_t* p = line + x * 2 * s;
+                return over_white(p[0], p[s]);
+            }
+            default: {
+                int s = _depth == 16 ? 2 : 1;
+                const uint8_t* p = line + x * 4 * s;
+                return over_white(gray(p[0], p[s], p[2 * s]), p[3 * s]);
+            }
+        }
+    }
+
+    // Raw sample for gray/palette (1..16 bits)
+    int sample(const uint8_t* line, int x) const {
+        if (_depth == 8) return line[x];
+        if (_depth == 16) return line[x * 2] << 8 | line[x * 2 + 1];
+        int per_byte = 8 / _depth;
+        int shift = 8 - _depth * (x % per_byte + 1);
+        return (line[x / per_byte] >> shift) & ((1 << _depth) - 1);
+    }
+
+    int scale_sample(int v) const {
+        switch (_depth) {
+            case 1: return v * 255;
+            case 2: return v * 85;
+            case 4: return v * 17;
+            case 16: return v >> 8;
+            default: return v;
+        }
+    }
+
+    void emit_row() {
+        uint8_t* out = reinterpret_cast<uint8_t*>(_sums + _out_w);  // Second half as bytes
+        int cw = 1 << _shift;
+        for (int x = 0; x < _out_w; x++) {
+            int w = (x + 1) * cw <= _width ? cw : _width - x * cw;
+            int count = w * _rows_in_sum;
+            out[x] = (uint8_t) ((_sums[x] + count / 2) / count);
+            _sums[x] = 0;
+        }
+        (*_sink)(_y_out++, out, _out_w);
+        _rows_in_sum = 0;
+    }
+
+    const uint8_t* _data;
+    size_t _len;
+    const char* _error = nullptr;
+    uint8_t _shift;
+    int _width = 0, _height = 0;
+    int _depth, _color, _channels, _bpp;
+    int _out_w;
+    size_t _stride;
+    int _trns_gray;
+    uint8_t _palette[256];
+
+    const uint8_t* _idat;
+    const uint8_t* _chunk;
+    const uint8_t* _chunk_end;
+    uint32_t _bitbuf;
+    int _bitcnt;
+    bool _eof;
+
+    uint8_t _window[WINDOW_BYTES];
+    uint32_t _window_size;
+    uint32_t _wpos;
+    uint8_t _lines[2 * (MAX_STRIDE + 1)];
+    uint8_t* _prev;
+    uint8_t* _cur;
+    size_t _line_pos;
+    uint16_t _sums[MAX_WIDTH * 2];  // Box sums, then the output row as bytes
+    int _rows_in_sum;
+    int _y, _y_out;
+    const RowSink* _sink;
+    size_t _working = 0;
+
+    Huffman _lit, _dist;
+};
+
+// Floyd-Steinberg to 1-bit (MSB first, 1 = dark), centred in the buffer
+class Dither1Bit {
+public:
+    static const int MAX_WIDTH = 256;
+
+    Dither1Bit(uint8_t* buf, int buf_w, int buf_h) : _buf(buf), _buf_w(buf_w), _buf_h(buf_h), _x0(0), _y0(0) {}
+
+    // Where the top-left of the image goes (call once the size is known)
+    void place(int image_w, int image_h) {
+        _x0 = (_buf_w - image_w) / 2;
+        _y0 = (_buf_h - image_h) / 2;
+        memset(_err, 0, sizeof(_err));
+    }
+
+    void clear() { memset(_buf, 0, ((_buf_w + 7) / 8) * _buf_h); }
+
+    void row(int y, const uint8_t* gray, int width) {
+        if (width > MAX_WIDTH) width = MAX_WIDTH;
+        int16_t* cur = _err[y & 1];
+        int16_t* next = _err[(y + 1) & 1];
+        memset(next, 0, sizeof(_err[0]));
+        int by = _y0 + y;
+        int stride = (_buf_w + 7) / 8;
+        for (int x = 0; x < width; x++) {
+            int v = gray[x] + cur[x + 1] / 16;
+            int out = v < 128 ? 0 : 255;
+            int e = v - out;
+            cur[x + 2] += e * 7;
+            next[x] += e * 3;
+            next[x + 1] += e * 5;
+            next[x + 2] += e;
+            int bx = _x0 + x;
+            if (by < 0 || by >= _buf_h || bx < 0 || bx >= _buf_w) continue;
+            uint8_t bit = 0x80 >> (bx & 7);
+            if (out == 0) _buf[by * stride + (bx >> 3)] |= bit;
+            else _buf[by * stride + (bx >> 3)] &= ~bit;
+        }
+    }
+
+    RowSink sink() {
+        return [this](int y, const uint8_t* gray, int width) { row(y, gray, width); };
+    }
+
+private:
+    uint8_t* _buf;
+    int _buf_w, _buf_h;
+    int _x0, _y0;
+    int16_t _err[2][MAX_WIDTH + 2];
+};
+
+class ImageDecoder {
+public:
+    static ImageDecoder& instance() {
+        static ImageDecoder inst;
+        return inst;
+    }
+
+    // Decode at the largest integer scale that fits max_w x max_h.
+    // Returns false (see error()) for unknown or unsupported images.
+    bool decode(const uint8_t* data, size_t len, int max_w, int max_h, const RowSink& sink,
+                ImageInfo* info_out = nullptr) {
+        ImageInfo info;
+        if (!image_probe(data, len, &info)) {
+            _error = "unknown image format";
+            return false;
+        }
+        uint8_t shift = image_pick_scale(info.width, info.height, max_w, max_h);
+        if (info_out) {
+            *info_out = info;
+            info_out->width = (info.width + (1 << shift) - 1) >> shift;
+            info_out->height = (info.height + (1 << shift) - 1) >> shift;
+        }
+        return decode(data, len, info.format, shift, sink);
+    }
+
+    bool decode(const uint8_t* data, size_t len, ImageFormat format, uint8_t shift, const RowSink& sink) {
+        bool ok;
+        if (format == ImageFormat::JPEG) {
+            ok = _jpeg.decode(data, len, shift, sink);
+            _error = _jpeg.error();
+        } else if (format == ImageFormat::PNG) {
+            ok = _png.decode(data, len, shift, sink);
+            _error = _png.error();
+        } else {
+            _error = "unknown image format";
+            ok = false;
+        }
+        return ok;
+    }
+
+    const char* error() const { return _error; }
+    size_t png_working_bytes() const { return _png.working_bytes(); }
+
+    // Static footprint (for memory budgeting)
+    static constexpr size_t storage_bytes() {
+        return sizeof(ImageDecoder);
+    }
+
+private:
+    ImageDecoder() : _error("ok") {}
+
+    JpegDecoder _jpeg;
+    PngDecoder _png;
+    const char* _error;
+};
+
+// Global accessor
+inline ImageDecoder& image_decoder() {
+    return ImageDecoder::instance();
+}
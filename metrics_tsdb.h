@@ -0,0 +1,335 @@
+// Metrics TSDB for Clawd Pager
+// Battery, charging, RSSI, loop and frame time kept on the device at
+// 1 s / 1 min / 15 min resolution, fetched in one go instead of polled.
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <functional>
+
+// Samples go into record(); each tier keeps min/avg/max per bucket:
+//
+//   tier  bucket   blocks  horizon, noisy .. steady (devtools/metrics_tsdb.py --bench)
+//   0     1 s      6       2-5 min
+//   1     1 min    12      2.5-10 h
+//   2     15 min   30      4-15 days
+//
+// About 16 KB static for the five metrics (storage_bytes()).
+//
+// Compaction is exact: every tier aggregates the raw sample min, max, sum
+// and count of its bucket (a minute's avg is the mean of its samples, not
+// of rounded per-second averages). A bucket with no samples is a gap.
+//
+// Storage: each tier of each metric is a ring of fixed 64-byte blocks;
+// a full ring drops its oldest block. A block holds consecutive buckets
+// from its start index as varints of (payload << 2 | tag):
+//   tag 0  flat    zigzag(avg - previous avg)            min = avg = max
+//   tag 1  spread  zigzag(avg - previous avg), then avg - min, max - avg
+//   tag 2  gap     number of empty buckets
+// The first point of a block is relative to 0, so blocks decode alone. A
+// steady gauge costs 1 byte per point.
+//
+// Values are fixed point per metric (SCALE): 87.3 % battery is 873.
+// Time is uptime; dump() carries now and the clock_sync stamp so the host
+// can map buckets to wall time. Bulk fetch (dump_metrics service):
+//   METRICS begin now_s=<uptime> t=<stamp> metrics=5 blocks=<n>
+//   METRICS <metric> <tier> <start bucket> <bucket count> <hex>
+//   METRICS <metric> <tier> open <bucket> <min> <avg> <max> <samples>
+//   METRICS end bytes=<n>
+// devtools/metrics_tsdb.py decodes the log.
+
+enum class Metric : uint8_t {
+    BATTERY = 0,   // %, from battery_level
+    CHARGING = 1,  // 0/1; the avg is the fraction of time on power
+    RSSI = 2,      // dBm
+    LOOP_MS = 3,   // Period of the 20 ms interval: above 20 the main loop ran long
+    FRAME_MS = 4,  // Display lambda time
+    COUNT = 5,
+};
+
+class MetricsTsdb {
+public:
+    static const uint8_t TIERS = 3;
+    static const size_t BLOCK_DATA = 52;
+
+    static const char* name(Metric m) {
+        static const char* NAMES[] = {"battery", "charging", "rssi", "loop_ms", "frame_ms"};
+        return NAMES[(int) m];
+    }
+    static int32_t scale(Metric m) {
+        static const int32_t SCALE[] = {10, 1000, 1, 10, 10};
+        return SCALE[(int) m];
+    }
+    static uint32_t tier_seconds(uint8_t tier) {
+        static const uint32_t SECONDS[TIERS] = {1, 60, 900};
+        return SECONDS[tier];
+    }
+    static uint8_t ring_blocks(uint8_t tier) {
+        static const uint8_t BLOCKS[TIERS] = {6, 12, 30};
+        return BLOCKS[tier];
+    }
+
+    static MetricsTsdb& instance() {
+        static MetricsTsdb inst;
+        return inst;
+    }
+
+    void record(Metric m, float value, uint32_t now_ms) {
+        record_fixed(m, (int32_t) lroundf(value * scale(m)), now_ms);
+    }
+
+    void record_fixed(Metric m, int32_t value, uint32_t now_ms) {
+        if (_tap) _tap(m, value, now_ms);
+        add((uint8_t) m, 0, (uint32_t) (uptime_ms(now_ms) / 1000), value, value, value, 1);
+    }
+
+    // Also hand every sample to tap (fleet_telemetry.h); nullptr to stop
+    typedef void (*Tap)(Metric m, int32_t value, uint32_t now_ms);
+    void set_tap(Tap tap) { _tap = tap; }
+
+    // Bytes held in blocks (all metrics and tiers)
+    size_t bytes_used() const {
+        size_t n = 0;
+        for (const Ring& r : _rings) {
+            for (uint8_t i = 0; i < r.blocks; i++) n += _blocks[r.first + i].used;
+        }
+        return n;
+    }
+
+    size_t blocks_used() const {
+        size_t n = 0;
+        for (const Ring& r : _rings) n += r.blocks;
+        return n;
+    }
+
+    // One call per log line; oldest block first within each metric/tier
+    void dump(uint32_t now_ms, const char* stamp, const std::function<void(const char* line)>& emit) const {
+        char line[40 + BLOCK_DATA * 2];
+        snprintf(line, sizeof(line), "begin now_s=%u t=%s metrics=%d blocks=%u",
+                 (unsigned) (uptime_ms(now_ms) / 1000), stamp, (int) Metric::COUNT, (unsigned) blocks_used());
+        emit(line);
+        for (uint8_t m = 0; m < (uint8_t) Metric::COUNT; m++) {
+            for (uint8_t t = 0; t < TIERS; t++) {
+                const Ring& r = ring(m, t);
+                for (uint8_t i = 0; i < r.blocks; i++) {
+                    const Block& b = _blocks[r.first + (r.head + ring_blocks(t) - r.blocks + 1 + i) % ring_blocks(t)];
+                    int n = snprintf(line, sizeof(line), "%s %u %u %u ", name((Metric) m), t, (unsigned) b.start,
+                                     (unsigned) b.count);
+                    for (uint8_t k = 0; k < b.used; k++) n += snprintf(line + n, sizeof(line) - n, "%02x", b.data[k]);
+                    emit(line);
+                }
+            }
+        }
+        // Buckets still open, each including the open buckets below it that
+        // fall inside it: <metric> <tier> open <bucket> <min> <avg> <max> <samples>
+        for (uint8_t m = 0; m < (uint8_t) Metric::COUNT; m++) {
+            Acc run = {};
+            bool have = false;
+            uint64_t run_s = 0;  // Start of run's bucket, in seconds
+            for (uint8_t t = 0; t < TIERS; t++) {
+                if (_open[m][t]) {
+                    const Acc& a = _acc[m][t];
+                    if (have && run_s / tier_seconds(t) == a.bucket) {
+                        if (a.min < run.min) run.min = a.min;
+                        if (a.max > run.max) run.max = a.max;
+                        run.sum += a.sum;
+                        run.n += a.n;
+                    } else {
+                        run = a;
+                        have = true;
+                    }
+                    run_s = (uint64_t) a.bucket * tier_seconds(t);
+                }
+                if (!have) continue;
+                snprintf(line, sizeof(line), "%s %u open %u %d %d %d %u", name((Metric) m), t,
+                         (unsigned) (run_s / tier_seconds(t)), (int) run.min, (int) avg(run.sum, run.n), (int) run.max,
+                         (unsigned) run.n);
+                emit(line);
+            }
+        }
+        snprintf(line, sizeof(line), "end bytes=%u", (unsigned) bytes_used());
+        emit(line);
+    }
+
+    // Static footprint (for memory budgeting)
+    static constexpr size_t storage_bytes() {
+        return sizeof(MetricsTsdb);
+    }
+
+private:
+    static const uint8_t TAG_FLAT = 0;
+    static const uint8_t TAG_SPREAD = 1;
+    static const uint8_t TAG_GAP = 2;
+    static const uint8_t BLOCKS_PER_METRIC = 6 + 12 + 30;
+
+    struct Block {
+        uint32_t start;   // Bucket index (tier units) of the first point
+        int32_t last;     // Avg of the last point, the base for the next delta
+        uint16_t count;   // Buckets covered, gaps included
+        uint8_t used;
+        uint8_t data[BLOCK_DATA];
+    };
+
+    // Open bucket of one tier
+    struct Acc {
+        uint32_t bucket;
+        int32_t min;
+        int32_t max;
+        int64_t sum;
+        uint32_t n;
+    };
+
+    struct Ring {
+        uint16_t first;   // Index of its first block in _blocks
+        uint8_t head;     // Block being appended to
+        uint8_t blocks;   // Blocks in use
+    };
+
+    MetricsTsdb() : _latest_ms(0), _tap(nullptr) {
+        memset(_blocks, 0, sizeof(_blocks));
+        memset(_acc, 0, sizeof(_acc));
+        memset(_open, 0, sizeof(_open));
+        uint16_t first = 0;
+        for (uint8_t m = 0; m < (uint8_t) Metric::COUNT; m++) {
+            for (uint8_t t = 0; t < TIERS; t++) {
+                Ring& r = _rings[m * TIERS + t];
+                r.first = first;
+                r.head = ring_blocks(t) - 1;
+                r.blocks = 0;
+                first += ring_blocks(t);
+            }
+        }
+    }
+
+    // millis() wraps after 49.7 days: take the 64-bit time nearest the
+    // latest seen, so a caller a little behind is not counted as a wrap
+    uint64_t uptime_ms(uint32_t now_ms) {
+        uint64_t t = resolve(now_ms);
+        if (t > _latest_ms) _latest_ms = t;
+        return t;
+    }
+    uint64_t uptime_ms(uint32_t now_ms) const { return resolve(now_ms); }
+
+    uint64_t resolve(uint32_t now_ms) const {
+        uint64_t t = (_latest_ms & ~(uint64_t) 0xFFFFFFFF) | now_ms;
+        if (t > _latest_ms + 0x80000000ull && t >= ((uint64_t) 1 << 32)) t -= (uint64_t) 1 << 32;
+        else if (t + 0x80000000ull < _latest_ms) t += (uint64_t) 1 << 32;
+        return t;
+    }
+
+    Ring& ring(uint8_t m, uint8_t t) { return _rings[m * TIERS + t]; }
+    const Ring& ring(uint8_t m, uint8_t t) const { return _rings[m * TIERS + t]; }
+
+    // Merge an aggregate into tier t; moving to a later bucket closes the
+    // open one into the ring and passes it up to the next tier
+    void add(uint8_t m, uint8_t t, uint32_t bucket, int32_t mn, int64_t sum, int32_t mx, uint32_t n) {
+        Acc& a = _acc[m][t];
+        if (_open[m][t] && bucket != a.bucket) {
+            if (bucket < a.bucket) return;  // Clock went back: drop
+            append(m, t, a.bucket, a.min, avg(a.sum, a.n), a.max);
+            if (t + 1 < TIERS) {
+                add(m, t + 1, a.bucket / (tier_seconds(t + 1) / tier_seconds(t)), a.min, a.sum, a.max, a.n);
+            }
+            _open[m][t] = false;
+        }
+        if (!_open[m][t]) {
+            a.bucket = bucket;
+            a.min = mn;
+            a.max = mx;
+            a.sum = 0;
+            a.n = 0;
+            _open[m][t] = true;
+        }
+        if (mn < a.min) a.min = mn;
+        if (mx > a.max) a.max = mx;
+        a.sum += sum;
+        a.n += n;
+    }
+
+    // Rounded half up, also for negative sums (RSSI)
+    static int32_t avg(int64_t sum, uint32_t n) {
+        int64_t num = 2 * sum + n, den = 2 * (int64_t) n;
+        int64_t q = num / den;
+        if ((num % den != 0) && ((num < 0) != (den < 0))) q--;
+        return (int32_t) q;
+    }
+
+    void append(uint8_t m, uint8_t t, uint32_t bucket, int32_t mn, int32_t av, int32_t mx) {
+        Ring& r = ring(m, t);
+        Block* b = r.blocks ? &_blocks[r.first + r.head] : nullptr;
+        uint8_t buf[24];
+        if (b && bucket >= b->start + b->count && bucket - b->start < 0xFFFF) {
+            size_t n = 0;
+            uint32_t gap = bucket - (b->start + b->count);
+            if (gap > 0) n = put_varint(buf, ((uint64_t) gap << 2) | TAG_GAP);
+            n = encode(buf, n, b->last, mn, av, mx);
+            if (b->used + n <= BLOCK_DATA) {
+                memcpy(b->data + b->used, buf, n);
+                b->used += n;
+                b->count += gap + 1;
+                b->last = av;
+                return;
+            }
+        }
+        // New block (evicts the oldest when the ring is full)
+        r.head = (r.head + 1) % ring_blocks(t);
+        if (r.blocks < ring_blocks(t)) r.blocks++;
+        b = &_blocks[r.first + r.head];
+        b->start = bucket;
+        b->count = 1;
+        b->used = (uint8_t) encode(b->data, 0, 0, mn, av, mx);
+        b->last = av;
+    }
+
+    static size_t encode(uint8_t* out, size_t n, int32_t last, int32_t mn, int32_t av, int32_t mx) {
+        int64_t delta = (int64_t) av - last;
+        uint64_t zz = delta < 0 ? ((uint64_t) (-(delta + 1)) << 1) | 1 : (uint64_t) delta << 1;
+        if (mn == av && mx == av) return n + put_varint(out + n, zz << 2 | TAG_FLAT);
+        n += put_varint(out + n, zz << 2 | TAG_SPREAD);
+        n += put_varint(out + n, (uint64_t) ((int64_t) av - mn));
+        return n + put_varint(out + n, (uint64_t) ((int64_t) mx - av));
+    }
+
+    static size_t put_varint(uint8_t* out, uint64_t v) {
+        size_t n = 0;
+        while (v >= 0x80) {
+            out[n++] = (uint8_t) (v | 0x80);
+            v >>= 7;
+        }
+        out[n++] = (uint8_t) v;
+        return n;
+    }
+
+    Block _blocks[(size_t) Metric::COUNT * BLOCKS_PER_METRIC];
+    Ring _rings[(size_t) Metric::COUNT * TIERS];
+    Acc _acc[(size_t) Metric::COUNT][TIERS];
+    bool _open[(size_t) Metric::COUNT][TIERS];
+    uint64_t _latest_ms;
+    Tap _tap;
+};
+
+// Times a scope into a metric, in ms (early returns included):
+//   MetricTimer frame_timer(Metric::FRAME_MS, micros, millis);
+class MetricTimer {
+public:
+    typedef unsigned long (*Clock)();
+
+    MetricTimer(Metric m, Clock clock_us, Clock clock_ms) : _m(m), _us(clock_us), _ms(clock_ms), _start(clock_us()) {}
+    ~MetricTimer() {
+        MetricsTsdb::instance().record(_m, (uint32_t) (_us() - _start) / 1000.0f, (uint32_t) _ms());
+    }
+
+private:
+    Metric _m;
+    Clock _us;
+    Clock _ms;
+    unsigned long _start;
+};
+
+// Global accessor
+inline MetricsTsdb& metrics_tsdb() {
+    return MetricsTsdb::instance();
+}
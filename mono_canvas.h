@@ -0,0 +1,337 @@
+// Mono Canvas for Clawd Pager
+// Word-wide drawing straight into 1-bit framebuffers: the ePaper buffer
+// and ClawdMediaLink::image_buffer.
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// ESPHome draws every primitive pixel by pixel (filled_rectangle ->
+// horizontal_line -> draw_pixel_at -> clip, rotate, bounds, one bit). On a
+// 1-bit buffer a row of a rectangle is a run of bits, so here:
+// - Rectangles and horizontal lines are spans of a big-endian bitstream:
+//   a masked 32-bit read-modify-write at each end, whole words between.
+//   A full-width rectangle is a single span.
+// - Vertical lines are one byte op per row.
+// - Blits (glyphs, sprites, 1-bit images) are shifted into the
+//   destination a word at a time and OR'd (or AND-NOT'd) in; all-blank
+//   words of a transparent source are skipped.
+// - Everything is clipped once per primitive, never per pixel.
+//
+// Layout: MSB-first, row r starts at bit r * stride_bits (default: width
+// rounded up to bytes, the image_buffer / QrCode::render_1bit layout).
+// ESPHome's waveshare_epaper buffer is the same with stride = width and
+// ink (black) as 0 bits. No rotation: draw unrotated, or use the pixel
+// API for rotated displays. Word ops need a 4-byte aligned buffer (others
+// fall back to byte ops); words that run past the buffer end use bytes.
+//
+// Glyphs: MonoFont is a packed 1-bit bitstream per glyph, row-major with
+// stride = glyph width, which is also how ESPHome stores 1 bpp font
+// glyphs, so those can go through blit() too.
+//
+// devtools/mono_canvas.py benches this against the pixel path on the
+// ePaper dashboard layouts (EPAPER_DESIGN.md).
+//
+// Usage:
+//   MonoCanvas canvas(image_buffer, 240, 135);                      // 1 = dark
+//   MonoCanvas epd(buffer, 200, 200, MonoCanvas::INK_ZERO, 200);  // waveshare
+//   epd.clear(false);
+//   epd.fill_rect(0, 0, 200, 30, true);
+//   epd.text(5, 8, font, "14:23", false);
+
+struct MonoGlyph {
+    uint32_t offset;   // First bit of the glyph in MonoFont::bitmap
+    uint8_t width;
+    uint8_t height;
+    int8_t x_off;      // From the pen position
+    int8_t y_off;      // From the top of the line
+    uint8_t advance;
+};
+
+struct MonoFont {
+    const uint8_t* bitmap;
+    const MonoGlyph* glyphs;
+    uint8_t first;     // Code of glyphs[0]
+    uint8_t count;
+    uint8_t line_height;
+};
+
+class MonoCanvas {
+public:
+    enum Ink : uint8_t {
+        INK_ZERO = 0,  // "on" clears bits (waveshare_epaper)
+        INK_ONE = 1,   // "on" sets bits (image_buffer, dark_is_set)
+    };
+    static const int TEXT_CHUNK = 32;  // Glyphs placed per pass of text()
+
+    MonoCanvas(uint8_t* buf, int width, int height, Ink ink = INK_ONE, int stride_bits = 0)
+        : _buf(buf), _w(width), _h(height), _stride(stride_bits > 0 ? (uint32_t) stride_bits : ((width + 7) / 8) * 8),
+          _bytes((_stride * (uint32_t) height + 7) / 8), _ink(ink), _aligned(((uintptr_t) buf & 3) == 0), _ops(0) {}
+
+    int width() const { return _w; }
+    int height() const { return _h; }
+
+    void clear(bool on) {
+        memset(_buf, bit(on) ? 0xFF : 0x00, _bytes);
+        count(_bytes / 4);
+    }
+
+    void fill_rect(int x, int y, int w, int h, bool on) {
+        if (!clip(x, y, w, h)) return;
+        uint8_t b = bit(on);
+        if (w == (int) _stride) {
+            span((uint32_t) y * _stride, (uint32_t) w * h, b);  // Rows are contiguous
+            return;
+        }
+        uint32_t start = (uint32_t) y * _stride + x;
+        for (int r = 0; r < h; r++, start += _stride) span(start, (uint32_t) w, b);
+    }
+
+    // Same signature as ESPHome's, so QrCode::draw() can target a canvas
+    void filled_rectangle(int x, int y, int w, int h, bool on) { fill_rect(x, y, w, h, on); }
+
+    void hline(int x, int y, int w, bool on) { fill_rect(x, y, w, 1, on); }
+
+    void vline(int x, int y, int h, bool on) {
+        int w = 1;
+        if (!clip(x, y, w, h)) return;
+        uint32_t pos = (uint32_t) y * _stride + x;
+        if (bit(on)) {
+            for (int r = 0; r < h; r++, pos += _stride) _buf[pos >> 3] |= 0x80 >> (pos & 7);
+        } else {
+            for (int r = 0; r < h; r++, pos += _stride) _buf[pos >> 3] &= ~(0x80 >> (pos & 7));
+        }
+        count(h);
+    }
+
+    void rect(int x, int y, int w, int h, bool on) {
+        if (w <= 0 || h <= 0) return;
+        hline(x, y, w, on);
+        if (h > 1) hline(x, y + h - 1, w, on);
+        if (h > 2) {
+            vline(x, y + 1, h - 2, on);
+            if (w > 1) vline(x + w - 1, y + 1, h - 2, on);
+        }
+    }
+
+    // Draw the 1 bits of a 1-bit source (MSB first, row r at src_bit +
+    // r * src_stride) in "on"; opaque also draws its 0 bits in !on
+    void blit(int x, int y, const uint8_t* src, uint32_t src_bit, int w, int h, uint32_t src_stride, bool on,
+              bool opaque = false) {
+        int sx = x < 0 ? -x : 0, sy = y < 0 ? -y : 0;
+        int cw = w, ch = h;
+        if (!clip(x, y, cw, ch)) return;
+        if (cw <= 0) return;
+        uint8_t b = bit(on);
+        src_bit += (uint32_t) sy * src_stride + sx;
+        uint32_t dst = (uint32_t) y * _stride + x;
+        for (int r = 0; r < ch; r++, src_bit += src_stride, dst += _stride) {
+            uint32_t s = src_bit, d = dst, n = (uint32_t) cw;
+            while (n > 0) {
+                uint32_t shift = d & 31;
+                uint32_t k = 32 - shift < n ? 32 - shift : n;  // Up to the next destination word
+                uint32_t bits = fetch(src, s, k) >> shift;
+                uint32_t mask = (k == 32 ? 0xFFFFFFFFu : ~(0xFFFFFFFFu >> k)) >> shift;
+                if (opaque) {
+                    rmw(d >> 5, bits, b);
+                    rmw(d >> 5, mask & ~bits, b ^ 1);
+                } else if (bits) {
+                    rmw(d >> 5, bits, b);
+                }
+                s += k;
+                d += k;
+                n -= k;
+            }
+        }
+    }
+
+    // Returns the pen x after the text; y is the top of the line. Drawn a
+    // row at a time across up to TEXT_CHUNK glyphs: glyph rows are OR'd
+    // into a two-word window, so each destination word is written once
+    // per row instead of once per glyph.
+    int text(int x, int y, const MonoFont& font, const char* str, bool on) {
+        struct Placed {
+            const MonoGlyph* g;
+            int x;
+        };
+        Placed placed[TEXT_CHUNK];
+        uint8_t b = bit(on);
+        while (*str) {
+            int n = 0, top = 255, bottom = 0;
+            for (; *str && n < TEXT_CHUNK; str++) {
+                const MonoGlyph* g = glyph(font, *str);
+                if (!g) continue;
+                if (g->width && g->height) {
+                    if (g->width > 32) {  // Too wide for the window: blit it
+                        blit(x + g->x_off, y + g->y_off, font.bitmap, g->offset, g->width, g->height, g->width, on);
+                    } else {
+                        placed[n++] = {g, x + g->x_off};
+                        if (g->y_off < top) top = g->y_off;
+                        if (g->y_off + g->height > bottom) bottom = g->y_off + g->height;
+                    }
+                }
+                x += g->advance;
+            }
+            int r0 = y + top < 0 ? 0 : y + top;
+            int r1 = y + bottom > _h ? _h : y + bottom;
+            for (int row = r0; row < r1; row++) text_row(font, placed, n, row, row - y, b);
+        }
+        return x;
+    }
+
+    static int text_width(const MonoFont& font, const char* str) {
+        int w = 0;
+        for (; *str; str++) {
+            const MonoGlyph* g = glyph(font, *str);
+            if (g) w += g->advance;
+        }
+        return w;
+    }
+
+    // Word/byte reads and writes so far (only with -DMONO_CANVAS_STATS)
+    uint32_t ops() const { return _ops; }
+
+private:
+    uint8_t bit(bool on) const { return on ? _ink : _ink ^ 1; }
+
+    static const MonoGlyph* glyph(const MonoFont& font, char c) {
+        uint8_t code = (uint8_t) c;
+        if (code < font.first || code >= font.first + font.count) return nullptr;
+        return &font.glyphs[code - font.first];
+    }
+
+    void flush(int32_t word, uint32_t bits, uint8_t b) {
+        if (word >= 0 && bits) rmw((uint32_t) word, bits, b);
+    }
+
+    // One buffer row of placed glyphs (line_y: row relative to the text top)
+    template<typename Placed>
+    void text_row(const MonoFont& font, const Placed* placed, int n, int row, int line_y, uint8_t b) {
+        uint32_t base = (uint32_t) row * _stride;
+        int32_t word = -2;  // acc0 covers word, acc1 word + 1
+        uint32_t acc0 = 0, acc1 = 0;
+        for (int i = 0; i < n; i++) {
+            const MonoGlyph* g = placed[i].g;
+            int gx = placed[i].x, gy = line_y - g->y_off;
+            if (gy < 0 || gy >= g->height) continue;
+            int c0 = gx < 0 ? -gx : 0;
+            int c1 = gx + g->width > _w ? _w - gx : g->width;
+            if (c0 >= c1) continue;
+            uint32_t d = base + gx + c0;
+            uint32_t bits = fetch(font.bitmap, g->offset + (uint32_t) gy * g->width + c0, c1 - c0);
+            uint64_t v = ((uint64_t) bits << 32) >> (d & 31);
+            uint32_t hi = (uint32_t) (v >> 32), lo = (uint32_t) v;
+            int32_t wd = (int32_t) (d >> 5);
+            if (wd == word) {
+                acc0 |= hi;
+                acc1 |= lo;
+            } else if (wd == word + 1) {
+                flush(word, acc0, b);
+                word = wd;
+                acc0 = acc1 | hi;
+                acc1 = lo;
+            } else if (wd > word + 1) {
+                flush(word, acc0, b);
+                flush(word + 1, acc1, b);
+                word = wd;
+                acc0 = hi;
+                acc1 = lo;
+            } else {  // Negative x_off reaching back before the window
+                flush(wd, hi, b);
+                flush(wd + 1, lo, b);
+            }
+        }
+        flush(word, acc0, b);
+        flush(word + 1, acc1, b);
+    }
+
+    void count(uint32_t n) {
+#ifdef MONO_CANVAS_STATS
+        _ops += n;
+#else
+        (void) n;
+#endif
+    }
+
+    // Clip a rectangle to the canvas; false if nothing is left
+    bool clip(int& x, int& y, int& w, int& h) const {
+        if (x < 0) {
+            w += x;
+            x = 0;
+        }
+        if (y < 0) {
+            h += y;
+            y = 0;
+        }
+        if (x + w > _w) w = _w - x;
+        if (y + h > _h) h = _h - y;
+        return w > 0 && h > 0;
+    }
+
+    // Set (b = 1) or clear bits [start, start + n) of the buffer
+    void span(uint32_t start, uint32_t n, uint8_t b) {
+        uint32_t end = start + n;
+        uint32_t w0 = start >> 5, w1 = (end - 1) >> 5;
+        uint32_t head = 0xFFFFFFFFu >> (start & 31);
+        uint32_t tail = 0xFFFFFFFFu << (31 - ((end - 1) & 31));
+        if (w0 == w1) {
+            rmw(w0, head & tail, b);
+            return;
+        }
+        rmw(w0, head, b);
+        if (w1 > w0 + 1) {
+            memset(_buf + (w0 + 1) * 4, b ? 0xFF : 0x00, (w1 - w0 - 1) * 4);
+            count(w1 - w0 - 1);
+        }
+        rmw(w1, tail, b);
+    }
+
+    // Masked read-modify-write of 32 bits (big-endian: bit 31 is the
+    // leftmost pixel); bytes past the end of the buffer are left alone
+    void rmw(uint32_t word, uint32_t mask, uint8_t b) {
+        count(1);
+        uint8_t* p = _buf + word * 4;
+        if (_aligned && word * 4 + 4 <= _bytes) {
+            uint32_t v;
+            memcpy(&v, __builtin_assume_aligned(p, 4), 4);
+            uint32_t m = to_memory(mask);
+            v = b ? (v | m) : (v & ~m);
+            memcpy(__builtin_assume_aligned(p, 4), &v, 4);
+            return;
+        }
+        for (uint32_t i = 0; i < 4 && word * 4 + i < _bytes; i++) {
+            uint8_t m = (uint8_t) (mask >> (24 - 8 * i));
+            if (m) p[i] = b ? (p[i] | m) : (p[i] & ~m);
+        }
+    }
+
+    static uint32_t to_memory(uint32_t be) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return be;
+#else
+        return __builtin_bswap32(be);
+#endif
+    }
+
+    // k (1..32) source bits from bit position, left-aligned
+    uint32_t fetch(const uint8_t* src, uint32_t pos, uint32_t k) {
+        const uint8_t* p = src + (pos >> 3);
+        uint32_t off = pos & 7;
+        uint32_t nbytes = (off + k + 7) >> 3;
+        count(nbytes);
+        uint64_t v = 0;
+        for (uint32_t i = 0; i < nbytes; i++) v |= (uint64_t) p[i] << (56 - 8 * i);
+        uint32_t bits = (uint32_t) ((v << off) >> 32);
+        return k == 32 ? bits : bits & ~(0xFFFFFFFFu >> k);
+    }
+
+    uint8_t* _buf;
+    int _w;
+    int _h;
+    uint32_t _stride;
+    uint32_t _bytes;
+    uint8_t _ink;
+    bool _aligned;
+    uint32_t _ops;
+};
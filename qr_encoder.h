@@ -0,0 +1,494 @@
+// QR Code Encoder for Clawd Pager
+// Encodes short text (URLs, pairing codes) on-device so the bridge sends
+// tens of bytes instead of pushing a 4 KB bitmap through push_image.
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "mono_canvas.h"
+
+// Byte mode, versions 1-10 (21x21 .. 57x57), ECC level L or M.
+// No heap: all working storage lives in the QrCode object (~1.6 KB), so keep
+// one static instance (qr_code()) rather than putting it on the stack.
+// Capacity at version 10: 271 bytes (L) / 213 bytes (M).
+//
+// Usage:
+//   if (qr_code().encode(url.c_str(), url.size(), QrEcc::MEDIUM)) {
+//       qr_code().draw(it, x, y, 3, Color::BLACK, Color::WHITE);   // display
+//       qr_code().render_1bit(buf, 240, 135, 0, 0, 2);             // bitmap
+//   }
+
+enum class QrEcc : uint8_t {
+    LOW = 0,     // ~7% recovery
+    MEDIUM = 1,  // ~15% recovery
+};
+
+class QrCode {
+public:
+    static const uint8_t MIN_VERSION = 1;
+    static const uint8_t MAX_VERSION = 10;
+    static const uint8_t MAX_SIZE = 17 + 4 * MAX_VERSION;   // 57
+    static const uint8_t QUIET_ZONE = 4;                     // Modules of margin
+    static const uint16_t MAX_CODEWORDS = 346;               // Raw codewords at v10
+
+    static QrCode& instance() {
+        static QrCode inst;
+        return inst;
+    }
+
+    QrCode() : _version(0), _size(0), _ecc(QrEcc::LOW), _mask(0) {}
+
+    // Encode text in byte mode using the smallest version that fits
+    // @param boost_ecc: use MEDIUM if it fits in the same version as LOW
+    // @return false if the text is too long for version 10
+    bool encode(const char* text, size_t len, QrEcc ecc, bool boost_ecc = true) {
+        _version = 0;
+        _size = 0;
+
+        uint8_t version = 0;
+        for (uint8_t v = MIN_VERSION; v <= MAX_VERSION; v++) {
+            if (len <= byte_capacity(v, ecc)) {
+                version = v;
+                break;
+            }
+        }
+        if (version == 0) return false;
+        if (boost_ecc && ecc == QrEcc::LOW && len <= byte_capacity(version, QrEcc::MEDIUM)) {
+            ecc = QrEcc::MEDIUM;
+        }
+
+        _version = version;
+        _size = 17 + 4 * version;
+        _ecc = ecc;
+
+        build_data_codewords(reinterpret_cast<const uint8_t*>(text), len);
+        add_ecc_and_interleave();
+
+        memset(_modules, 0, sizeof(_modules));
+        memset(_function, 0, sizeof(_function));
+        draw_function_patterns();
+        draw_codewords();
+
+        // Try all eight masks and keep the lowest penalty (masks are XOR, so
+        // applying the same mask twice undoes it)
+        long best_penalty = -1;
+        uint8_t best_mask = 0;
+        for (uint8_t m = 0; m < 8; m++) {
+            apply_mask(m);
+            draw_format_bits(m);
+            long penalty = penalty_score();
+            if (best_penalty < 0 || penalty < best_penalty) {
+                best_penalty = penalty;
+                best_mask = m;
+            }
+            apply_mask(m);
+        }
+        _mask = best_mask;
+        apply_mask(_mask);
+        draw_format_bits(_mask);
+        return true;
+    }
+
+    bool valid() const { return _size != 0; }
+    uint8_t version() const { return _version; }
+    uint8_t size() const { return _size; }
+    uint8_t mask() const { return _mask; }
+    QrEcc ecc() const { return _ecc; }
+
+    // Module color (true = dark); outside the symbol is light
+    bool module(int x, int y) const {
+        if (x < 0 || y < 0 || x >= _size || y >= _size) return false;
+        return get_bit(_modules, x, y);
+    }
+
+    // Largest integer scale (quiet zone included) that fits a box
+    int fit_scale(int box_w, int box_h) const {
+        int modules = _size + 2 * QUIET_ZONE;
+        int s = (box_w < box_h ? box_w : box_h) / modules;
+        return s > 0 ? s : 1;
+    }
+
+    // Render into a 1-bit, row-major, MSB-first bitmap (e.g. image_buffer)
+    // Draws the quiet zone light, symbol at (x0, y0) + quiet zone, clipped.
+    // Goes through draw() on a MonoCanvas: word fills per run of modules.
+    // @param dark_is_set: true -> dark modules are 1 bits
+    void render_1bit(uint8_t* buf, int buf_w, int buf_h, int x0, int y0, int scale,
+                     bool dark_is_set = true) const {
+        MonoCanvas canvas(buf, buf_w, buf_h, dark_is_set ? MonoCanvas::INK_ONE : MonoCanvas::INK_ZERO);
+        draw(canvas, x0, y0, scale, true, false);
+    }
+
+    // Draw on an ESPHome display (or anything with filled_rectangle)
+    // Dark modules are merged into horizontal runs: one call per run.
+    template<typename Display, typename Color>
+    void draw(Display& it, int x0, int y0, int scale, Color dark, Color light) const {
+        if (!valid() || scale < 1) return;
+        int total = (_size + 2 * QUIET_ZONE) * scale;
+        it.filled_rectangle(x0, y0, total, total, light);
+        int ox = x0 + QUIET_ZONE * scale;
+        int oy = y0 + QUIET_ZONE * scale;
+        for (int y = 0; y < _size; y++) {
+            int x = 0;
+            while (x < _size) {
+                if (!module(x, y)) { x++; continue; }
+                int start = x;
+                while (x < _size && module(x, y)) x++;
+                it.filled_rectangle(ox + start * scale, oy + y * scale,
+                                    (x - start) * scale, scale, dark);
+            }
+        }
+    }
+
+    // Max payload in byte mode for a version/ECC level
+    static uint16_t byte_capacity(uint8_t version, QrEcc ecc) {
+        int bits = data_codewords(version, ecc) * 8 - 4 - count_bits(version);
+        return bits > 0 ? bits / 8 : 0;
+    }
+
+private:
+    // ---- Tables (index 0 unused) ----
+
+    static uint8_t ecc_per_block(uint8_t version, QrEcc ecc) {
+        static const uint8_t TABLE[2][MAX_VERSION + 1] = {
+            {0, 7, 10, 15, 20, 26, 18, 20, 24, 30, 18},   // L
+            {0, 10, 16, 26, 18, 24, 16, 18, 22, 22, 26},  // M
+        };
+        return TABLE[(int) ecc][version];
+    }
+
+    static uint8_t num_blocks(uint8_t version, QrEcc ecc) {
+        static const uint8_t TABLE[2][MAX_VERSION + 1] = {
+            {0, 1, 1, 1, 1, 1, 2, 2, 2, 2, 4},  // L
+            {0, 1, 1, 1, 2, 2, 4, 4, 4, 5, 5},  // M
+        };
+        return TABLE[(int) ecc][version];
+    }
+
+    static uint8_t count_bits(uint8_t version) {
+        return version <= 9 ? 8 : 16;  // Byte-mode character count field
+    }
+
+    // Modules available for data + ECC, in codewords
+    static uint16_t raw_codewords(uint8_t version) {
+        int result = (16 * version + 128) * version + 64;
+        if (version >= 2) {
+            int num_align = version / 7 + 2;
+            result -= (25 * num_align - 10) * num_align - 55;
+            if (version >= 7) result -= 36;
+        }
+        return result / 8;
+    }
+
+    static uint16_t data_codewords(uint8_t version, QrEcc ecc) {
+        return raw_codewords(version) - ecc_per_block(version, ecc) * num_blocks(version, ecc);
+    }
+
+    // ---- Bit grids ----
+
+    static const uint16_t GRID_BYTES = (MAX_SIZE * MAX_SIZE + 7) / 8;
+
+    bool get_bit(const uint8_t* grid, int x, int y) const {
+        int i = y * _size + x;
+        return (grid[i >> 3] >> (i & 7)) & 1;
+    }
+
+    void put_bit(uint8_t* grid, int x, int y, bool on) {
+        int i = y * _size + x;
+        if (on) grid[i >> 3] |= 1 << (i & 7);
+        else grid[i >> 3] &= ~(1 << (i & 7));
+    }
+
+    void set_function(int x, int y, bool dark) {
+        put_bit(_modules, x, y, dark);
+        put_bit(_function, x, y, true);
+    }
+
+    // ---- Data encoding ----
+
+    void append_bits(uint32_t value, uint8_t count, uint16_t& bit_len) {
+        for (int i = count - 1; i >= 0; i--, bit_len++) {
+            if ((value >> i) & 1) _data[bit_len >> 3] |= 0x80 >> (bit_len & 7);
+        }
+    }
+
+    void build_data_codewords(const uint8_t* text, size_t len) {
+        uint16_t capacity = data_codewords(_version, _ecc);
+        memset(_data, 0, sizeof(_data));
+        uint16_t bits = 0;
+        append_bits(0x4, 4, bits);                      // Byte mode
+        append_bits(len, count_bits(_version), bits);   // Character count
+        for (size_t i = 0; i < len; i++) append_bits(text[i], 8, bits);
+
+        uint16_t cap_bits = capacity * 8;
+        uint16_t term = cap_bits - bits < 4 ? cap_bits - bits : 4;
+        append_bits(0, term, bits);                     // Terminator
+        bits = (bits + 7) & ~7;                         // Byte align
+        for (uint8_t pad = 0xEC; bits < cap_bits; pad ^= 0xEC ^ 0x11) {
+            append_bits(pad, 8, bits);
+        }
+    }
+
+    static uint8_t gf_mul(uint8_t x, uint8_t y) {
+        uint8_t z = 0;
+        for (int i = 7; i >= 0; i--) {
+            z = (z << 1) ^ ((z >> 7) * 0x1D);
+            z ^= ((y >> i) & 1) * x;
+        }
+        return z;
+    }
+
+    // Reed-Solomon generator for a degree, highest term implied
+    static void rs_divisor(uint8_t degree, uint8_t* out) {
+        memset(out, 0, degree);
+        out[degree - 1] = 1;
+        uint8_t root = 1;
+        for (uint8_t i = 0; i < degree; i++) {
+            for (uint8_t j = 0; j < degree; j++) {
+                out[j] = gf_mul(out[j], root);
+                if (j + 1 < degree) out[j] ^= out[j + 1];
+            }
+            root = gf_mul(root, 0x02);
+        }
+    }
+
+    static void rs_remainder(const uint8_t* data, uint16_t len, const uint8_t* divisor,
+                             uint8_t degree, uint8_t* out) {
+        memset(out, 0, degree);
+        for (uint16_t i = 0; i < len; i++) {
+            uint8_t factor = data[i] ^ out[0];
+            memmove(out, out + 1, degree - 1);
+            out[degree - 1] = 0;
+            for (uint8_t j = 0; j < degree; j++) out[j] ^= gf_mul(divisor[j], factor);
+        }
+    }
+
+    // Split data into blocks, append ECC per block, interleave into _codewords
+    void add_ecc_and_interleave() {
+        const uint8_t blocks = num_blocks(_version, _ecc);
+        const uint8_t ecc_len = ecc_per_block(_version, _ecc);
+        const uint16_t raw = raw_codewords(_version);
+        const uint8_t short_blocks = blocks - raw % blocks;
+        const uint16_t short_len = raw / blocks;          // Data + ECC of a short block
+        const uint16_t short_data = short_len - ecc_len;
+
+        uint8_t divisor[30];
+        rs_divisor(ecc_len, divisor);
+
+        uint16_t data_offset = 0;
+        for (uint8_t b = 0; b < blocks; b++) {
+            uint16_t dlen = short_data + (b < short_blocks ? 0 : 1);
+            const uint8_t* dat = _data + data_offset;
+
+            // Data bytes: position i of block b lands at i*blocks + b, except
+            // long blocks' extra byte goes after all short-block data
+            for (uint16_t i = 0; i < dlen; i++) {
+                uint16_t pos;
+                if (i < short_data) pos = i * blocks + b;
+                else pos = short_data * blocks + (b - short_blocks);
+                _codewords[pos] = dat[i];
+            }
+
+            uint8_t ecc[30];
+            rs_remainder(dat, dlen, divisor, ecc_len, ecc);
+            uint16_t ecc_base = raw - ecc_len * blocks;
+            for (uint8_t i = 0; i < ecc_len; i++) {
+                _codewords[ecc_base + i * blocks + b] = ecc[i];
+            }
+            data_offset += dlen;
+        }
+    }
+
+    // ---- Function patterns ----
+
+    void draw_function_patterns() {
+        for (int i = 0; i < _size; i++) {
+            set_function(6, i, i % 2 == 0);
+            set_function(i, 6, i % 2 == 0);
+        }
+        draw_finder(3, 3);
+        draw_finder(_size - 4, 3);
+        draw_finder(3, _size - 4);
+
+        uint8_t pos[7];
+        uint8_t n = alignment_positions(pos);
+        for (uint8_t i = 0; i < n; i++) {
+            for (uint8_t j = 0; j < n; j++) {
+                bool corner = (i == 0 && j == 0) || (i == 0 && j == n - 1) || (i == n - 1 && j == 0);
+                if (!corner) draw_alignment(pos[i], pos[j]);
+            }
+        }
+
+        draw_format_bits(0);  // Reserve area; real bits drawn after masking
+        draw_version_bits();
+    }
+
+    uint8_t alignment_positions(uint8_t* out) const {
+        if (_version == 1) return 0;
+        uint8_t n = _version / 7 + 2;
+        uint8_t step = (_version * 4 + n * 2 + 1) / (n * 2 - 2) * 2;
+        out[0] = 6;
+        for (uint8_t i = n - 1, p = _size - 7; i >= 1; i--, p -= step) out[i] = p;
+        return n;
+    }
+
+    void draw_finder(int cx, int cy) {
+        for (int dy = -4; dy <= 4; dy++) {
+            for (int dx = -4; dx <= 4; dx++) {
+                int x = cx + dx, y = cy + dy;
+                if (x < 0 || y < 0 || x >= _size || y >= _size) continue;
+                int adx = dx < 0 ? -dx : dx, ady = dy < 0 ? -dy : dy;
+                int dist = adx > ady ? adx : ady;
+                set_function(x, y, dist != 2 && dist != 4);
+            }
+        }
+    }
+
+    void draw_alignment(int cx, int cy) {
+        for (int dy = -2; dy <= 2; dy++) {
+            for (int dx = -2; dx <= 2; dx++) {
+                int adx = dx < 0 ? -dx : dx, ady = dy < 0 ? -dy : dy;
+                set_function(cx + dx, cy + dy, (adx > ady ? adx : ady) != 1);
+            }
+        }
+    }
+
+    void draw_format_bits(uint8_t mask) {
+        // ECC format field: L = 01, M = 00
+        uint16_t data = ((_ecc == QrEcc::LOW ? 1 : 0) << 3) | mask;
+        uint16_t rem = data;
+        for (int i = 0; i < 10; i++) rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+        uint16_t bits = ((data << 10) | rem) ^ 0x5412;
+
+        for (int i = 0; i <= 5; i++) set_function(8, i, (bits >> i) & 1);
+        set_function(8, 7, (bits >> 6) & 1);
+        set_function(8, 8, (bits >> 7) & 1);
+        set_function(7, 8, (bits >> 8) & 1);
+        for (int i = 9; i < 15; i++) set_function(14 - i, 8, (bits >> i) & 1);
+
+        for (int i = 0; i < 8; i++) set_function(_size - 1 - i, 8, (bits >> i) & 1);
+        for (int i = 8; i < 15; i++) set_function(8, _size - 15 + i, (bits >> i) & 1);
+        set_function(8, _size - 8, true);  // Always-dark module
+    }
+
+    void draw_version_bits() {
+        if (_version < 7) return;
+        uint32_t rem = _version;
+        for (int i = 0; i < 12; i++) rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+        uint32_t bits = ((uint32_t) _version << 12) | rem;
+        for (int i = 0; i < 18; i++) {
+            bool bit = (bits >> i) & 1;
+            int a = _size - 11 + i % 3, b = i / 3;
+            set_function(a, b, bit);
+            set_function(b, a, bit);
+        }
+    }
+
+    // Zig-zag codeword placement, two columns at a time from the right
+    void draw_codewords() {
+        const uint16_t total_bits = raw_codewords(_version) * 8;
+        uint16_t i = 0;
+        for (int right = _size - 1; right >= 1; right -= 2) {
+            if (right == 6) right = 5;  // Skip the vertical timing column
+            for (int vert = 0; vert < _size; vert++) {
+                for (int j = 0; j < 2; j++) {
+                    int x = right - j;
+                    bool upward = ((right + 1) & 2) == 0;
+                    int y = upward ? _size - 1 - vert : vert;
+                    if (get_bit(_function, x, y)) continue;
+                    // Remainder bits beyond the codewords stay light
+                    bool dark = i < total_bits && ((_codewords[i >> 3] >> (7 - (i & 7))) & 1);
+                    put_bit(_modules, x, y, dark);
+                    i++;
+                }
+            }
+        }
+    }
+
+    // ---- Masking ----
+
+    static bool mask_bit(uint8_t mask, int x, int y) {
+        switch (mask) {
+            case 0: return (x + y) % 2 == 0;
+            case 1: return y % 2 == 0;
+            case 2: return x % 3 == 0;
+            case 3: return (x + y) % 3 == 0;
+            case 4: return (x / 3 + y / 2) % 2 == 0;
+            case 5: return x * y % 2 + x * y % 3 == 0;
+            case 6: return (x * y % 2 + x * y % 3) % 2 == 0;
+            default: return ((x + y) % 2 + x * y % 3) % 2 == 0;
+        }
+    }
+
+    void apply_mask(uint8_t mask) {
+        for (int y = 0; y < _size; y++) {
+            for (int x = 0; x < _size; x++) {
+                if (!get_bit(_function, x, y) && mask_bit(mask, x, y)) {
+                    put_bit(_modules, x, y, !get_bit(_modules, x, y));
+                }
+            }
+        }
+    }
+
+    // Standard penalty rules: runs, 2x2 blocks, finder look-alikes, balance
+    long penalty_score() const {
+        long score = 0;
+        int dark = 0;
+
+        for (int pass = 0; pass < 2; pass++) {  // 0 = rows, 1 = columns
+            for (int a = 0; a < _size; a++) {
+                int run = 0;
+                bool run_color = false;
+                uint16_t window = 0;  // Last 11 modules, newest in bit 0
+                for (int b = 0; b < _size; b++) {
+                    bool c = pass == 0 ? get_bit(_modules, b, a) : get_bit(_modules, a, b);
+                    if (pass == 0 && c) dark++;
+
+                    if (b > 0 && c == run_color) {
+                        run++;
+                        if (run == 5) score += 3;
+                        else if (run > 5) score++;
+                    } else {
+                        run_color = c;
+                        run = 1;
+                    }
+
+                    window = ((window << 1) | c) & 0x7FF;
+                    if (b >= 10 && (window == 0x05D || window == 0x5D0)) score += 40;
+                }
+            }
+        }
+
+        for (int y = 0; y + 1 < _size; y++) {
+            for (int x = 0; x + 1 < _size; x++) {
+                bool c = get_bit(_modules, x, y);
+                if (c == get_bit(_modules, x + 1, y) && c == get_bit(_modules, x, y + 1) &&
+                    c == get_bit(_modules, x + 1, y + 1)) {
+                    score += 3;
+                }
+            }
+        }
+
+        long total = (long) _size * _size;
+        long diff = (long) dark * 20 - total * 10;
+        if (diff < 0) diff = -diff;
+        long k = (diff + total - 1) / total - 1;
+        score += k * 10;
+        return score;
+    }
+
+    uint8_t _version;
+    uint8_t _size;
+    QrEcc _ecc;
+    uint8_t _mask;
+    uint8_t _modules[GRID_BYTES];
+    uint8_t _function[GRID_BYTES];
+    uint8_t _data[MAX_CODEWORDS];       // Data codewords, block order
+    uint8_t _codewords[MAX_CODEWORDS];  // Interleaved data + ECC
+};
+
+// Global accessor
+inline QrCode& qr_code() {
+    return QrCode::instance();
+}
@@ -0,0 +1,262 @@
+// Screen Capture for Clawd Pager
+// Streams the current framebuffer to the bridge as RLE-compressed UDP chunks
+
+#pragma once
+#include "esphome.h"
+#include "audio_streamer.h"
+
+// Packet layout (little-endian), sent on AudioStreamer's socket:
+//   0  FF FF 'C' 'P'     magic (same FF FF prefix as audio START/STOP markers)
+//   4  capture_id        u8, increments per capture
+//   5  flags             u8, CAPTURE_FLAG_*
+//   6  format            u8, CaptureFormat
+//   7  rotation          u8, display rotation / 90
+//   8  width, height     u16 each, panel (unrotated) size
+//   12 first_row, rows   u16 each, rows covered by this packet
+//   16 payload           PackBits over pixel units (2 bytes RGB565, 1 byte otherwise):
+//                        h < 0x80: h+1 literal units follow
+//                        h >= 0x80: next unit repeated (h & 0x7F)+1 times
+//
+// Capture runs in loop() between display updates, so rendering is never
+// blocked: up to PACKETS_PER_LOOP packets per call, each filled with as
+// many rows as their encoded length allows. A 240x135 RGB565 frame that
+// doesn't compress at all is 80 packets, so at the 20 ms interval even
+// that is sent in 5 calls, well inside one 0.5 s redraw. If a new frame
+// still starts mid-capture the rows would tear, so the capture restarts
+// on the new frame (up to MAX_RESTARTS, then it finishes anyway and sets
+// CAPTURE_FLAG_TORN).
+//
+// Decode on the host with devtools/screen_capture.py; the C++ decoder in
+// devtools/screen_capture_bench.cpp checks the round trip.
+
+enum class CaptureFormat : uint8_t {
+    RGB565_BE = 0,  // st7789v default (2 bytes/pixel, big-endian)
+    RGB332 = 1,     // st7789v eightbitcolor
+    MONO1 = 2,      // waveshare_epaper (1 bit/pixel, MSB first, rows packed)
+};
+
+static const uint8_t CAPTURE_FLAG_LAST = 0x01;
+static const uint8_t CAPTURE_FLAG_TORN = 0x02;
+
+// DisplayBuffer keeps its framebuffer protected; expose it (read-only for
+// capture, writable for MonoCanvas drawing on waveshare_epaper)
+class FrameBufferPeek : public esphome::display::DisplayBuffer {
+public:
+    static const uint8_t* buffer(esphome::display::DisplayBuffer* d) {
+        return static_cast<FrameBufferPeek*>(d)->buffer_;
+    }
+    static uint8_t* writable_buffer(esphome::display::DisplayBuffer* d) {
+        return static_cast<FrameBufferPeek*>(d)->buffer_;
+    }
+    static int width(esphome::display::DisplayBuffer* d) {
+        return static_cast<FrameBufferPeek*>(d)->get_width_internal();
+    }
+    static int height(esphome::display::DisplayBuffer* d) {
+        return static_cast<FrameBufferPeek*>(d)->get_height_internal();
+    }
+    static int rotation(esphome::display::DisplayBuffer* d) {
+        return static_cast<FrameBufferPeek*>(d)->rotation_;
+    }
+};
+
+class ScreenCapture {
+public:
+    static const size_t HEADER_SIZE = 16;
+    static const size_t MAX_PACKET = 1024;  // Same chunk size as audio
+    static const uint8_t MAX_RESTARTS = 3;
+    static const uint8_t PACKETS_PER_LOOP = 16;  // lwIP queues this many without dropping
+
+    static ScreenCapture& instance() {
+        static ScreenCapture inst;
+        return inst;
+    }
+
+    void set_format(CaptureFormat format) { _format = format; }
+
+    // Arm a capture (from the capture_screen API service)
+    // @param port: bridge port to stream to (0 = audio port)
+    void request(uint16_t port) {
+        _port = port;
+        _armed = true;
+        _active = false;
+    }
+
+    // Call at the top of the display lambda, before drawing
+    void on_frame(esphome::display::DisplayBuffer& it) {
+        _display = &it;
+        if (_armed) {
+            // Start streaming after this frame has been drawn
+            _armed = false;
+            begin();
+        } else if (_active && _row > 0 && _restarts < MAX_RESTARTS) {
+            // New frame while streaming - restart so rows come from one frame
+            _restarts++;
+            _row = 0;
+            _pending_len = 0;
+        } else if (_active && _row > 0) {
+            _torn = true;
+        }
+    }
+
+    // Call from an interval; sends up to PACKETS_PER_LOOP packets per call
+    void loop() {
+        for (uint8_t i = 0; i < PACKETS_PER_LOOP && _active; i++) send_packet();
+    }
+
+    bool is_active() const { return _active || _armed; }
+    uint32_t bytes_sent() const { return _bytes_sent; }
+    uint32_t packets_sent() const { return _packets_sent; }
+
+    // Public for devtools/screen_capture_bench.cpp (a fresh capture per
+    // format); the pager uses instance()
+    ScreenCapture()
+        : _display(nullptr), _format(CaptureFormat::RGB565_BE), _port(0), _armed(false),
+          _active(false), _torn(false), _restarts(0), _capture_id(0), _width(0), _height(0),
+          _row(0), _bytes_sent(0), _packets_sent(0), _pending_len(0) {}
+
+private:
+    // One packet: whole rows, by their encoded length. A row that doesn't
+    // fit stays encoded in _pending and opens the next packet.
+    void send_packet() {
+        const uint8_t* fb = FrameBufferPeek::buffer(_display);
+        if (fb == nullptr) {
+            _active = false;
+            return;
+        }
+
+        size_t stride = row_bytes();
+        uint16_t first_row = _row;
+        size_t len = HEADER_SIZE;
+        if (_pending_len > 0) {
+            memcpy(_packet + len, _pending, _pending_len);
+            len += _pending_len;
+            _pending_len = 0;
+            _row++;
+        }
+        while (_row < _height) {
+            size_t n = encode_row(fb + (size_t) _row * stride, stride, _pending);
+            if (len + n > MAX_PACKET) {
+                _pending_len = n;
+                break;
+            }
+            memcpy(_packet + len, _pending, n);
+            len += n;
+            _row++;
+        }
+
+        uint8_t flags = (_row >= _height) ? CAPTURE_FLAG_LAST : 0;
+        if (_torn) flags |= CAPTURE_FLAG_TORN;
+        write_header(flags, first_row, _row - first_row);
+        audio_streamer().send_datagram(_packet, len, _port);
+        _bytes_sent += len;
+        _packets_sent++;
+
+        if (flags & CAPTURE_FLAG_LAST) {
+            _active = false;
+            ESP_LOGI("CAPTURE", "Capture %d sent: %u bytes in %u packets (raw %u)%s", _capture_id,
+                     (unsigned) _bytes_sent, (unsigned) _packets_sent, (unsigned) (stride * _height),
+                     _torn ? " [torn]" : "");
+        }
+    }
+
+    void begin() {
+        _width = FrameBufferPeek::width(_display);
+        _height = FrameBufferPeek::height(_display);
+        _row = 0;
+        _restarts = 0;
+        _torn = false;
+        _bytes_sent = 0;
+        _packets_sent = 0;
+        _pending_len = 0;
+        _capture_id++;
+        _active = max_encoded_row() + HEADER_SIZE <= MAX_PACKET;
+        if (!_active) ESP_LOGW("CAPTURE", "Row too wide for a packet");
+    }
+
+    size_t unit_size() const { return _format == CaptureFormat::RGB565_BE ? 2 : 1; }
+
+    size_t row_bytes() const {
+        switch (_format) {
+            case CaptureFormat::RGB565_BE: return (size_t) _width * 2;
+            case CaptureFormat::RGB332: return _width;
+            default: return (_width + 7) / 8;
+        }
+    }
+
+    // Worst case: all literals, one header byte per 128 units
+    size_t max_encoded_row() const {
+        size_t units = row_bytes() / unit_size();
+        return row_bytes() + (units + 127) / 128;
+    }
+
+    // PackBits over fixed-size units; runs and literals never cross rows
+    size_t encode_row(const uint8_t* row, size_t row_len, uint8_t* out) const {
+        const size_t u = unit_size();
+        const size_t units = row_len / u;
+        size_t o = 0, i = 0;
+
+        while (i < units) {
+            // Measure run at i
+            size_t run = 1;
+            while (i + run < units && run < 128 &&
+                   memcmp(row + (i + run) * u, row + i * u, u) == 0) {
+                run++;
+            }
+            if (run >= 2) {
+                out[o++] = 0x80 | (uint8_t) (run - 1);
+                memcpy(out + o, row + i * u, u);
+                o += u;
+                i += run;
+                continue;
+            }
+
+            // Literal span until the next run of 2+ (or 128 units)
+            size_t start = i;
+            size_t count = 0;
+            while (i < units && count < 128) {
+                if (i + 1 < units && memcmp(row + (i + 1) * u, row + i * u, u) == 0) break;
+                i++;
+                count++;
+            }
+            out[o++] = (uint8_t) (count - 1);
+            memcpy(out + o, row + start * u, count * u);
+            o += count * u;
+        }
+        return o;
+    }
+
+    void write_header(uint8_t flags, uint16_t first_row, uint16_t rows) {
+        uint8_t* h = _packet;
+        h[0] = 0xFF; h[1] = 0xFF; h[2] = 'C'; h[3] = 'P';
+        h[4] = _capture_id;
+        h[5] = flags;
+        h[6] = (uint8_t) _format;
+        h[7] = (uint8_t) (FrameBufferPeek::rotation(_display) / 90);
+        h[8] = _width & 0xFF; h[9] = _width >> 8;
+        h[10] = _height & 0xFF; h[11] = _height >> 8;
+        h[12] = first_row & 0xFF; h[13] = first_row >> 8;
+        h[14] = rows & 0xFF; h[15] = rows >> 8;
+    }
+
+    esphome::display::DisplayBuffer* _display;
+    CaptureFormat _format;
+    uint16_t _port;
+    bool _armed;
+    bool _active;
+    bool _torn;
+    uint8_t _restarts;
+    uint8_t _capture_id;
+    uint16_t _width;
+    uint16_t _height;
+    uint16_t _row;
+    uint32_t _bytes_sent;
+    uint32_t _packets_sent;
+    size_t _pending_len;
+    uint8_t _packet[MAX_PACKET];
+    uint8_t _pending[MAX_PACKET - HEADER_SIZE];  // Encoded row waiting for the next packet
+};
+
+// Global accessor
+inline ScreenCapture& screen_capture() {
+    return ScreenCapture::instance();
+}
@@ -0,0 +1,542 @@
+// SIMD Kernels for Clawd Pager
+// Data-parallel audio and raster kernels, written once over a thin vector layer
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// Three layers:
+// - SimdRef: plain scalar loops. These define the results; every other
+//   path must match them bit for bit.
+// - Lane backends: 8 x int16 / 16 x uint8 vectors with a small op set
+//   (load/store, add/sub, saturating add, widening multiply-shift, min/max,
+//   masks, shifts, movemask):
+//     SimdLanesScalar  arrays, any target (checks the kernel logic anywhere)
+//     SimdLanesSse2    x86-64 (bridge host)
+//     SimdLanesNeon    AArch64 (bridge on a Pi)
+//   SimdKernels<Lanes> writes each kernel once against that op set and
+//   hands tails to SimdRef.
+// - ESP32-S3 PIE has no compiler intrinsics (its q registers can't be bound
+//   to C variables), so it gets per-kernel inline asm instead of a lane
+//   backend: mix_s16 and peak_s16 (ee.vadds / ee.vmax / ee.vmin on 16-byte
+//   aligned data). Simd::begin() runs them against SimdRef once and falls
+//   back to SimdRef if they disagree.
+//
+// Simd:: picks the path for the build: SSE2 or NEON on the host, PIE (when
+// verified) then SimdRef on the ESP32-S3, SimdRef on the classic ESP32.
+//
+// Not here: IMA ADPCM (each sample depends on the previous predictor) and
+// Floyd-Steinberg (error carried along the row) are serial; the ordered
+// dither kernels are the data-parallel alternative.
+//
+// devtools/simd_bench.cpp checks every backend against SimdRef and prints
+// the kernel x backend timing matrix.
+//
+// Usage:
+//   Simd::begin();                                        // once, at boot
+//   Simd::mix_s16(out, tts, chime, 320);
+//   Simd::gain_s16(out, mic, 320, 3, 1);                  // x1.5, saturating
+//   int32_t level = Simd::peak_s16(mic, 320);
+//   Simd::blend_rgb565(row, from, to, 240, 12);           // 12/32 of the way
+//   Simd::dither_select_rgb565(row, from, to, 240, 0, y, 6);
+//   Simd::dither_1bit(image_buffer + y * 30, gray, 240, 0, y);
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CLAWD_SIMD_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CLAWD_SIMD_NEON 1
+#endif
+
+#if defined(__XTENSA__) && defined(__has_include)
+#if __has_include(<sdkconfig.h>)
+#include <sdkconfig.h>
+#endif
+#endif
+#if defined(__XTENSA__) && defined(CONFIG_IDF_TARGET_ESP32S3)
+#define CLAWD_SIMD_PIE 1
+#endif
+
+// 4x4 Bayer matrix, thresholds 0..15
+static const uint8_t SIMD_BAYER4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+struct SimdRef {
+    static int16_t sat16(int32_t v) { return v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t) v); }
+
+    // dst = a + b, saturating
+    static void mix_s16(int16_t* dst, const int16_t* a, const int16_t* b, size_t n) {
+        for (size_t i = 0; i < n; i++) dst[i] = sat16((int32_t) a[i] + b[i]);
+    }
+
+    // dst = (src * gain) >> shift (arithmetic, shift 0..15), saturating
+    static void gain_s16(int16_t* dst, const int16_t* src, size_t n, int16_t gain, uint8_t shift) {
+        for (size_t i = 0; i < n; i++) dst[i] = sat16(((int32_t) src[i] * gain) >> shift);
+    }
+
+    // Largest |x| (32768 for -32768)
+    static int32_t peak_s16(const int16_t* src, size_t n) {
+        int32_t peak = 0;
+        for (size_t i = 0; i < n; i++) {
+            int32_t v = src[i] < 0 ? -(int32_t) src[i] : src[i];
+            if (v > peak) peak = v;
+        }
+        return peak;
+    }
+
+    // Per channel: a + ((b - a) * alpha >> 5), alpha 0..32 (32 = b)
+    static void blend_rgb565(uint16_t* dst, const uint16_t* a, const uint16_t* b, size_t n, uint8_t alpha) {
+        for (size_t i = 0; i < n; i++) {
+            int ra = a[i] >> 11, ga = (a[i] >> 5) & 63, ba = a[i] & 31;
+            int rb = b[i] >> 11, gb = (b[i] >> 5) & 63, bb = b[i] & 31;
+            int r = ra + (((rb - ra) * alpha) >> 5);
+            int g = ga + (((gb - ga) * alpha) >> 5);
+            int bl = ba + (((bb - ba) * alpha) >> 5);
+            dst[i] = (uint16_t) ((r << 11) | (g << 5) | bl);
+        }
+    }
+
+    // Ordered-dither crossfade: b where the Bayer threshold < level (0..16)
+    // at (x0 + i, y), else a. level 16 is all b.
+    static void dither_select_rgb565(uint16_t* dst, const uint16_t* a, const uint16_t* b, size_t n, int x0, int y,
+                                     uint8_t level) {
+        const uint8_t* row = SIMD_BAYER4[y & 3];
+        for (size_t i = 0; i < n; i++) dst[i] = row[(x0 + i) & 3] < level ? b[i] : a[i];
+    }
+
+    // Ordered dither of gray to 1 bit (MSB first, 1 = dark where
+    // gray < 16 * threshold + 8). dst[0] bit 7 is pixel 0; x0 only sets the
+    // pattern phase. Bits past n in the last byte are kept.
+    static void dither_1bit(uint8_t* dst, const uint8_t* gray, size_t n, int x0, int y) {
+        const uint8_t* row = SIMD_BAYER4[y & 3];
+        for (size_t i = 0; i < n; i++) {
+            uint8_t bit = 0x80 >> (i & 7);
+            if (gray[i] < row[(x0 + i) & 3] * 16 + 8) dst[i >> 3] |= bit;
+            else dst[i >> 3] &= ~bit;
+        }
+    }
+};
+
+struct SimdLanesScalar {
+    struct I16 {
+        int16_t v[8];
+    };
+    struct U8 {
+        uint8_t v[16];
+    };
+    static const char* name() { return "scalar-lanes"; }
+
+    static I16 load(const int16_t* p) {
+        I16 r;
+        memcpy(r.v, p, 16);
+        return r;
+    }
+    static void store(int16_t* p, I16 a) { memcpy(p, a.v, 16); }
+    static I16 splat(int16_t x) {
+        I16 r;
+        for (int i = 0; i < 8; i++) r.v[i] = x;
+        return r;
+    }
+    static I16 add(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] = (int16_t) (uint16_t) ((uint16_t) a.v[i] + (uint16_t) b.v[i]);
+        return a;
+    }
+    static I16 sub(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] = (int16_t) (uint16_t) ((uint16_t) a.v[i] - (uint16_t) b.v[i]);
+        return a;
+    }
+    static I16 adds(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] = SimdRef::sat16((int32_t) a.v[i] + b.v[i]);
+        return a;
+    }
+    static I16 mullo(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] = (int16_t) (uint16_t) ((uint32_t) (int32_t) a.v[i] * (uint32_t) (int32_t) b.v[i]);
+        return a;
+    }
+    // sat16((a * b) >> shift), the product at 32 bits
+    static I16 mul_shift_sat(I16 a, I16 b, int shift) {
+        for (int i = 0; i < 8; i++) a.v[i] = SimdRef::sat16(((int32_t) a.v[i] * b.v[i]) >> shift);
+        return a;
+    }
+    static I16 max(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+    static I16 min(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+    static I16 and_(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] &= b.v[i];
+        return a;
+    }
+    static I16 or_(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] |= b.v[i];
+        return a;
+    }
+    // Lanes of all ones where a < b (signed)
+    static I16 cmplt(I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] = a.v[i] < b.v[i] ? -1 : 0;
+        return a;
+    }
+    // mask ? b : a
+    static I16 select(I16 mask, I16 a, I16 b) {
+        for (int i = 0; i < 8; i++) a.v[i] = (int16_t) ((b.v[i] & mask.v[i]) | (a.v[i] & ~mask.v[i]));
+        return a;
+    }
+    static I16 srl(I16 a, int n) {
+        for (int i = 0; i < 8; i++) a.v[i] = (int16_t) ((uint16_t) a.v[i] >> n);
+        return a;
+    }
+    static I16 sll(I16 a, int n) {
+        for (int i = 0; i < 8; i++) a.v[i] = (int16_t) (uint16_t) ((uint16_t) a.v[i] << n);
+        return a;
+    }
+    static I16 sra(I16 a, int n) {
+        for (int i = 0; i < 8; i++) a.v[i] = (int16_t) (a.v[i] >> n);
+        return a;
+    }
+    static int16_t hmax(I16 a) {
+        int16_t m = a.v[0];
+        for (int i = 1; i < 8; i++) m = a.v[i] > m ? a.v[i] : m;
+        return m;
+    }
+    static int16_t hmin(I16 a) {
+        int16_t m = a.v[0];
+        for (int i = 1; i < 8; i++) m = a.v[i] < m ? a.v[i] : m;
+        return m;
+    }
+
+    static U8 load_u8(const uint8_t* p) {
+        U8 r;
+        memcpy(r.v, p, 16);
+        return r;
+    }
+    // Bit i set where a[i] < b[i] (unsigned)
+    static uint16_t lt_bits_u8(U8 a, U8 b) {
+        uint16_t bits = 0;
+        for (int i = 0; i < 16; i++) bits |= (uint16_t) (a.v[i] < b.v[i]) << i;
+        return bits;
+    }
+};
+
+#if CLAWD_SIMD_SSE2
+struct SimdLanesSse2 {
+    typedef __m128i I16;
+    typedef __m128i U8;
+    static const char* name() { return "sse2"; }
+
+    static I16 load(const int16_t* p) { return _mm_loadu_si128((const __m128i*) p); }
+    static void store(int16_t* p, I16 a) { _mm_storeu_si128((__m128i*) p, a); }
+    static I16 splat(int16_t x) { return _mm_set1_epi16(x); }
+    static I16 add(I16 a, I16 b) { return _mm_add_epi16(a, b); }
+    static I16 sub(I16 a, I16 b) { return _mm_sub_epi16(a, b); }
+    static I16 adds(I16 a, I16 b) { return _mm_adds_epi16(a, b); }
+    static I16 mullo(I16 a, I16 b) { return _mm_mullo_epi16(a, b); }
+    static I16 mul_shift_sat(I16 a, I16 b, int shift) {
+        __m128i lo = _mm_mullo_epi16(a, b), hi = _mm_mulhi_epi16(a, b);
+        __m128i count = _mm_cvtsi32_si128(shift);
+        __m128i p0 = _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), count);
+        __m128i p1 = _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), count);
+        return _mm_packs_epi32(p0, p1);
+    }
+    static I16 max(I16 a, I16 b) { return _mm_max_epi16(a, b); }
+    static I16 min(I16 a, I16 b) { return _mm_min_epi16(a, b); }
+    static I16 and_(I16 a, I16 b) { return _mm_and_si128(a, b); }
+    static I16 or_(I16 a, I16 b) { return _mm_or_si128(a, b); }
+    static I16 cmplt(I16 a, I16 b) { return _mm_cmplt_epi16(a, b); }
+    static I16 select(I16 mask, I16 a, I16 b) { return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a)); }
+    static I16 srl(I16 a, int n) { return _mm_srl_epi16(a, _mm_cvtsi32_si128(n)); }
+    static I16 sll(I16 a, int n) { return _mm_sll_epi16(a, _mm_cvtsi32_si128(n)); }
+    static I16 sra(I16 a, int n) { return _mm_sra_epi16(a, _mm_cvtsi32_si128(n)); }
+    static int16_t hmax(I16 a) {
+        a = _mm_max_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+        a = _mm_max_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+        a = _mm_max_epi16(a, _mm_srli_epi32(a, 16));
+        return (int16_t) _mm_cvtsi128_si32(a);
+    }
+    static int16_t hmin(I16 a) {
+        a = _mm_min_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+        a = _mm_min_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+        a = _mm_min_epi16(a, _mm_srli_epi32(a, 16));
+        return (int16_t) _mm_cvtsi128_si32(a);
+    }
+
+    static U8 load_u8(const uint8_t* p) { return _mm_loadu_si128((const __m128i*) p); }
+    static uint16_t lt_bits_u8(U8 a, U8 b) {
+        // SSE2 has no unsigned compare: a < b <=> max(a, b) != a
+        __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(a, b), a);
+        return (uint16_t) ~_mm_movemask_epi8(ge);
+    }
+};
+#endif
+
+#if CLAWD_SIMD_NEON
+struct SimdLanesNeon {
+    typedef int16x8_t I16;
+    typedef uint8x16_t U8;
+    static const char* name() { return "neon"; }
+
+    static I16 load(const int16_t* p) { return vld1q_s16(p); }
+    static void store(int16_t* p, I16 a) { vst1q_s16(p, a); }
+    static I16 splat(int16_t x) { return vdupq_n_s16(x); }
+    static I16 add(I16 a, I16 b) { return vaddq_s16(a, b); }
+    static I16 sub(I16 a, I16 b) { return vsubq_s16(a, b); }
+    static I16 adds(I16 a, I16 b) { return vqaddq_s16(a, b); }
+    static I16 mullo(I16 a, I16 b) { return vmulq_s16(a, b); }
+    static I16 mul_shift_sat(I16 a, I16 b, int shift) {
+        int32x4_t count = vdupq_n_s32(-shift);
+        int32x4_t p0 = vshlq_s32(vmull_s16(vget_low_s16(a), vget_low_s16(b)), count);
+        int32x4_t p1 = vshlq_s32(vmull_s16(vget_high_s16(a), vget_high_s16(b)), count);
+        return vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1));
+    }
+    static I16 max(I16 a, I16 b) { return vmaxq_s16(a, b); }
+    static I16 min(I16 a, I16 b) { return vminq_s16(a, b); }
+    static I16 and_(I16 a, I16 b) { return vandq_s16(a, b); }
+    static I16 or_(I16 a, I16 b) { return vorrq_s16(a, b); }
+    static I16 cmplt(I16 a, I16 b) { return vreinterpretq_s16_u16(vcltq_s16(a, b)); }
+    static I16 select(I16 mask, I16 a, I16 b) { return vbslq_s16(vreinterpretq_u16_s16(mask), b, a); }
+    static I16 srl(I16 a, int n) {
+        return vreinterpretq_s16_u16(vshlq_u16(vreinterpretq_u16_s16(a), vdupq_n_s16((int16_t) -n)));
+    }
+    static I16 sll(I16 a, int n) { return vshlq_s16(a, vdupq_n_s16((int16_t) n)); }
+    static I16 sra(I16 a, int n) { return vshlq_s16(a, vdupq_n_s16((int16_t) -n)); }
+    static int16_t hmax(I16 a) { return vmaxvq_s16(a); }
+    static int16_t hmin(I16 a) { return vminvq_s16(a); }
+
+    static U8 load_u8(const uint8_t* p) { return vld1q_u8(p); }
+    static uint16_t lt_bits_u8(U8 a, U8 b) {
+        static const uint8_t WEIGHTS[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+        uint8x16_t bits = vandq_u8(vcltq_u8(a, b), vld1q_u8(WEIGHTS));
+        return (uint16_t) (vaddv_u8(vget_low_u8(bits)) | (vaddv_u8(vget_high_u8(bits)) << 8));
+    }
+};
+#endif
+
+// Each kernel once, over any lane backend; tails go to SimdRef
+template<typename L>
+struct SimdKernels {
+    typedef typename L::I16 I16;
+
+    static void mix_s16(int16_t* dst, const int16_t* a, const int16_t* b, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) L::store(dst + i, L::adds(L::load(a + i), L::load(b + i)));
+        SimdRef::mix_s16(dst + i, a + i, b + i, n - i);
+    }
+
+    static void gain_s16(int16_t* dst, const int16_t* src, size_t n, int16_t gain, uint8_t shift) {
+        I16 g = L::splat(gain);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) L::store(dst + i, L::mul_shift_sat(L::load(src + i), g, shift));
+        SimdRef::gain_s16(dst + i, src + i, n - i, gain, shift);
+    }
+
+    static int32_t peak_s16(const int16_t* src, size_t n) {
+        size_t i = 0;
+        int32_t peak = 0;
+        if (n >= 8) {
+            I16 hi = L::load(src), lo = hi;
+            for (i = 8; i + 8 <= n; i += 8) {
+                I16 v = L::load(src + i);
+                hi = L::max(hi, v);
+                lo = L::min(lo, v);
+            }
+            int32_t mx = L::hmax(hi), mn = -(int32_t) L::hmin(lo);
+            peak = mx > mn ? mx : mn;
+        }
+        int32_t tail = SimdRef::peak_s16(src + i, n - i);
+        return tail > peak ? tail : peak;
+    }
+
+    static void blend_rgb565(uint16_t* dst, const uint16_t* a, const uint16_t* b, size_t n, uint8_t alpha) {
+        const I16 m5 = L::splat(31), m6 = L::splat(63), k = L::splat(alpha);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            I16 pa = L::load((const int16_t*) a + i), pb = L::load((const int16_t*) b + i);
+            I16 ra = L::srl(pa, 11), ga = L::and_(L::srl(pa, 5), m6), ba = L::and_(pa, m5);
+            I16 rb = L::srl(pb, 11), gb = L::and_(L::srl(pb, 5), m6), bb = L::and_(pb, m5);
+            I16 r = L::add(ra, L::sra(L::mullo(L::sub(rb, ra), k), 5));
+            I16 g = L::add(ga, L::sra(L::mullo(L::sub(gb, ga), k), 5));
+            I16 bl = L::add(ba, L::sra(L::mullo(L::sub(bb, ba), k), 5));
+            L::store((int16_t*) dst + i, L::or_(L::or_(L::sll(r, 11), L::sll(g, 5)), bl));
+        }
+        SimdRef::blend_rgb565(dst + i, a + i, b + i, n - i, alpha);
+    }
+
+    static void dither_select_rgb565(uint16_t* dst, const uint16_t* a, const uint16_t* b, size_t n, int x0, int y,
+                                     uint8_t level) {
+        const uint8_t* row = SIMD_BAYER4[y & 3];
+        int16_t t[8];
+        for (int j = 0; j < 8; j++) t[j] = row[(x0 + j) & 3];
+        const I16 mask = L::cmplt(L::load(t), L::splat(level));  // 8 lanes = two periods
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            L::store((int16_t*) dst + i,
+                     L::select(mask, L::load((const int16_t*) a + i), L::load((const int16_t*) b + i)));
+        }
+        SimdRef::dither_select_rgb565(dst + i, a + i, b + i, n - i, x0 + (int) i, y, level);
+    }
+
+    static void dither_1bit(uint8_t* dst, const uint8_t* gray, size_t n, int x0, int y) {
+        const uint8_t* row = SIMD_BAYER4[y & 3];
+        uint8_t t[16];
+        for (int j = 0; j < 16; j++) t[j] = row[(x0 + j) & 3] * 16 + 8;
+        const typename L::U8 thr = L::load_u8(t);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            uint16_t bits = L::lt_bits_u8(L::load_u8(gray + i), thr);  // Bit j = pixel j
+            dst[i >> 3] = reverse8((uint8_t) bits);
+            dst[(i >> 3) + 1] = reverse8((uint8_t) (bits >> 8));
+        }
+        SimdRef::dither_1bit(dst + (i >> 3), gray + i, n - i, x0 + (int) i, y);
+    }
+
+    static uint8_t reverse8(uint8_t b) {
+        static const uint8_t NIBBLE[16] = {0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+                                           0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF};
+        return (uint8_t) (NIBBLE[b & 15] << 4 | NIBBLE[b >> 4]);
+    }
+};
+
+#if CLAWD_SIMD_PIE
+// ESP32-S3 PIE: 128-bit q registers, 16-byte aligned loads/stores
+struct SimdPie {
+    static bool aligned(const void* p) { return ((uintptr_t) p & 15) == 0; }
+
+    static void mix_s16(int16_t* dst, const int16_t* a, const int16_t* b, size_t n) {
+        size_t blocks = (aligned(dst) && aligned(a) && aligned(b)) ? n / 8 : 0;
+        int16_t* d = dst;
+        const int16_t* pa = a;
+        const int16_t* pb = b;
+        for (size_t k = 0; k < blocks; k++) {
+            asm volatile(
+                "ee.vld.128.ip q0, %0, 16\n"
+                "ee.vld.128.ip q1, %1, 16\n"
+                "ee.vadds.s16 q2, q0, q1\n"
+                "ee.vst.128.ip q2, %2, 16\n"
+                : "+r"(pa), "+r"(pb), "+r"(d)
+                :
+                : "memory");
+        }
+        size_t done = blocks * 8;
+        SimdRef::mix_s16(dst + done, a + done, b + done, n - done);
+    }
+
+    static int32_t peak_s16(const int16_t* src, size_t n) {
+        size_t blocks = aligned(src) ? n / 8 : 0;
+        int32_t peak = 0;
+        if (blocks) {
+            alignas(16) int16_t hi[8], lo[8];
+            const int16_t* p = src;
+            int16_t* ph = hi;
+            int16_t* pl = lo;
+            size_t rest = blocks - 1;
+            asm volatile(
+                "ee.vld.128.ip q1, %0, 16\n"
+                "mv.qr q2, q1\n"
+                "beqz %1, 2f\n"
+                "1:\n"
+                "ee.vld.128.ip q0, %0, 16\n"
+                "ee.vmax.s16 q1, q1, q0\n"
+                "ee.vmin.s16 q2, q2, q0\n"
+                "addi %1, %1, -1\n"
+                "bnez %1, 1b\n"
+                "2:\n"
+                "ee.vst.128.ip q1, %2, 0\n"
+                "ee.vst.128.ip q2, %3, 0\n"
+                : "+r"(p), "+r"(rest), "+r"(ph), "+r"(pl)
+                :
+                : "memory");
+            for (int j = 0; j < 8; j++) {
+                int32_t h = hi[j], l = -(int32_t) lo[j];
+                if (h > peak) peak = h;
+                if (l > peak) peak = l;
+            }
+        }
+        int32_t tail = SimdRef::peak_s16(src + blocks * 8, n - blocks * 8);
+        return tail > peak ? tail : peak;
+    }
+};
+#endif
+
+class Simd {
+public:
+#if CLAWD_SIMD_SSE2
+    typedef SimdKernels<SimdLanesSse2> Best;
+#elif CLAWD_SIMD_NEON
+    typedef SimdKernels<SimdLanesNeon> Best;
+#else
+    typedef SimdRef Best;
+#endif
+
+    // Check the hand-written paths against SimdRef (ESP32-S3); false means
+    // they disagreed and SimdRef is used instead
+    static bool begin() {
+#if CLAWD_SIMD_PIE
+        alignas(16) int16_t a[40], b[40], want[40], got[40];
+        for (int i = 0; i < 40; i++) {
+            a[i] = (int16_t) (i * 1733 - 30000);
+            b[i] = (int16_t) (i & 1 ? 32767 - i * 97 : -32768 + i * 131);
+        }
+        SimdRef::mix_s16(want, a, b, 40);
+        SimdPie::mix_s16(got, a, b, 40);
+        bool ok = memcmp(want, got, sizeof(want)) == 0;
+        ok = ok && SimdPie::peak_s16(a, 40) == SimdRef::peak_s16(a, 40);
+        ok = ok && SimdPie::peak_s16(b, 40) == SimdRef::peak_s16(b, 40);
+        pie_ok() = ok;
+        return ok;
+#else
+        return true;
+#endif
+    }
+
+    static const char* backend() {
+#if CLAWD_SIMD_SSE2
+        return "sse2";
+#elif CLAWD_SIMD_NEON
+        return "neon";
+#elif CLAWD_SIMD_PIE
+        return pie_ok() ? "pie" : "scalar (pie failed self-test)";
+#else
+        return "scalar";
+#endif
+    }
+
+    static void mix_s16(int16_t* dst, const int16_t* a, const int16_t* b, size_t n) {
+#if CLAWD_SIMD_PIE
+        if (pie_ok()) return SimdPie::mix_s16(dst, a, b, n);
+#endif
+        Best::mix_s16(dst, a, b, n);
+    }
+    static void gain_s16(int16_t* dst, const int16_t* src, size_t n, int16_t gain, uint8_t shift) {
+        Best::gain_s16(dst, src, n, gain, shift);
+    }
+    static int32_t peak_s16(const int16_t* src, size_t n) {
+#if CLAWD_SIMD_PIE
+        if (pie_ok()) return SimdPie::peak_s16(src, n);
+#endif
+        return Best::peak_s16(src, n);
+    }
+    static void blend_rgb565(uint16_t* dst, const uint16_t* a, const uint16_t* b, size_t n, uint8_t alpha) {
+        Best::blend_rgb565(dst, a, b, n, alpha);
+    }
+    static void dither_select_rgb565(uint16_t* dst, const uint16_t* a, const uint16_t* b, size_t n, int x0, int y,
+                                     uint8_t level) {
+        Best::dither_select_rgb565(dst, a, b, n, x0, y, level);
+    }
+    static void dither_1bit(uint8_t* dst, const uint8_t* gray, size_t n, int x0, int y) {
+        Best::dither_1bit(dst, gray, n, x0, y);
+    }
+
+private:
+    static bool& pie_ok() {
+        static bool ok = false;
+        return ok;
+    }
+};